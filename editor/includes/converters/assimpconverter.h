@@ -24,6 +24,10 @@ class AssimpImportSettings : public AssetConverterSettings {
         A_PROPERTY(float, Custom_Scale, AssimpImportSettings::customScale, AssimpImportSettings::setCustomScale),
         A_PROPERTY(bool, Import_Color, AssimpImportSettings::colors, AssimpImportSettings::setColors),
         A_PROPERTY(bool, Import_Normals, AssimpImportSettings::normals, AssimpImportSettings::setNormals),
+        A_PROPERTY(bool, Pack_Vertices, AssimpImportSettings::packVertices, AssimpImportSettings::setPackVertices),
+        A_PROPERTY(bool, Optimize_Mesh, AssimpImportSettings::optimizeMesh, AssimpImportSettings::setOptimizeMesh),
+        A_PROPERTY(bool, Build_Clusters, AssimpImportSettings::buildClusters, AssimpImportSettings::setBuildClusters),
+        A_PROPERTY(int, Lod_Count, AssimpImportSettings::lodCount, AssimpImportSettings::setLodCount),
         A_PROPERTY(bool, Import_Animation, AssimpImportSettings::animation, AssimpImportSettings::setAnimation),
         A_PROPERTYEX(Compression, Compress_Animation, AssimpImportSettings::filter, AssimpImportSettings::setFilter, "enum=Compression"),
         A_PROPERTY(float, Position_Error, AssimpImportSettings::positionError, AssimpImportSettings::setPositionError),
@@ -50,6 +54,18 @@ public:
     bool normals() const;
     void setNormals(bool value);
 
+    bool packVertices() const;
+    void setPackVertices(bool value);
+
+    bool optimizeMesh() const;
+    void setOptimizeMesh(bool value);
+
+    bool buildClusters() const;
+    void setBuildClusters(bool value);
+
+    int lodCount() const;
+    void setLodCount(int value);
+
     bool animation() const;
     void setAnimation(bool value);
 
@@ -93,6 +109,10 @@ protected:
 
     bool m_colors;
     bool m_normals;
+    bool m_packVertices;
+    bool m_optimizeMesh;
+    bool m_buildClusters;
+    int m_lodCount;
 
     bool m_animation;
     int m_filter;
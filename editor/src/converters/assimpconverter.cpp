@@ -24,7 +24,9 @@
 
 #include "systems/resourcesystem.h"
 
-#define FORMAT_VERSION 9
+#include "utils/meshoptimizer.h"
+
+#define FORMAT_VERSION 12
 
 int32_t indexOf(const aiBone *item, const BonesList &list) {
     int i = 0;
@@ -65,6 +67,10 @@ AssimpImportSettings::AssimpImportSettings() :
         m_scale(1.0f),
         m_colors(true),
         m_normals(true),
+        m_packVertices(true),
+        m_optimizeMesh(true),
+        m_buildClusters(false),
+        m_lodCount(3),
         m_animation(true),
         m_filter(Keyframe_Reduction),
         m_positionError(0.5f),
@@ -98,6 +104,47 @@ void AssimpImportSettings::setNormals(bool value) {
     }
 }
 
+bool AssimpImportSettings::packVertices() const {
+    return m_packVertices;
+}
+void AssimpImportSettings::setPackVertices(bool value) {
+    if(m_packVertices != value) {
+        m_packVertices = value;
+        setModified();
+    }
+}
+
+bool AssimpImportSettings::optimizeMesh() const {
+    return m_optimizeMesh;
+}
+void AssimpImportSettings::setOptimizeMesh(bool value) {
+    if(m_optimizeMesh != value) {
+        m_optimizeMesh = value;
+        setModified();
+    }
+}
+
+bool AssimpImportSettings::buildClusters() const {
+    return m_buildClusters;
+}
+void AssimpImportSettings::setBuildClusters(bool value) {
+    if(m_buildClusters != value) {
+        m_buildClusters = value;
+        setModified();
+    }
+}
+
+int AssimpImportSettings::lodCount() const {
+    return m_lodCount;
+}
+void AssimpImportSettings::setLodCount(int value) {
+    value = CLAMP(value, 0, 8);
+    if(m_lodCount != value) {
+        m_lodCount = value;
+        setModified();
+    }
+}
+
 bool AssimpImportSettings::animation() const {
     return m_animation;
 }
@@ -628,6 +675,29 @@ Mesh *AssimpConverter::importMesh(const aiScene *scene, const aiNode *element, A
             index++;
         }
 
+        // Levels authored in the model have their own meshes
+        if(lod == 0 && fbxSettings->lodCount() > 0) {
+            MeshOptimizer::generateLods(*mesh, fbxSettings->lodCount());
+
+            aInfo() << "Mesh" << actor->name() << "LODs:" << mesh->lodCount() - 1;
+        }
+
+        if(fbxSettings->optimizeMesh()) {
+            MeshOptimizer::Statistics before = MeshOptimizer::analyzeVertexCache(*mesh);
+
+            int options = MeshOptimizer::VertexCache | MeshOptimizer::Overdraw | MeshOptimizer::VertexFetch;
+            if(fbxSettings->buildClusters()) {
+                options |= MeshOptimizer::Clusters;
+            }
+            MeshOptimizer::optimize(*mesh, options);
+
+            MeshOptimizer::Statistics after = MeshOptimizer::analyzeVertexCache(*mesh);
+
+            aInfo() << "Mesh" << actor->name() << "ACMR:" << before.acmr << "->" << after.acmr << "ATVR:" << before.atvr << "->" << after.atvr;
+        }
+
+        mesh->setPacked(fbxSettings->packVertices());
+
         Url dst(fbxSettings->absoluteDestination());
 
         AssetConverter::ReturnCode result = fbxSettings->saveBinary(Engine::toVariant(mesh), dst.absoluteDir() + "/" + info.uuid);
@@ -8,6 +8,7 @@
 
 #include "editor/projectsettings.h"
 #include "systems/resourcesystem.h"
+#include "utils/assetcontainer.h"
 
 #include "config.h"
 
@@ -419,7 +420,7 @@ AssetConverter::ReturnCode AssetConverterSettings::saveBinary(const Variant &dat
 
         Editor::project()->reportTypes(types);
 
-        file.write(Bson::save(data));
+        file.write(AssetContainer::pack(data));
         file.close();
 
         return AssetConverter::Success;
@@ -172,6 +172,19 @@ protected:
         return ::ftell(reinterpret_cast<FILE *>(handle));
     }
 
+    void *map(const char *path, size_t &size) override {
+        void *result = mapFile(path, size);
+        if(result == nullptr) {
+            for(auto &it : m_searchPath) {
+                result = mapFile((it + "/" + path).data(), size);
+                if(result) {
+                    break;
+                }
+            }
+        }
+        return result;
+    }
+
 protected:
     StringList m_searchPath;
 
@@ -3,6 +3,8 @@
 
 #include <physfs.h>
 
+#include <filesystem>
+
 #include <file.h>
 #include <log.h>
 
@@ -127,6 +129,16 @@ protected:
         return static_cast<size_t>(PHYSFS_tell(reinterpret_cast<PHYSFS_file *>(handle)));
     }
 
+    void *map(const char *path, size_t &size) override {
+        size = 0;
+        // Only files from mounted directories can be mapped, archived files must be read
+        const char *dir = PHYSFS_getRealDir(path);
+        if(dir && std::filesystem::is_directory(dir)) {
+            return mapFile((TString(dir) + "/" + path).data(), size);
+        }
+        return nullptr;
+    }
+
 };
 
 #endif // PHYSFSFILEHANDLER_H
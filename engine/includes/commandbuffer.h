@@ -13,6 +13,7 @@
 #define UNIFORM_BIND    4
 
 class ComputeInstance;
+class CommandList;
 class RenderTarget;
 class Texture;
 class Mesh;
@@ -66,6 +67,10 @@ public:
 
     virtual void flipResult();
 
+    virtual void execute(const CommandList &list);
+
+    virtual bool isComputeSupported() const;
+
     static Vector4 idToColor(uint32_t id);
 
     static bool isInited();
@@ -0,0 +1,130 @@
+#ifndef COMMANDLIST_H
+#define COMMANDLIST_H
+
+#include "engine.h"
+
+class CommandBuffer;
+class MaterialInstance;
+class RenderTarget;
+class Mesh;
+
+class ENGINE_EXPORT CommandList {
+public:
+    enum Type {
+        SetTarget = 1,
+        SetTile,
+        SetViewport,
+        SetViewProjection,
+        BindMaterial,
+        DrawInstanced,
+        EnableScissor,
+        DisableScissor,
+        BeginMarker,
+        EndMarker
+    };
+
+    struct TargetCommand {
+        RenderTarget *target;
+
+        uint32_t level;
+    };
+
+    struct TileCommand {
+        RenderTarget *target;
+
+        int32_t index;
+    };
+
+    struct RectCommand {
+        int32_t x;
+
+        int32_t y;
+
+        int32_t width;
+
+        int32_t height;
+    };
+
+    struct MatrixCommand {
+        areal matrix[16];
+    };
+
+    struct MaterialCommand {
+        MaterialInstance *instance;
+
+        const ByteArray *instances;
+    };
+
+    struct DrawCommand {
+        Mesh *mesh;
+
+        uint32_t subMesh;
+
+        uint32_t layer;
+    };
+
+    struct MarkerCommand {
+        uint32_t name;
+    };
+
+public:
+    CommandList();
+
+    void clear();
+
+    bool isEmpty() const;
+
+    void setRenderTarget(RenderTarget *target, uint32_t level = 0);
+
+    void setTileIndex(RenderTarget *target, int32_t index);
+
+    void setViewport(int32_t x, int32_t y, int32_t width, int32_t height);
+
+    void setViewProjection(const Matrix4 &viewProjection);
+
+    void bindMaterial(MaterialInstance *instance, const ByteArray *instances = nullptr);
+
+    void drawInstanced(Mesh *mesh, uint32_t subMesh, uint32_t layer);
+
+    void enableScissor(int32_t x, int32_t y, int32_t width, int32_t height);
+
+    void disableScissor();
+
+    void beginDebugMarker(const TString &name);
+
+    void endDebugMarker();
+
+    uint32_t count() const;
+
+    Type type(uint32_t index) const;
+
+    template<typename T>
+    const T &command(uint32_t index) const {
+        return *reinterpret_cast<const T *>(&m_data[m_offsets[index] + sizeof(Header)]);
+    }
+
+    const TString &string(uint32_t index) const;
+
+    const ByteArray &data() const;
+
+    TString dump() const;
+
+private:
+    struct Header {
+        uint32_t type;
+
+        uint32_t size;
+    };
+
+    void *append(Type type, uint32_t size);
+
+private:
+    ByteArray m_data;
+
+    std::vector<uint32_t> m_offsets;
+
+    std::vector<TString> m_strings;
+
+};
+
+#endif // COMMANDLIST_H
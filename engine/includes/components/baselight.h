@@ -2,6 +2,7 @@
 #define BASELIGHT_H
 
 #include <renderable.h>
+#include <renderqueue.h>
 
 #include <amath.h>
 
@@ -50,9 +51,9 @@ public:
 
     const Matrix4 &cropMatrix(int index);
 
-    const Renderable::GroupList &groups(int index) const;
+    const RenderQueue &queue(int index) const;
 
-    void buildGroups(const Renderable::RenderList &list);
+    void buildGroups(World *world);
 
 
 protected:
@@ -74,7 +75,7 @@ protected:
 
     std::vector<Frustum> m_viewFrustum;
 
-    std::vector<Renderable::GroupList> m_groups;
+    std::vector<RenderQueue> m_queues;
 
     Vector4 m_params;
 
@@ -5,11 +5,18 @@
 
 #include "resources/visualeffect.h"
 
+class CommandBuffer;
+
+namespace EngineSuite {
+    class VisualEffectTest;
+}
+
 class ENGINE_EXPORT EffectRender : public Renderable {
     A_OBJECT(EffectRender, Renderable, Components/Effects)
 
     A_PROPERTIES(
-        A_PROPERTYEX(VisualEffect *, effect, EffectRender::effect, EffectRender::setEffect, "editor=Asset")
+        A_PROPERTYEX(VisualEffect *, effect, EffectRender::effect, EffectRender::setEffect, "editor=Asset"),
+        A_PROPERTY(int, offscreenInterval, EffectRender::offscreenInterval, EffectRender::setOffscreenInterval)
     )
     A_NOMETHODS()
 
@@ -20,6 +27,9 @@ public:
     VisualEffect *effect() const;
     void setEffect(VisualEffect *effect);
 
+    int offscreenInterval() const;
+    void setOffscreenInterval(int interval);
+
     void deltaUpdate(float dt);
 
 private:
@@ -27,15 +37,40 @@ private:
 
     Mesh *meshToDraw() override;
 
-    void update() override;
+    bool prepareSimulation(float dt);
+    void simulate();
+    void publish();
+
+    bool dispatch(CommandBuffer &buffer);
+    void releaseKernel();
 
     static void effectUpdated(int state, void *ptr);
 
 private:
+    friend class PipelineContext;
+    friend class EngineSuite::VisualEffectTest;
+
     VisualEffect::Buffers m_data;
 
     VisualEffect *m_effect;
 
+    ComputeBuffer *m_particlesBuffer;
+    ComputeBuffer *m_emitterBuffer;
+    ComputeBuffer *m_stateBuffer;
+    ComputeBuffer *m_instancesBuffer;
+
+    std::vector<ComputeInstance *> m_kernelStages;
+
+    float m_deltaTime;
+
+    int m_offscreenInterval;
+
+    int m_skippedFrames;
+
+    int m_invisibleFrames;
+
+    bool m_ready;
+
 };
 
 #endif // EFFECTRENDER_H
@@ -36,6 +36,9 @@ protected:
     AABBox localBound() override;
 
     Mesh *meshToDraw() override;
+    Mesh *meshToStream() override;
+
+    void setLod(uint32_t lod) override;
 
     void drawGizmosSelected() override;
 
@@ -52,11 +52,24 @@ public:
 
 protected:
     virtual Mesh *meshToDraw();
+    virtual Mesh *meshToStream();
+
+    virtual int chunkCount();
+    virtual Mesh *chunkToDraw(int index);
+    virtual bool isChunkVisible(int index);
+    virtual void cullChunks(const Frustum *frustum);
+    virtual void updateChunks();
+
+    virtual bool isBatchable() const;
 
     virtual AABBox localBound();
 
     virtual void setLod(uint32_t lod);
 
+    bool updateLod(const Vector3 &center, float radius, const Vector3 &up, const Matrix4 &viewProjection);
+
+    static float screenSize(const Vector3 &center, float radius, const Vector3 &up, const Matrix4 &viewProjection);
+
     virtual void setMaterialsList(const std::list<Material *> &materials);
 
     void applyBlendShapeWeights(Mesh &mesh, Mesh &instance, const std::vector<float> &weights);
@@ -64,6 +77,7 @@ protected:
 protected:
     friend class PipelineContext;
     friend class PipelineTask;
+    friend class RenderQueue;
 
     std::vector<MaterialInstance *> m_materials;
 
@@ -71,6 +85,10 @@ protected:
 
     uint32_t m_lod;
 
+    uint32_t m_meshLod;
+
+    float m_screenSize;
+
 private:
     mutable AABBox m_localBox;
     mutable AABBox m_worldBox;
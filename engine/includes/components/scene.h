@@ -5,6 +5,9 @@
 
 class Map;
 class World;
+class BoundingTree;
+class TransformStorage;
+class JobSystem;
 
 class ENGINE_EXPORT Scene : public Object {
     A_OBJECT(Scene, Object, General)
@@ -33,6 +36,14 @@ public:
     ObjectList &getObjectsInGroup(const TString &group);
     ObjectList &getObjectsInGroupByHash(uint32_t hash);
 
+    void updateBounds(bool refitStatic);
+
+    void updateTransforms(JobSystem *jobs);
+
+    void queryRenderables(const Frustum &frustum, ObjectList &result);
+    void queryRenderables(const Vector3 &center, float radius, ObjectList &result);
+    void queryRenderables(const AABBox &box, ObjectList &result);
+
     Map *map() const;
     void setMap(Map *map);
 
@@ -40,9 +51,26 @@ public:
     void setModified(bool flag);
 
 private:
+    struct Proxy {
+        BoundingTree *tree = nullptr;
+
+        int32_t index = -1;
+    };
+
     std::mutex m_mutex;
+
     std::unordered_map<uint32_t, Object::ObjectList> m_groups;
 
+    std::unordered_map<Object *, Proxy> m_proxies;
+
+    Object::ObjectList m_unbound;
+
+    BoundingTree *m_dynamicTree;
+
+    BoundingTree *m_staticTree;
+
+    TransformStorage *m_transforms;
+
     mutable Map *m_map;
 
     bool m_modified;
@@ -68,6 +68,8 @@ public:
 protected:
     Mesh *meshToDraw() override;
 
+    bool isBatchable() const override;
+
     void setMaterialsList(const std::list<Material *> &materials) override;
 
     AABBox localBound() override;
@@ -36,11 +36,21 @@ private:
 
     Mesh *meshToDraw() override;
 
+    int chunkCount() override;
+    Mesh *chunkToDraw(int index) override;
+    bool isChunkVisible(int index) override;
+    void cullChunks(const Frustum *frustum) override;
+    void updateChunks() override;
+
+    bool isBatchable() const override;
+
     void setMaterialsList(const std::list<Material *> &materials) override;
 
     void composeComponent() override;
 
 private:
+    std::vector<bool> m_visibleChunks;
+
     TileMap *m_tileMap;
 
     int m_priority;
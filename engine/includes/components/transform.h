@@ -5,6 +5,8 @@
 
 #include <mutex>
 
+class TransformStorage;
+
 class ENGINE_EXPORT Transform : public Component {
     A_OBJECT(Transform, Component, General)
 
@@ -67,6 +69,7 @@ protected:
 
 protected:
     friend class Actor;
+    friend class TransformStorage;
 
     Vector3 m_position;
     Vector3 m_rotation;
@@ -85,8 +88,14 @@ protected:
 
     Transform *m_parent;
 
+    TransformStorage *m_storage;
+
     mutable std::mutex m_mutex;
 
+    int32_t m_slot;
+
+    int32_t m_pendingSlot;
+
     mutable uint32_t m_hash;
     mutable bool m_dirty;
 
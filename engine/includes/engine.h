@@ -11,7 +11,8 @@ class ResourceSystem;
 class RenderSystem;
 class Resource;
 class World;
-class SystemRunner;
+class SystemScheduler;
+class JobSystem;
 class PlatformAdaptor;
 class NativeBehaviour;
 
@@ -94,6 +95,10 @@ public:
 
     static RenderSystem *renderSystem();
 
+    static JobSystem *jobSystem();
+
+    static SystemScheduler *systemScheduler();
+
     static System *getSystem(const TString &name);
 
     static World *world();
@@ -139,8 +144,6 @@ private:
 private:
     static VariantMap m_values;
 
-    static std::list<SystemRunner *> m_pool;
-    static std::list<System *> m_serial;
 };
 
 #endif // ENGINE_H
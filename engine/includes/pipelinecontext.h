@@ -19,11 +19,14 @@ class PipelineTask;
 
 class BaseLight;
 class Renderable;
+class EffectRender;
 class PostProcessSettings;
 class InstancingBatch;
 
 class Frustum;
 
+class JobCounter;
+
 typedef std::list<Renderable *> RenderList;
 typedef std::list<BaseLight *> LightList;
 
@@ -70,6 +73,8 @@ public:
 
     const std::list<PipelineTask *> &renderTasks() const;
 
+    uint64_t renderTargetMemory();
+
     void setCurrentCamera(Camera *camera);
     Camera *currentCamera() const;
 
@@ -91,12 +96,34 @@ public:
 private:
     void analizeGraph();
 
+    void compileGraph();
+
+    void cullRenderables(const Frustum &frustum, const Matrix4 &viewProjection);
+
+    void markVisible(Renderable *renderable);
+
+    void simulateEffects(bool update);
+
+    void requestTextures();
+
+    void prioritizeResources(const Vector3 &origin);
+
 protected:
     typedef std::map<TString, Texture *> BuffersMap;
     typedef std::map<TString, RenderTarget *> TargetsMap;
 
     typedef std::list<std::pair<PipelineContext::RenderCallback, void *>> Callbacks;
 
+    struct TransientTexture {
+        Texture *texture;
+
+        int format;
+
+        int filtering;
+
+        int downscale;
+    };
+
     Callbacks m_postObservers;
 
     RenderList m_sceneRenderables;
@@ -106,10 +133,30 @@ protected:
 
     std::list<std::pair<const PostProcessSettings *, float>> m_culledPostProcessSettings;
 
+    Object::ObjectList m_candidates;
+
+    std::vector<Renderable *> m_boundsRenderables;
+    std::vector<float> m_boundsX;
+    std::vector<float> m_boundsY;
+    std::vector<float> m_boundsZ;
+    std::vector<float> m_boundsRadius;
+    std::vector<uint8_t> m_visibility;
+    std::vector<uint32_t> m_visibleIndices;
+
+    std::vector<EffectRender *> m_effects;
+
+    std::unordered_map<Resource *, float> m_priorities;
+
+    JobCounter *m_effectsCounter;
+
     BuffersMap m_textureBuffers;
 
     std::list<PipelineTask *> m_renderTasks;
 
+    std::vector<PipelineTask *> m_liveTasks;
+
+    std::vector<TransientTexture> m_transients;
+
     World *m_world;
 
     Pipeline *m_pipeline;
@@ -127,6 +174,8 @@ protected:
 
     bool m_frustumCulling;
 
+    bool m_graphDirty;
+
 };
 
 #endif // PIPELINECONTEXT
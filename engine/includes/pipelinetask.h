@@ -29,10 +29,33 @@ public:
     TString outputName(int index) const;
     virtual Texture *output(int index);
 
+    int transientCount() const;
+    Texture *transient(int index) const;
+
     virtual void setEnabled(bool enable);
     bool isEnabled() const;
 
 protected:
+    int addTransient(const TString &name, int format, int filtering, int downscale);
+    virtual void setTransient(int index, Texture *texture);
+
+protected:
+    friend class PipelineContext;
+
+    struct Transient {
+        TString name;
+
+        int format;
+
+        int filtering;
+
+        int downscale;
+
+        Texture *texture;
+    };
+
+    std::vector<Transient> m_transients;
+
     std::vector<TString> m_inputs;
     std::vector<std::pair<TString, Texture *>> m_outputs;
 
@@ -23,6 +23,8 @@ private:
 
     void setEnabled(bool enable) override;
 
+    void setTransient(int index, Texture *texture) override;
+
 protected:
     Texture *m_noiseTexture;
     Texture *m_aoTexture;
@@ -44,6 +44,8 @@ private:
 
     void setInput(int index, Texture *source) override;
 
+    void setTransient(int index, Texture *texture) override;
+
     void generateKernel(float radius, int32_t steps, float *points);
 
 private:
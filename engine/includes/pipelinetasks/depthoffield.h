@@ -22,6 +22,8 @@ private:
 
     void setInput(int index, Texture *texture) override;
 
+    void setTransient(int index, Texture *texture) override;
+
     void generateKernel(float radius, int32_t steps, float *points);
 
 private:
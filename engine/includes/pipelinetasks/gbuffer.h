@@ -2,6 +2,8 @@
 #define GBUFFER_H
 
 #include "pipelinetask.h"
+#include "renderqueue.h"
+#include "commandlist.h"
 
 class RenderTarget;
 
@@ -17,7 +19,9 @@ private:
     void analyze(World *world) override;
 
 private:
-    Renderable::GroupList m_opaque;
+    RenderQueue m_opaque;
+
+    CommandList m_commands;
 
     RenderTarget *m_gbuffer;
 
@@ -2,8 +2,10 @@
 #define SHADOWMAP_H
 
 #include "pipelinetask.h"
+#include "commandlist.h"
 
 class RenderTarget;
+class RenderQueue;
 class AtlasNode;
 
 class DirectLight;
@@ -20,6 +22,7 @@ private:
     void exec() override;
 
     void lightUpdate(BaseLight *light, int count);
+    void recordTiles();
     void cleanShadowCache();
 
     const std::vector<AtlasNode *> *requestShadowTiles(uint32_t id, uint32_t lod, uint32_t count);
@@ -35,8 +38,20 @@ private:
         bool unused = true;
     };
 
+    struct ShadowTile {
+        Matrix4 crop;
+
+        const RenderQueue *queue = nullptr;
+
+        AtlasNode *node = nullptr;
+    };
+
     std::unordered_map<uint32_t, AtlasData> m_tiles;
 
+    std::vector<ShadowTile> m_shadowTiles;
+
+    std::vector<CommandList> m_commands;
+
     AtlasNode *m_root;
 
     RenderTarget *m_shadowTarget;
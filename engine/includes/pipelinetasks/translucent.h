@@ -2,6 +2,8 @@
 #define TRANSLUCENT_H
 
 #include "pipelinetask.h"
+#include "renderqueue.h"
+#include "commandlist.h"
 
 class RenderTarget;
 
@@ -19,7 +21,9 @@ private:
     void setInput(int index, Texture *texture) override;
 
 private:
-    Renderable::GroupList m_translucent;
+    RenderQueue m_translucent;
+
+    CommandList m_commands;
 
     RenderTarget *m_translucentPass;
 
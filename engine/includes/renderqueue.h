@@ -0,0 +1,105 @@
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include <renderable.h>
+
+#include <deque>
+
+class CommandList;
+
+class ENGINE_EXPORT RenderQueue {
+public:
+    struct Item {
+        uint64_t key = 0;
+
+        MaterialInstance *instance = nullptr;
+
+        Mesh *mesh = nullptr;
+
+        uint32_t subMesh = 0;
+
+        uint32_t hash = 0;
+
+        Renderable *renderable = nullptr;
+
+        bool batchable = false;
+    };
+
+    struct Batch {
+        MaterialInstance *instance = nullptr;
+
+        Mesh *mesh = nullptr;
+
+        const ByteArray *buffer = nullptr;
+
+        uint32_t subMesh = 0;
+
+        uint32_t count = 0;
+    };
+
+    typedef std::vector<Item> Items;
+    typedef std::vector<Batch> Batches;
+
+public:
+    RenderQueue();
+    RenderQueue(const RenderQueue &queue);
+    ~RenderQueue();
+
+    RenderQueue &operator=(const RenderQueue &queue);
+
+    void clear();
+
+    bool isBatching() const;
+    void setBatching(bool enable);
+
+    bool isChunkCulling() const;
+    void setChunkCulling(bool enable);
+
+    void add(const Renderable::RenderList &list, int layer, const Vector3 &origin = Vector3(), const Vector3 &direction = Vector3());
+
+    void build();
+
+    void record(CommandList &list, uint32_t layer) const;
+
+    bool isEmpty() const;
+
+    const Items &items() const;
+
+    const Batches &batches() const;
+
+    static uint64_t sortKey(int layer, int32_t priority, uint32_t hash, float depth);
+
+private:
+    void sort();
+
+    void mergeItems(uint32_t begin, uint32_t end);
+
+    ByteArray &nextBuffer();
+
+private:
+    Items m_items;
+    Items m_itemsSwap;
+
+    Batches m_batches;
+
+    std::deque<ByteArray> m_buffers;
+
+    std::vector<Mesh *> m_meshes;
+
+    uint32_t m_usedBuffers;
+
+    uint32_t m_usedMeshes;
+
+    bool m_batching;
+
+    bool m_chunkCulling;
+
+    std::vector<uint64_t> m_keys;
+    std::vector<uint64_t> m_keysSwap;
+
+    std::vector<uint32_t> m_indices;
+    std::vector<uint32_t> m_indicesSwap;
+
+};
+
+#endif // RENDERQUEUE_H
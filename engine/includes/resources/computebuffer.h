@@ -18,6 +18,10 @@ public:
     virtual ByteArray data() const;
     void setData(const ByteArray &data);
 
+protected:
+    void switchState(Resource::State state) override;
+    bool isUnloadable() override;
+
 protected:
     ByteArray m_buffer;
 
@@ -7,6 +7,7 @@
 class Transform;
 class MaterialInstance;
 class CommandBuffer;
+class ComputeBuffer;
 
 class ENGINE_EXPORT Material : public Resource {
     A_OBJECT(Material, Resource, Resources)
@@ -313,6 +314,10 @@ public:
 
     void setInstanceBuffer(const ByteArray *buffer);
 
+    ComputeBuffer *indirectInstances() const;
+    ComputeBuffer *indirectArguments() const;
+    void setIndirect(ComputeBuffer *instances, ComputeBuffer *arguments);
+
     uint32_t hash() const;
 
 protected:
@@ -322,8 +327,12 @@ protected:
 
     virtual void overrideTexture(int32_t binding, Texture *texture);
 
+    void updateHash();
+
 protected:
     friend class Material;
+    friend class PipelineContext;
+    friend class TextureStreamer;
 
     std::unordered_map<int32_t, Texture *> m_textureOverride;
 
@@ -331,6 +340,9 @@ protected:
 
     const ByteArray *m_batchBuffer;
 
+    ComputeBuffer *m_indirectInstances;
+    ComputeBuffer *m_indirectArguments;
+
     Material *m_material;
 
     uint32_t m_instanceCount;
@@ -15,11 +15,44 @@ class ENGINE_EXPORT Mesh : public Resource {
     A_NOPROPERTIES()
     A_METHODS(
         A_METHOD(bool, Mesh::isDynamic),
-        A_METHOD(void, Mesh::makeDynamic)
+        A_METHOD(void, Mesh::makeDynamic),
+        A_METHOD(bool, Mesh::isPacked),
+        A_METHOD(void, Mesh::setPacked)
     )
     A_NOENUMS()
 
 public:
+    enum Attribute {
+        Position = 0,
+        TexCoord0,
+        VertexColor,
+        Normal,
+        Tangent,
+        BoneIndices,
+        BoneWeights
+    };
+
+    enum VertexFormat {
+        Float2 = 0,
+        Float3,
+        Float4,
+        Half2,
+        Half4,
+        Unorm8x4,
+        Snorm10x3
+    };
+
+    struct VertexAttribute {
+        uint32_t location;
+
+        uint32_t format;
+
+        uint32_t offset;
+
+        uint32_t stride;
+    };
+    typedef std::vector<VertexAttribute> VertexLayout;
+
     struct BlendShapeFrame {
         float weight;
         IndexVector indices;
@@ -33,6 +66,21 @@ public:
         std::vector<BlendShapeFrame> frames;
     };
 
+    struct Cluster {
+        Vector3 center;
+
+        float radius;
+
+        Vector3 coneAxis;
+
+        float coneCutoff;
+
+        uint32_t indexStart;
+
+        uint32_t indexCount;
+    };
+    typedef std::vector<Cluster> ClusterVector;
+
     Mesh();
 
     bool operator== (const Mesh &right) const;
@@ -40,6 +88,9 @@ public:
     bool isDynamic() const;
     void makeDynamic();
 
+    bool isPacked() const;
+    void setPacked(bool packed);
+
     bool isEmpty() const;
     void clear();
 
@@ -83,6 +134,9 @@ public:
                             const Vector3Vector &normals = Vector3Vector(),
                             const Vector3Vector &tangents = Vector3Vector());
 
+    ClusterVector &clusters();
+    void setClusters(const ClusterVector &clusters);
+
     AABBox bound() const;
     void setBound(const AABBox &box);
 
@@ -91,6 +145,14 @@ public:
     int indexStart(int sub) const;
     int indexCount(int sub) const;
 
+    int lodCount() const;
+    float lodScreenSize(int lod) const;
+    void addLod(const IndexVector &indices, const IndexVector &offsets, float screenSize);
+    void clearLods();
+
+    int lodSubMesh(int sub, int lod) const;
+    int selectLod(float screenSize, int current, float hysteresis) const;
+
     Material *defaultMaterial(int sub = 0) const;
     void setDefaultMaterial(Material *material, int sub = 0);
 
@@ -101,6 +163,21 @@ public:
 
     void batchMesh(Mesh &mesh, const Matrix4 *transform = nullptr);
 
+    VertexLayout vertexLayout() const;
+
+    size_t vertexBufferSize() const;
+    void fillVertexBuffer(uint8_t *data) const;
+
+    uint32_t indexSize() const;
+
+    size_t indexBufferSize() const;
+    void fillIndexBuffer(uint8_t *data) const;
+
+    static uint32_t formatSize(uint32_t format);
+
+    uint64_t cpuMemory() const override;
+    uint64_t gpuMemory() const override;
+
 protected:
     void switchState(Resource::State state) override;
     bool isUnloadable() override;
@@ -132,14 +209,20 @@ private:
 
     std::vector<BlendShape> m_blendShapes;
 
+    ClusterVector m_clusters;
+
     IndexVector m_indices;
 
     IndexVector m_offsets;
 
+    std::vector<float> m_lodSizes;
+
     std::vector<Material *> m_defaultMaterials;
 
     bool m_dynamic;
 
+    bool m_packed;
+
 };
 
 #endif // MESH_H
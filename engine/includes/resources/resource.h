@@ -34,6 +34,9 @@ public:
     void incRef();
     void decRef();
 
+    virtual uint64_t cpuMemory() const;
+    virtual uint64_t gpuMemory() const;
+
     void subscribe(ResourceUpdatedCallback callback, void *object);
     void unsubscribe(void *object);
 
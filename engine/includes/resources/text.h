@@ -25,6 +25,8 @@ public:
 
     uint8_t *data();
 
+    uint64_t cpuMemory() const override;
+
 protected:
     void loadUserData(const VariantMap &data) override;
 
@@ -6,6 +6,7 @@
 #include "resource.h"
 
 class CommandBuffer;
+class TextureStreamer;
 
 class ENGINE_EXPORT Texture : public Resource {
     A_OBJECT(Texture, Resource, Resources)
@@ -117,6 +118,9 @@ public:
     int mipCount() const;
     void setMipCount(int levels);
 
+    int residentMip() const;
+    bool isStreamable() const;
+
     Surface &surface(int side);
     void addSurface(const Surface &surface);
 
@@ -145,13 +149,25 @@ public:
     static uint32_t maxCubemapSize();
     static void setMaxCubemapSize(uint32_t size);
 
+    static uint32_t streamingSize();
+    static void setStreamingSize(uint32_t size);
+
     virtual void readPixels(int x, int y, int width, int height);
     int getPixel(int x, int y, int level) const;
     ByteArray getPixels(int level) const;
 
     void resize(int width, int height);
 
+    uint64_t cpuMemory() const override;
+    uint64_t gpuMemory() const override;
+
 protected:
+    struct MipSection {
+        uint64_t offset;
+
+        uint64_t size;
+    };
+
     void loadUserData(const VariantMap &data) override;
     VariantMap saveUserData() const override;
 
@@ -166,9 +182,22 @@ protected:
     uint8_t components() const;
     uint8_t bytesPerChannel() const;
 
+    uint64_t mipsSize(int begin, int end) const;
+
+    void applyMips(int level, Sides &levels);
+    void evictMips(int level);
+
 protected:
+    friend class TextureStreamer;
+
     Texture::Sides m_sides;
 
+    std::vector<MipSection> m_mipSections;
+
+    TString m_mipSource;
+
+    TextureStreamer *m_streamer;
+
     int32_t m_format;
     int32_t m_compress;
     int32_t m_filtering;
@@ -178,6 +207,7 @@ protected:
     int32_t m_height;
     int32_t m_depth;
     int32_t m_mips;
+    int32_t m_residentMip;
 
     int32_t m_depthBits;
 
@@ -185,6 +215,7 @@ protected:
 
     static uint32_t s_maxTextureSize;
     static uint32_t s_maxCubemapSize;
+    static uint32_t s_streamingSize;
 
 };
 
@@ -22,7 +22,12 @@ class ENGINE_EXPORT TileMap : public Resource {
     )
 
 public:
+    enum {
+        ChunkSize = 32
+    };
+
     TileMap();
+    ~TileMap();
 
     TileSet *tileSet() const;
     void setTileSet(TileSet *set);
@@ -51,8 +56,15 @@ public:
     int hexSideLength() const;
     void setHexSideLength(int length);
 
-    Mesh *tileMesh() const;
+    int chunkCount() const;
+    Mesh *chunkMesh(int index) const;
+    AABBox chunkBound(int index) const;
+
+    AABBox bound() const;
+
+    Vector2 tilePosition(int x, int y) const;
 
+    void refreshChunks() const;
     void refreshAllTiles() const;
 
 protected:
@@ -60,6 +72,13 @@ protected:
 
     VariantMap saveUserData() const override;
 
+private:
+    void resizeChunks();
+
+    void markChunk(int x, int y);
+
+    void refreshChunk(int index) const;
+
 private:
     std::vector<int> m_data;
 
@@ -79,7 +98,11 @@ private:
 
     TileSet *m_tileSet;
 
-    Mesh *m_tileMesh;
+    std::vector<Mesh *> m_chunks;
+
+    mutable std::vector<bool> m_dirtyChunks;
+
+    int m_chunksX;
 
     mutable bool m_dirty;
 
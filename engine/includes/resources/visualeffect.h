@@ -6,6 +6,10 @@
 #include <material.h>
 #include <mesh.h>
 
+class ComputeShader;
+class ComputeInstance;
+class ComputeBuffer;
+
 class ENGINE_EXPORT VisualEffect : public Resource {
     A_OBJECT(VisualEffect, Resource, Resources)
 
@@ -24,28 +28,27 @@ public:
 
     typedef std::vector<float> FloatData;
 
-    struct Operator {
+    struct Instruction {
         int32_t op;
 
-        int32_t resultSpace;
-
-        int32_t resultOffset;
-
-        int32_t resultSize;
-
-        std::vector<Argument> arguments;
+        Argument result;
 
-        FloatData constData;
+        Argument arguments[3];
     };
 
+    typedef std::vector<Instruction> Program;
+
     struct Buffers {
         FloatData system;
         FloatData emitter;
         FloatData particles;
+        FloatData random;
 
-        std::vector<FloatData> render;
+        std::vector<ByteArray> render;
 
         int instances = 0;
+
+        int alive = 0;
     };
 
     struct Renderable {
@@ -66,11 +69,42 @@ public:
         Transform
     };
 
+    enum KernelStages {
+        KernelEmitter = 0,
+        KernelParticles,
+        KernelFinish
+    };
+
+    struct KernelState {
+        uint32_t indexCount = 0;
+        uint32_t instanceCount = 0;
+        uint32_t firstIndex = 0;
+        int32_t baseVertex = 0;
+        uint32_t baseInstance = 0;
+
+        int32_t spawn = 0;
+        uint32_t spawned = 0;
+        uint32_t padding = 0;
+    };
+
+    enum {
+        KernelGroupSize = 64
+    };
+
 public:
     VisualEffect();
+    ~VisualEffect();
 
     void update(Buffers &buffers);
 
+    void kernelUpdate(Buffers &buffers) const;
+
+    TString kernelSource() const;
+
+    ComputeShader *kernel();
+
+    ComputeInstance *createKernelInstance(int stage, ComputeBuffer *particles, ComputeBuffer *emitter, ComputeBuffer *state, ComputeBuffer *instances);
+
     int capacity() const;
     void setCapacity(int capacity);
 
@@ -91,16 +125,28 @@ public:
     int emitterStride() const;
     int particleStride() const;
 
+    const FloatData &randomStreams() const;
+
     AABBox bound() const;
 
     void loadUserData(const VariantMap &data) override;
 
 protected:
-    std::vector<Operator> m_emitterSpawnOperations;
-    std::vector<Operator> m_emitterUpdateOperations;
-    std::vector<Operator> m_particleSpawnOperations;
-    std::vector<Operator> m_particleUpdateOperations;
-    std::vector<Operator> m_renderOperations;
+    Program m_emitterSpawnProgram;
+    Program m_emitterUpdateProgram;
+    Program m_particleSpawnProgram;
+    Program m_particleUpdateProgram;
+    Program m_renderProgram;
+
+    FloatData m_constants;
+
+    FloatData m_random;
+
+    ComputeShader *m_kernel;
+
+    ComputeBuffer *m_kernelConstants;
+
+    bool m_kernelDirty;
 
     std::vector<Renderable> m_renderables;
 
@@ -121,9 +167,15 @@ protected:
     bool m_continous;
 
 private:
-    void apply(std::vector<Operator> &operations, Buffers &buffers, int particle = 0, int render = 0, int stride = 0) const;
+    void execute(const Program &program, Buffers &buffers, int begin, int count, float *render = nullptr, int stride = 0) const;
+
+    void compact(Buffers &buffers) const;
+
+    int kernelStride() const;
+
+    ComputeBuffer *kernelConstants();
 
-    void loadOperations(const VariantList &list, std::vector<Operator> &operations);
+    void loadOperations(const VariantList &list, Program &program);
 
     void loadRenderables(const VariantList &list);
 
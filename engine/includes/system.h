@@ -3,6 +3,8 @@
 
 #include <engine.h>
 
+#include <set>
+
 class Component;
 
 class ENGINE_EXPORT System : public ObjectSystem {
@@ -30,9 +32,24 @@ public:
 
     void processEvents() override;
 
+    const std::set<TString> &reads() const;
+
+    const std::set<TString> &writes() const;
+
+    bool isConflicting(const System *other) const;
+
+protected:
+    void declareRead(const TString &type);
+
+    void declareWrite(const TString &type);
+
 protected:
     World *m_world;
 
+    std::set<TString> m_reads;
+
+    std::set<TString> m_writes;
+
 };
 
 #endif // SYSTEM_H
@@ -4,6 +4,13 @@
 #include "system.h"
 #include "resource.h"
 
+class File;
+class AssetContainer;
+class BsonReader;
+class JobCounter;
+class JobSystem;
+class TextureStreamer;
+
 class ENGINE_EXPORT ResourceSystem : public System {
 public:
     struct ResourceInfo {
@@ -22,6 +29,22 @@ public:
 
     typedef void (*BundleUpdatedCallback)(const TString &path, bool unload, void *object);
 
+    struct CacheStatistics {
+        uint32_t hits = 0;
+
+        uint32_t misses = 0;
+
+        uint32_t evictions = 0;
+
+        uint32_t cachedCount = 0;
+
+        uint64_t cachedMemory = 0;
+
+        std::unordered_map<TString, uint64_t> cpuMemory;
+
+        std::unordered_map<TString, uint64_t> gpuMemory;
+    };
+
 public:
     ResourceSystem();
     ~ResourceSystem();
@@ -59,7 +82,47 @@ public:
     void subscribe(BundleUpdatedCallback callback, void *object);
     void unsubscribe(void *object);
 
+    void setPriority(Resource *resource, float priority);
+
+    std::list<Resource *> streamingQueue() const;
+
+    void cancelResource(Resource *resource);
+
+    float streamingBudget() const;
+    void setStreamingBudget(float budget);
+
+    uint32_t streamingCount() const;
+
+    JobSystem *jobSystem() const;
+    void setJobSystem(JobSystem *system);
+
+    TextureStreamer *textureStreamer() const;
+
+    uint64_t cacheBudget() const;
+    void setCacheBudget(uint64_t budget);
+
+    CacheStatistics cacheStatistics() const;
+    void resetCacheStatistics();
+
 private:
+    struct StreamRequest {
+        Resource *resource;
+
+        TString uuid;
+
+        float priority;
+
+        uint32_t ticket;
+    };
+
+    struct StreamResult;
+
+    struct CacheEntry {
+        std::list<Resource *>::iterator position;
+
+        uint64_t size;
+    };
+
     void update(World *) override;
 
     int threadPolicy() const override;
@@ -68,7 +131,26 @@ private:
 
     Object *instantiateObject(const MetaObject *meta, const TString &name, Object *parent) override;
 
-    void processState(Resource *resource);
+    void processState(Resource *resource, bool force = false);
+
+    Object *readObject(File &fp, const TString &uuid);
+
+    Object *deserialize(const Variant &data, const AssetContainer &container, const TString &uuid);
+    Object *deserialize(const BsonReader &reader, const AssetContainer &container, const TString &uuid);
+
+    void request(Resource *resource, const TString &uuid);
+
+    static bool lessImportant(const StreamRequest &left, const StreamRequest &right);
+
+    void dispatch();
+
+    void finalize();
+
+    void cacheResource(Resource *resource);
+
+    void uncacheResource(Resource *resource);
+
+    void trimCache();
 
     void removeObject(Object *object) override;
 
@@ -85,6 +167,36 @@ private:
 
     ObjectList m_deleteList;
 
+    std::vector<StreamRequest> m_queue;
+
+    std::unordered_map<Resource *, uint32_t> m_tickets;
+
+    std::list<StreamResult *> m_decoded;
+
+    mutable std::mutex m_streamMutex;
+
+    JobSystem *m_jobSystem;
+
+    JobCounter *m_streamCounter;
+
+    TextureStreamer *m_textureStreamer;
+
+    std::list<Resource *> m_suspended;
+
+    std::unordered_map<Resource *, CacheEntry> m_cacheIndex;
+
+    CacheStatistics m_statistics;
+
+    uint64_t m_cacheBudget;
+
+    uint64_t m_cachedMemory;
+
+    float m_streamingBudget;
+
+    uint32_t m_inFlight;
+
+    uint32_t m_nextTicket;
+
     bool m_clean;
 
 };
@@ -0,0 +1,94 @@
+#ifndef SYSTEMSCHEDULER_H
+#define SYSTEMSCHEDULER_H
+
+#include <engine.h>
+
+#include <atomic>
+#include <chrono>
+
+class System;
+class JobSystem;
+class JobCounter;
+
+class ENGINE_EXPORT SystemScheduler {
+public:
+    struct Record {
+        System *system = nullptr;
+
+        int32_t thread = 0;
+
+        float start = 0.0f;
+
+        float end = 0.0f;
+
+        bool critical = false;
+    };
+
+    typedef std::vector<Record> Records;
+
+public:
+    SystemScheduler();
+    ~SystemScheduler();
+
+    void addSystem(System *system);
+    void removeSystem(System *system);
+
+    const std::list<System *> &systems() const;
+
+    std::list<System *> dependencies(System *system);
+
+    void execute(World *world, JobSystem *jobs);
+
+    const Records &records() const;
+
+    float criticalPath() const;
+
+    TString dump() const;
+
+private:
+    struct Node {
+        System *system = nullptr;
+
+        std::vector<Node *> successors;
+
+        std::vector<Node *> predecessors;
+
+        std::atomic<int32_t> remaining = { 0 };
+
+        std::atomic<bool> ready = { false };
+
+        bool main = true;
+
+        int32_t thread = 0;
+
+        float start = 0.0f;
+
+        float end = 0.0f;
+    };
+
+    void build();
+
+    void launch(Node *node, World *world, JobSystem *jobs, JobCounter *counter);
+
+    void run(Node *node, World *world);
+
+    void complete(Node *node, World *world, JobSystem *jobs, JobCounter *counter);
+
+    void record();
+
+private:
+    std::list<System *> m_systems;
+
+    std::vector<Node *> m_nodes;
+
+    Records m_records;
+
+    std::chrono::steady_clock::time_point m_frameStart;
+
+    float m_criticalPath;
+
+    bool m_dirty;
+
+};
+
+#endif // SYSTEMSCHEDULER_H
@@ -0,0 +1,83 @@
+#ifndef ASSETCONTAINER_H
+#define ASSETCONTAINER_H
+
+#include <engine.h>
+#include <bson.h>
+
+class ENGINE_EXPORT AssetContainer {
+public:
+    AssetContainer();
+    ~AssetContainer();
+
+    bool open(const TString &path);
+    bool load(ByteArray data, const TString &path = TString());
+
+    void close();
+
+    bool isValid() const;
+    bool isMapped() const;
+
+    TString path() const;
+
+    uint32_t sectionCount() const;
+
+    const uint8_t *section(uint32_t index) const;
+    uint64_t sectionOffset(uint32_t index) const;
+    uint64_t sectionSize(uint32_t index) const;
+
+    Variant metadata() const;
+    BsonReader metadataReader() const;
+
+    static bool isContainer(const uint8_t *data, size_t size);
+
+    static ByteArray pack(const Variant &objects);
+
+    static const AssetContainer *current();
+    static void setCurrent(const AssetContainer *container);
+
+    static bool blob(const Variant &value, const uint8_t *&data, size_t &size);
+
+private:
+    AssetContainer(const AssetContainer &) = delete;
+    AssetContainer &operator=(const AssetContainer &) = delete;
+
+    struct Header {
+        uint32_t magic;
+
+        uint32_t version;
+
+        uint32_t sections;
+
+        uint32_t reserved;
+
+        uint64_t table;
+
+        uint64_t size;
+    };
+
+    struct Section {
+        uint64_t offset;
+
+        uint64_t size;
+    };
+
+    bool parse();
+
+private:
+    ByteArray m_buffer;
+
+    TString m_path;
+
+    const uint8_t *m_data;
+
+    size_t m_size;
+
+    const Section *m_sections;
+
+    uint32_t m_count;
+
+    bool m_mapped;
+
+};
+
+#endif // ASSETCONTAINER_H
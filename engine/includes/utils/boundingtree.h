@@ -0,0 +1,71 @@
+#ifndef BOUNDINGTREE_H
+#define BOUNDINGTREE_H
+
+#include <engine.h>
+
+#include <amath.h>
+
+class ENGINE_EXPORT BoundingTree {
+public:
+    explicit BoundingTree(float margin = 0.1f);
+
+    int32_t insert(const AABBox &box, Object *object);
+    void remove(int32_t proxy);
+    bool update(int32_t proxy, const AABBox &box);
+
+    Object *object(int32_t proxy) const;
+    AABBox fatBox(int32_t proxy) const;
+
+    void clear();
+
+    int32_t count() const;
+    int32_t height() const;
+
+    void query(const Frustum &frustum, Object::ObjectList &result) const;
+    void query(const Vector3 &center, float radius, Object::ObjectList &result) const;
+    void query(const AABBox &box, Object::ObjectList &result) const;
+
+private:
+    struct Node {
+        Vector3 min;
+        Vector3 max;
+
+        Object *object = nullptr;
+
+        int32_t parent = -1;
+
+        int32_t left = -1;
+
+        int32_t right = -1;
+
+        int32_t height = -1;
+
+        bool isLeaf() const { return left == -1; }
+    };
+
+    int32_t allocate();
+    void release(int32_t index);
+
+    void insertLeaf(int32_t leaf);
+    void removeLeaf(int32_t leaf);
+
+    int32_t balance(int32_t index);
+
+    void refit(int32_t index);
+
+    void collect(int32_t index, Object::ObjectList &result) const;
+
+private:
+    std::vector<Node> m_nodes;
+
+    int32_t m_root;
+
+    int32_t m_free;
+
+    int32_t m_count;
+
+    float m_margin;
+
+};
+
+#endif // BOUNDINGTREE_H
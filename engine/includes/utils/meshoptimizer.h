@@ -0,0 +1,42 @@
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <engine.h>
+
+#include "resources/mesh.h"
+
+class ENGINE_EXPORT MeshOptimizer {
+public:
+    enum Options {
+        VertexCache = (1<<0),
+        Overdraw    = (1<<1),
+        VertexFetch = (1<<2),
+        Clusters    = (1<<3)
+    };
+
+    struct Statistics {
+        float acmr = 0.0f;
+
+        float atvr = 0.0f;
+    };
+
+    static Statistics analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize = 16);
+    static Statistics analyzeVertexCache(Mesh &mesh, uint32_t cacheSize = 16);
+
+    static void optimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount);
+
+    static void optimizeOverdraw(uint32_t *indices, size_t indexCount, const Vector3 *vertices, size_t vertexCount);
+
+    static void optimizeVertexFetch(Mesh &mesh);
+
+    static IndexVector simplify(Mesh &mesh, const uint32_t *indices, size_t indexCount, size_t targetIndexCount, float targetError, float *resultError = nullptr);
+
+    static void generateLods(Mesh &mesh, uint32_t count, float ratio = 0.5f, float maxError = 0.1f);
+
+    static Mesh::ClusterVector buildClusters(Mesh &mesh, uint32_t maxVertices = 64, uint32_t maxTriangles = 124);
+
+    static void optimize(Mesh &mesh, int options = VertexCache | Overdraw | VertexFetch);
+
+};
+
+#endif // MESHOPTIMIZER_H
@@ -0,0 +1,81 @@
+#ifndef TEXTURESTREAMER_H
+#define TEXTURESTREAMER_H
+
+#include <engine.h>
+
+class Texture;
+class MaterialInstance;
+class JobCounter;
+
+class ENGINE_EXPORT TextureStreamer {
+public:
+    TextureStreamer();
+    ~TextureStreamer();
+
+    uint64_t budget() const;
+    void setBudget(uint64_t budget);
+
+    uint64_t residentSize() const;
+
+    uint32_t textureCount() const;
+
+    void add(Texture *texture);
+    void remove(Texture *texture);
+
+    void request(Texture *texture, float size);
+    void request(const MaterialInstance &instance, float size);
+
+    void update();
+
+private:
+    TextureStreamer(const TextureStreamer &) = delete;
+    TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+    struct Entry {
+        int32_t requested = 0;
+
+        int32_t tail = 0;
+
+        uint32_t used = 0;
+
+        uint32_t added = 0;
+
+        uint32_t ticket = 0;
+
+        bool scene = false;
+
+        bool loading = false;
+    };
+
+    struct Result;
+
+    void finalize();
+
+    void load(Texture *texture, Entry &entry);
+
+    bool evict(uint64_t size);
+
+private:
+    std::unordered_map<Texture *, Entry> m_textures;
+
+    std::vector<Texture *> m_pending;
+
+    std::list<Result *> m_results;
+
+    mutable std::mutex m_mutex;
+
+    JobCounter *m_counter;
+
+    uint64_t m_budget;
+
+    uint64_t m_residentSize;
+
+    uint32_t m_frame;
+
+    uint32_t m_loading;
+
+    uint32_t m_nextTicket;
+
+};
+
+#endif // TEXTURESTREAMER_H
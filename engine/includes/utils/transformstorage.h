@@ -0,0 +1,62 @@
+#ifndef TRANSFORMSTORAGE_H
+#define TRANSFORMSTORAGE_H
+
+#include <engine.h>
+
+#include <amath.h>
+
+class Transform;
+class JobSystem;
+
+class ENGINE_EXPORT TransformStorage {
+public:
+    TransformStorage();
+    ~TransformStorage();
+
+    void add(Transform *transform);
+    void remove(Transform *transform);
+
+    void clear();
+
+    void update(JobSystem *jobs = nullptr);
+
+    uint32_t count() const;
+    uint32_t levels() const;
+
+private:
+    friend class Transform;
+
+    void rebuild();
+
+    void updateRange(uint32_t begin, uint32_t end);
+
+    void detach(uint32_t index);
+
+private:
+    std::vector<Transform *> m_transforms;
+
+    std::vector<Transform *> m_pending;
+
+    std::vector<int32_t> m_parents;
+
+    std::vector<uint32_t> m_levels;
+
+    std::vector<uint8_t> m_dirty;
+
+    std::vector<Matrix4> m_local;
+
+    std::vector<Matrix4> m_world;
+
+    std::vector<Quaternion> m_worldQuaternion;
+
+    std::vector<Vector3> m_worldRotation;
+
+    std::vector<Vector3> m_worldScale;
+
+    std::vector<uint32_t> m_hash;
+
+    bool m_structure;
+
+};
+
+#endif // TRANSFORMSTORAGE_H
@@ -1,10 +1,15 @@
 #include "commandbuffer.h"
 
+#include "commandlist.h"
+
+#include "resources/rendertarget.h"
+
 #include "components/camera.h"
 #include "components/transform.h"
 #include "timer.h"
 
 #include <algorithm>
+#include <cstring>
 
 static bool s_Inited = false;
 
@@ -152,6 +157,76 @@ void CommandBuffer::endDebugMarker() {
 */
 void CommandBuffer::flipResult() {
 
+}
+/*!
+    Executes all commands recorded in the command \a list in order.
+    The default implementation replays the commands using methods of this command buffer; backends can override it to translate the list natively.
+*/
+void CommandBuffer::execute(const CommandList &list) {
+    PROFILE_FUNCTION();
+
+    MaterialInstance *instance = nullptr;
+
+    for(uint32_t i = 0; i < list.count(); i++) {
+        switch(list.type(i)) {
+            case CommandList::SetTarget: {
+                const CommandList::TargetCommand &command = list.command<CommandList::TargetCommand>(i);
+                setRenderTarget(command.target, command.level);
+            } break;
+            case CommandList::SetTile: {
+                const CommandList::TileCommand &command = list.command<CommandList::TileCommand>(i);
+                command.target->setTileIndex(command.index);
+            } break;
+            case CommandList::SetViewport: {
+                const CommandList::RectCommand &command = list.command<CommandList::RectCommand>(i);
+                setViewport(command.x, command.y, command.width, command.height);
+            } break;
+            case CommandList::SetViewProjection: {
+                Matrix4 viewProjection;
+                memcpy(viewProjection.mat, list.command<CommandList::MatrixCommand>(i).matrix, sizeof(viewProjection.mat));
+                setViewProjection(viewProjection);
+            } break;
+            case CommandList::BindMaterial: {
+                const CommandList::MaterialCommand &command = list.command<CommandList::MaterialCommand>(i);
+                if(instance) {
+                    instance->setInstanceBuffer(nullptr);
+                }
+                instance = command.instance;
+                instance->setInstanceBuffer(command.instances);
+            } break;
+            case CommandList::DrawInstanced: {
+                const CommandList::DrawCommand &command = list.command<CommandList::DrawCommand>(i);
+                if(instance) {
+                    drawMesh(command.mesh, command.subMesh, command.layer, *instance);
+                }
+            } break;
+            case CommandList::EnableScissor: {
+                const CommandList::RectCommand &command = list.command<CommandList::RectCommand>(i);
+                enableScissor(command.x, command.y, command.width, command.height);
+            } break;
+            case CommandList::DisableScissor: {
+                disableScissor();
+            } break;
+            case CommandList::BeginMarker: {
+                beginDebugMarker(list.string(list.command<CommandList::MarkerCommand>(i).name));
+            } break;
+            case CommandList::EndMarker: {
+                endDebugMarker();
+            } break;
+            default: break;
+        }
+    }
+
+    if(instance) {
+        instance->setInstanceBuffer(nullptr);
+    }
+}
+/*!
+    Returns true if the backend can compile compute kernels from the generated GLSL source at runtime and draw with indirect arguments written by them; otherwise returns false.
+    Effects with the VisualEffect::gpu() flag are simulated on the CPU when this feature is not supported.
+*/
+bool CommandBuffer::isComputeSupported() const {
+    return false;
 }
 /*!
     Sets the viewport dimensions.
@@ -0,0 +1,222 @@
+#include "commandlist.h"
+
+#include "resources/rendertarget.h"
+#include "resources/material.h"
+#include "resources/mesh.h"
+
+#include <cstring>
+
+namespace {
+    const uint32_t gAlignment(sizeof(uint64_t));
+}
+
+/*!
+    \class CommandList
+    \brief The CommandList class records rendering commands to replay them later with a CommandBuffer.
+    \inmodule Engine
+
+    A command list is a compact stream of plain data commands: render target and viewport changes, material bindings and instanced draws.
+    Recording doesn't touch any rendering API, so several lists can be recorded at the same time on different threads (each list must be recorded by a single thread).
+    Recorded lists are executed in order by CommandBuffer::execute() on the rendering thread.
+
+    Commands can be inspected using count(), type() and command() or converted to text with dump(), which allows to test recorded frames without GPU.
+
+    \note Command list doesn't own any recorded objects; all of them must stay alive until the list is executed.
+*/
+
+CommandList::CommandList() {
+
+}
+/*!
+    Removes all recorded commands; allocated memory is kept for the next recording.
+*/
+void CommandList::clear() {
+    m_data.clear();
+    m_offsets.clear();
+    m_strings.clear();
+}
+/*!
+    Returns true if the list has no commands.
+*/
+bool CommandList::isEmpty() const {
+    return m_offsets.empty();
+}
+/*!
+    Records a command to set the render \a target with mipmap \a level.
+*/
+void CommandList::setRenderTarget(RenderTarget *target, uint32_t level) {
+    TargetCommand *command = static_cast<TargetCommand *>(append(SetTarget, sizeof(TargetCommand)));
+    command->target = target;
+    command->level = level;
+}
+/*!
+    Records a command to set a tile \a index for the atlas render \a target.
+*/
+void CommandList::setTileIndex(RenderTarget *target, int32_t index) {
+    TileCommand *command = static_cast<TileCommand *>(append(SetTile, sizeof(TileCommand)));
+    command->target = target;
+    command->index = index;
+}
+/*!
+    Records a command to set the viewport with coordinates \a x and \a y and dimensions \a width and \a height.
+*/
+void CommandList::setViewport(int32_t x, int32_t y, int32_t width, int32_t height) {
+    RectCommand *command = static_cast<RectCommand *>(append(SetViewport, sizeof(RectCommand)));
+    command->x = x;
+    command->y = y;
+    command->width = width;
+    command->height = height;
+}
+/*!
+    Records a command to set the \a viewProjection matrix.
+*/
+void CommandList::setViewProjection(const Matrix4 &viewProjection) {
+    MatrixCommand *command = static_cast<MatrixCommand *>(append(SetViewProjection, sizeof(MatrixCommand)));
+    memcpy(command->matrix, viewProjection.mat, sizeof(command->matrix));
+}
+/*!
+    Records a command to bind the material \a instance for the subsequent draws.
+    Optional \a instances buffer contains uniform data of all instances to be drawn with a single draw call.
+*/
+void CommandList::bindMaterial(MaterialInstance *instance, const ByteArray *instances) {
+    MaterialCommand *command = static_cast<MaterialCommand *>(append(BindMaterial, sizeof(MaterialCommand)));
+    command->instance = instance;
+    command->instances = instances;
+}
+/*!
+    Records a command to draw the \a subMesh of the \a mesh in the rendering \a layer with the bound material.
+*/
+void CommandList::drawInstanced(Mesh *mesh, uint32_t subMesh, uint32_t layer) {
+    DrawCommand *command = static_cast<DrawCommand *>(append(DrawInstanced, sizeof(DrawCommand)));
+    command->mesh = mesh;
+    command->subMesh = subMesh;
+    command->layer = layer;
+}
+/*!
+    Records a command to enable scissor test with coordinates \a x and \a y and dimensions \a width and \a height.
+*/
+void CommandList::enableScissor(int32_t x, int32_t y, int32_t width, int32_t height) {
+    RectCommand *command = static_cast<RectCommand *>(append(EnableScissor, sizeof(RectCommand)));
+    command->x = x;
+    command->y = y;
+    command->width = width;
+    command->height = height;
+}
+/*!
+    Records a command to disable scissor test.
+*/
+void CommandList::disableScissor() {
+    append(DisableScissor, 0);
+}
+/*!
+    Records a command to begin a debug marker with the specified \a name.
+*/
+void CommandList::beginDebugMarker(const TString &name) {
+    MarkerCommand *command = static_cast<MarkerCommand *>(append(BeginMarker, sizeof(MarkerCommand)));
+    command->name = m_strings.size();
+
+    m_strings.push_back(name);
+}
+/*!
+    Records a command to end the current debug marker.
+*/
+void CommandList::endDebugMarker() {
+    append(EndMarker, 0);
+}
+/*!
+    Returns the number of recorded commands.
+*/
+uint32_t CommandList::count() const {
+    return m_offsets.size();
+}
+/*!
+    Returns a type of the command with \a index.
+*/
+CommandList::Type CommandList::type(uint32_t index) const {
+    return static_cast<Type>(reinterpret_cast<const Header *>(&m_data[m_offsets[index]])->type);
+}
+/*!
+    \fn template<typename T> const T &CommandList::command(uint32_t index) const
+
+    Returns data of the command with \a index.
+    Type \a T must match the command type().
+*/
+/*!
+    Returns a string with \a index referenced by the recorded commands.
+*/
+const TString &CommandList::string(uint32_t index) const {
+    return m_strings[index];
+}
+/*!
+    Returns the raw stream of recorded commands.
+*/
+const ByteArray &CommandList::data() const {
+    return m_data;
+}
+/*!
+    Returns a human readable representation of recorded commands, a command per line.
+*/
+TString CommandList::dump() const {
+    TString result;
+
+    for(uint32_t i = 0; i < count(); i++) {
+        switch(type(i)) {
+            case SetTarget: {
+                const TargetCommand &command = CommandList::command<TargetCommand>(i);
+                result += TString("SetTarget %1 %2\n").arg(command.target ? command.target->name() : TString("null"), TString::number(int32_t(command.level)));
+            } break;
+            case SetTile: {
+                const TileCommand &command = CommandList::command<TileCommand>(i);
+                result += TString("SetTile %1 %2\n").arg(command.target ? command.target->name() : TString("null"), TString::number(command.index));
+            } break;
+            case SetViewport:
+            case EnableScissor: {
+                const RectCommand &command = CommandList::command<RectCommand>(i);
+                result += TString("%1 %2 %3 %4 %5\n").arg((type(i) == SetViewport) ? "SetViewport" : "EnableScissor",
+                                                          TString::number(command.x), TString::number(command.y),
+                                                          TString::number(command.width), TString::number(command.height));
+            } break;
+            case SetViewProjection: {
+                result += "SetViewProjection\n";
+            } break;
+            case BindMaterial: {
+                const MaterialCommand &command = CommandList::command<MaterialCommand>(i);
+                Material *material = command.instance ? command.instance->material() : nullptr;
+                result += TString("BindMaterial %1 %2\n").arg(material ? material->name() : TString("null"),
+                                                              TString::number(command.instances ? int32_t(command.instances->size()) : 0));
+            } break;
+            case DrawInstanced: {
+                const DrawCommand &command = CommandList::command<DrawCommand>(i);
+                result += TString("DrawInstanced %1 %2 %3\n").arg(command.mesh ? command.mesh->name() : TString("null"),
+                                                                  TString::number(int32_t(command.subMesh)), TString::number(int32_t(command.layer)));
+            } break;
+            case DisableScissor: {
+                result += "DisableScissor\n";
+            } break;
+            case BeginMarker: {
+                result += TString("BeginMarker %1\n").arg(m_strings[command<MarkerCommand>(i).name]);
+            } break;
+            case EndMarker: {
+                result += "EndMarker\n";
+            } break;
+            default: break;
+        }
+    }
+
+    return result;
+}
+
+void *CommandList::append(Type type, uint32_t size) {
+    size = (size + gAlignment - 1) & ~(gAlignment - 1);
+
+    uint32_t offset = m_data.size();
+    m_offsets.push_back(offset);
+
+    m_data.resize(offset + sizeof(Header) + size);
+
+    Header *header = reinterpret_cast<Header *>(&m_data[offset]);
+    header->type = type;
+    header->size = size;
+
+    return &m_data[offset + sizeof(Header)];
+}
@@ -1,6 +1,8 @@
 #include "baselight.h"
 
 #include "components/transform.h"
+#include "components/world.h"
+#include "components/scene.h"
 
 #include "systems/rendersystem.h"
 
@@ -160,11 +162,11 @@ bool BaseLight::isCulled(const Frustum &frustum, const Matrix4 &viewProjection)
     return false;
 }
 
-const Renderable::GroupList &BaseLight::groups(int index) const {
-    return m_groups[index];
+const RenderQueue &BaseLight::queue(int index) const {
+    return m_queues[index];
 }
 
-void BaseLight::buildGroups(const Renderable::RenderList &list) {
+void BaseLight::buildGroups(World *world) {
     if(m_hash != transform()->hash()) {
         m_dirty = true;
     }
@@ -173,24 +175,34 @@ void BaseLight::buildGroups(const Renderable::RenderList &list) {
     }
 
     int count = tilesCount();
-    if(m_groups.empty()) {
-        m_groups.resize(count);
+    if(m_queues.size() != static_cast<size_t>(count)) {
+        m_queues.resize(count);
+
+        // Chunks culled by the camera can still cast shadows
+        for(auto &it : m_queues) {
+            it.setChunkCulling(false);
+        }
     }
 
     for(int i = 0; i < count; i++) {
-        Renderable::RenderList culled;
         const Frustum &frustom = m_viewFrustum[i];
-        for(auto it : list) {
-            if(!it->isCulled(frustom, m_cropMatrix[i])) {
-                culled.push_back(it);
-            }
+
+        Object::ObjectList candidates;
+        for(auto scene : world->scenes()) {
+            scene->queryRenderables(frustom, candidates);
         }
 
-        Renderable::GroupList groupList;
-        Renderable::filterByLayer(culled, groupList, Material::Shadowcast);
+        Renderable::RenderList culled;
+        for(auto it : candidates) {
+            Renderable *renderable = static_cast<Renderable *>(it);
+            if(renderable->isEnabledInHierarchy() && !renderable->isCulled(frustom, m_cropMatrix[i])) {
+                culled.push_back(renderable);
+            }
+        }
 
-        m_groups[i].clear();
-        Renderable::group(groupList, m_groups[i]);
+        m_queues[i].clear();
+        m_queues[i].add(culled, Material::Shadowcast);
+        m_queues[i].build();
     }
 }
 /*!
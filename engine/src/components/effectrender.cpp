@@ -1,15 +1,19 @@
 #include "effectrender.h"
 
-#include <cstring>
-
 #include "actor.h"
 #include "transform.h"
 
 #include "visualeffect.h"
 #include "material.h"
+#include "computeshader.h"
+#include "computebuffer.h"
 
 #include "commandbuffer.h"
-#include "timer.h"
+
+namespace {
+    // Number of frames after which an invisible emitter is considered off-screen
+    const int gRecentFrames(30);
+}
 
 /*!
     \class EffectRender
@@ -17,45 +21,200 @@
     \inmodule Components
 
     The ParticleRender component allows you to display Particle Effects such as fire and explosions.
+
+    Effects of the scene are simulated on the worker threads by the render pipeline before the frustum culling.
+    Results are double-buffered: the simulation writes instance data to its own buffers which are swapped with the material buffers at the beginning of the next frame, so rendering reads the previous state without waiting for the simulation.
+    Emitters which were not visible for a while can be simulated less often, see setOffscreenInterval().
+    Effects with the VisualEffect::gpu() flag are simulated by a compute shader instead when the backend supports it, the particle state never leaves the GPU and the first renderable is drawn with indirect draw arguments.
 */
 
 EffectRender::EffectRender() :
-        m_effect(nullptr) {
+        m_effect(nullptr),
+        m_particlesBuffer(nullptr),
+        m_emitterBuffer(nullptr),
+        m_stateBuffer(nullptr),
+        m_instancesBuffer(nullptr),
+        m_deltaTime(0.0f),
+        m_offscreenInterval(1),
+        m_skippedFrames(0),
+        m_invisibleFrames(0),
+        m_ready(false) {
 
+    static uint32_t hash = Mathf::hashString("effects");
+    addTagByHash(hash);
 }
 
 EffectRender::~EffectRender() {
     if(m_effect) {
         m_effect->unsubscribe(this);
     }
+
+    releaseKernel();
+}
+/*!
+    Returns the number of frames between simulation steps of the emitter which is off-screen.
+*/
+int EffectRender::offscreenInterval() const {
+    return m_offscreenInterval;
+}
+/*!
+    Sets the number of frames between simulation steps of the emitter which is off-screen.
+    The elapsed time is accumulated between the steps, so the emission rate is kept.
+    The default \a interval 1 simulates the emitter every frame.
+*/
+void EffectRender::setOffscreenInterval(int interval) {
+    m_offscreenInterval = MAX(interval, 1);
+}
+/*!
+    Simulates the effect for \a dt seconds and immediately makes the result visible.
+*/
+void EffectRender::deltaUpdate(float dt) {
+    if(prepareSimulation(dt)) {
+        simulate();
+        publish();
+    }
 }
 /*!
     \internal
+    Prepares the simulation step for \a dt seconds on the main thread.
+    Returns true if the emitter must be simulated in this frame; otherwise returns false.
 */
-void EffectRender::update() {
-    deltaUpdate(Timer::deltaTime() * Timer::scale());
+bool EffectRender::prepareSimulation(float dt) {
+    if(m_effect == nullptr || !isEnabled() || m_materials.empty()) {
+        return false;
+    }
+
+    m_deltaTime += dt;
+
+    if(m_invisibleFrames < gRecentFrames) {
+        ++m_invisibleFrames;
+    } else if(++m_skippedFrames < m_offscreenInterval) {
+        return false;
+    }
+
+    float emitterAge = m_data.emitter[VisualEffect::EmitterAge];
+    if(!m_effect->continous() && emitterAge <= 0.0f) {
+        m_deltaTime = 0.0f;
+        return false;
+    }
+
+    m_data.system[VisualEffect::DeltaTime] = m_deltaTime;
+    m_deltaTime = 0.0f;
+    m_skippedFrames = 0;
+
+    Matrix4 *t = reinterpret_cast<Matrix4 *>(&m_data.emitter[VisualEffect::Transform]);
+    *t = transform()->worldTransform();
+
+    return true;
 }
 /*!
     \internal
+    Runs the simulation step, can be called from any thread.
 */
-void EffectRender::deltaUpdate(float dt) {
-    if(m_effect && isEnabled() && !m_materials.empty()) {
-        m_data.system[VisualEffect::DeltaTime] = dt;
+void EffectRender::simulate() {
+    m_effect->update(m_data);
 
-        float &emitterAge = m_data.emitter[VisualEffect::EmitterAge];
-        if(m_effect->continous() || emitterAge > 0.0f) {
-            Matrix4 *t = reinterpret_cast<Matrix4 *>(&m_data.emitter[VisualEffect::Transform]);
-            *t = transform()->worldTransform();
+    m_ready = true;
+}
+/*!
+    \internal
+    Swaps the instance data of the last simulation step with the material buffers.
+*/
+void EffectRender::publish() {
+    if(!m_ready) {
+        return;
+    }
 
-            m_effect->update(m_data);
+    for(size_t i = 0; i < m_materials.size(); i++) {
+        if(m_materials[i] && i < m_data.render.size()) {
+            m_materials[i]->setInstanceCount(m_data.instances);
 
-            for(int i = 0; i < m_materials.size(); i++) {
-                m_materials[i]->setInstanceCount(m_data.instances);
+            std::swap(m_materials[i]->rawUniformBuffer(), m_data.render[i]);
+        }
+    }
+
+    m_ready = false;
+}
+/*!
+    \internal
+    Records the simulation step of the GPU effect to the command \a buffer.
+    Kernel buffers are created on the first call.
+    Returns false if the kernel can't be created, the effect must be simulated on the CPU in this case.
+*/
+bool EffectRender::dispatch(CommandBuffer &buffer) {
+    PROFILE_FUNCTION();
+
+    if(m_kernelStages.empty()) {
+        const VisualEffect::Renderable *renderable = m_effect->renderable(0);
+        if(renderable == nullptr || m_materials.empty() || m_materials.front() == nullptr) {
+            return false;
+        }
+
+        int capacity = m_effect->capacity();
+
+        m_particlesBuffer = Engine::objectCreate<ComputeBuffer>();
+        m_particlesBuffer->setData(ByteArray(capacity * m_effect->particleStride() * sizeof(float), 0));
+
+        m_emitterBuffer = Engine::objectCreate<ComputeBuffer>();
+        m_emitterBuffer->setData(ByteArray(m_data.emitter.size() * sizeof(float), 0));
 
-                memcpy(m_materials[i]->rawUniformBuffer().data(), m_data.render[i].data(), m_data.render[i].size());
+        VisualEffect::KernelState state;
+        state.indexCount = renderable->mesh->indexCount(0);
+        state.firstIndex = renderable->mesh->indexStart(0);
+
+        m_stateBuffer = Engine::objectCreate<ComputeBuffer>();
+        m_stateBuffer->setData(ByteArray(reinterpret_cast<uint8_t *>(&state), reinterpret_cast<uint8_t *>(&state + 1)));
+
+        m_instancesBuffer = Engine::objectCreate<ComputeBuffer>();
+        m_instancesBuffer->setData(ByteArray(MAX(m_materials.front()->rawUniformBuffer().size(), sizeof(float)), 0));
+
+        for(int stage = VisualEffect::KernelEmitter; stage <= VisualEffect::KernelFinish; stage++) {
+            ComputeInstance *instance = m_effect->createKernelInstance(stage, m_particlesBuffer, m_emitterBuffer, m_stateBuffer, m_instancesBuffer);
+            if(instance == nullptr) {
+                releaseKernel();
+                return false;
             }
+            m_kernelStages.push_back(instance);
         }
+
+        m_materials.front()->setIndirect(m_instancesBuffer, m_stateBuffer);
     }
+
+    Matrix4 worldTransform(transform()->worldTransform());
+
+    Vector4 system;
+    for(size_t i = 0; i < 4 && i < m_data.system.size(); i++) {
+        system[i] = m_data.system[i];
+    }
+
+    int groups = (m_effect->capacity() + VisualEffect::KernelGroupSize - 1) / VisualEffect::KernelGroupSize;
+    for(auto it : m_kernelStages) {
+        it->setMatrix4("transform", &worldTransform);
+        it->setVector4("system", &system);
+
+        buffer.dispatchCompute(*it, (it == m_kernelStages[VisualEffect::KernelParticles]) ? groups : 1, 1, 1);
+    }
+
+    return true;
+}
+/*!
+    \internal
+    Destroys the kernel instances and buffers of the GPU simulation.
+*/
+void EffectRender::releaseKernel() {
+    for(auto it : m_kernelStages) {
+        delete it;
+    }
+    m_kernelStages.clear();
+
+    delete m_particlesBuffer;
+    m_particlesBuffer = nullptr;
+    delete m_emitterBuffer;
+    m_emitterBuffer = nullptr;
+    delete m_stateBuffer;
+    m_stateBuffer = nullptr;
+    delete m_instancesBuffer;
+    m_instancesBuffer = nullptr;
 }
 /*!
     \internal
@@ -104,6 +263,8 @@ void EffectRender::effectUpdated(int state, void *ptr) {
     if(state == Resource::Ready) {
         EffectRender *render = static_cast<EffectRender *>(ptr);
 
+        render->releaseKernel();
+
         // Update materials
         for(auto it : render->m_materials) {
             delete it;
@@ -117,7 +278,11 @@ void EffectRender::effectUpdated(int state, void *ptr) {
         // Update emitter buffer
         render->m_data.emitter.resize(render->m_effect->emitterStride());
         // Update particles buffer
-        render->m_data.particles.resize(capacity * render->m_effect->particleStride());
+        render->m_data.particles.assign(capacity * render->m_effect->particleStride(), 0.0f);
+        render->m_data.random = render->m_effect->randomStreams();
+        render->m_data.alive = 0;
+
+        render->m_ready = false;
 
         render->m_data.render.resize(render->m_effect->renderablesCount());
         for(int i = 0; i < render->m_effect->renderablesCount(); i++) {
@@ -131,7 +296,7 @@ void EffectRender::effectUpdated(int state, void *ptr) {
 
                     instance->setInstanceCount(capacity);
 
-                    render->m_data.render[i].resize(capacity * (m->uniformSize() / sizeof(float)));
+                    render->m_data.render[i].resize(instance->rawUniformBuffer().size());
                 }
 
                 render->m_materials.push_back(instance);
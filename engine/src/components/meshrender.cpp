@@ -7,12 +7,19 @@
 #include "pipelinecontext.h"
 #include "gizmos.h"
 
+namespace {
+    const float gLodHysteresis(0.1f);
+}
+
 /*!
     \class MeshRender
     \brief Draws a mesh for the 3D graphics.
     \inmodule Components
 
     The MeshRender component allows you to display 3D Mesh to use in both 2D and 3D scenes.
+
+    If the Mesh contains generated levels of detail, the level is selected every frame from the projected screen size of the bounding sphere.
+    The selection uses a hysteresis band of 10% around each threshold, so objects which stay near a threshold don't switch levels every frame.
 */
 
 MeshRender::MeshRender() :
@@ -69,6 +76,27 @@ Mesh *MeshRender::meshToDraw() {
 /*!
     \internal
 */
+Mesh *MeshRender::meshToStream() {
+    if(m_lod < m_lods.size() && m_lods[m_lod].first) {
+        return m_lods[m_lod].first;
+    }
+    return m_baseMesh;
+}
+/*!
+    \internal
+*/
+void MeshRender::setLod(uint32_t lod) {
+    Renderable::setLod(lod);
+
+    if(m_baseMesh && m_baseMesh->lodCount() > 1) {
+        m_meshLod = m_baseMesh->selectLod(m_screenSize, m_meshLod, gLodHysteresis);
+    } else {
+        m_meshLod = 0;
+    }
+}
+/*!
+    \internal
+*/
 AABBox MeshRender::localBound() {
     if(m_baseMesh) {
         return m_baseMesh->bound();
@@ -189,8 +217,26 @@ bool MeshRender::ensureMeshInstance() {
     }
 
     if(m_meshInstance == nullptr) {
+        Mesh *source = m_lods[m_lod].first;
+        int count = source->subMeshCount();
+
         m_meshInstance = Engine::objectCreate<Mesh>();
-        m_meshInstance->setIndices(m_lods[m_lod].first->indices());
+        m_meshInstance->setIndices(source->lodCount() > 1 ? IndexVector(source->indices().begin(), source->indices().begin() + source->indexStart(count)) :
+                                                            source->indices());
+        for(int sub = 0; sub < count; sub++) {
+            m_meshInstance->setSubMesh(source->indexStart(sub), sub);
+        }
+        for(int lod = 1; lod < source->lodCount(); lod++) {
+            int start = source->indexStart(source->lodSubMesh(0, lod));
+
+            IndexVector offsets;
+            for(int sub = 0; sub < count; sub++) {
+                offsets.push_back(source->indexStart(source->lodSubMesh(sub, lod)) - start);
+            }
+            int end = source->indexStart(source->lodSubMesh(count - 1, lod)) + source->indexCount(source->lodSubMesh(count - 1, lod));
+            m_meshInstance->addLod(IndexVector(source->indices().begin() + start, source->indices().begin() + end), offsets, source->lodScreenSize(lod));
+        }
+
         m_meshInstance->setVertices(m_lods[m_lod].first->vertices());
         m_meshInstance->setNormals(m_lods[m_lod].first->normals());
         m_meshInstance->setTangents(m_lods[m_lod].first->tangents());
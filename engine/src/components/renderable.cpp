@@ -11,6 +11,8 @@
 
 #include "pipelinecontext.h"
 
+#include <cfloat>
+
 /*!
     \class Renderable
     \brief Base class for every object which can be drawn on the screen.
@@ -22,6 +24,8 @@
 Renderable::Renderable() :
         m_surfaceType(Material::Static),
         m_lod(0),
+        m_meshLod(0),
+        m_screenSize(FLT_MAX),
         m_transformHash(0) {
 
     static uint32_t hash = Mathf::hashString("renderable");
@@ -51,23 +55,14 @@ AABBox Renderable::bound() {
 }
 /*!
     Returns true if current renderable fails \a frustum culling test; otherwise returns true;
-    Parameter \a viewProjection used to project bounding box to screen space for LOD calculation.
+    Parameter \a viewProjection used to project bounding box to screen space to reject too small renderables.
+    This test doesn't change the selected LOD, it's used for the secondary views like shadow cascades.
 */
 bool Renderable::isCulled(const Frustum &frustum, const Matrix4 &viewProjection) {
     AABBox bb(bound());
 
     if(bb.extent.x < 0.0f || frustum.contains(bb)) {
-        Vector4 v0(viewProjection * Vector4(bb.center, 1.0f));
-        Vector2 l0(v0.x / v0.w, v0.y / v0.w);
-
-        bb.center += frustum.m_top.normal * bb.radius;
-        Vector4 v1(viewProjection * Vector4(bb.center, 1.0f));
-        Vector2 l1(v1.x / v1.w, v1.y / v1.w);
-
-        float size = (l1 - l0).length();
-        setLod(PipelineContext::lod(size));
-
-        return !(m_lod < 3);
+        return PipelineContext::lod(screenSize(bb.center, bb.radius, frustum.m_top.normal, viewProjection)) >= 3;
     }
 
     return true;
@@ -77,6 +72,58 @@ bool Renderable::isCulled(const Frustum &frustum, const Matrix4 &viewProjection)
 */
 Mesh *Renderable::meshToDraw() {
     return nullptr;
+}
+/*!
+    Returns a mesh which is requested from the resource system for the current level of detail and can be still loading.
+    Generated meshes are never streamed, so the default implementation returns nullptr.
+*/
+Mesh *Renderable::meshToStream() {
+    return nullptr;
+}
+/*!
+    Returns the number of meshes which will be drawn.
+    Renderables which consist of several independently culled parts override this method together with chunkToDraw() and cullChunks().
+*/
+int Renderable::chunkCount() {
+    return 1;
+}
+/*!
+    Returns a mesh of the part with \a index which will be drawn or nullptr if the part is culled.
+*/
+Mesh *Renderable::chunkToDraw(int index) {
+    return (index == 0) ? meshToDraw() : nullptr;
+}
+/*!
+    \internal
+    Returns true if the part with \a index passed the last camera culling in cullChunks(); otherwise returns false.
+    \sa RenderQueue::setChunkCulling()
+*/
+bool Renderable::isChunkVisible(int index) {
+    A_UNUSED(index);
+    return true;
+}
+/*!
+    \internal
+    Returns true if small meshes of the renderable can be merged with other renderables into shared dynamic meshes; otherwise returns false.
+    \sa RenderQueue::setBatching()
+*/
+bool Renderable::isBatchable() const {
+    return false;
+}
+/*!
+    \internal
+    Tests parts of the visible renderable against the \a frustum; nullptr frustum means that all parts are visible.
+*/
+void Renderable::cullChunks(const Frustum *frustum) {
+    A_UNUSED(frustum);
+}
+/*!
+    \internal
+    Rebuilds parts of the renderable which were changed since the last frame.
+    Called on the main thread before the bounds are updated and culled, so bound() and chunkToDraw() don't modify the renderable on the worker threads.
+*/
+void Renderable::updateChunks() {
+
 }
 /*!
     Returns a first instantiated Material assigned to this Renderable.
@@ -152,20 +199,55 @@ AABBox Renderable::localBound() {
 void Renderable::setLod(uint32_t lod) {
     m_lod = lod;
 }
+/*!
+    \internal
+    Calculates the LOD level from the screen space size of a bounding sphere with \a center and \a radius.
+    The sphere is projected with \a viewProjection matrix along the \a up direction.
+    Returns true if the renderable is visible at the calculated LOD; otherwise returns false.
+    Must be called only for the main camera view, the selected LOD is shared by all render queues.
+*/
+bool Renderable::updateLod(const Vector3 &center, float radius, const Vector3 &up, const Matrix4 &viewProjection) {
+    m_screenSize = screenSize(center, radius, up, viewProjection);
+    setLod(PipelineContext::lod(m_screenSize));
+
+    return m_lod < 3;
+}
+/*!
+    \internal
+    Returns the screen space size of a bounding sphere with \a center and \a radius.
+    The sphere is projected with \a viewProjection matrix along the \a up direction.
+*/
+float Renderable::screenSize(const Vector3 &center, float radius, const Vector3 &up, const Matrix4 &viewProjection) {
+    Vector4 v0(viewProjection * Vector4(center, 1.0f));
+    Vector2 l0(v0.x / v0.w, v0.y / v0.w);
+
+    Vector4 v1(viewProjection * Vector4(center + up * radius, 1.0f));
+    Vector2 l1(v1.x / v1.w, v1.y / v1.w);
+
+    return (l1 - l0).length();
+}
 /*!
     Filters \a out an \a in renderable components by it's material \a layer.
 */
 void Renderable::filterByLayer(const RenderList &in, GroupList &out, int layer) {
     for(auto it : in) {
-        Mesh *mesh = it->meshToDraw();
-        if(mesh) {
+        int chunks = it->chunkCount();
+        for(int c = 0; c < chunks; c++) {
+            Mesh *mesh = it->chunkToDraw(c);
+            if(mesh == nullptr) {
+                continue;
+            }
+
             for(uint32_t i = 0; i < mesh->subMeshCount(); i++) {
                 MaterialInstance *instance = it->materialInstance(i);
                 if(instance && instance->material()->layers() & layer) {
+                    uint32_t sub = mesh->lodSubMesh(i, it->m_meshLod);
+
                     uint32_t hash = instance->hash();
                     Mathf::hashCombine(hash, mesh->uuid());
+                    Mathf::hashCombine(hash, sub);
 
-                    out.push_back({instance, mesh, i, hash});
+                    out.push_back({instance, mesh, sub, hash, 0, ByteArray()});
                 }
             }
         }
@@ -1,7 +1,17 @@
 #include "components/scene.h"
 
 #include "components/world.h"
-#include "components/component.h"
+#include "components/actor.h"
+#include "components/renderable.h"
+#include "components/transform.h"
+
+#include "utils/boundingtree.h"
+#include "utils/transformstorage.h"
+
+namespace {
+    static const uint32_t gRenderableHash(Mathf::hashString("renderable"));
+    static const uint32_t gTransformHash(Mathf::hashString("transform"));
+}
 
 /*!
     \class Scene
@@ -9,8 +19,16 @@
     \inmodule Components
 
     The Scene class serves as a container for actors and entities within the application, providing methods to interact with the world and manage the associated resource.
+
+    Bounds of the renderable components are stored in a bounding volume hierarchy to find visible objects without iterating over the whole scene, see queryRenderables().
+    Renderables of static actors are stored in a separate tree which is never refitted while the world is active.
+
+    Transforms of the actors are kept in a TransformStorage and updated all together with updateTransforms().
 */
 Scene::Scene() :
+        m_dynamicTree(new BoundingTree),
+        m_staticTree(new BoundingTree(0.0f)),
+        m_transforms(new TransformStorage),
         m_map(nullptr),
         m_modified(false) {
 
@@ -18,9 +36,16 @@ Scene::Scene() :
 
 Scene::Scene(const Scene &origin) :
         m_groups(origin.m_groups),
+        m_dynamicTree(new BoundingTree),
+        m_staticTree(new BoundingTree(0.0f)),
+        m_transforms(new TransformStorage),
         m_map(origin.m_map),
         m_modified(origin.m_modified) {
 
+    auto it = m_groups.find(gRenderableHash);
+    if(it != m_groups.end()) {
+        m_unbound = it->second;
+    }
 }
 
 Scene::~Scene() {
@@ -32,6 +57,11 @@ Scene::~Scene() {
             }
         }
     }
+
+    delete m_dynamicTree;
+    delete m_staticTree;
+
+    delete m_transforms;
 }
 /*!
     Returns the World to which the scene belongs.
@@ -52,6 +82,12 @@ void Scene::addToGroupByHash(Object *object, uint32_t hash) {
     std::lock_guard<std::mutex> lock(m_mutex);
 
     m_groups[hash].push_back(object);
+
+    if(hash == gRenderableHash) {
+        m_unbound.push_back(object);
+    } else if(hash == gTransformHash) {
+        m_transforms->add(static_cast<Transform *>(object));
+    }
 }
 /*!
     Removes \a object from \a group.
@@ -69,6 +105,18 @@ void Scene::removeFromGroupByHash(Object *object, uint32_t hash) {
     if(it != m_groups.end()) {
         it->second.remove(object);
     }
+
+    if(hash == gRenderableHash) {
+        auto proxy = m_proxies.find(object);
+        if(proxy != m_proxies.end()) {
+            proxy->second.tree->remove(proxy->second.index);
+            m_proxies.erase(proxy);
+        } else {
+            m_unbound.remove(object);
+        }
+    } else if(hash == gTransformHash) {
+        m_transforms->remove(static_cast<Transform *>(object));
+    }
 }
 /*!
     Returns a list of objects in \a group.
@@ -84,6 +132,102 @@ Object::ObjectList &Scene::getObjectsInGroupByHash(uint32_t hash) {
 
     return m_groups[hash];
 }
+/*!
+    \internal
+    Synchronizes the bounding volume hierarchy with the current bounds of renderable components.
+    Renderables of static actors are refitted only if \a refitStatic is true.
+*/
+void Scene::updateBounds(bool refitStatic) {
+    PROFILE_FUNCTION();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    auto it = m_proxies.begin();
+    while(it != m_proxies.end()) {
+        Proxy &proxy = it->second;
+        if(proxy.tree == m_staticTree && !refitStatic) {
+            ++it;
+            continue;
+        }
+
+        Renderable *renderable = static_cast<Renderable *>(it->first);
+        AABBox bb(renderable->bound());
+
+        bool isStatic = renderable->actor()->isStatic();
+        if(bb.extent.x < 0.0f || !bb.isValid() || isStatic != (proxy.tree == m_staticTree)) {
+            proxy.tree->remove(proxy.index);
+            m_unbound.push_back(renderable);
+            it = m_proxies.erase(it);
+            continue;
+        }
+
+        proxy.tree->update(proxy.index, bb);
+        ++it;
+    }
+
+    auto unbound = m_unbound.begin();
+    while(unbound != m_unbound.end()) {
+        Renderable *renderable = static_cast<Renderable *>(*unbound);
+        AABBox bb(renderable->bound());
+        if(bb.extent.x < 0.0f || !bb.isValid()) {
+            ++unbound;
+            continue;
+        }
+
+        Proxy proxy;
+        proxy.tree = renderable->actor()->isStatic() ? m_staticTree : m_dynamicTree;
+        proxy.index = proxy.tree->insert(bb, renderable);
+        m_proxies[renderable] = proxy;
+
+        unbound = m_unbound.erase(unbound);
+    }
+}
+/*!
+    Recalculates world transformations of all changed transforms in the scene with a single pass over the hierarchy.
+    Large levels of the hierarchy are processed in parallel using \a jobs.
+    Must be called at the point of the frame when no one reads or writes transforms.
+*/
+void Scene::updateTransforms(JobSystem *jobs) {
+    PROFILE_FUNCTION();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_transforms->update(jobs);
+}
+/*!
+    Appends renderable components which bounds are inside or intersect the \a frustum to the \a result list.
+    Renderables without valid bounds are always appended.
+    The result is conservative; bounds of the moving objects are enlarged to avoid restructuring of the hierarchy every frame.
+*/
+void Scene::queryRenderables(const Frustum &frustum, ObjectList &result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_staticTree->query(frustum, result);
+    m_dynamicTree->query(frustum, result);
+    result.insert(result.end(), m_unbound.begin(), m_unbound.end());
+}
+/*!
+    Appends renderable components which bounds intersect a sphere with \a center and \a radius to the \a result list.
+    Renderables without valid bounds are always appended.
+*/
+void Scene::queryRenderables(const Vector3 &center, float radius, ObjectList &result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_staticTree->query(center, radius, result);
+    m_dynamicTree->query(center, radius, result);
+    result.insert(result.end(), m_unbound.begin(), m_unbound.end());
+}
+/*!
+    Appends renderable components which bounds intersect the \a box to the \a result list.
+    Renderables without valid bounds are always appended.
+*/
+void Scene::queryRenderables(const AABBox &box, ObjectList &result) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_staticTree->query(box, result);
+    m_dynamicTree->query(box, result);
+    result.insert(result.end(), m_unbound.begin(), m_unbound.end());
+}
 /*!
     \internal
 */
@@ -86,6 +86,12 @@ Mesh *SpriteRender::meshToDraw() {
 /*!
     \internal
 */
+bool SpriteRender::isBatchable() const {
+    return true;
+}
+/*!
+    \internal
+*/
 MaterialInstance *SpriteRender::materialInstance(int index) {
     if(m_dirtyMaterial) {
         for(auto it : m_materials) {
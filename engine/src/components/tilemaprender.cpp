@@ -4,6 +4,8 @@
 #include "resources/tileset.h"
 #include "resources/mesh.h"
 
+#include "components/transform.h"
+
 namespace {
     const char *gTileMap("TileMap");
     const char *gMaterial("Material");
@@ -19,6 +21,7 @@ namespace {
 
     TileMapRender is a class designed for rendering tile maps within Thunder Engine.
     It manages the rendering of a tile map, including handling materials, layers, and transformations.
+    Each chunk of the tile map is culled and drawn separately.
 */
 
 TileMapRender::TileMapRender() :
@@ -33,15 +36,72 @@ TileMapRender::~TileMapRender() {
     }
 }
 
+/*!
+    \internal
+*/
 Mesh *TileMapRender::meshToDraw() {
-    return m_tileMap ? m_tileMap->tileMesh() : nullptr;
+    return chunkToDraw(0);
+}
+/*!
+    \internal
+*/
+int TileMapRender::chunkCount() {
+    return m_tileMap ? m_tileMap->chunkCount() : 0;
+}
+/*!
+    \internal
+*/
+Mesh *TileMapRender::chunkToDraw(int index) {
+    if(m_tileMap) {
+        Mesh *mesh = m_tileMap->chunkMesh(index);
+        if(mesh && !mesh->isEmpty()) {
+            return mesh;
+        }
+    }
+    return nullptr;
+}
+/*!
+    \internal
+*/
+bool TileMapRender::isChunkVisible(int index) {
+    return index >= 0 && index < static_cast<int32_t>(m_visibleChunks.size()) && m_visibleChunks[index];
+}
+/*!
+    \internal
+    Chunks of the tile map are tested against the \a frustum one by one, so only the visible part of the large maps is drawn by the camera.
+    Shadow casters don't use the result, chunks outside of the camera view can cast shadows into it.
+*/
+void TileMapRender::cullChunks(const Frustum *frustum) {
+    int count = chunkCount();
+    m_visibleChunks.resize(count);
+
+    Matrix4 world(transform()->worldTransform());
+    for(int i = 0; i < count; i++) {
+        AABBox bb(m_tileMap->chunkBound(i));
+        m_visibleChunks[i] = bb.extent.x >= 0.0f && (frustum == nullptr || frustum->contains(bb * world));
+    }
+}
+/*!
+    \internal
+    Rebuilds chunks of the tile map which were changed since the last frame.
+*/
+void TileMapRender::updateChunks() {
+    if(m_tileMap) {
+        m_tileMap->refreshChunks();
+    }
+}
+/*!
+    \internal
+*/
+bool TileMapRender::isBatchable() const {
+    return true;
 }
 /*!
     \internal
 */
 AABBox TileMapRender::localBound() {
     if(m_tileMap) {
-        return m_tileMap->tileMesh()->bound();
+        return m_tileMap->bound();
     }
     return Renderable::localBound();
 }
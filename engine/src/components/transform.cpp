@@ -2,8 +2,14 @@
 
 #include "components/actor.h"
 
+#include "utils/transformstorage.h"
+
 #include <algorithm>
 
+namespace {
+    const uint32_t gTransformHash(Mathf::hashString("transform"));
+}
+
 /*!
     \class Transform
     \brief Position, rotation and scale of an Actor.
@@ -12,6 +18,9 @@
     Every Actor in a Scene has a Transform.
     It's used to store and manipulate the position, rotation and scale of the object.
     Every Transform can have a parent, which allows you to apply position, rotation and scale hierarchically.
+
+    World transformations are calculated lazily on the first request after a change.
+    Transforms of actors in a Scene are kept in a TransformStorage and updated in a single batched pass once per frame, so reading them is cheap.
 */
 
 Transform::Transform() :
@@ -25,9 +34,13 @@ Transform::Transform() :
         m_transform(Matrix4()),
         m_worldTransform(Matrix4()),
         m_parent(nullptr),
+        m_storage(nullptr),
+        m_slot(-1),
+        m_pendingSlot(-1),
         m_hash(0),
         m_dirty(true) {
 
+    addTagByHash(gTransformHash);
 }
 
 Transform::Transform(const Transform &origin) :
@@ -41,12 +54,18 @@ Transform::Transform(const Transform &origin) :
         m_transform(origin.m_transform),
         m_worldTransform(origin.m_worldTransform),
         m_parent(origin.m_parent),
+        m_storage(nullptr),
+        m_slot(-1),
+        m_pendingSlot(-1),
         m_hash(origin.m_hash),
-        m_dirty(origin.m_dirty) {
+        m_dirty(true) {
 
+    addTagByHash(gTransformHash);
 }
 
 Transform::~Transform() {
+    removeTagByHash(gTransformHash);
+
     updateHierarchy(nullptr, true);
 
     std::list<Transform *> temp = m_children;
@@ -159,42 +178,41 @@ void Transform::setParentTransform(Transform *parent, bool force) {
 */
 const Matrix4 &Transform::localTransform() const {
     cleanDirty();
-    return m_transform;
+    return m_storage ? m_storage->m_local[m_slot] : m_transform;
 }
 /*!
     Returns current transform matrix in world space.
 */
 const Matrix4 &Transform::worldTransform() const {
     cleanDirty();
-    return m_worldTransform;
+    return m_storage ? m_storage->m_world[m_slot] : m_worldTransform;
 }
 /*!
     Returns current position of the transform in world space.
 */
 Vector3 Transform::worldPosition() const {
-    cleanDirty();
-    return m_worldTransform.position();
+    return worldTransform().position();
 }
 /*!
     Returns current rotation of the transform in world space as Euler angles in degrees.
 */
 Vector3 Transform::worldRotation() const {
     cleanDirty();
-    return m_worldRotation;
+    return m_storage ? m_storage->m_worldRotation[m_slot] : m_worldRotation;
 }
 /*!
     Returns current rotation of the transform in world space as Quaternion.
 */
 Quaternion Transform::worldQuaternion() const {
     cleanDirty();
-    return m_worldQuaternion;
+    return m_storage ? m_storage->m_worldQuaternion[m_slot] : m_worldQuaternion;
 }
 /*!
     Returns current scale of the transform in world space.
 */
 Vector3 Transform::worldScale() const {
     cleanDirty();
-    return m_worldScale;
+    return m_storage ? m_storage->m_worldScale[m_slot] : m_worldScale;
 }
 /*!
     Makes the Transform a child of \a parent at given \a position.
@@ -220,7 +238,7 @@ void Transform::setParent(Object *parent, int32_t position, bool force) {
 */
 uint32_t Transform::hash() const {
     cleanDirty();
-    return m_hash;
+    return m_storage ? m_storage->m_hash[m_slot] : m_hash;
 }
 /*!
     \internal
@@ -239,6 +257,10 @@ void Transform::setDirty() {
         }
     }
     m_dirty = true;
+
+    if(m_storage) {
+        m_storage->m_dirty[m_slot] = 1;
+    }
 }
 /*!
     \internal
@@ -247,20 +269,30 @@ void Transform::cleanDirty() const {
     if(m_dirty) {
         std::unique_lock<std::mutex> locker(m_mutex);
 
-        m_transform = Matrix4(m_position, m_quaternion, m_scale);
-        m_worldTransform = m_transform;
-        m_worldRotation = m_rotation;
-        m_worldQuaternion = m_quaternion;
-        m_worldScale = m_scale;
+        Matrix4 &local = m_storage ? m_storage->m_local[m_slot] : m_transform;
+        Matrix4 &world = m_storage ? m_storage->m_world[m_slot] : m_worldTransform;
+        Vector3 &worldRotation = m_storage ? m_storage->m_worldRotation[m_slot] : m_worldRotation;
+        Quaternion &worldQuaternion = m_storage ? m_storage->m_worldQuaternion[m_slot] : m_worldQuaternion;
+        Vector3 &worldScale = m_storage ? m_storage->m_worldScale[m_slot] : m_worldScale;
+        uint32_t &hash = m_storage ? m_storage->m_hash[m_slot] : m_hash;
+
+        local = Matrix4(m_position, m_quaternion, m_scale);
+        world = local;
+        worldRotation = m_rotation;
+        worldQuaternion = m_quaternion;
+        worldScale = m_scale;
         if(m_parent) {
-            m_worldScale = m_parent->worldScale() * m_worldScale;
-            m_worldRotation = m_parent->worldRotation() + m_worldRotation;
-            m_worldQuaternion = m_parent->worldQuaternion() * m_worldQuaternion;
-            m_worldTransform = m_parent->worldTransform() * m_worldTransform;
+            worldScale = m_parent->worldScale() * worldScale;
+            worldRotation = m_parent->worldRotation() + worldRotation;
+            worldQuaternion = m_parent->worldQuaternion() * worldQuaternion;
+            world = m_parent->worldTransform() * world;
         }
-        m_hash = 16;
+        hash = 16;
         for(int i = 0; i < 16; i++) {
-            Mathf::hashCombine(m_hash, m_worldTransform[i]);
+            Mathf::hashCombine(hash, world[i]);
+        }
+        if(m_storage) {
+            m_storage->m_dirty[m_slot] = 0;
         }
         m_dirty = false;
     }
@@ -287,6 +319,11 @@ void Transform::updateHierarchy(Transform *parent, bool force) {
     }
 
     m_parent = parent;
+
+    if(m_storage) {
+        m_storage->m_structure = true;
+    }
+
     if(m_parent) {
         m_parent->m_children.push_back(this);
         if(!force) {
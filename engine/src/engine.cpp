@@ -11,10 +11,12 @@
 #include <metatype.h>
 #include <url.h>
 #include <threadpool.h>
+#include <jobsystem.h>
 #include <os/backtrace.h>
 
 #include "module.h"
 #include "system.h"
+#include "systemscheduler.h"
 #include "timer.h"
 #include "input.h"
 
@@ -57,30 +59,14 @@ namespace {
     static const char *gTransform("Transform");
 }
 
-class SystemRunner : public Runable {
-public:
-    explicit SystemRunner(System *system) :
-            m_system(system) {
-
-        setAutoDelete(false);
-    }
-
-    void run() override {
-        m_system->processEvents();
-    }
-
-    System *m_system;
-};
-
 static bool m_game = false;
 
 // Settings section
 VariantMap Engine::m_values;
 
 // Systems section
-std::list<SystemRunner *> Engine::m_pool;
-std::list<System *> Engine::m_serial;
-static ThreadPool *m_threadPool = nullptr;
+static SystemScheduler m_scheduler;
+static JobSystem *m_jobSystem = nullptr;
 
 static std::list<NativeBehaviour *> m_behaviours;
 
@@ -164,12 +150,11 @@ Engine::Engine() {
 
     Spline::registerClassFactory(m_instance);
 
-    uint32_t maxThreads = MAX(ThreadPool::optimalThreadCount() - 1, 1);
+    uint32_t maxThreads = ThreadPool::optimalThreadCount();
     if(maxThreads > 1) {
-        m_threadPool = new ThreadPool;
-        m_threadPool->setMaxThreads(maxThreads);
+        m_jobSystem = new JobSystem(maxThreads);
     } else {
-        aWarning() << "Engine's Thread pool disabled.";
+        aWarning() << "Engine's Job system disabled.";
     }
 }
 /*!
@@ -178,18 +163,22 @@ Engine::Engine() {
 Engine::~Engine() {
     PROFILE_FUNCTION();
 
-    auto localSerial = m_serial;
-    for(auto it : localSerial) {
-        delete it;
+    auto localSystems = m_scheduler.systems();
+    for(auto it : localSystems) {
+        if(it->threadPolicy() == System::Main) {
+            delete it;
+        }
     }
 
-    auto localPool = m_pool;
-    for(auto it : localPool) {
-        delete it->m_system;
+    localSystems = m_scheduler.systems();
+    for(auto it : localSystems) {
         delete it;
     }
+    m_resourceSystem = nullptr;
+    m_renderSystem = nullptr;
 
-    delete m_threadPool;
+    delete m_jobSystem;
+    m_jobSystem = nullptr;
 
     if(m_platform) {
         m_platform->destroy();
@@ -224,15 +213,15 @@ bool Engine::start() {
 
     m_platform->start();
 
-    for(auto it : m_pool) {
-        if(!it->m_system->init()) {
-            aError() << "Failed to initialize system:" << it->m_system->name();
+    for(auto it : m_scheduler.systems()) {
+        if(it->threadPolicy() == System::Pool && !it->init()) {
+            aError() << "Failed to initialize system:" << it->name();
             return false;
         }
     }
 
-    for(auto it : m_serial) {
-        if(!it->init()) {
+    for(auto it : m_scheduler.systems()) {
+        if(it->threadPolicy() == System::Main && !it->init()) {
             aError() << "Failed to initialize system:" << it->name();
             return false;
         }
@@ -262,6 +251,7 @@ bool Engine::start() {
     \note Usually, this method calls internally and must not be called manually.
 */
 void Engine::update(World *world) {
+    PROFILE_FRAME();
     PROFILE_FUNCTION();
 
     if(m_renderSystem) {
@@ -296,19 +286,11 @@ void Engine::update(World *world) {
 
             world->setActive(true);
 
-            for(auto it : m_pool) {
-                it->m_system->setActiveWorld(world);
-                if(m_threadPool) {
-                    m_threadPool->start(it);
-                } else {
-                    it->m_system->processEvents();
-                }
+            for(auto it : world->scenes()) {
+                it->updateTransforms(m_jobSystem);
             }
-            for(auto it : m_serial) {
-                it->setActiveWorld(world);
-                it->processEvents();
-            }
-            m_threadPool->waitForDone();
+
+            m_scheduler.execute(world, m_jobSystem);
 
             world->setActive(false);
         }
@@ -359,10 +341,7 @@ void Engine::setValue(const TString &key, const Variant &value) {
 void Engine::syncValues() {
     PROFILE_FUNCTION();
 
-    for(auto it : m_pool) {
-        it->m_system->syncSettings();
-    }
-    for(auto it : m_serial) {
+    for(auto it : m_scheduler.systems()) {
         it->syncSettings();
     }
 
@@ -520,22 +499,30 @@ ResourceSystem *Engine::resourceSystem() {
 RenderSystem *Engine::renderSystem() {
     return m_renderSystem;
 }
+/*!
+    Returns the job system which executes engine systems and parallel jobs.
+    Returns nullptr if multithreading is disabled.
+*/
+JobSystem *Engine::jobSystem() {
+    return m_jobSystem;
+}
+/*!
+    Returns the scheduler which executes engine systems each frame.
+    Use SystemScheduler::dump() to inspect the schedule of the last frame.
+*/
+SystemScheduler *Engine::systemScheduler() {
+    return &m_scheduler;
+}
 /*!
     Returns a sub system with specific \a name.
 */
 System *Engine::getSystem(const TString &name) {
-    for(auto it : m_serial) {
+    for(auto it : m_scheduler.systems()) {
         if(it->name() == name) {
             return it;
         }
     }
 
-    for(auto it : m_pool) {
-        if(it->m_system->name() == name) {
-            return it->m_system;
-        }
-    }
-
     return nullptr;
 }
 /*!
@@ -552,11 +539,7 @@ void Engine::setGameMode(bool flag) {
 
     m_game = flag;
 
-    for(auto it : m_pool) {
-        it->m_system->reset();
-    }
-
-    for(auto it : m_serial) {
+    for(auto it : m_scheduler.systems()) {
         it->reset();
     }
 }
@@ -589,11 +572,7 @@ void Engine::addModule(Module *module) {
 void Engine::addSystem(System *system) {
     PROFILE_FUNCTION();
 
-    if(system->threadPolicy() == System::Pool) {
-        m_pool.push_back(new SystemRunner(system));
-    } else {
-        m_serial.push_back(system);
-    }
+    m_scheduler.addSystem(system);
 
     if(dynamic_cast<RenderSystem *>(system) != nullptr) {
         m_renderSystem = static_cast<RenderSystem *>(system);
@@ -607,14 +586,7 @@ void Engine::addSystem(System *system) {
 void Engine::removeSystem(System *system) {
     PROFILE_FUNCTION();
 
-    m_serial.remove(system);
-
-    for(auto it : m_pool) {
-        if(it->m_system == system) {
-            m_pool.remove(it);
-            break;
-        }
-    }
+    m_scheduler.removeSystem(system);
 }
 /*!
     Returns game World.
@@ -690,14 +662,9 @@ Actor *Engine::composeActor(const TString &component, const TString &name, Objec
 Object::ObjectList Engine::getAllObjectsByType(const TString &type) const {
     Object::ObjectList result = ObjectSystem::getAllObjectsByType(type);
 
-    for(auto it : m_serial) {
-        Object::ObjectList serial = it->getAllObjectsByType(type);
-        result.insert(result.end(), serial.begin(), serial.end());
-    }
-
-    for(auto it : m_pool) {
-        Object::ObjectList pool = it->m_system->getAllObjectsByType(type);
-        result.insert(result.end(), pool.begin(), pool.end());
+    for(auto it : m_scheduler.systems()) {
+        Object::ObjectList list = it->getAllObjectsByType(type);
+        result.insert(result.end(), list.begin(), list.end());
     }
 
     return result;
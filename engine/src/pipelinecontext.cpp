@@ -1,6 +1,7 @@
 #include "pipelinecontext.h"
 
 #include "systems/rendersystem.h"
+#include "systems/resourcesystem.h"
 
 #include "components/scene.h"
 #include "components/actor.h"
@@ -8,6 +9,7 @@
 #include "components/world.h"
 #include "components/camera.h"
 #include "components/renderable.h"
+#include "components/effectrender.h"
 #include "components/baselight.h"
 #include "components/postprocessvolume.h"
 
@@ -18,16 +20,24 @@
 #include "resources/rendertarget.h"
 #include "resources/pipeline.h"
 
+#include "utils/texturestreamer.h"
+
 #include "pipelinetask.h"
 #include "commandbuffer.h"
 #include "log.h"
+#include "timer.h"
 
 #include <algorithm>
+#include <cfloat>
+
+#include <jobsystem.h>
 
 #include "frustum.h"
 
 namespace {
     const char *gTexture("mainTexture");
+
+    const uint32_t gCullingGrain = 4096;
 };
 
 /*!
@@ -39,6 +49,7 @@ namespace {
 */
 
 PipelineContext::PipelineContext() :
+        m_effectsCounter(new JobCounter),
         m_world(nullptr),
         m_pipeline(nullptr),
         m_buffer(Engine::objectCreate<CommandBuffer>()),
@@ -47,17 +58,28 @@ PipelineContext::PipelineContext() :
         m_camera(nullptr),
         m_width(64),
         m_height(64),
-        m_frustumCulling(true) {
+        m_frustumCulling(true),
+        m_graphDirty(true) {
 
 }
 
 PipelineContext::~PipelineContext() {
     m_textureBuffers.clear();
 
+    for(auto &it : m_transients) {
+        it.texture->deleteLater();
+    }
+
     m_defaultTarget->deleteLater();
     m_buffer->deleteLater();
 
     delete m_finalMaterial;
+
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs) {
+        jobs->wait(m_effectsCounter);
+    }
+    delete m_effectsCounter;
 }
 /*!
     Retrieves the command buffer associated with the pipeline context.
@@ -70,13 +92,17 @@ CommandBuffer *PipelineContext::buffer() const {
     Initiates the rendering process using the specified camera.
 */
 void PipelineContext::draw(Camera *camera) {
+    if(m_graphDirty) {
+        compileGraph();
+    }
+
     analizeGraph();
 
     camera->setRatio((float)m_width / (float)m_height);
     setCurrentCamera(camera);
 
-    for(auto it : m_renderTasks) {
-        if(it && it->isEnabled()) {
+    for(auto it : m_liveTasks) {
+        if(it->isEnabled()) {
             it->exec();
         }
     }
@@ -93,6 +119,12 @@ void PipelineContext::draw(Camera *camera) {
     for(auto it : m_postObservers) {
         (*it.first)(it.second);
     }
+
+    // Effects must not be simulated while the scene is changing between frames
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs) {
+        jobs->wait(m_effectsCounter);
+    }
 }
 /*!
     Sets the current \a camera and updates associated matrices in the command buffer.
@@ -126,6 +158,8 @@ void PipelineContext::resize(int32_t width, int32_t height) {
             it->resize(m_width, m_height);
         }
 
+        m_graphDirty = true;
+
         Camera *camera = Camera::current();
         if(camera) {
             camera->setRatio(float(m_width) / float(m_height));
@@ -136,6 +170,8 @@ void PipelineContext::resize(int32_t width, int32_t height) {
     Invalidates all the pipeline tasks to let them to reestablish connections.
 */
 void PipelineContext::invalidateTasks() {
+    m_graphDirty = true;
+
     for(int i = 0; i < m_pipeline->renderTasksLinksCount(); i++) {
         Pipeline::Link link = m_pipeline->renderTaskLink(i);
         PipelineTask *output = nullptr;
@@ -198,23 +234,58 @@ void PipelineContext::analizeGraph() {
                 if(update) {
                     renderable->update();
                 }
+                // Generated geometry is rebuilt here, the bounds and meshes are only read after this point
+                renderable->updateChunks();
                 m_sceneRenderables.push_back(renderable);
             }
         }
+
+        // Static renderables are expected to be moved in the editor only
+        scene->updateBounds(!update);
     }
 
+    simulateEffects(update);
+
     // Renderables frustum culling
     Frustum frustum(camera->frustum());
     Matrix4 viewProjection(camera->projectionMatrix() * camera->viewMatrix());
     if(m_frustumCulling) {
-        m_culledRenderables.clear();
-        for(auto it : m_sceneRenderables) {
-            if(!it->isCulled(frustum, viewProjection)) {
-                m_culledRenderables.push_back(it);
+        m_boundsRenderables.clear();
+        m_boundsX.clear();
+        m_boundsY.clear();
+        m_boundsZ.clear();
+        m_boundsRadius.clear();
+
+        for(auto scene : m_world->scenes()) {
+            m_candidates.clear();
+            scene->queryRenderables(frustum, m_candidates);
+
+            for(auto it : m_candidates) {
+                Renderable *renderable = static_cast<Renderable *>(it);
+                if(renderable->isEnabledInHierarchy()) {
+                    // World bound is cached by the renderable until transform hash is changed
+                    AABBox bb(renderable->bound());
+                    m_boundsRenderables.push_back(renderable);
+                    m_boundsX.push_back(bb.center.x);
+                    m_boundsY.push_back(bb.center.y);
+                    m_boundsZ.push_back(bb.center.z);
+                    m_boundsRadius.push_back(bb.extent.x < 0.0f ? FLT_MAX : bb.radius);
+                }
             }
         }
+
+        cullRenderables(frustum, viewProjection);
+    } else {
+        for(auto it : m_sceneRenderables) {
+            it->cullChunks(nullptr);
+
+            markVisible(it);
+        }
     }
 
+    requestTextures();
+    prioritizeResources(cameraWorldPosition);
+
     // Add lights
     m_sceneLights.clear();
     static uint32_t lightHash = Mathf::hashString("lights");
@@ -239,12 +310,308 @@ void PipelineContext::analizeGraph() {
         }
     }
 
-    for(auto &it : m_renderTasks) {
-        if(it && it->isEnabled()) {
+    for(auto it : m_liveTasks) {
+        if(it->isEnabled()) {
             it->analyze(m_world);
         }
     }
 }
+/*!
+    \internal
+    Compiles the render tasks into a frame graph.
+    Tasks which outputs are not consumed by the final task of the pipeline are culled and will not be analyzed and executed.
+    Tasks which are not a part of the pipeline resource (like the editor tasks) and tasks without outputs are always kept.
+    Links are followed regardless of enabled state of the tasks, so disabled pass-through tasks don't cut off their sources.
+    Transient textures of the tasks are assigned from the shared pool.
+    Transients are valid only while their task is executed, so any two tasks can alias the same texture if the format, filtering and size are matched.
+    Textures of the culled tasks are released.
+*/
+void PipelineContext::compileGraph() {
+    PROFILE_FUNCTION();
+
+    m_graphDirty = false;
+
+    m_liveTasks.clear();
+    if(m_pipeline) {
+        int tasksCount = m_pipeline->renderTasksCount();
+        TString last = (tasksCount > 0) ? m_pipeline->renderTaskName(tasksCount - 1) : TString();
+
+        std::vector<PipelineTask *> stack;
+        for(auto it : m_renderTasks) {
+            bool pipelineTask = false;
+            for(int i = 0; i < tasksCount; i++) {
+                if(m_pipeline->renderTaskName(i) == it->name()) {
+                    pipelineTask = true;
+                    break;
+                }
+            }
+
+            if(!pipelineTask || it->outputCount() == 0 || it->name() == last) {
+                stack.push_back(it);
+            }
+        }
+
+        std::vector<PipelineTask *> live;
+        while(!stack.empty()) {
+            PipelineTask *task = stack.back();
+            stack.pop_back();
+
+            if(std::find(live.begin(), live.end(), task) != live.end()) {
+                continue;
+            }
+            live.push_back(task);
+
+            for(int i = 0; i < m_pipeline->renderTasksLinksCount(); i++) {
+                Pipeline::Link link = m_pipeline->renderTaskLink(i);
+                if(link.target == task->name()) {
+                    for(auto it : m_renderTasks) {
+                        if(it->name() == link.source) {
+                            stack.push_back(it);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        for(auto it : m_renderTasks) {
+            if(std::find(live.begin(), live.end(), it) != live.end()) {
+                m_liveTasks.push_back(it);
+            }
+        }
+    } else {
+        m_liveTasks.assign(m_renderTasks.begin(), m_renderTasks.end());
+    }
+
+    std::vector<bool> used(m_transients.size(), false);
+    std::vector<bool> taken;
+    for(auto task : m_renderTasks) {
+        bool alive = std::find(m_liveTasks.begin(), m_liveTasks.end(), task) != m_liveTasks.end();
+
+        taken.assign(m_transients.size(), false);
+        for(int i = 0; i < task->transientCount(); i++) {
+            PipelineTask::Transient &slot = task->m_transients[i];
+
+            Texture *texture = nullptr;
+            if(alive) {
+                size_t index = 0;
+                for(; index < m_transients.size(); index++) {
+                    TransientTexture &entry = m_transients[index];
+                    if(!taken[index] && entry.format == slot.format && entry.filtering == slot.filtering && entry.downscale == slot.downscale) {
+                        break;
+                    }
+                }
+
+                if(index == m_transients.size()) {
+                    Texture *created = Engine::objectCreate<Texture>(slot.name);
+                    created->setFormat(slot.format);
+                    created->setFiltering(slot.filtering);
+                    created->setFlags(Texture::Render);
+
+                    m_transients.push_back({created, slot.format, slot.filtering, slot.downscale});
+                    used.push_back(false);
+                    taken.push_back(false);
+                }
+
+                used[index] = true;
+                taken[index] = true;
+
+                texture = m_transients[index].texture;
+                texture->resize(MAX(m_width >> slot.downscale, 1), MAX(m_height >> slot.downscale, 1));
+            }
+
+            if(slot.texture != texture) {
+                task->setTransient(i, texture);
+            }
+        }
+    }
+
+    size_t count = 0;
+    for(size_t i = 0; i < m_transients.size(); i++) {
+        if(used[i]) {
+            m_transients[count] = m_transients[i];
+            count++;
+        } else {
+            m_transients[i].texture->deleteLater();
+        }
+    }
+    m_transients.resize(count);
+}
+/*!
+    \internal
+    Tests world bounds of the candidate renderables against the \a frustum and calculates LODs using \a viewProjection matrix.
+    Candidates are gathered from the scene bounding volume hierarchies, so only renderables near the frustum are processed.
+    Bounds are processed in batches on the worker threads, visible renderables are collected to the culled list in the candidates order.
+    Parts of the visible renderables, like chunks of the tile maps, are culled individually after that.
+*/
+void PipelineContext::cullRenderables(const Frustum &frustum, const Matrix4 &viewProjection) {
+    uint32_t count = m_boundsRenderables.size();
+    m_visibility.resize(count);
+
+    auto cull = [this, &frustum, &viewProjection](uint32_t begin, uint32_t end) {
+        frustum.containsSpheres(&m_boundsX[begin], &m_boundsY[begin], &m_boundsZ[begin], &m_boundsRadius[begin], end - begin, &m_visibility[begin]);
+
+        for(uint32_t i = begin; i < end; i++) {
+            if(m_visibility[i]) {
+                Renderable *renderable = m_boundsRenderables[i];
+                if(m_boundsRadius[i] == FLT_MAX) {
+                    renderable->setLod(0);
+                } else {
+                    Vector3 center(m_boundsX[i], m_boundsY[i], m_boundsZ[i]);
+                    m_visibility[i] = renderable->updateLod(center, m_boundsRadius[i], frustum.m_top.normal, viewProjection) ? 1 : 0;
+                }
+            }
+        }
+    };
+
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs && count > gCullingGrain) {
+        jobs->parallelFor(count, gCullingGrain, cull);
+    } else {
+        cull(0, count);
+    }
+
+    m_visibleIndices.clear();
+    m_culledRenderables.clear();
+    for(uint32_t i = 0; i < count; i++) {
+        if(m_visibility[i]) {
+            m_visibleIndices.push_back(i);
+            m_culledRenderables.push_back(m_boundsRenderables[i]);
+
+            m_boundsRenderables[i]->cullChunks(&frustum);
+
+            markVisible(m_boundsRenderables[i]);
+        }
+    }
+}
+/*!
+    \internal
+    Notifies the \a renderable that it passed the culling in this frame.
+    Emitters which were not visible for a while are simulated at a reduced rate, see EffectRender::setOffscreenInterval().
+*/
+void PipelineContext::markVisible(Renderable *renderable) {
+    static uint32_t effectHash = Mathf::hashString("effects");
+    if(renderable->hasTagByHash(effectHash)) {
+        static_cast<EffectRender *>(renderable)->m_invisibleFrames = 0;
+    }
+}
+/*!
+    \internal
+    Publishes results of the previous effects simulation and starts the next step if the world is going to \a update.
+    Emitters are simulated on the worker threads while the frame is culled and recorded, the jobs are finished at the end of draw().
+    Visibility of the emitters is known from the previous frames, so emitters which were off-screen for a while are simulated at a reduced rate.
+    GPU effects are dispatched to the command buffer instead if the backend supports compute kernels, see CommandBuffer::isComputeSupported().
+*/
+void PipelineContext::simulateEffects(bool update) {
+    PROFILE_FUNCTION();
+
+    float dt = Timer::deltaTime() * Timer::scale();
+
+    m_effects.clear();
+    static uint32_t effectHash = Mathf::hashString("effects");
+    for(auto scene : m_world->scenes()) {
+        for(auto it : scene->getObjectsInGroupByHash(effectHash)) {
+            EffectRender *effect = static_cast<EffectRender *>(it);
+            if(effect->isEnabledInHierarchy()) {
+                effect->publish();
+
+                if(update && effect->prepareSimulation(dt)) {
+                    // Kernels are not supported by all backends, the CPU simulation is used as a fallback
+                    bool gpu = effect->m_effect->gpu() && m_buffer->isComputeSupported();
+                    if(!gpu || !effect->dispatch(*m_buffer)) {
+                        m_effects.push_back(effect);
+                    }
+                }
+            }
+        }
+    }
+
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs && m_effects.size() > 1) {
+        jobs->parallelFor(m_effects.size(), 1, [this](uint32_t begin, uint32_t end) {
+            for(uint32_t i = begin; i < end; i++) {
+                m_effects[i]->simulate();
+            }
+        }, m_effectsCounter);
+    } else {
+        for(auto it : m_effects) {
+            it->simulate();
+        }
+    }
+}
+/*!
+    \internal
+    Requests mip levels of the streamed textures sampled by the scene renderables.
+    Visible renderables request levels according to their screen space size in pixels.
+*/
+void PipelineContext::requestTextures() {
+    ResourceSystem *system = Engine::resourceSystem();
+    TextureStreamer *streamer = (system) ? system->textureStreamer() : nullptr;
+    if(streamer == nullptr || streamer->textureCount() == 0) {
+        return;
+    }
+
+    for(auto it : m_sceneRenderables) {
+        for(auto instance : it->m_materials) {
+            if(instance) {
+                streamer->request(*instance, 0.0f);
+            }
+        }
+    }
+
+    for(auto it : (m_frustumCulling ? m_culledRenderables : m_sceneRenderables)) {
+        float size = (it->m_screenSize == FLT_MAX) ? FLT_MAX : it->m_screenSize * m_height;
+        for(auto instance : it->m_materials) {
+            if(instance) {
+                streamer->request(*instance, size);
+            }
+        }
+    }
+}
+/*!
+    \internal
+    Sets the streaming priority of the meshes, materials and textures which are still loading for the visible renderables.
+    A resource is prioritized by the distance from the camera \a origin to the closest renderable which uses it, so the nearby objects are loaded first.
+*/
+void PipelineContext::prioritizeResources(const Vector3 &origin) {
+    ResourceSystem *system = Engine::resourceSystem();
+    if(system == nullptr || system->streamingCount() == 0) {
+        return;
+    }
+
+    m_priorities.clear();
+
+    auto prioritize = [this](Resource *resource, float distance) {
+        if(resource && resource->state() == Resource::Loading) {
+            auto it = m_priorities.find(resource);
+            if(it == m_priorities.end()) {
+                m_priorities[resource] = distance;
+            } else {
+                it->second = MIN(it->second, distance);
+            }
+        }
+    };
+
+    for(auto it : (m_frustumCulling ? m_culledRenderables : m_sceneRenderables)) {
+        AABBox bb(it->bound());
+        float distance = (bb.extent.x < 0.0f) ? 0.0f : (bb.center - origin).length();
+
+        prioritize(it->meshToStream(), distance);
+
+        for(auto instance : it->m_materials) {
+            if(instance) {
+                prioritize(instance->material(), distance);
+                for(auto &texture : instance->m_textureOverride) {
+                    prioritize(texture.second, distance);
+                }
+            }
+        }
+    }
+
+    for(auto &it : m_priorities) {
+        system->setPriority(it.first, it.second);
+    }
+}
 /*!
     Returns the curent world instance to process.
 */
@@ -399,6 +766,8 @@ void PipelineContext::insertRenderTask(PipelineTask *task, PipelineTask *before)
         } else {
             m_renderTasks.push_back(task);
         }
+
+        m_graphDirty = true;
     }
 }
 /*!
@@ -407,6 +776,38 @@ void PipelineContext::insertRenderTask(PipelineTask *task, PipelineTask *before)
 const std::list<PipelineTask *> &PipelineContext::renderTasks() const {
     return m_renderTasks;
 }
+/*!
+    Returns the peak amount of video memory in bytes occupied by the render targets of the pipeline.
+    Includes outputs of the tasks which are not culled from the frame graph and the shared pool of transient textures.
+    Transient textures are shared between the tasks, so the pool holds only as many textures of each format and size as the most demanding task needs.
+*/
+uint64_t PipelineContext::renderTargetMemory() {
+    PROFILE_FUNCTION();
+
+    if(m_graphDirty) {
+        compileGraph();
+    }
+
+    std::vector<Texture *> textures;
+    for(auto task : m_liveTasks) {
+        for(int i = 0; i < task->outputCount(); i++) {
+            Texture *texture = task->output(i);
+            if(texture && std::find(textures.begin(), textures.end(), texture) == textures.end()) {
+                textures.push_back(texture);
+            }
+        }
+    }
+
+    uint64_t result = 0;
+    for(auto it : textures) {
+        result += it->gpuMemory();
+    }
+    for(auto &it : m_transients) {
+        result += it.texture->gpuMemory();
+    }
+
+    return result;
+}
 /*!
     Returns a list of names of the global textures.
 */
@@ -102,6 +102,44 @@ Texture *PipelineTask::output(int index) {
     }
     return nullptr;
 }
+/*!
+    Returns the number of transient textures used by the task.
+*/
+int PipelineTask::transientCount() const {
+    return m_transients.size();
+}
+/*!
+    Returns by \a index a transient texture assigned to the task or nullptr if the task was culled from the frame graph.
+*/
+Texture *PipelineTask::transient(int index) const {
+    if(index < static_cast<int>(m_transients.size())) {
+        return m_transients[index].texture;
+    }
+    return nullptr;
+}
+/*!
+    Declares a transient render texture with given \a name, \a format and \a filtering.
+    The size of texture is the screen size divided by 2 in power of \a downscale.
+    Transient textures are valid only during exec() of the task, so PipelineContext shares the same textures between the tasks.
+    The actual texture will be passed to setTransient() when the frame graph is compiled.
+    Transients must be declared in the constructor or in resize().
+    Returns an index of transient.
+*/
+int PipelineTask::addTransient(const TString &name, int format, int filtering, int downscale) {
+    m_transients.push_back({name, format, filtering, downscale, nullptr});
+
+    return m_transients.size() - 1;
+}
+/*!
+    Assigns a \a texture to the transient with given \a index.
+    Tasks must reimplement this method to attach the new \a texture to their render targets and materials.
+    The \a texture can be nullptr if the task was culled from the frame graph.
+*/
+void PipelineTask::setTransient(int index, Texture *texture) {
+    if(index < static_cast<int>(m_transients.size())) {
+        m_transients[index].texture = texture;
+    }
+}
 /*!
     Sets task to \a enable or disable.
     The disabled effect will not be executed.
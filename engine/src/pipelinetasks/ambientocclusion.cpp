@@ -20,7 +20,7 @@ namespace {
 
 AmbientOcclusion::AmbientOcclusion() :
         m_noiseTexture(Engine::objectCreate<Texture>("aoNoiseTexture")),
-        m_aoTexture(Engine::objectCreate<Texture>("aoOcclusion")),
+        m_aoTexture(nullptr),
         m_blurTexture(Engine::objectCreate<Texture>("aoBlur")),
         m_aoTarget(Engine::objectCreate<RenderTarget>("aoTarget")),
         m_blurTarget(Engine::objectCreate<RenderTarget>("aoBlurTarget")),
@@ -56,10 +56,7 @@ AmbientOcclusion::AmbientOcclusion() :
         //ptr[i].normalize();
     }
 
-    m_aoTexture->setFormat(Texture::R8);
-    m_aoTexture->setFlags(Texture::Render);
-
-    m_aoTarget->setColorAttachment(0, m_aoTexture);
+    addTransient("aoOcclusion", Texture::R8, Texture::None, 0);
 
     m_blurTexture->setFormat(Texture::R8);
     m_blurTexture->setFlags(Texture::Render);
@@ -98,7 +95,6 @@ AmbientOcclusion::AmbientOcclusion() :
         Material *material = Engine::loadResource<Material>(".embedded/BlurOcclusion.shader");
         if(material) {
             m_blur = material->createInstance();
-            m_blur->setTexture("aoMap", m_aoTexture);
         }
     }
 
@@ -107,7 +103,6 @@ AmbientOcclusion::AmbientOcclusion() :
 
 AmbientOcclusion::~AmbientOcclusion() {
     m_noiseTexture->deleteLater();
-    m_aoTexture->deleteLater();
     m_blurTexture->deleteLater();
 
     m_aoTarget->deleteLater();
@@ -159,7 +154,7 @@ void AmbientOcclusion::exec() {
 
     buffer->beginDebugMarker("AmbientOcclusion");
 
-    buffer->setViewport(0, 0, m_aoTexture->width(), m_aoTexture->height());
+    buffer->setViewport(0, 0, m_blurTexture->width(), m_blurTexture->height());
     if(m_toDisable) {
         buffer->setRenderTarget(m_blurTarget);
         m_enabled = false;
@@ -182,7 +177,6 @@ void AmbientOcclusion::exec() {
 void AmbientOcclusion::resize(int32_t width, int32_t height) {
     PipelineTask::resize(width, height);
 
-    m_aoTexture->resize(width, height);
     m_blurTexture->resize(width, height);
 }
 
@@ -193,3 +187,13 @@ void AmbientOcclusion::setEnabled(bool enable) {
         m_enabled = enable;
     }
 }
+
+void AmbientOcclusion::setTransient(int index, Texture *texture) {
+    PipelineTask::setTransient(index, texture);
+
+    m_aoTexture = texture;
+    m_aoTarget->setColorAttachment(0, m_aoTexture);
+    if(m_blur) {
+        m_blur->setTexture("aoMap", m_aoTexture);
+    }
+}
@@ -76,9 +76,6 @@ Bloom::~Bloom() {
         it.downTarget->deleteLater();
         delete it.blurMaterialV;
         delete it.blurMaterialH;
-
-        it.downTexture->deleteLater();
-        it.blurTempTexture->deleteLater();
     }
 }
 
@@ -181,32 +178,12 @@ void Bloom::resize(int32_t width, int32_t height) {
         Vector2 directionV(0.0f, 1.0f);
 
         for(uint8_t i = 0; i < m_mipLevels; i++) {
-            if(m_bloomPasses[i].downTexture == nullptr) {
-                m_bloomPasses[i].downTexture = Engine::objectCreate<Texture>("downSampleTexture");
-                m_bloomPasses[i].downTexture->setFormat(Texture::RGBA16Float);
-                m_bloomPasses[i].downTexture->setFiltering(Texture::Bilinear);
-                m_bloomPasses[i].downTexture->setFlags(Texture::Render);
-            }
-            m_bloomPasses[i].downTexture->resize((width >> i), (height >> i));
-
-            if(m_bloomPasses[i].blurTempTexture == nullptr) {
-                m_bloomPasses[i].blurTempTexture = Engine::objectCreate<Texture>("blurTempTexture");
-                m_bloomPasses[i].blurTempTexture->setFormat(Texture::RGBA16Float);
-                m_bloomPasses[i].blurTempTexture->setFiltering(Texture::Bilinear);
-                m_bloomPasses[i].blurTempTexture->setFlags(Texture::Render);
-            }
-            m_bloomPasses[i].blurTempTexture->resize((width >> i), (height >> i));
-
             if(m_bloomPasses[i].downTarget == nullptr) {
                 m_bloomPasses[i].downTarget = Engine::objectCreate<RenderTarget>("downSampleTarget");
-
-                m_bloomPasses[i].downTarget->setColorAttachment(0, m_bloomPasses[i].downTexture);
             }
 
             if(m_bloomPasses[i].blurTempTarget == nullptr) {
                 m_bloomPasses[i].blurTempTarget = Engine::objectCreate<RenderTarget>("blurTempTarget");
-
-                m_bloomPasses[i].blurTempTarget->setColorAttachment(0, m_bloomPasses[i].blurTempTexture);
                 m_bloomPasses[i].blurTempTarget->setFlags(RenderTarget::ClearColor);
             }
 
@@ -234,13 +211,17 @@ void Bloom::resize(int32_t width, int32_t height) {
             m_bloomPasses[i].blurMaterialH->setInteger(gSteps, &m_bloomPasses[i].steps);
             m_bloomPasses[i].blurMaterialH->setFloat(gCurve, m_bloomPasses[i].blurPoints);
             m_bloomPasses[i].blurMaterialH->setVector2(gDirection, &directionH);
-            m_bloomPasses[i].blurMaterialH->setTexture(gRgbMap, m_bloomPasses[i].downTexture);
 
             m_bloomPasses[i].blurMaterialV->setVector2(gSize, &size);
             m_bloomPasses[i].blurMaterialV->setInteger(gSteps, &m_bloomPasses[i].steps);
             m_bloomPasses[i].blurMaterialV->setFloat(gCurve, m_bloomPasses[i].blurPoints);
             m_bloomPasses[i].blurMaterialV->setVector2(gDirection, &directionV);
-            m_bloomPasses[i].blurMaterialV->setTexture(gRgbMap, m_bloomPasses[i].blurTempTexture);
+        }
+
+        // Each level downsamples and blurs the scene in two transient textures
+        for(uint32_t i = m_transients.size() / 2; i < m_mipLevels; i++) {
+            addTransient("downSampleTexture", Texture::RGBA16Float, Texture::Bilinear, i);
+            addTransient("blurTempTexture", Texture::RGBA16Float, Texture::Bilinear, i);
         }
     }
 
@@ -258,6 +239,25 @@ void Bloom::setInput(int index, Texture *source) {
     }
 }
 
+void Bloom::setTransient(int index, Texture *texture) {
+    PipelineTask::setTransient(index, texture);
+
+    BloomPass &pass = m_bloomPasses[index / 2];
+    if(index % 2 == 0) {
+        pass.downTexture = texture;
+        pass.downTarget->setColorAttachment(0, texture);
+        if(pass.blurMaterialH) {
+            pass.blurMaterialH->setTexture(gRgbMap, texture);
+        }
+    } else {
+        pass.blurTempTexture = texture;
+        pass.blurTempTarget->setColorAttachment(0, texture);
+        if(pass.blurMaterialV) {
+            pass.blurMaterialV->setTexture(gRgbMap, texture);
+        }
+    }
+}
+
 void Bloom::generateKernel(float radius, int32_t steps, float *points) {
     memset(points, 0, sizeof(float) * MAX_SAMPLES);
 
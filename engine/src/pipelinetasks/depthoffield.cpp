@@ -41,8 +41,6 @@ namespace {
 
 DepthOfField::DepthOfField() :
         m_resultTexture(Engine::objectCreate<Texture>("depthOfField")),
-        m_downTexture(Engine::objectCreate<Texture>("downTexture")),
-        m_blurTexture(Engine::objectCreate<Texture>("downTexture")),
         m_resultTarget(Engine::objectCreate<RenderTarget>("depthOfField")),
         m_downTarget(Engine::objectCreate<RenderTarget>("downTarget")),
         m_blurTarget(Engine::objectCreate<RenderTarget>("blurTarget")),
@@ -86,27 +84,19 @@ DepthOfField::DepthOfField() :
         m_dofMaterial->setFloat(gFocusScale, &scale);
         m_dofMaterial->setFloat(gBlurSize, &m_blurSize);
         m_dofMaterial->setFloat(gSkyDistance, &m_skyDistance);
-        m_dofMaterial->setTexture("lowMap", m_downTexture);
     }
 
     m_resultTexture->setFormat(Texture::RGBA16Float);
     m_resultTexture->setFiltering(Texture::Bilinear);
     m_resultTexture->setFlags(Texture::Render);
 
-    m_downTexture->setFormat(Texture::RGBA16Float);
-    m_downTexture->setFiltering(Texture::Bilinear);
-    m_downTexture->setFlags(Texture::Render);
-
-    m_blurTexture->setFormat(Texture::RGBA16Float);
-    m_blurTexture->setFiltering(Texture::Bilinear);
-    m_blurTexture->setFlags(Texture::Render);
+    addTransient("downTexture", Texture::RGBA16Float, Texture::Bilinear, 1);
+    addTransient("blurTexture", Texture::RGBA16Float, Texture::Bilinear, 1);
 
     m_resultTarget->setColorAttachment(0, m_resultTexture);
 
-    m_downTarget->setColorAttachment(0, m_downTexture);
     m_downTarget->setFlags(RenderTarget::ClearColor);
 
-    m_blurTarget->setColorAttachment(0, m_blurTexture);
     m_blurTarget->setFlags(RenderTarget::ClearColor);
 
     m_outputs.push_back(std::make_pair(m_resultTexture->name(), m_resultTexture));
@@ -115,9 +105,9 @@ DepthOfField::DepthOfField() :
 DepthOfField::~DepthOfField() {
     m_resultTarget->deleteLater();
     m_downTarget->deleteLater();
+    m_blurTarget->deleteLater();
 
     m_resultTexture->deleteLater();
-    m_downTexture->deleteLater();
 
     delete m_dofMaterial;
     delete m_downMaterial;
@@ -222,8 +212,6 @@ void DepthOfField::exec() {
 void DepthOfField::resize(int32_t width, int32_t height) {
     if(m_width != width || m_height != height) {
 
-        m_downTexture->resize((width >> 1), (height >> 1));
-        m_blurTexture->resize((width >> 1), (height >> 1));
         m_resultTexture->resize(width, height);
 
         float radius = MAX((width >> 1), 1) * 4.0f * 0.01f;
@@ -261,6 +249,25 @@ void DepthOfField::setInput(int index, Texture *texture) {
     }
 }
 
+void DepthOfField::setTransient(int index, Texture *texture) {
+    PipelineTask::setTransient(index, texture);
+
+    switch(index) {
+        case 0: {
+            m_downTexture = texture;
+            m_downTarget->setColorAttachment(0, m_downTexture);
+            if(m_dofMaterial) {
+                m_dofMaterial->setTexture("lowMap", m_downTexture);
+            }
+        } break;
+        case 1: {
+            m_blurTexture = texture;
+            m_blurTarget->setColorAttachment(0, m_blurTexture);
+        } break;
+        default: break;
+    }
+}
+
 void DepthOfField::generateKernel(float radius, int32_t steps, float *points) {
     memset(points, 0, sizeof(float) * MAX_SAMPLES);
 
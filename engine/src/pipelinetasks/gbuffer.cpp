@@ -2,6 +2,9 @@
 
 #include "resources/rendertarget.h"
 
+#include "components/camera.h"
+#include "components/transform.h"
+
 #include "pipelinecontext.h"
 #include "commandbuffer.h"
 
@@ -16,6 +19,8 @@ GBuffer::GBuffer() :
 
     setName("GBuffer");
 
+    m_opaque.setBatching(true);
+
     Texture *emissive = Engine::objectCreate<Texture>(G_EMISSIVE);
     emissive->setFormat(Texture::RGBA16Float);
     emissive->setFlags(Texture::Render);
@@ -61,24 +66,21 @@ void GBuffer::exec() {
     buffer->setViewport(0, 0, m_width, m_height);
     m_context->cameraReset();
 
-    buffer->setRenderTarget(m_gbuffer);
-
-    for(auto &it : m_opaque) {
-        if(it.count > 1) {
-            it.instance->setInstanceBuffer(&it.buffer);
-        }
-        buffer->drawMesh(it.mesh, it.subMesh, Material::Opaque, *it.instance);
-        it.instance->setInstanceBuffer(nullptr);
-    }
+    buffer->execute(m_commands);
 
     buffer->endDebugMarker();
 }
 
 void GBuffer::analyze(World *world) {
     A_UNUSED(world);
-    Renderable::GroupList list;
-    Renderable::filterByLayer(m_context->culledRenderables(), list, Material::Opaque);
+    Camera *camera = Camera::current();
+    Transform *transform = camera->transform();
 
     m_opaque.clear();
-    Renderable::group(list, m_opaque);
+    m_opaque.add(m_context->culledRenderables(), Material::Opaque, transform->worldPosition(), transform->worldQuaternion() * Vector3(0.0f, 0.0f,-1.0f));
+    m_opaque.build();
+
+    m_commands.clear();
+    m_commands.setRenderTarget(m_gbuffer);
+    m_opaque.record(m_commands, Material::Opaque);
 }
@@ -3,6 +3,7 @@
 #include "engine.h"
 
 #include "commandbuffer.h"
+#include "renderqueue.h"
 
 #include "components/baselight.h"
 
@@ -10,6 +11,8 @@
 #include "resources/rendertarget.h"
 #include "resources/material.h"
 
+#include <jobsystem.h>
+
 namespace {
     const char *gShadowmap("g.shadowmap");
 
@@ -44,11 +47,9 @@ ShadowMap::ShadowMap() :
 }
 
 void ShadowMap::analyze(World *world) {
-    A_UNUSED(world);
-    RenderList &components = m_context->sceneRenderables();
     for(auto &it : m_context->sceneLights()) {
         if(it->castShadows()) {
-            it->buildGroups(components);
+            it->buildGroups(world);
         }
     }
 }
@@ -60,6 +61,8 @@ void ShadowMap::exec() {
     cleanShadowCache();
 
     buffer->setRenderTarget(m_shadowTarget);
+
+    m_shadowTiles.clear();
     for(auto &it : m_context->sceneLights()) {
         auto instance = it->material();
         if(instance) {
@@ -71,6 +74,11 @@ void ShadowMap::exec() {
             lightUpdate(it, it->tilesCount());
         }
     }
+
+    recordTiles();
+    for(uint32_t i = 0; i < m_shadowTiles.size(); i++) {
+        buffer->execute(m_commands[i]);
+    }
     m_shadowTarget->setTileIndex(-1);
 
     m_context->cameraReset();
@@ -83,29 +91,20 @@ void ShadowMap::lightUpdate(BaseLight *light, int count) {
         const std::vector<AtlasNode *> &nodes(*t);
         Vector4 tiles[6];
 
-        CommandBuffer *buffer = m_context->buffer();
         for(int32_t i = count - 1; i >= 0; i--) {
             tiles[i] = Vector4(static_cast<float>(nodes[i]->x) / m_shadowAtlasSize,
                                static_cast<float>(nodes[i]->y) / m_shadowAtlasSize,
                                static_cast<float>(nodes[i]->w) / m_shadowAtlasSize,
                                static_cast<float>(nodes[i]->h) / m_shadowAtlasSize);
 
-            const Renderable::GroupList &groups = light->groups(i);
-            if(!groups.empty()) {
-                uint32_t index = nodes[i]->x / m_shadowTileSize + (nodes[i]->y / m_shadowTileSize) * (m_shadowAtlasSize / m_shadowTileSize);
-                m_shadowTarget->setTileIndex(index);
-
-                buffer->setViewProjection(light->cropMatrix(i));
-                buffer->setViewport(nodes[i]->x, nodes[i]->y, nodes[i]->w, nodes[i]->h);
-
-                // Draw to the depth buffer from the position of the light source
-                for(auto &it : groups) {
-                    if(it.count > 1) {
-                        it.instance->setInstanceBuffer(&it.buffer);
-                    }
-                    buffer->drawMesh(it.mesh, it.subMesh, Material::Shadowcast, *it.instance);
-                    it.instance->setInstanceBuffer(nullptr);
-                }
+            const RenderQueue &queue = light->queue(i);
+            if(!queue.isEmpty()) {
+                ShadowTile tile;
+                tile.crop = light->cropMatrix(i);
+                tile.queue = &queue;
+                tile.node = nodes[i];
+
+                m_shadowTiles.push_back(tile);
             }
         }
 
@@ -118,6 +117,36 @@ void ShadowMap::lightUpdate(BaseLight *light, int count) {
 
 }
 
+void ShadowMap::recordTiles() {
+    uint32_t count = m_shadowTiles.size();
+    if(m_commands.size() < count) {
+        m_commands.resize(count);
+    }
+
+    // Tiles are independent, so their commands are recorded in parallel
+    auto record = [this](uint32_t begin, uint32_t end) {
+        for(uint32_t i = begin; i < end; i++) {
+            const ShadowTile &tile = m_shadowTiles[i];
+            CommandList &list = m_commands[i];
+
+            list.clear();
+            list.setTileIndex(m_shadowTarget, tile.node->x / m_shadowTileSize + (tile.node->y / m_shadowTileSize) * (m_shadowAtlasSize / m_shadowTileSize));
+            list.setViewProjection(tile.crop);
+            list.setViewport(tile.node->x, tile.node->y, tile.node->w, tile.node->h);
+
+            // Draw to the depth buffer from the position of the light source
+            tile.queue->record(list, Material::Shadowcast);
+        }
+    };
+
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs && count > 1) {
+        jobs->parallelFor(count, 1, record);
+    } else {
+        record(0, count);
+    }
+}
+
 void ShadowMap::cleanShadowCache() {
     for(auto tiles = m_tiles.begin(); tiles != m_tiles.end(); ) {
         if(tiles->second.unused) {
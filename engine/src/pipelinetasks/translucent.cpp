@@ -2,6 +2,8 @@
 
 #include "resources/rendertarget.h"
 
+#include "components/camera.h"
+#include "components/transform.h"
 #include "components/renderable.h"
 
 #include "commandbuffer.h"
@@ -11,6 +13,8 @@ Translucent::Translucent() :
 
     setName("Translucent");
 
+    m_translucent.setBatching(true);
+
     m_inputs.push_back("In");
     m_inputs.push_back("Depth");
 
@@ -20,18 +24,10 @@ Translucent::Translucent() :
 void Translucent::exec() {
     CommandBuffer *buffer = m_context->buffer();
 
-    if(!m_translucent.empty()) {
+    if(!m_translucent.isEmpty()) {
         buffer->beginDebugMarker("TranslucentPass");
 
-        buffer->setRenderTarget(m_translucentPass);
-
-        for(auto &it : m_translucent) {
-            if(it.count > 1) {
-                it.instance->setInstanceBuffer(&it.buffer);
-            }
-            buffer->drawMesh(it.mesh, it.subMesh, Material::Translucent, *it.instance);
-            it.instance->setInstanceBuffer(nullptr);
-        }
+        buffer->execute(m_commands);
 
         buffer->endDebugMarker();
     }
@@ -52,9 +48,14 @@ void Translucent::setInput(int index, Texture *texture) {
 
 void Translucent::analyze(World *world) {
     A_UNUSED(world);
-    Renderable::GroupList list;
-    Renderable::filterByLayer(m_context->culledRenderables(), list, Material::Translucent);
+    Camera *camera = Camera::current();
+    Transform *transform = camera->transform();
 
     m_translucent.clear();
-    Renderable::group(list, m_translucent);
+    m_translucent.add(m_context->culledRenderables(), Material::Translucent, transform->worldPosition(), transform->worldQuaternion() * Vector3(0.0f, 0.0f,-1.0f));
+    m_translucent.build();
+
+    m_commands.clear();
+    m_commands.setRenderTarget(m_translucentPass);
+    m_translucent.record(m_commands, Material::Translucent);
 }
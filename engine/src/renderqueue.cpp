@@ -0,0 +1,466 @@
+#include "renderqueue.h"
+
+#include "commandlist.h"
+
+#include "mesh.h"
+#include "material.h"
+
+#include "components/transform.h"
+
+#include <cstring>
+
+namespace {
+    const int32_t gPriorityBias(1 << 11);
+    const int32_t gPriorityMax((1 << 12) - 1);
+
+    const uint32_t gRadixBits(8);
+    const uint32_t gRadixSize(1 << gRadixBits);
+
+    // Limits of the geometry merged on the CPU every frame
+    const uint32_t gMaxItemVertices(4096);
+    const uint32_t gMaxBatchVertices(65536);
+}
+
+/*!
+    \class RenderQueue
+    \brief The RenderQueue class collects draw items of renderables and merges them into instancing batches.
+    \inmodule Engine
+
+    Each draw item has a packed 64-bit sort key which contains a material layer, a final material priority, a hash of the material instance and mesh and a depth along the view direction.
+    Items are sorted with a radix sort and adjacent items with the same material instance hash and mesh are merged into a single instanced draw call.
+
+    Translucent items are sorted from back to front before the hash, other layers are sorted by the hash first to maximize batching and then from front to back.
+
+    When batching is enabled with setBatching(), small meshes of 2D renderables (sprites and tile map chunks) are also merged across different meshes.
+    Adjacent items with the same material, textures and instance parameters are transformed to world space and copied into a shared dynamic mesh, so the whole run is drawn with a single draw call.
+    Only adjacent items are merged, so the order defined by the sort key, including the priority, is kept.
+    The number of merged draw calls and items is reported with the SPRITE_BATCHES and BATCHED_SPRITES profiler counters.
+
+    All storage, including instance data of batches, is reused across frames, so the queue doesn't allocate memory once it has reached its working size.
+*/
+
+RenderQueue::RenderQueue() :
+        m_usedBuffers(0),
+        m_usedMeshes(0),
+        m_batching(false),
+        m_chunkCulling(true) {
+
+}
+/*!
+    Copies settings of the \a queue, draw data is not copied and must be rebuilt.
+*/
+RenderQueue::RenderQueue(const RenderQueue &queue) :
+        m_usedBuffers(0),
+        m_usedMeshes(0),
+        m_batching(queue.m_batching),
+        m_chunkCulling(queue.m_chunkCulling) {
+
+}
+
+RenderQueue::~RenderQueue() {
+    for(auto it : m_meshes) {
+        delete it;
+    }
+}
+/*!
+    Copies settings of the \a queue, draw data is not copied and must be rebuilt.
+*/
+RenderQueue &RenderQueue::operator=(const RenderQueue &queue) {
+    if(this != &queue) {
+        clear();
+        m_batching = queue.m_batching;
+        m_chunkCulling = queue.m_chunkCulling;
+    }
+    return *this;
+}
+/*!
+    Removes all items and batches from the queue.
+*/
+void RenderQueue::clear() {
+    m_items.clear();
+    m_batches.clear();
+}
+/*!
+    Returns true if the queue merges 2D geometry of different meshes; otherwise returns false.
+*/
+bool RenderQueue::isBatching() const {
+    return m_batching;
+}
+/*!
+    Enables or disables merging of the 2D geometry of different meshes into shared dynamic meshes.
+    Batching is disabled by default.
+*/
+void RenderQueue::setBatching(bool enable) {
+    m_batching = enable;
+}
+/*!
+    Returns true if the queue skips parts of the renderables which were culled by the camera; otherwise returns false.
+*/
+bool RenderQueue::isChunkCulling() const {
+    return m_chunkCulling;
+}
+/*!
+    Enables or disables skipping of the renderable parts (like chunks of the tile maps) which were culled by the camera.
+    Chunk culling is enabled by default; queues of other views, like shadow cascades, must disable it because the parts outside of the camera view are still visible for them.
+*/
+void RenderQueue::setChunkCulling(bool enable) {
+    m_chunkCulling = enable;
+}
+/*!
+    Adds draw items of all renderables from the \a list which have materials in the \a layer.
+    Depth of items is measured along the view \a direction from the \a origin; zero direction disables depth sorting.
+*/
+void RenderQueue::add(const Renderable::RenderList &list, int layer, const Vector3 &origin, const Vector3 &direction) {
+    PROFILE_FUNCTION();
+
+    bool depth = direction.sqrLength() > 0.0f;
+
+    for(auto it : list) {
+        int chunks = it->chunkCount();
+        if(chunks == 0) {
+            continue;
+        }
+
+        float distance = 0.0f;
+        if(depth) {
+            AABBox bb(it->bound());
+            if(bb.extent.x >= 0.0f) {
+                distance = direction.dot(bb.center - origin);
+            }
+        }
+
+        bool batchable = m_batching && it->isBatchable();
+
+        for(int c = 0; c < chunks; c++) {
+            if(m_chunkCulling && !it->isChunkVisible(c)) {
+                continue;
+            }
+
+            Mesh *mesh = it->chunkToDraw(c);
+            if(mesh == nullptr) {
+                continue;
+            }
+
+            // Skinned meshes and blend shapes are deformed on the GPU and can't be merged
+            bool merge = batchable && mesh->vertices().size() <= gMaxItemVertices && mesh->bones().empty() && mesh->blendShapes().empty();
+
+            for(int i = 0; i < mesh->subMeshCount(); i++) {
+                MaterialInstance *instance = it->materialInstance(i);
+                if(instance && instance->material()->layers() & layer) {
+                    uint32_t sub = mesh->lodSubMesh(i, it->m_meshLod);
+
+                    // Mergeable items are grouped by material and textures only
+                    uint32_t hash = instance->hash();
+                    if(!merge) {
+                        Mathf::hashCombine(hash, mesh->uuid());
+                        Mathf::hashCombine(hash, sub);
+                    }
+
+                    Item item;
+                    item.key = sortKey(layer, instance->finalPriority(), hash, distance);
+                    item.instance = instance;
+                    item.mesh = mesh;
+                    item.subMesh = sub;
+                    item.hash = hash;
+                    item.renderable = it;
+                    item.batchable = merge;
+
+                    m_items.push_back(item);
+                }
+            }
+        }
+    }
+}
+/*!
+    Sorts the draw items and merges them into instancing batches.
+*/
+void RenderQueue::build() {
+    PROFILE_FUNCTION();
+
+    sort();
+
+    m_batches.clear();
+    m_usedBuffers = 0;
+    m_usedMeshes = 0;
+
+    // Items with the same hash and material are adjacent after sorting
+    uint32_t count = m_items.size();
+    uint32_t begin = 0;
+    while(begin < count) {
+        const Item &first = m_items[begin];
+
+        uint32_t end = begin + 1;
+        bool sameMesh = true;
+        while(end < count && m_items[end].hash == first.hash && m_items[end].instance->material() == first.instance->material()) {
+            sameMesh &= (m_items[end].mesh == first.mesh && m_items[end].subMesh == first.subMesh);
+            ++end;
+        }
+
+        if(first.batchable && !sameMesh) {
+            mergeItems(begin, end);
+        } else {
+            Batch batch;
+            batch.instance = first.instance;
+            batch.mesh = first.mesh;
+            batch.subMesh = first.subMesh;
+            batch.count = end - begin;
+
+            if(batch.count > 1) {
+                ByteArray &data = nextBuffer();
+                for(uint32_t i = begin; i < end; i++) {
+                    MaterialInstance *instance = m_items[i].instance;
+
+                    const ByteArray &uniforms = instance->rawUniformBuffer();
+                    data.insert(data.end(), uniforms.begin(), uniforms.begin() + instance->instanceSize());
+                }
+                batch.buffer = &data;
+            }
+
+            m_batches.push_back(batch);
+        }
+
+        begin = end;
+    }
+
+    PROFILER_STAT(SPRITE_BATCHES, m_usedMeshes);
+}
+/*!
+    Copies geometry of the batchable items in range [\a begin, \a end) into shared dynamic meshes.
+    The run is split when instance parameters of items differ or the mesh vertex limit is reached.
+*/
+void RenderQueue::mergeItems(uint32_t begin, uint32_t end) {
+    const size_t matrixSize = sizeof(Matrix4);
+
+    uint32_t first = begin;
+    while(first < end) {
+        MaterialInstance *instance = m_items[first].instance;
+        const ByteArray &uniforms = instance->rawUniformBuffer();
+        uint32_t size = instance->instanceSize();
+
+        // Items drawn with a single call must share all parameters except the world transform
+        uint32_t last = first;
+        uint32_t vertices = 0;
+        while(last < end) {
+            const Item &item = m_items[last];
+            const ByteArray &other = item.instance->rawUniformBuffer();
+
+            if(last > first) {
+                if(item.instance->instanceSize() != size ||
+                   memcmp(uniforms.data() + matrixSize, other.data() + matrixSize, size - matrixSize) != 0 ||
+                   vertices + item.mesh->vertices().size() > gMaxBatchVertices) {
+                    break;
+                }
+            }
+            vertices += item.mesh->vertices().size();
+            ++last;
+        }
+
+        if(last - first == 1) {
+            Batch batch;
+            batch.instance = instance;
+            batch.mesh = m_items[first].mesh;
+            batch.subMesh = m_items[first].subMesh;
+            batch.count = 1;
+
+            m_batches.push_back(batch);
+
+            first = last;
+            continue;
+        }
+
+        if(m_usedMeshes >= m_meshes.size()) {
+            Mesh *mesh = Engine::objectCreate<Mesh>();
+            mesh->makeDynamic();
+            m_meshes.push_back(mesh);
+        }
+        Mesh *mesh = m_meshes[m_usedMeshes];
+        ++m_usedMeshes;
+
+        mesh->clear();
+
+        Vector3Vector &positions = mesh->vertices();
+        Vector2Vector &uv0 = mesh->uv0();
+        Vector4Vector &colors = mesh->colors();
+        IndexVector &indices = mesh->indices();
+
+        for(uint32_t i = first; i < last; i++) {
+            const Item &item = m_items[i];
+            Mesh *source = item.mesh;
+
+            const Matrix4 &transform = item.renderable->transform()->worldTransform();
+
+            uint32_t base = positions.size();
+            for(auto &it : source->vertices()) {
+                positions.push_back(transform * it);
+            }
+
+            if(source->uv0().size() == source->vertices().size()) {
+                uv0.insert(uv0.end(), source->uv0().begin(), source->uv0().end());
+            } else {
+                uv0.resize(positions.size(), Vector2(0.0f));
+            }
+
+            if(source->colors().size() == source->vertices().size()) {
+                colors.insert(colors.end(), source->colors().begin(), source->colors().end());
+            } else {
+                colors.resize(positions.size(), Vector4(1.0f));
+            }
+
+            uint32_t start = source->indexStart(item.subMesh);
+            uint32_t count = source->indexCount(item.subMesh);
+            for(uint32_t index = start; index < start + count; index++) {
+                indices.push_back(base + source->indices()[index]);
+            }
+        }
+
+        mesh->recalcBounds();
+
+        // Geometry is already in world space, the object id is taken from the first item
+        ByteArray &data = nextBuffer();
+        data.assign(uniforms.begin(), uniforms.begin() + size);
+
+        Matrix4 identity;
+        for(int i = 0; i < 15; i++) {
+            if(i % 4 != 3) {
+                memcpy(data.data() + i * sizeof(float), &identity.mat[i], sizeof(float));
+            }
+        }
+
+        Batch batch;
+        batch.instance = instance;
+        batch.mesh = mesh;
+        batch.buffer = &data;
+        batch.subMesh = 0;
+        batch.count = 1;
+
+        m_batches.push_back(batch);
+
+        PROFILER_STAT(BATCHED_SPRITES, last - first);
+
+        first = last;
+    }
+}
+/*!
+    Returns an empty buffer for instance data, buffers are reused across frames.
+*/
+ByteArray &RenderQueue::nextBuffer() {
+    if(m_usedBuffers >= m_buffers.size()) {
+        m_buffers.emplace_back();
+    }
+    ByteArray &data = m_buffers[m_usedBuffers];
+    data.clear();
+    ++m_usedBuffers;
+
+    return data;
+}
+/*!
+    Records draw commands of all batches for the rendering \a layer to the command \a list.
+*/
+void RenderQueue::record(CommandList &list, uint32_t layer) const {
+    for(auto &it : m_batches) {
+        list.bindMaterial(it.instance, it.buffer);
+        list.drawInstanced(it.mesh, it.subMesh, layer);
+    }
+}
+/*!
+    Returns true if the queue has no draw items.
+*/
+bool RenderQueue::isEmpty() const {
+    return m_items.empty();
+}
+/*!
+    Returns a list of draw items; the items are sorted after build() call.
+*/
+const RenderQueue::Items &RenderQueue::items() const {
+    return m_items;
+}
+/*!
+    Returns a list of instancing batches produced by build().
+    Batch buffer contains instance data of all merged items and must be set with MaterialInstance::setInstanceBuffer() before drawing; it's nullptr for single items.
+*/
+const RenderQueue::Batches &RenderQueue::batches() const {
+    return m_batches;
+}
+/*!
+    Returns a sort key for the material \a layer, final material \a priority, material instance and mesh \a hash and \a depth along the view direction.
+    From the most significant bits: 4 bits of the layer index, 12 bits of the priority, then 32 bits of the hash and 16 bits of the depth.
+    For the Material::Translucent layer inverted depth goes before the hash to draw items from back to front.
+*/
+uint64_t RenderQueue::sortKey(int layer, int32_t priority, uint32_t hash, float depth) {
+    uint64_t index = 0;
+    while(index < 15 && (layer & (1 << index)) == 0) {
+        ++index;
+    }
+
+    uint64_t key = index << 60;
+    key |= static_cast<uint64_t>(CLAMP(priority + gPriorityBias, 0, gPriorityMax)) << 48;
+
+    // Upper bits of the positive float are monotonic with its value
+    uint32_t bits = 0;
+    float value = std::max(depth, 0.0f);
+    memcpy(&bits, &value, sizeof(bits));
+    uint64_t distance = bits >> 16;
+
+    if(layer & Material::Translucent) {
+        key |= (0xffff - distance) << 32;
+        key |= hash;
+    } else {
+        key |= static_cast<uint64_t>(hash) << 16;
+        key |= distance;
+    }
+
+    return key;
+}
+
+void RenderQueue::sort() {
+    uint32_t count = m_items.size();
+    if(count < 2) {
+        return;
+    }
+
+    m_keys.resize(count);
+    m_keysSwap.resize(count);
+    m_indices.resize(count);
+    m_indicesSwap.resize(count);
+
+    for(uint32_t i = 0; i < count; i++) {
+        m_keys[i] = m_items[i].key;
+        m_indices[i] = i;
+    }
+
+    // Least significant digit first radix sort, stable for equal keys
+    uint32_t histogram[gRadixSize];
+    for(uint32_t shift = 0; shift < 64; shift += gRadixBits) {
+        memset(histogram, 0, sizeof(histogram));
+        for(uint32_t i = 0; i < count; i++) {
+            histogram[(m_keys[i] >> shift) & (gRadixSize - 1)]++;
+        }
+
+        // All keys have the same digit
+        if(histogram[(m_keys[0] >> shift) & (gRadixSize - 1)] == count) {
+            continue;
+        }
+
+        uint32_t offset = 0;
+        for(uint32_t i = 0; i < gRadixSize; i++) {
+            uint32_t size = histogram[i];
+            histogram[i] = offset;
+            offset += size;
+        }
+
+        for(uint32_t i = 0; i < count; i++) {
+            uint32_t position = histogram[(m_keys[i] >> shift) & (gRadixSize - 1)]++;
+            m_keysSwap[position] = m_keys[i];
+            m_indicesSwap[position] = m_indices[i];
+        }
+
+        m_keys.swap(m_keysSwap);
+        m_indices.swap(m_indicesSwap);
+    }
+
+    m_itemsSwap.resize(count);
+    for(uint32_t i = 0; i < count; i++) {
+        m_itemsSwap[i] = m_items[m_indices[i]];
+    }
+    m_items.swap(m_itemsSwap);
+}
@@ -84,6 +84,7 @@ void AnimationTrack::setDuration(int duration) {
 }
 /*!
     Tries to fix animation curves in the animation track. Renormalizes existant keyframes and checks the duration.
+    Also compiles the curve for fast sampling.
 */
 void AnimationTrack::fixCurves() {
     PROFILE_FUNCTION();
@@ -113,6 +114,8 @@ void AnimationTrack::fixCurves() {
             it.m_position /= scale;
         }
     }
+
+    m_curve.compile();
 }
 /*!
     Returns current value for the animation curve.
@@ -155,8 +158,10 @@ TString AnimationTrack::valueString(float time) const {
 }
 /*!
     Returns curve used for interpolation based animation.
+    The curve may be modified through the returned reference, so its compiled data is dropped; call fixCurves() after modifications to compile it again.
 */
 AnimationCurve &AnimationTrack::curve() {
+    m_curve.invalidate();
     return m_curve;
 }
 /*!
@@ -252,6 +257,7 @@ void AnimationTrack::fromVariant(const Variant &variant) {
 
         m_curve.m_keys.push_back(key);
     }
+    m_curve.compile();
     i++;
 
     m_frames.clear();
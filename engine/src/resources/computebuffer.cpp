@@ -50,4 +50,18 @@ ByteArray ComputeBuffer::data() const {
 void ComputeBuffer::setData(const ByteArray &data) {
     m_buffer = data;
     m_bufferDirty = true;
+
+    switchState(ToBeUpdated);
+}
+/*!
+    \internal
+*/
+void ComputeBuffer::switchState(State state) {
+    setState(state);
+}
+/*!
+    \internal
+*/
+bool ComputeBuffer::isUnloadable() {
+    return true;
 }
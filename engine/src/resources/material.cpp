@@ -1,5 +1,6 @@
 #include "resources/material.h"
 #include "resources/texture.h"
+#include "resources/computebuffer.h"
 
 #include "commandbuffer.h"
 
@@ -25,6 +26,8 @@ namespace {
 MaterialInstance::MaterialInstance(Material *material) :
         m_material(material),
         m_batchBuffer(nullptr),
+        m_indirectInstances(nullptr),
+        m_indirectArguments(nullptr),
         m_instanceCount(1),
         m_batchesCount(0),
         m_hash(material->uuid()),
@@ -229,12 +232,7 @@ void MaterialInstance::setTexture(const TString &name, Texture *texture) {
     }
 
     if(changed) {
-        m_hash = m_material->uuid();
-        for(auto &it : m_textureOverride) {
-            if(it.second) {
-                Mathf::hashCombine(m_hash, it.second->uuid());
-            }
-        }
+        updateHash();
     }
 }
 /*!
@@ -270,6 +268,47 @@ void MaterialInstance::setInstanceBuffer(const ByteArray *buffer) {
         m_localDirty = true;
     }
 }
+/*!
+    Returns the buffer with instance data generated on the GPU, or nullptr for regular instancing.
+*/
+ComputeBuffer *MaterialInstance::indirectInstances() const {
+    return m_indirectInstances;
+}
+/*!
+    Returns the buffer with indirect draw arguments, or nullptr for regular instancing.
+*/
+ComputeBuffer *MaterialInstance::indirectArguments() const {
+    return m_indirectArguments;
+}
+/*!
+    Makes the instance be drawn with the number of instances and index range stored in the \a arguments buffer.
+    Instance data is taken from the \a instances buffer instead of the CPU uniform buffer, so both buffers can be filled by a compute shader.
+    The \a arguments buffer contains the indexCount, instanceCount, firstIndex, baseVertex and baseInstance values.
+    Pass nullptr to go back to regular instancing.
+
+    \note Indirect instances are never merged with other instances into batches.
+*/
+void MaterialInstance::setIndirect(ComputeBuffer *instances, ComputeBuffer *arguments) {
+    m_indirectInstances = instances;
+    m_indirectArguments = arguments;
+
+    updateHash();
+}
+/*!
+    \internal
+    Recalculates the hash used to group instances which can be drawn together.
+*/
+void MaterialInstance::updateHash() {
+    m_hash = m_material->uuid();
+    for(auto &it : m_textureOverride) {
+        if(it.second) {
+            Mathf::hashCombine(m_hash, it.second->uuid());
+        }
+    }
+    if(m_indirectArguments) {
+        Mathf::hashCombine(m_hash, m_indirectArguments->uuid());
+    }
+}
 /*!
     \internal
 */
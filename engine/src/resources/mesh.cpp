@@ -4,11 +4,51 @@
 
 #include "systems/resourcesystem.h"
 
+#include "utils/assetcontainer.h"
+
 #include <cstring>
 #include <cfloat>
 
 namespace  {
     const char *gData("Data");
+    const char *gClusters("Clusters");
+    const char *gLods("Lods");
+
+    template<typename T>
+    void loadArray(const Variant &value, std::vector<T> &array, size_t count) {
+        ByteArray buffer;
+
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        if(!AssetContainer::blob(value, data, size)) {
+            buffer = value.toByteArray();
+            data = buffer.data();
+            size = buffer.size();
+        }
+
+        array.resize(count);
+        if(count > 0 && data) {
+            memcpy(reinterpret_cast<void *>(array.data()), data, std::min(size, sizeof(T) * count));
+        }
+    }
+
+    template<typename T>
+    void loadArray(const Variant &value, std::vector<T> &array) {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        if(AssetContainer::blob(value, data, size)) {
+            array.resize(size / sizeof(T));
+            if(!array.empty()) {
+                memcpy(reinterpret_cast<void *>(array.data()), data, sizeof(T) * array.size());
+            }
+        } else {
+            ByteArray buffer(value.toByteArray());
+            array.resize(buffer.size() / sizeof(T));
+            if(!array.empty()) {
+                memcpy(reinterpret_cast<void *>(array.data()), buffer.data(), sizeof(T) * array.size());
+            }
+        }
+    }
 }
 
 enum MeshAttributes {
@@ -18,8 +58,102 @@ enum MeshAttributes {
     Normals  = (1<<3),
     Tangents = (1<<4),
     Skinned  = (1<<5),
+    Packed   = (1<<6),
 };
 
+namespace {
+    uint16_t toHalf(float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(float));
+
+        uint16_t sign = (bits >> 16) & 0x8000;
+        int32_t exponent = static_cast<int32_t>((bits >> 23) & 0xff) - 127 + 15;
+        uint32_t mantissa = bits & 0x7fffff;
+
+        if(exponent <= 0) {
+            // Denormalized or too small
+            if(exponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000;
+            uint32_t shift = 14 - exponent;
+            uint32_t half = mantissa >> shift;
+            if((mantissa >> (shift - 1)) & 1) {
+                half++;
+            }
+            return sign | half;
+        }
+        if(exponent >= 31) {
+            // Overflow, infinity or NaN
+            return sign | 0x7c00 | (((bits & 0x7fffffff) > 0x7f800000) ? 0x200 : 0);
+        }
+
+        uint32_t half = (exponent << 10) | (mantissa >> 13);
+        if(mantissa & 0x1000) {
+            half++; // Carry to exponent is correct rounding
+        }
+        return sign | half;
+    }
+
+    uint32_t toSnorm10x3(const Vector3 &value) {
+        uint32_t result = 0;
+        for(int i = 0; i < 3; i++) {
+            float v = CLAMP(value[i], -1.0f, 1.0f) * 511.0f;
+            int32_t component = static_cast<int32_t>(v + ((v < 0.0f) ? -0.5f : 0.5f));
+            result |= (static_cast<uint32_t>(component) & 0x3ff) << (i * 10);
+        }
+        return result;
+    }
+
+    uint32_t toUnorm8x4(const Vector4 &value) {
+        uint32_t result = 0;
+        for(int i = 0; i < 4; i++) {
+            uint32_t component = static_cast<uint32_t>(CLAMP(value[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+            result |= component << (i * 8);
+        }
+        return result;
+    }
+
+    uint32_t toWeights(const Vector4 &value) {
+        float sum = value.x + value.y + value.z + value.w;
+        float scale = (sum > 0.0f) ? 255.0f / sum : 0.0f;
+
+        uint8_t weights[4];
+        int32_t total = 0;
+        int32_t biggest = 0;
+        for(int i = 0; i < 4; i++) {
+            weights[i] = static_cast<uint8_t>(CLAMP(value[i] * scale + 0.5f, 0.0f, 255.0f));
+            total += weights[i];
+            if(weights[i] > weights[biggest]) {
+                biggest = i;
+            }
+        }
+        // Keep the sum of weights equal to one after quantization
+        if(total > 0) {
+            weights[biggest] = static_cast<uint8_t>(weights[biggest] + 255 - total);
+        }
+
+        uint32_t result;
+        memcpy(&result, weights, sizeof(uint32_t));
+        return result;
+    }
+
+    // Attributes which have more elements than vertices are clamped to the vertex count
+    template<typename T>
+    void fillAttribute(uint8_t *data, const Mesh::VertexAttribute &attribute, const std::vector<T> &array, size_t vertices) {
+        uint8_t *dst = data + attribute.offset;
+        size_t count = MIN(array.size(), vertices);
+        if(attribute.stride == sizeof(T)) {
+            memcpy(dst, array.data(), sizeof(T) * count);
+            return;
+        }
+        for(size_t i = 0; i < count; i++) {
+            memcpy(dst, &array[i], sizeof(T));
+            dst += attribute.stride;
+        }
+    }
+}
+
 /*!
     \class Mesh
     \brief This class contains all necessary data for the Mesh.
@@ -27,7 +161,8 @@ enum MeshAttributes {
 */
 
 Mesh::Mesh() :
-        m_dynamic(false)  {
+        m_dynamic(false),
+        m_packed(false) {
 
 }
 
@@ -55,6 +190,27 @@ bool Mesh::isDynamic() const {
 void Mesh::makeDynamic() {
     m_dynamic = true;
 }
+/*!
+    Returns true if vertex attributes are uploaded to the GPU in the packed format; otherwise returns false.
+    Dynamic meshes are never packed.
+    \sa vertexLayout()
+*/
+bool Mesh::isPacked() const {
+    return m_packed && !m_dynamic;
+}
+/*!
+    Enables or disables the \a packed vertex format.
+    Packed meshes store all attributes in one interleaved stream: positions as floats, texture coordinates and bone indices as half floats, normals and tangents as 10-10-10-2 signed normalized values, colors and bone weights as 8-bit unsigned normalized values.
+    Indices of packed meshes with less than 65536 vertices are stored as 16-bit values.
+    Data is converted by the GPU on fetch, so shaders don't need changes.
+    \note The CPU side arrays are kept in full precision.
+*/
+void Mesh::setPacked(bool packed) {
+    if(m_packed != packed) {
+        m_packed = packed;
+        switchState(ToBeUpdated);
+    }
+}
 /*!
     Returns false if mesh structure is empty; otherwise returns true.
 */
@@ -67,6 +223,7 @@ bool Mesh::isEmpty() const {
 void Mesh::clear() {
     m_indices.clear();
     m_offsets.clear();
+    m_lodSizes.clear();
     m_vertices.clear();
     m_uv0.clear();
     m_uv1.clear();
@@ -76,12 +233,13 @@ void Mesh::clear() {
     m_bones.clear();
     m_weights.clear();
     m_blendShapes.clear();
+    m_clusters.clear();
 }
 /*!
     Returns a default material for the \a sub mesh.
 */
 Material *Mesh::defaultMaterial(int sub) const {
-    if(sub < m_defaultMaterials.size()) {
+    if(sub >= 0 && sub < static_cast<int32_t>(m_defaultMaterials.size())) {
         return m_defaultMaterials[sub];
     }
     return nullptr;
@@ -90,7 +248,7 @@ Material *Mesh::defaultMaterial(int sub) const {
     Sets a default \a material for the \a sub mesh.
 */
 void Mesh::setDefaultMaterial(Material *material, int sub) {
-    if(sub < m_defaultMaterials.size()) {
+    if(sub >= 0 && sub < static_cast<int32_t>(m_defaultMaterials.size())) {
         if(m_defaultMaterials[sub]) {
             m_defaultMaterials[sub]->decRef();
         }
@@ -287,6 +445,21 @@ void Mesh::addBlendShapeFrame(const TString &name, float weight,
     shape.frames.push_back(frame);
     m_blendShapes.push_back(shape);
 }
+/*!
+    Returns an array of triangle clusters of the Mesh.
+    Each cluster references a range of the index buffer and contains a bounding sphere and a normal cone, so the whole cluster can be culled at once.
+    The cluster is back facing for the camera at the point \c eye if dot(normalize(center - eye), coneAxis) >= coneCutoff + radius / length(center - eye).
+    The array is empty unless clusters were built on import.
+*/
+Mesh::ClusterVector &Mesh::clusters() {
+    return m_clusters;
+}
+/*!
+    Replaces the \a clusters of the Mesh.
+*/
+void Mesh::setClusters(const ClusterVector &clusters) {
+    m_clusters = clusters;
+}
 /*! 
     Returns bounding box for the Mesh.
 */
@@ -302,15 +475,16 @@ void Mesh::setBound(const AABBox &box) {
 }
 /*!
     Returns the number of sub-meshes inside the Mesh.
+    Each level of detail contains the same number of sub-meshes.
 */
 int Mesh::subMeshCount() const {
-    return m_offsets.size();
+    return m_offsets.size() / lodCount();
 }
 /*!
     Sets a base vertex \a offset for the \a sub mesh.
 */
 void Mesh::setSubMesh(int offset, int sub) {
-    if(sub < m_offsets.size()) {
+    if(sub >= 0 && sub < static_cast<int32_t>(m_offsets.size())) {
         m_offsets[sub] = offset;
         return;
     }
@@ -320,7 +494,7 @@ void Mesh::setSubMesh(int offset, int sub) {
     Returns starting point index for the \a sub mesh.
 */
 int Mesh::indexStart(int sub) const {
-    if(sub < m_offsets.size()) {
+    if(sub >= 0 && sub < static_cast<int32_t>(m_offsets.size())) {
         return m_offsets[sub];
     }
     return 0;
@@ -333,9 +507,89 @@ int Mesh::indexCount(int sub) const {
         return m_offsets[sub+1] - m_offsets[sub];
     }
 
-    size_t offsetId = CLAMP(sub, 0, m_offsets.size() - 1);
+    size_t offsetId = CLAMP(sub, 0, static_cast<int32_t>(m_offsets.size()) - 1);
     return m_indices.size() - (m_offsets.empty() ? 0 : m_offsets[offsetId]);
 }
+/*!
+    Returns the number of levels of detail inside the Mesh including the original geometry.
+    \sa addLod()
+*/
+int Mesh::lodCount() const {
+    return m_lodSizes.size() + 1;
+}
+/*!
+    Returns the projected screen size of the Mesh bounding sphere below which the \a lod level can be used.
+    The original geometry (lod 0) is used at any size.
+*/
+float Mesh::lodScreenSize(int lod) const {
+    if(lod > 0 && lod <= static_cast<int32_t>(m_lodSizes.size())) {
+        return m_lodSizes[lod - 1];
+    }
+    return FLT_MAX;
+}
+/*!
+    Adds a new level of detail to the Mesh.
+    The \a indices reference existing vertices of the Mesh, \a offsets contain the starting points of each sub-mesh within \a indices.
+    Indices of the level are appended to the index buffer, so all levels share the same vertex and index buffers.
+    The level will be used when the projected size of the Mesh is below \a screenSize; levels must be added from the most detailed to the coarsest.
+    \sa lodSubMesh()
+*/
+void Mesh::addLod(const IndexVector &indices, const IndexVector &offsets, float screenSize) {
+    if(m_offsets.empty()) {
+        m_offsets.push_back(0);
+    }
+
+    int count = subMeshCount();
+    uint32_t start = m_indices.size();
+    for(int sub = 0; sub < count; sub++) {
+        m_offsets.push_back(start + (sub < static_cast<int32_t>(offsets.size()) ? offsets[sub] : indices.size()));
+    }
+    m_indices.insert(m_indices.end(), indices.begin(), indices.end());
+
+    m_lodSizes.push_back(screenSize);
+
+    switchState(ToBeUpdated);
+}
+/*!
+    Removes all levels of detail except the original geometry.
+*/
+void Mesh::clearLods() {
+    if(m_lodSizes.empty()) {
+        return;
+    }
+
+    int count = subMeshCount();
+    if(count < static_cast<int32_t>(m_offsets.size())) {
+        m_indices.resize(m_offsets[count]);
+        m_offsets.resize(count);
+    }
+    m_lodSizes.clear();
+
+    switchState(ToBeUpdated);
+}
+/*!
+    Returns the index of the range to pass to indexStart() and indexCount() for the \a sub mesh at the \a lod level.
+    The \a lod is clamped to the available levels.
+*/
+int Mesh::lodSubMesh(int sub, int lod) const {
+    return CLAMP(lod, 0, lodCount() - 1) * subMeshCount() + sub;
+}
+/*!
+    Returns the level of detail for the projected \a screenSize of the Mesh bounding sphere.
+    The \a current level is changed only when the size leaves the threshold band widened by the relative \a hysteresis; this prevents popping when the size oscillates around a threshold.
+*/
+int Mesh::selectLod(float screenSize, int current, float hysteresis) const {
+    int lod = CLAMP(current, 0, lodCount() - 1);
+
+    while(lod < static_cast<int32_t>(m_lodSizes.size()) && screenSize < m_lodSizes[lod] * (1.0f - hysteresis)) {
+        lod++;
+    }
+    while(lod > 0 && screenSize > m_lodSizes[lod - 1] * (1.0f + hysteresis)) {
+        lod--;
+    }
+
+    return lod;
+}
 /*!
     Recalculates normals of the Mesh from the triangles and vertices.
 */
@@ -450,6 +704,8 @@ void Mesh::recalcBounds() {
     In the case of the \a transform, the matrix is not nullptr it will be applied to \a mesh before merging.
 */
 void Mesh::batchMesh(Mesh &mesh, const Matrix4 *transform) {
+    clearLods();
+
     auto vertexVector = mesh.vertices();
     auto normalVector = mesh.normals();
     auto tangentVector = mesh.tangents();
@@ -470,6 +726,9 @@ void Mesh::batchMesh(Mesh &mesh, const Matrix4 *transform) {
     // Indices
     size_t size = vertices().size();
     auto indexVector = mesh.indices();
+    if(mesh.lodCount() > 1) {
+        indexVector.resize(mesh.indexStart(mesh.subMeshCount()));
+    }
     for(auto &it : indexVector) {
         it += size;
     }
@@ -484,6 +743,221 @@ void Mesh::batchMesh(Mesh &mesh, const Matrix4 *transform) {
 
     recalcBounds();
 }
+/*!
+    Returns the description of the vertex buffer produced by fillVertexBuffer().
+    Each attribute has the shader location (one of Mesh::Attribute), the format (one of Mesh::VertexFormat), the offset of the first element and the distance between elements in bytes.
+    Unpacked meshes store attributes in consecutive blocks of full precision values, packed meshes interleave all attributes in one stream.
+*/
+Mesh::VertexLayout Mesh::vertexLayout() const {
+    VertexLayout result;
+    if(m_vertices.empty()) {
+        return result;
+    }
+
+    bool packed = isPacked();
+    bool skinned = !m_bones.empty() && !m_weights.empty();
+
+    result.push_back({Position, Float3, 0, 0});
+    if(!m_uv0.empty()) {
+        result.push_back({TexCoord0, packed ? Half2 : Float2, 0, 0});
+    }
+    if(!m_colors.empty()) {
+        result.push_back({VertexColor, packed ? Unorm8x4 : Float4, 0, 0});
+    }
+    if(!m_normals.empty()) {
+        result.push_back({Normal, packed ? Snorm10x3 : Float3, 0, 0});
+    }
+    if(!m_tangents.empty()) {
+        result.push_back({Tangent, packed ? Snorm10x3 : Float3, 0, 0});
+    }
+    if(skinned) {
+        // Half floats keep bone indices exact up to 2048
+        result.push_back({BoneIndices, packed ? Half4 : Float4, 0, 0});
+        result.push_back({BoneWeights, packed ? Unorm8x4 : Float4, 0, 0});
+    }
+
+    uint32_t offset = 0;
+    if(packed) {
+        for(auto &it : result) {
+            it.offset = offset;
+            offset += formatSize(it.format);
+        }
+        for(auto &it : result) {
+            it.stride = offset;
+        }
+    } else {
+        uint32_t count = m_vertices.size();
+        for(auto &it : result) {
+            it.offset = offset;
+            it.stride = formatSize(it.format);
+            offset += it.stride * count;
+        }
+    }
+
+    return result;
+}
+/*!
+    Returns the size in bytes of the vertex buffer described by vertexLayout().
+*/
+size_t Mesh::vertexBufferSize() const {
+    size_t result = 0;
+    for(auto &it : vertexLayout()) {
+        result += formatSize(it.format);
+    }
+    return result * m_vertices.size();
+}
+/*!
+    Writes vertex attributes to the \a data in the format described by vertexLayout().
+    The \a data must be at least vertexBufferSize() bytes long.
+    Attributes with more elements than vertices are truncated, missing elements are left untouched.
+*/
+void Mesh::fillVertexBuffer(uint8_t *data) const {
+    PROFILE_FUNCTION();
+
+    size_t vertices = m_vertices.size();
+
+    for(auto &it : vertexLayout()) {
+        switch(it.location) {
+            case Position: fillAttribute(data, it, m_vertices, vertices); break;
+            case TexCoord0: {
+                if(it.format == Half2) {
+                    uint8_t *dst = data + it.offset;
+                    size_t count = MIN(m_uv0.size(), vertices);
+                    for(size_t i = 0; i < count; i++) {
+                        const Vector2 &uv = m_uv0[i];
+                        uint16_t half[2] = { toHalf(uv.x), toHalf(uv.y) };
+                        memcpy(dst, half, sizeof(half));
+                        dst += it.stride;
+                    }
+                } else {
+                    fillAttribute(data, it, m_uv0, vertices);
+                }
+            } break;
+            case VertexColor: {
+                if(it.format == Unorm8x4) {
+                    uint8_t *dst = data + it.offset;
+                    size_t count = MIN(m_colors.size(), vertices);
+                    for(size_t i = 0; i < count; i++) {
+                        uint32_t value = toUnorm8x4(m_colors[i]);
+                        memcpy(dst, &value, sizeof(uint32_t));
+                        dst += it.stride;
+                    }
+                } else {
+                    fillAttribute(data, it, m_colors, vertices);
+                }
+            } break;
+            case Normal:
+            case Tangent: {
+                const Vector3Vector &array = (it.location == Normal) ? m_normals : m_tangents;
+                if(it.format == Snorm10x3) {
+                    uint8_t *dst = data + it.offset;
+                    size_t count = MIN(array.size(), vertices);
+                    for(size_t i = 0; i < count; i++) {
+                        uint32_t value = toSnorm10x3(array[i]);
+                        memcpy(dst, &value, sizeof(uint32_t));
+                        dst += it.stride;
+                    }
+                } else {
+                    fillAttribute(data, it, array, vertices);
+                }
+            } break;
+            case BoneIndices: {
+                if(it.format == Half4) {
+                    uint8_t *dst = data + it.offset;
+                    size_t count = MIN(m_bones.size(), vertices);
+                    for(size_t i = 0; i < count; i++) {
+                        const Vector4 &bones = m_bones[i];
+                        uint16_t half[4] = { toHalf(bones.x), toHalf(bones.y), toHalf(bones.z), toHalf(bones.w) };
+                        memcpy(dst, half, sizeof(half));
+                        dst += it.stride;
+                    }
+                } else {
+                    fillAttribute(data, it, m_bones, vertices);
+                }
+            } break;
+            case BoneWeights: {
+                if(it.format == Unorm8x4) {
+                    uint8_t *dst = data + it.offset;
+                    size_t count = MIN(m_weights.size(), vertices);
+                    for(size_t i = 0; i < count; i++) {
+                        uint32_t value = toWeights(m_weights[i]);
+                        memcpy(dst, &value, sizeof(uint32_t));
+                        dst += it.stride;
+                    }
+                } else {
+                    fillAttribute(data, it, m_weights, vertices);
+                }
+            } break;
+            default: break;
+        }
+    }
+}
+/*!
+    Returns the size of one index in bytes; 2 for packed meshes with less than 65536 vertices, otherwise 4.
+*/
+uint32_t Mesh::indexSize() const {
+    return (isPacked() && m_vertices.size() <= UINT16_MAX) ? sizeof(uint16_t) : sizeof(uint32_t);
+}
+/*!
+    Returns the size in bytes of the index buffer produced by fillIndexBuffer().
+*/
+size_t Mesh::indexBufferSize() const {
+    return m_indices.size() * indexSize();
+}
+/*!
+    Writes indices to the \a data using indexSize() bytes for each index.
+    The \a data must be at least indexBufferSize() bytes long.
+*/
+void Mesh::fillIndexBuffer(uint8_t *data) const {
+    if(indexSize() == sizeof(uint16_t)) {
+        uint16_t *dst = reinterpret_cast<uint16_t *>(data);
+        for(auto it : m_indices) {
+            *dst = static_cast<uint16_t>(it);
+            dst++;
+        }
+    } else if(!m_indices.empty()) {
+        memcpy(data, m_indices.data(), sizeof(uint32_t) * m_indices.size());
+    }
+}
+/*!
+    Returns the size in bytes of one element of the vertex \a format.
+*/
+uint32_t Mesh::formatSize(uint32_t format) {
+    switch(format) {
+        case Float2: return sizeof(Vector2);
+        case Float3: return sizeof(Vector3);
+        case Float4: return sizeof(Vector4);
+        case Half2: return sizeof(uint16_t) * 2;
+        case Half4: return sizeof(uint16_t) * 4;
+        case Unorm8x4:
+        case Snorm10x3: return sizeof(uint32_t);
+        default: break;
+    }
+    return 0;
+}
+/*!
+    \reimp
+*/
+uint64_t Mesh::cpuMemory() const {
+    uint64_t result = (m_vertices.size() + m_normals.size() + m_tangents.size()) * sizeof(Vector3) +
+            (m_uv0.size() + m_uv1.size()) * sizeof(Vector2) +
+            (m_colors.size() + m_weights.size() + m_bones.size()) * sizeof(Vector4) +
+            m_indices.size() * sizeof(uint32_t);
+    for(auto &shape : m_blendShapes) {
+        for(auto &frame : shape.frames) {
+            result += frame.indices.size() * sizeof(uint32_t) +
+                    (frame.vertices.size() + frame.normals.size() + frame.tangents.size()) * sizeof(Vector3);
+        }
+    }
+    return result;
+}
+/*!
+    \reimp
+    Returns the size of vertex and index buffers in the GPU format.
+*/
+uint64_t Mesh::gpuMemory() const {
+    return vertexBufferSize() + indexBufferSize();
+}
 /*!
     \internal
 */
@@ -501,11 +975,12 @@ bool Mesh::isUnloadable() {
 */
 void Mesh::loadUserData(const VariantMap &data) {
     auto meshData = data.find(gData);
-    if(meshData != data.end()) {
-        VariantList mesh = meshData->second.value<VariantList>();
+    if(meshData != data.end() && meshData->second.type() == MetaType::VARIANTLIST) {
+        const VariantList &mesh = *reinterpret_cast<const VariantList *>(meshData->second.data());
         auto i = mesh.begin();
 
         int flags = (*i).toInt();
+        m_packed = (flags & MeshAttributes::Packed);
 
         i++;
         int sub = 0;
@@ -523,12 +998,9 @@ void Mesh::loadUserData(const VariantMap &data) {
         Vector3 min( FLT_MAX);
         Vector3 max(-FLT_MAX);
 
-        ByteArray vertexData;
         // Positions (Required field)
         i++;
-        vertexData = (*i).toByteArray();
-        m_vertices.resize(vCount);
-        memcpy(reinterpret_cast<void*>(m_vertices.data()), &vertexData[0], sizeof(Vector3) * vCount);
+        loadArray(*i, m_vertices, vCount);
         for(uint32_t i = 0; i < vCount; i++) {
             min.x = MIN(min.x, m_vertices[i].x);
             min.y = MIN(min.y, m_vertices[i].y);
@@ -541,45 +1013,31 @@ void Mesh::loadUserData(const VariantMap &data) {
 
         // Indices (Required field)
         i++;
-        vertexData = (*i).toByteArray();
-        m_indices.resize(tCount * 3);
-        memcpy(m_indices.data(), vertexData.data(), sizeof(uint32_t) * tCount * 3);
+        loadArray(*i, m_indices, tCount * 3);
 
         // Load attributes
         if(flags & MeshAttributes::Color) { // Optional field
             i++;
-            vertexData = (*i).toByteArray();
-            m_colors.resize(vCount);
-            memcpy(reinterpret_cast<void*>(m_colors.data()), vertexData.data(), sizeof(Vector4) * vCount);
+            loadArray(*i, m_colors, vCount);
         }
         if(flags & MeshAttributes::Uv0) { // Optional field
             i++;
-            vertexData = (*i).toByteArray();
-            m_uv0.resize(vCount);
-            memcpy(reinterpret_cast<void*>(m_uv0.data()), vertexData.data(), sizeof(Vector2) * vCount);
+            loadArray(*i, m_uv0, vCount);
         }
         if(flags & MeshAttributes::Normals) { // Optional field
             i++;
-            vertexData = (*i).toByteArray();
-            m_normals.resize(vCount);
-            memcpy(reinterpret_cast<void*>(m_normals.data()), vertexData.data(), sizeof(Vector3) * vCount);
+            loadArray(*i, m_normals, vCount);
         }
         if(flags & MeshAttributes::Tangents) { // Optional field
             i++;
-            vertexData = (*i).toByteArray();
-            m_tangents.resize(vCount);
-            memcpy(reinterpret_cast<void*>(m_tangents.data()), vertexData.data(), sizeof(Vector3) * vCount);
+            loadArray(*i, m_tangents, vCount);
         }
         if(flags & MeshAttributes::Skinned) { // Optional field
             i++;
-            vertexData = (*i).toByteArray();
-            m_weights.resize(vCount);
-            memcpy(reinterpret_cast<void*>(m_weights.data()), vertexData.data(), sizeof(Vector4) * vCount);
+            loadArray(*i, m_weights, vCount);
 
             i++;
-            vertexData = (*i).toByteArray();
-            m_bones.resize(vCount);
-            memcpy(reinterpret_cast<void*>(m_bones.data()), vertexData.data(), sizeof(Vector4) * vCount);
+            loadArray(*i, m_bones, vCount);
         }
 
         i++;
@@ -617,22 +1075,13 @@ void Mesh::loadUserData(const VariantMap &data) {
                     auto f = frameData.begin();
                     shapeFrame.weight = f->toFloat();
                     f++;
-                    ByteArray shapeData;
-                    shapeData = f->toByteArray();
-                    shapeFrame.indices.resize(shapeData.size() / sizeof(uint32_t));
-                    memcpy(reinterpret_cast<void*>(shapeFrame.indices.data()), shapeData.data(), shapeData.size());
+                    loadArray(*f, shapeFrame.indices);
                     f++;
-                    shapeData = f->toByteArray();
-                    shapeFrame.vertices.resize(shapeData.size() / sizeof(Vector3));
-                    memcpy(reinterpret_cast<void*>(shapeFrame.vertices.data()), shapeData.data(), shapeData.size());
+                    loadArray(*f, shapeFrame.vertices);
                     f++;
-                    shapeData = f->toByteArray();
-                    shapeFrame.normals.resize(shapeData.size() / sizeof(Vector3));
-                    memcpy(reinterpret_cast<void*>(shapeFrame.normals.data()), shapeData.data(), shapeData.size());
+                    loadArray(*f, shapeFrame.normals);
                     f++;
-                    shapeData = f->toByteArray();
-                    shapeFrame.tangents.resize(shapeData.size() / sizeof(Vector3));
-                    memcpy(reinterpret_cast<void*>(shapeFrame.tangents.data()), shapeData.data(), shapeData.size());
+                    loadArray(*f, shapeFrame.tangents);
 
                     blendShape.frames.push_back(shapeFrame);
                 }
@@ -643,6 +1092,21 @@ void Mesh::loadUserData(const VariantMap &data) {
 
         m_box.setBox(min, max);
     }
+
+    m_lodSizes.clear();
+    auto lods = data.find(gLods);
+    if(lods != data.end()) {
+        for(auto &it : lods->second.toList()) {
+            m_lodSizes.push_back(it.toFloat());
+        }
+    }
+
+    m_clusters.clear();
+    auto clusters = data.find(gClusters);
+    if(clusters != data.end()) {
+        loadArray(clusters->second, m_clusters);
+    }
+
     switchState(ToBeUpdated);
 }
 /*!
@@ -661,6 +1125,8 @@ VariantMap Mesh::saveUserData() const {
 
     flags = m_weights.empty() ? flags : (flags | Skinned);
 
+    flags = m_packed ? (flags | Packed) : flags;
+
     mesh.push_back(flags);
 
     // Push materials
@@ -775,5 +1241,20 @@ VariantMap Mesh::saveUserData() const {
 
     result[gData] = mesh;
 
+    if(!m_lodSizes.empty()) {
+        VariantList lods;
+        for(auto it : m_lodSizes) {
+            lods.push_back(it);
+        }
+        result[gLods] = lods;
+    }
+
+    if(!m_clusters.empty()) {
+        ByteArray buffer;
+        buffer.resize(sizeof(Cluster) * m_clusters.size());
+        memcpy(buffer.data(), m_clusters.data(), buffer.size());
+        result[gClusters] = buffer;
+    }
+
     return result;
 }
@@ -94,6 +94,19 @@ void Resource::switchState(State state) {
         default: setState(state); break;
     }
 }
+/*!
+    Returns the amount of main memory in bytes occupied by the resource data.
+    The resource system uses this value to limit the size of the cache of suspended resources.
+*/
+uint64_t Resource::cpuMemory() const {
+    return 0;
+}
+/*!
+    Returns the estimated amount of video memory in bytes occupied by the resource.
+*/
+uint64_t Resource::gpuMemory() const {
+    return 0;
+}
 /*!
     Returns true in case of resource can be unloaded from GPU; otherwise returns false.
 */
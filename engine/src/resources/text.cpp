@@ -42,6 +42,12 @@ VariantMap Text::saveUserData() const {
 uint8_t *Text::data() {
     return reinterpret_cast<uint8_t *>(m_data.data());
 }
+/*!
+    \reimp
+*/
+uint64_t Text::cpuMemory() const {
+    return m_data.size();
+}
 /*!
     Returns size of the text resource.
 */
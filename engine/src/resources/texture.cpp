@@ -1,5 +1,10 @@
 #include "resources/texture.h"
 
+#include "systems/resourcesystem.h"
+
+#include "utils/assetcontainer.h"
+#include "utils/texturestreamer.h"
+
 #include <variant.h>
 
 #include <cstring>
@@ -10,6 +15,11 @@ namespace {
 
 uint32_t Texture::s_maxTextureSize = 1024;
 uint32_t Texture::s_maxCubemapSize = 512;
+#if defined(SHARED_DEFINE)
+uint32_t Texture::s_streamingSize = 0;
+#else
+uint32_t Texture::s_streamingSize = 128;
+#endif
 
 /*!
     \class Texture
@@ -17,6 +27,11 @@ uint32_t Texture::s_maxCubemapSize = 512;
     \inmodule Resources
 
     This class can be used to handle texture resource or create them at runtime.
+
+    Textures loaded from the asset container can be streamed.
+    Only the smallest mip levels which are not bigger than streamingSize() are loaded initially, higher levels are referenced by their location in the container file.
+    The TextureStreamer loads higher levels on demand and evicts them when they are no longer needed, residentMip() returns the highest mip level currently loaded.
+    Surfaces of the streamed texture contain only resident levels, so the first element of the surface corresponds to residentMip() level.
 */
 
 /*!
@@ -68,6 +83,7 @@ uint32_t Texture::s_maxCubemapSize = 512;
 */
 
 Texture::Texture() :
+        m_streamer(nullptr),
         m_format(Texture::R8),
         m_compress(Texture::Uncompressed),
         m_filtering(Texture::None),
@@ -76,6 +92,7 @@ Texture::Texture() :
         m_height(1),
         m_depth(1),
         m_mips(1),
+        m_residentMip(0),
         m_depthBits(0),
         m_flags(0) {
 
@@ -93,15 +110,60 @@ void Texture::loadUserData(const VariantMap &data) {
     auto it = data.find(gData);
     if(it != data.end()) {
         const VariantList &surfaces = (*it).second.value<VariantList>();
+
+        // Mip levels can be streamed only if they can be read from the container file later
+        const AssetContainer *container = AssetContainer::current();
+        int32_t first = 0;
+        if(s_streamingSize > 0 && container && !container->path().isEmpty() && !isRender() && !surfaces.empty()) {
+            int32_t levels = surfaces.front().value<VariantList>().size();
+            int32_t size = MAX(m_width, m_height);
+            while(first < levels - 1 && (size >> first) > int32_t(s_streamingSize)) {
+                first++;
+            }
+
+            for(auto &s : surfaces) {
+                for(auto &l : s.value<VariantList>()) {
+                    if(l.type() != MetaType::INTEGER) {
+                        first = 0;
+                    }
+                }
+            }
+        }
+
         for(auto &s : surfaces) {
             Surface surface;
 
+            int32_t level = 0;
             for(auto &l : s.value<VariantList>()) {
-                surface.push_back(l.toByteArray());
+                if(first > 0) {
+                    uint32_t index = l.toInt();
+                    m_mipSections.push_back({container->sectionOffset(index), container->sectionSize(index)});
+                }
+
+                if(level >= first) {
+                    const uint8_t *lod = nullptr;
+                    size_t size = 0;
+                    if(AssetContainer::blob(l, lod, size)) {
+                        surface.push_back(ByteArray(lod, lod + size));
+                    } else {
+                        surface.push_back(l.toByteArray());
+                    }
+                }
+                level++;
             }
-            m_mips = surface.size();
+            m_mips = level;
             addSurface(surface);
         }
+
+        if(first > 0) {
+            m_residentMip = first;
+            m_mipSource = container->path();
+
+            ResourceSystem *system = Engine::resourceSystem();
+            if(system) {
+                system->textureStreamer()->add(this);
+            }
+        }
     }
 }
 /*!
@@ -141,6 +203,19 @@ int Texture::mipCount() const {
 void Texture::setMipCount(int levels) {
     m_mips = levels;
 }
+/*!
+    Returns the highest MIP level loaded to the memory.
+    Returns 0 for the textures which are not streamed or completely loaded.
+*/
+int Texture::residentMip() const {
+    return m_residentMip;
+}
+/*!
+    Returns true if MIP levels of the texture can be streamed; otherwise returns false.
+*/
+bool Texture::isStreamable() const {
+    return !m_mipSections.empty();
+}
 /*!
     Returns a surface for the provided \a side.
     Each texture must contain at least one surface.
@@ -177,21 +252,46 @@ void Texture::readPixels(int x, int y, int width, int height) {
 */
 int Texture::getPixel(int x, int y, int level) const {
     uint32_t result = 0;
-    if(!m_sides.empty() && m_sides[0].size() > level) {
-        const uint8_t *ptr = m_sides[0][level].data() + (y * m_width + x) * 4;
+    int index = level - m_residentMip;
+    if(!m_sides.empty() && index >= 0 && m_sides[0].size() > static_cast<size_t>(index)) {
+        const uint8_t *ptr = m_sides[0][index].data() + (y * m_width + x) * 4;
         memcpy(&result, ptr, sizeof(uint32_t));
     }
     return result;
 }
 /*!
     Returns texture data from a mip \a level.
+    Returns an empty array if the level isn't resident.
 */
 ByteArray Texture::getPixels(int level) const {
-    if(!m_sides.empty() && m_sides[0].size() > level) {
-        return m_sides[0][level];
+    int index = level - m_residentMip;
+    if(!m_sides.empty() && index >= 0 && m_sides[0].size() > static_cast<size_t>(index)) {
+        return m_sides[0][index];
     }
     return ByteArray();
 }
+/*!
+    \reimp
+*/
+uint64_t Texture::cpuMemory() const {
+    uint64_t result = 0;
+    for(auto &side : m_sides) {
+        for(auto &lod : side) {
+            result += lod.size();
+        }
+    }
+    return result;
+}
+/*!
+    \reimp
+    Render targets are estimated by their dimensions, other textures occupy the same amount of memory as their resident mip levels.
+*/
+uint64_t Texture::gpuMemory() const {
+    if(isRender()) {
+        return uint64_t(sizeRGB(m_width, m_height, m_depth)) * MAX(m_sides.size(), size_t(1));
+    }
+    return cpuMemory();
+}
 /*!
     Returns width for the texture.
 */
@@ -405,7 +505,14 @@ bool Texture::isUnloadable() {
     \internal
 */
 void Texture::clear() {
+    if(m_streamer) {
+        m_streamer->remove(this);
+    }
+
     m_sides.clear();
+    m_mipSections.clear();
+    m_mipSource.clear();
+    m_residentMip = 0;
 }
 /*!
     Returns the maximum texure size.
@@ -431,6 +538,20 @@ uint32_t Texture::maxCubemapSize() {
 void Texture::setMaxCubemapSize(uint32_t size) {
     s_maxCubemapSize = size;
 }
+/*!
+    Returns the maximum size of the mip levels which are loaded for the streamed textures initially.
+    Zero means that streaming is disabled.
+*/
+uint32_t Texture::streamingSize() {
+    return s_streamingSize;
+}
+/*!
+    Sets the maximum \a size of the mip levels which are loaded for the streamed textures initially.
+    Zero disables streaming, so the textures loaded after this call keep all their mip levels in memory.
+*/
+void Texture::setStreamingSize(uint32_t size) {
+    s_streamingSize = size;
+}
 /*!
     \internal
 */
@@ -452,3 +573,57 @@ bool Texture::isDwordAligned() {
 inline int32_t Texture::dwordAlignedLineSize(int32_t width, int32_t bpp) {
     return ((width * bpp + 31) & -32) >> 3;
 }
+/*!
+    \internal
+    Returns the size in bytes of the streamed mip levels in range [\a begin, \a end) for all sides.
+*/
+uint64_t Texture::mipsSize(int begin, int end) const {
+    uint64_t result = 0;
+    if(!m_mipSections.empty()) {
+        for(int side = 0; side < sides(); side++) {
+            for(int level = MAX(begin, 0); level < MIN(end, m_mips); level++) {
+                result += m_mipSections[side * m_mips + level].size;
+            }
+        }
+    }
+    return result;
+}
+/*!
+    \internal
+    Makes the mip levels from \a level up to residentMip() resident using the data from \a levels.
+    Each element of \a levels contains the loaded levels for the corresponding side.
+*/
+void Texture::applyMips(int level, Sides &levels) {
+    if(level >= m_residentMip || levels.size() != m_sides.size()) {
+        return;
+    }
+
+    for(size_t side = 0; side < m_sides.size(); side++) {
+        Surface &src = levels[side];
+        for(auto it = src.rbegin(); it != src.rend(); ++it) {
+            m_sides[side].push_front(std::move(*it));
+        }
+    }
+    m_residentMip = level;
+
+    setDirty();
+}
+/*!
+    \internal
+    Releases the mip levels which are higher than \a level.
+*/
+void Texture::evictMips(int level) {
+    level = MIN(level, m_mips - 1);
+    if(level <= m_residentMip) {
+        return;
+    }
+
+    for(auto &side : m_sides) {
+        for(int i = m_residentMip; i < level && !side.empty(); i++) {
+            side.pop_front();
+        }
+    }
+    m_residentMip = level;
+
+    setDirty();
+}
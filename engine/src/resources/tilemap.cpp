@@ -4,6 +4,7 @@
 #include "resources/mesh.h"
 
 #include <cstring>
+#include <cfloat>
 
 namespace  {
     const char *gData = "Data";
@@ -17,6 +18,9 @@ namespace  {
 
     TileMap is a fundamental resource class used to define a grid of tiles for creating the layout of a game or application.
     It represents a grid-based map where each cell can be assigned a specific tile ID.
+
+    The map is split into square chunks of TileMap::ChunkSize cells, each chunk has its own mesh and bounding box.
+    Changing a tile rebuilds only the chunk which contains it, and renderers can cull chunks individually.
 */
 
 TileMap::TileMap() :
@@ -28,10 +32,16 @@ TileMap::TileMap() :
         m_staggerIndex(1),
         m_hexSizeLength(0),
         m_tileSet(nullptr),
-        m_tileMesh(Engine::objectCreate<Mesh>()),
+        m_chunksX(0),
         m_dirty(true) {
 
 }
+
+TileMap::~TileMap() {
+    for(auto it : m_chunks) {
+        delete it;
+    }
+}
 /*!
     Returns a pointer to the associated TileSet that defines the available tiles for this tile map.
 */
@@ -61,7 +71,7 @@ void TileMap::setWidth(int width) {
     if(m_width != width) {
         m_width = width;
         m_data.resize(m_width * m_height);
-        m_dirty = true;
+        resizeChunks();
     }
 }
 /*!
@@ -77,7 +87,7 @@ void TileMap::setHeight(int height) {
     if(m_height != height) {
         m_height = height;
         m_data.resize(m_width * m_height);
-        m_dirty = true;
+        resizeChunks();
     }
 }
 /*!
@@ -88,10 +98,14 @@ int TileMap::tile(int x, int y) const {
 }
 /*!
     Sets the tile \a id at the specified grid cell coordinates (\a x, \a y).
+    Only the chunk which contains the cell is rebuilt.
 */
 void TileMap::setTile(int x, int y, int id) {
-    m_data[y * m_width + x] = id;
-    m_dirty = true;
+    int &cell = m_data[y * m_width + x];
+    if(cell != id) {
+        cell = id;
+        markChunk(x, y);
+    }
 }
 /*!
     Returns the orientation of the tile map.
@@ -160,141 +174,211 @@ void TileMap::setHexSideLength(int length) {
     m_dirty = true;
 }
 /*!
-     Returns a pointer to a mesh representing the tile map's geometry. This mesh is updated and regenerated as needed.
+    Returns the number of chunks the tile map is split into.
+    Each chunk covers up to TileMap::ChunkSize by TileMap::ChunkSize cells and has its own mesh, so changes of a single tile rebuild and upload only one chunk.
 */
-Mesh *TileMap::tileMesh() const {
-    if(m_dirty) {
-        refreshAllTiles();
-
-        m_dirty = false;
+int TileMap::chunkCount() const {
+    return m_chunks.size();
+}
+/*!
+    Returns a mesh of the chunk with \a index.
+    The mesh isn't rebuilt by this call, so it's safe to use from the worker threads; changed chunks are rebuilt with refreshChunks().
+*/
+Mesh *TileMap::chunkMesh(int index) const {
+    if(index < 0 || index >= static_cast<int32_t>(m_chunks.size())) {
+        return nullptr;
     }
 
-    return m_tileMesh;
+    return m_chunks[index];
 }
 /*!
-    Refreshes all the tiles in the tile map, updating the tile mesh with the latest tile information based on the tile set and map data.
+    Returns a bounding box of the chunk with \a index in the tile map space.
+    The bound is valid after the call of refreshChunks().
 */
-void TileMap::refreshAllTiles() const {
-    if(m_tileSet == nullptr) {
-        return;
+AABBox TileMap::chunkBound(int index) const {
+    if(index < 0 || index >= static_cast<int32_t>(m_chunks.size()) || m_chunks[index]->isEmpty()) {
+        return AABBox(Vector3(0.0f), Vector3(-1.0f));
     }
+    return m_chunks[index]->bound();
+}
+/*!
+    Returns a bounding box of all tiles in the tile map space.
+    Like chunkMesh() it doesn't rebuild changed chunks, the bound is valid after the call of refreshChunks().
+*/
+AABBox TileMap::bound() const {
+    Vector3 min( FLT_MAX);
+    Vector3 max(-FLT_MAX);
 
-    Vector2 cellSize(m_cellWidth, m_cellHeight);
-    Vector2 tileSize(m_tileSet->tileWidth(), m_tileSet->tileHeight());
-
-    Vector2 tileOffset(m_tileSet->tileOffset());
-
-    m_tileMesh->clear();
-
-    uint32_t size = m_width * m_height;
-
-    Vector3Vector vertices;
-    vertices.resize(size * 4);
-
-    Vector2Vector uvs;
-    uvs.resize(size * 4);
+    for(uint32_t i = 0; i < m_chunks.size(); i++) {
+        if(!m_chunks[i]->isEmpty()) {
+            Vector3 chunkMin, chunkMax;
+            m_chunks[i]->bound().box(chunkMin, chunkMax);
 
-    Vector4Vector colors;
-    colors.resize(size * 4, Vector4(1.0f));
+            min = Vector3(MIN(min.x, chunkMin.x), MIN(min.y, chunkMin.y), MIN(min.z, chunkMin.z));
+            max = Vector3(MAX(max.x, chunkMax.x), MAX(max.y, chunkMax.y), MAX(max.z, chunkMax.z));
+        }
+    }
 
-    IndexVector indices;
-    indices.reserve(size * 6);
+    AABBox result(Vector3(0.0f), Vector3(0.0f));
+    if(min.x <= max.x) {
+        result.setBox(min, max);
+    }
+    return result;
+}
+/*!
+    Returns the position of the top left corner of the tile at the grid cell coordinates (\a x, \a y) in the tile map space.
+    The position depends on the orientation of the tile map and the tile offset of the tile set.
+*/
+Vector2 TileMap::tilePosition(int x, int y) const {
+    Vector2 cellSize(m_cellWidth, m_cellHeight);
+    Vector2 tileOffset(m_tileSet ? m_tileSet->tileOffset() : Vector2(0.0f));
 
     Vector2 offset;
     switch(m_orientation) {
     case TileSet::Isometric: {
-        offset.x = cellSize.x * (m_width-1) * 0.5f;
-        offset.y = -cellSize.y;
+        offset.x = cellSize.x * (m_width - 1 - y + x) * 0.5f;
+        offset.y = cellSize.y * (y - 2 + x) * 0.5f;
         offset += tileOffset;
         break;
     }
     case TileSet::Hexagonal: {
-        offset.x = (m_staggerIndex == 1) ? 0.0f : cellSize.x * 0.5f;
-        offset.y = -cellSize.y * 0.5f;
+        offset.x = cellSize.x * x + (((y + 1) % 2 == m_staggerIndex) ? 0.0f : cellSize.x * 0.5f);
+        offset.y = (cellSize.y + m_hexSizeLength) * 0.5f * y - cellSize.y * 0.5f;
         offset += tileOffset;
         break;
     }
-    default: break;
+    default: {
+        offset.x = cellSize.x * x + tileOffset.x;
+        offset.y = cellSize.y * y;
+        break;
+    }
     }
 
-    int index = 0;
-    for(int y = 0; y < m_height; y++) {
-        for(int x = 0; x < m_width; x++) {
-            int id = m_data[y * m_width + x];
-            if(id == -1) {
-                offset.x += cellSize.x;
-                continue;
-            }
+    return Vector2(offset.x, -offset.y);
+}
+/*!
+    Rebuilds meshes of the chunks which were changed since the last call.
+    Must be called from the thread which modifies the tile map; the engine calls it on the main thread for each visible TileMapRender before the culling.
+*/
+void TileMap::refreshChunks() const {
+    if(m_dirty) {
+        refreshAllTiles();
+        return;
+    }
 
-            Vector4 uv = m_tileSet->getCorners(id);
+    for(uint32_t i = 0; i < m_chunks.size(); i++) {
+        if(m_dirtyChunks[i]) {
+            refreshChunk(i);
+        }
+    }
+}
+/*!
+    Refreshes all the tiles in the tile map, updating the chunk meshes with the latest tile information based on the tile set and map data.
+*/
+void TileMap::refreshAllTiles() const {
+    if(m_tileSet == nullptr) {
+        return;
+    }
 
-            vertices[index].x = offset.x;
-            vertices[index].y = -offset.y;
+    for(uint32_t i = 0; i < m_chunks.size(); i++) {
+        refreshChunk(i);
+    }
 
-            vertices[index + 1].x = offset.x;
-            vertices[index + 1].y = -offset.y - tileSize.y;
+    m_dirty = false;
+}
+/*!
+    \internal
+    Recreates the chunk grid for the current size of the tile map.
+*/
+void TileMap::resizeChunks() {
+    m_chunksX = (m_width + ChunkSize - 1) / ChunkSize;
+    int chunksY = (m_height + ChunkSize - 1) / ChunkSize;
+
+    size_t count = m_chunksX * chunksY;
+    for(size_t i = count; i < m_chunks.size(); i++) {
+        delete m_chunks[i];
+    }
+    for(size_t i = m_chunks.size(); i < count; i++) {
+        m_chunks.push_back(Engine::objectCreate<Mesh>());
+    }
+    m_chunks.resize(count);
+    m_dirtyChunks.assign(count, true);
+
+    m_dirty = true;
+}
+/*!
+    \internal
+    Marks the chunk which contains the grid cell (\a x, \a y) to be rebuilt.
+*/
+void TileMap::markChunk(int x, int y) {
+    int index = (y / ChunkSize) * m_chunksX + x / ChunkSize;
+    if(index >= 0 && index < static_cast<int32_t>(m_dirtyChunks.size())) {
+        m_dirtyChunks[index] = true;
+    }
+}
+/*!
+    \internal
+    Rebuilds the mesh of the chunk with \a index.
+*/
+void TileMap::refreshChunk(int index) const {
+    m_dirtyChunks[index] = false;
 
-            vertices[index + 2].x = offset.x + tileSize.x;
-            vertices[index + 2].y = -offset.y - tileSize.y;
+    Mesh *mesh = m_chunks[index];
+    mesh->clear();
 
-            vertices[index + 3].x = offset.x + tileSize.x;
-            vertices[index + 3].y = -offset.y;
+    if(m_tileSet == nullptr) {
+        return;
+    }
 
-            uvs[index].x = uv.x;
-            uvs[index].y = uv.w;
+    Vector2 tileSize(m_tileSet->tileWidth(), m_tileSet->tileHeight());
 
-            uvs[index + 1].x = uv.x;
-            uvs[index + 1].y = uv.y;
+    int beginX = (index % m_chunksX) * ChunkSize;
+    int beginY = (index / m_chunksX) * ChunkSize;
+    int endX = MIN(beginX + ChunkSize, m_width);
+    int endY = MIN(beginY + ChunkSize, m_height);
 
-            uvs[index + 2].x = uv.z;
-            uvs[index + 2].y = uv.y;
+    Vector3Vector vertices;
+    vertices.reserve(ChunkSize * ChunkSize * 4);
 
-            uvs[index + 3].x = uv.z;
-            uvs[index + 3].y = uv.w;
+    Vector2Vector uvs;
+    uvs.reserve(ChunkSize * ChunkSize * 4);
 
-            indices.push_back(index);
-            indices.push_back(index + 1);
-            indices.push_back(index + 2);
-            indices.push_back(index);
-            indices.push_back(index + 2);
-            indices.push_back(index + 3);
-            index += 4;
+    IndexVector indices;
+    indices.reserve(ChunkSize * ChunkSize * 6);
 
-            if(m_orientation == TileSet::Isometric) {
-                offset.x += cellSize.x * 0.5f;
-                offset.y += cellSize.y * 0.5f;
-            } else {
-                offset.x += cellSize.x;
+    for(int y = beginY; y < endY; y++) {
+        for(int x = beginX; x < endX; x++) {
+            size_t cell = y * m_width + x;
+            if(cell >= m_data.size() || m_data[cell] == -1) {
+                continue;
             }
-        }
 
-        switch(m_orientation) {
-        case TileSet::Orthogonal: {
-            offset.x = tileOffset.x;
-            offset.y += cellSize.y;
-            break;
-        }
-        case TileSet::Isometric: {
-            offset.x = (cellSize.x * m_width - (y+2) * cellSize.x) * 0.5f;
-            offset.y = (y-1) * cellSize.y * 0.5f;
-            offset += tileOffset;
-            break;
-        }
-        case TileSet::Hexagonal: {
-            offset.x = (y % 2 == m_staggerIndex) ? 0.0f : cellSize.x * 0.5f + tileOffset.x;
-            offset.y += (cellSize.y + m_hexSizeLength) * 0.5f;
-            break;
-        }
-        default: break;
+            Vector2 position(tilePosition(x, y));
+            Vector4 uv = m_tileSet->getCorners(m_data[cell]);
+
+            uint32_t i = vertices.size();
+
+            vertices.push_back(Vector3(position.x, position.y, 0.0f));
+            vertices.push_back(Vector3(position.x, position.y - tileSize.y, 0.0f));
+            vertices.push_back(Vector3(position.x + tileSize.x, position.y - tileSize.y, 0.0f));
+            vertices.push_back(Vector3(position.x + tileSize.x, position.y, 0.0f));
+
+            uvs.push_back(Vector2(uv.x, uv.w));
+            uvs.push_back(Vector2(uv.x, uv.y));
+            uvs.push_back(Vector2(uv.z, uv.y));
+            uvs.push_back(Vector2(uv.z, uv.w));
+
+            indices.insert(indices.end(), { i, i + 1, i + 2, i, i + 2, i + 3 });
         }
     }
 
-    m_tileMesh->clear();
-    m_tileMesh->setUv0(uvs);
-    m_tileMesh->setColors(colors);
-    m_tileMesh->setVertices(vertices);
-    m_tileMesh->setIndices(indices);
-    m_tileMesh->recalcBounds();
+    if(!indices.empty()) {
+        mesh->setUv0(uvs);
+        mesh->setColors(Vector4Vector(vertices.size(), Vector4(1.0f)));
+        mesh->setVertices(vertices);
+        mesh->setIndices(indices);
+    }
+    mesh->recalcBounds();
 }
 /*!
     \internal
@@ -2,11 +2,29 @@
 
 #include "material.h"
 #include "mesh.h"
+#include "computeshader.h"
+#include "computebuffer.h"
 
-#include <array>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include <simd.h>
 
 namespace {
     const char *gEmitters("Emitters");
+
+    // Number of particles processed by each instruction at once
+    const int gBlockSize(256);
+
+    // Number of components of the local register
+    const int gLocalSize(16);
+
+    const char *gKernelParticles("Particles");
+    const char *gKernelEmitter("Emitter");
+    const char *gKernelState("State");
+    const char *gKernelConstants("Constants");
+    const char *gKernelInstances("Instances");
 }
 
 enum Stages {
@@ -50,6 +68,9 @@ enum Space {
 */
 
 VisualEffect::VisualEffect() :
+        m_kernel(nullptr),
+        m_kernelConstants(nullptr),
+        m_kernelDirty(true),
         m_capacity(1),
         m_systemStride(1),
         m_emitterStride(1),
@@ -60,50 +81,431 @@ VisualEffect::VisualEffect() :
 
 }
 
+VisualEffect::~VisualEffect() {
+    delete m_kernel;
+    delete m_kernelConstants;
+}
+
+/*!
+    Simulates the effect for one frame using the state stored in the \a buffers.
+
+    Particle attributes are stored as separate streams of capacity() values per component and live particles are always kept at the beginning of the streams.
+    Each stage program is executed for blocks of particles, so every instruction processes a whole block in a tight loop which the compiler can vectorize.
+    Dead particles are removed at the end of the frame by moving the last live particle into their slots.
+*/
 void VisualEffect::update(Buffers &buffers) {
-    if(!m_emitterUpdateOperations.empty()) {
-        apply(m_emitterUpdateOperations, buffers);
+    PROFILE_FUNCTION();
+
+    if(!m_emitterUpdateProgram.empty()) {
+        execute(m_emitterUpdateProgram, buffers, 0, 1);
     }
 
-    if(!m_particleSpawnOperations.empty()) {
-        for(int p = 0; p < m_capacity; p++) {
-            if(buffers.emitter[SpawnCounter] >= 1.0f) {
-                float &particleAge = buffers.particles[p * m_particleStride];
-                if(particleAge <= 0.0f) {
-                    apply(m_particleSpawnOperations, buffers, p);
+    if(buffers.particles.empty()) {
+        return;
+    }
 
-                    buffers.emitter[SpawnCounter] -= 1.0f;
-                }
-            } else break;
+    if(!m_particleSpawnProgram.empty()) {
+        float &counter = buffers.emitter[SpawnCounter];
+
+        int spawn = MIN(static_cast<int>(counter), m_capacity - buffers.alive);
+        if(spawn > 0) {
+            execute(m_particleSpawnProgram, buffers, buffers.alive, spawn);
+
+            buffers.alive += spawn;
+            counter -= spawn;
         }
     }
 
-    if(!m_renderOperations.empty() && !buffers.particles.empty()) {
+    if(!m_renderProgram.empty()) {
         buffers.instances = 0;
 
         for(int r = 0; r < buffers.render.size(); r++) {
             if(m_renderables[r].material) {
                 int renderableStride = m_renderables[r].material->uniformSize() / sizeof(float);
 
-                for(int p = 0; p < m_capacity; p++) {
-                    float particleAge = buffers.particles[p * m_particleStride];
-                    if(particleAge > 0.0f) {
-                        apply(m_renderOperations, buffers, p, r, renderableStride);
-                        buffers.instances++;
+                // Instance data is written directly for all live particles
+                execute(m_renderProgram, buffers, 0, buffers.alive, reinterpret_cast<float *>(buffers.render[r].data()), renderableStride);
+
+                buffers.instances = buffers.alive;
+            }
+        }
+    }
+
+    if(!m_particleUpdateProgram.empty()) {
+        execute(m_particleUpdateProgram, buffers, 0, buffers.alive);
+    }
+
+    compact(buffers);
+}
+/*!
+    Simulates the effect for one frame in the same way as the GPU kernel does and stores the state in the \a buffers.
+
+    This is a reference implementation of the kernelSource() used to validate the GPU simulation.
+    Particles stay in their slots, dead slots are reused for the new particles and instance data is written for the first renderable only.
+*/
+void VisualEffect::kernelUpdate(Buffers &buffers) const {
+    PROFILE_FUNCTION();
+
+    if(!m_emitterUpdateProgram.empty()) {
+        execute(m_emitterUpdateProgram, buffers, 0, 1);
+    }
+
+    if(buffers.particles.empty()) {
+        return;
+    }
+
+    float &counter = buffers.emitter[SpawnCounter];
+
+    int spawn = MAX(static_cast<int>(counter), 0);
+    int spawned = 0;
+
+    int stride = kernelStride();
+    float *render = nullptr;
+    if(stride > 0 && !buffers.render.empty()) {
+        render = reinterpret_cast<float *>(buffers.render.front().data());
+    }
+
+    int instances = 0;
+    for(int p = 0; p < m_capacity; p++) {
+        bool live = buffers.particles[p] > 0.0f;
+        if(!live && !m_particleSpawnProgram.empty() && spawned++ < spawn) {
+            execute(m_particleSpawnProgram, buffers, p, 1);
+            live = true;
+        }
+
+        if(live) {
+            if(render && !m_renderProgram.empty()) {
+                execute(m_renderProgram, buffers, p, 1, render + instances * stride, stride);
+            }
+            instances++;
+
+            if(!m_particleUpdateProgram.empty()) {
+                execute(m_particleUpdateProgram, buffers, p, 1);
+            }
+        }
+    }
+
+    buffers.instances = instances;
+
+    counter -= MIN(spawned, spawn);
+}
+namespace {
+
+std::string literal(float value) {
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.9g", value);
+
+    std::string result(buffer);
+    if(result.find_first_of(".e") == std::string::npos) {
+        result += ".0";
+    }
+    if(value < 0.0f) {
+        result = "(" + result + ")";
+    }
+    return result;
+}
+
+std::string operand(const VisualEffect::Argument &argument, int component, const VisualEffect::FloatData &constants, int capacity) {
+    int index = argument.offset + component;
+
+    std::ostringstream out;
+    switch(argument.space) {
+        case Space::System: {
+            if(index < 4) {
+                out << "system[" << index << "]";
+            } else {
+                out << "0.0";
+            }
+        } break;
+        case Space::Emitter: out << "emitter[" << index << "]"; break;
+        case Space::Particle: out << "particles[" << index * capacity << "u + p]"; break;
+        case Space::Renderable: out << "instances[instance + " << index << "]"; break;
+        case Space::Local: out << "local[" << index << "]"; break;
+        case Space::Constant: out << literal(constants[index]); break;
+        case Space::Random: out << "constants[" << constants.size() + index * capacity << "u + p]"; break;
+        default: out << "0.0"; break;
+    }
+    return out.str();
+}
+
+void emitProgram(std::ostringstream &out, const VisualEffect::Program &program, const VisualEffect::FloatData &constants, int capacity, bool render = false) {
+    if(program.empty()) {
+        return;
+    }
+
+    out << "        for(int i = 0; i < " << gLocalSize << "; i++) local[i] = 0.0;\n";
+
+    for(auto &it : program) {
+        int retSize = it.result.size;
+
+        if(it.result.space == Space::Constant || it.result.space == Space::Random ||
+           (it.result.space == Space::Renderable && !render) ||
+           (it.result.space == Space::Local && it.result.offset + retSize > gLocalSize)) {
+            continue;
+        }
+
+        int size0 = it.arguments[0].size;
+        int size1 = it.arguments[1].size;
+
+        auto ret = [&](int c) { return operand(it.result, c, constants, capacity); };
+        auto arg = [&](int a, int c) { return operand(it.arguments[a], c, constants, capacity); };
+        // The last component of the second argument is repeated for the rest of the result
+        auto second = [&](int c) { return arg(1, MIN(c, size1 - 1)); };
+
+        const char *binary = nullptr;
+        const char *function = nullptr;
+        int count = MIN(retSize, size0);
+
+        switch(it.op) {
+            case Mov: {
+                for(int c = 0; c < count; c++) {
+                    out << "        " << ret(c) << " = " << arg(0, c) << ";\n";
+                }
+            } break;
+            case Add: binary = " + "; break;
+            case Sub: binary = " - "; break;
+            case Mul: {
+                if(size0 == 16) {
+                    out << "        {\n"
+                           "            vec3 v = (mat4(";
+                    for(int c = 0; c < 16; c++) {
+                        out << (c > 0 ? ", " : "") << arg(0, c);
+                    }
+                    out << ") * vec4(" << arg(1, 0) << ", " << arg(1, 1) << ", " << arg(1, 2) << ", 1.0)).xyz;\n";
+                    for(int c = 0; c < 3; c++) {
+                        out << "            " << ret(c) << " = v[" << c << "];\n";
                     }
+                    out << "        }\n";
+                } else {
+                    binary = " * ";
                 }
+            } break;
+            case Div: binary = " / "; break;
+            case Mod: {
+                for(int c = 0; c < MIN(count, size1); c++) {
+                    out << "        " << ret(c) << " = " << arg(0, c) << " - trunc(" << arg(0, c) << ");\n";
+                }
+            } break;
+            case Min: function = "min"; count = MIN(count, size1); break;
+            case Max: function = "max"; count = MIN(count, size1); break;
+            case Floor: function = "floor"; break;
+            case Ceil: function = "ceil"; break;
+            case Make: {
+                if(retSize == 16) {
+                    out << "        {\n"
+                           "            mat4 m = makeTransform(";
+                    for(int a = 0; a < 3; a++) {
+                        out << (a > 0 ? ", " : "") << "vec3(" << arg(a, 0) << ", " << arg(a, 1) << ", " << arg(a, 2) << ")";
+                    }
+                    out << ");\n";
+                    for(int c = 0; c < 16; c++) {
+                        out << "            " << ret(c) << " = m[" << c / 4 << "][" << c % 4 << "];\n";
+                    }
+                    out << "        }\n";
+                }
+            } break;
+            default: break;
+        }
+
+        if(binary) {
+            for(int c = 0; c < count; c++) {
+                out << "        " << ret(c) << " = " << arg(0, c) << binary << second(c) << ";\n";
+            }
+        } else if(function) {
+            bool unary = (it.op == Floor || it.op == Ceil);
+            for(int c = 0; c < count; c++) {
+                out << "        " << ret(c) << " = " << function << "(" << arg(0, c);
+                if(!unary) {
+                    out << ", " << second(c);
+                }
+                out << ");\n";
             }
         }
     }
+}
 
-    if(!m_particleUpdateOperations.empty() && !buffers.particles.empty()) {
-        for(int p = 0; p < m_capacity; p++) {
-            float particleAge = buffers.particles[p * m_particleStride];
-            if(particleAge > 0.0f) {
-                apply(m_particleUpdateOperations, buffers, p);
-            }
+}
+
+/*!
+    Returns the GLSL source of the compute kernel which simulates the effect on the GPU.
+
+    The kernel is dispatched three times per frame with the stage number in the params uniform, see KernelStages.
+    The first stage updates the emitter, the second one spawns, renders and updates particles with a thread per particle slot and the last one consumes the spawn counter.
+    Instance data is appended to the Instances buffer and the number of instances is counted in the KernelState which is used as indirect draw arguments.
+*/
+TString VisualEffect::kernelSource() const {
+    PROFILE_FUNCTION();
+
+    std::ostringstream out;
+
+    out << "#version 430 core\n"
+           "\n"
+           "layout(local_size_x = " << KernelGroupSize << ") in;\n"
+           "\n"
+           "layout(std140, binding = 4) uniform Uniforms {\n"
+           "    mat4 transform;\n"
+           "    vec4 system;\n"
+           "    ivec4 params;\n"
+           "};\n"
+           "\n"
+           "layout(std430, binding = 0) buffer Particles { float particles[]; };\n"
+           "layout(std430, binding = 1) buffer Emitter { float emitter[]; };\n"
+           "layout(std430, binding = 2) buffer State {\n"
+           "    uint indexCount;\n"
+           "    uint instanceCount;\n"
+           "    uint firstIndex;\n"
+           "    int baseVertex;\n"
+           "    uint baseInstance;\n"
+           "    int spawn;\n"
+           "    uint spawned;\n"
+           "    uint padding;\n"
+           "};\n"
+           "layout(std430, binding = 3) readonly buffer Constants { float constants[]; };\n"
+           "layout(std430, binding = 5) writeonly buffer Instances { float instances[]; };\n"
+           "\n"
+           "mat4 makeTransform(vec3 t, vec3 r, vec3 s) {\n"
+           "    vec3 h = radians(r) * 0.5;\n"
+           "    vec3 c = cos(h);\n"
+           "    vec3 n = sin(h);\n"
+           "    vec4 q = vec4(n.x * c.y * c.z - c.x * n.y * n.z,\n"
+           "                  c.x * n.y * c.z + n.x * c.y * n.z,\n"
+           "                  c.x * c.y * n.z - n.x * n.y * c.z,\n"
+           "                  c.x * c.y * c.z + n.x * n.y * n.z);\n"
+           "    vec3 q2 = q.xyz * 2.0;\n"
+           "    float xx = q.x * q2.x; float yy = q.y * q2.y; float zz = q.z * q2.z;\n"
+           "    float xy = q.x * q2.y; float xz = q.x * q2.z; float yz = q.y * q2.z;\n"
+           "    float wx = q.w * q2.x; float wy = q.w * q2.y; float wz = q.w * q2.z;\n"
+           "    return mat4(vec4(1.0 - (yy + zz), xy + wz, xz - wy, 0.0) * s.x,\n"
+           "                vec4(xy - wz, 1.0 - (xx + zz), yz + wx, 0.0) * s.y,\n"
+           "                vec4(xz + wy, yz - wx, 1.0 - (xx + yy), 0.0) * s.z,\n"
+           "                vec4(t, 1.0));\n"
+           "}\n"
+           "\n"
+           "void main() {\n"
+           "    uint p = gl_GlobalInvocationID.x;\n"
+           "    int instance = 0;\n"
+           "    float local[" << gLocalSize << "];\n"
+           "\n"
+           "    if(params.x == " << KernelEmitter << ") {\n"
+           "        if(p != 0u) return;\n";
+
+    if(m_emitterStride >= Transform + 16) {
+        out << "        for(int i = 0; i < 16; i++) emitter[" << Transform << " + i] = transform[i / 4][i % 4];\n";
+    }
+    emitProgram(out, m_emitterUpdateProgram, m_constants, m_capacity);
+
+    out << "        spawn = max(int(emitter[" << SpawnCounter << "]), 0);\n"
+           "        spawned = 0u;\n"
+           "        instanceCount = 0u;\n"
+           "    } else if(params.x == " << KernelParticles << ") {\n"
+           "        if(p >= " << m_capacity << "u) return;\n"
+           "        bool live = particles[p] > 0.0;\n";
+
+    if(!m_particleSpawnProgram.empty()) {
+        out << "        if(!live && int(atomicAdd(spawned, 1u)) < spawn) {\n";
+        emitProgram(out, m_particleSpawnProgram, m_constants, m_capacity);
+        out << "            live = true;\n"
+               "        }\n";
+    }
+
+    out << "        if(!live) return;\n"
+           "        instance = int(atomicAdd(instanceCount, 1u)) * " << kernelStride() << ";\n";
+
+    if(kernelStride() > 0) {
+        emitProgram(out, m_renderProgram, m_constants, m_capacity, true);
+    }
+    emitProgram(out, m_particleUpdateProgram, m_constants, m_capacity);
+
+    out << "    } else if(params.x == " << KernelFinish << ") {\n"
+           "        if(p != 0u) return;\n"
+           "        emitter[" << SpawnCounter << "] -= float(min(int(spawned), spawn));\n"
+           "    }\n"
+           "}\n";
+
+    return out.str();
+}
+/*!
+    Returns the compute shader which simulates the effect on the GPU.
+    The shader is created on the first call and rebuilt after the effect has been changed.
+
+    \note The kernel is provided as a GLSL source, so only render backends which compile shaders at runtime can execute it.
+*/
+ComputeShader *VisualEffect::kernel() {
+    if(m_kernel == nullptr) {
+        m_kernel = Engine::objectCreate<ComputeShader>();
+    }
+
+    if(m_kernelDirty) {
+        m_kernelDirty = false;
+
+        VariantMap data;
+        data["Shader"] = kernelSource();
+        data["Buffers"] = VariantList({
+            VariantList({TString(), 0, gKernelParticles, 0}),
+            VariantList({TString(), 1, gKernelEmitter, 0}),
+            VariantList({TString(), 2, gKernelState, 0}),
+            VariantList({TString(), 3, gKernelConstants, 0}),
+            VariantList({TString(), 5, gKernelInstances, 0})
+        });
+        // Layout of the std140 uniform block
+        data["Uniforms"] = VariantList({
+            VariantList({Matrix4(), 64, "transform"}),
+            VariantList({Vector4(), 16, "system"}),
+            VariantList({Vector4(), 16, "params"})
+        });
+
+        m_kernel->loadUserData(data);
+
+        // Storage buffers can't be empty, random streams follow the constants
+        ByteArray constants(MAX(m_constants.size() + m_random.size(), size_t(1)) * sizeof(float), 0);
+        if(!m_constants.empty()) {
+            memcpy(constants.data(), m_constants.data(), m_constants.size() * sizeof(float));
+        }
+        if(!m_random.empty()) {
+            memcpy(constants.data() + m_constants.size() * sizeof(float), m_random.data(), m_random.size() * sizeof(float));
         }
+        kernelConstants()->setData(constants);
+    }
+
+    return m_kernel;
+}
+/*!
+    Creates an instance of the kernel() which executes the \a stage with the given buffers.
+    The \a particles buffer must contain capacity() values per particle attribute, the \a emitter buffer contains the emitter attributes,
+    the \a state buffer contains the KernelState and the \a instances buffer receives instance data of the first renderable.
+    Returns nullptr if the kernel can't be created.
+*/
+ComputeInstance *VisualEffect::createKernelInstance(int stage, ComputeBuffer *particles, ComputeBuffer *emitter, ComputeBuffer *state, ComputeBuffer *instances) {
+    ComputeShader *shader = kernel();
+    if(shader == nullptr) {
+        return nullptr;
     }
+
+    ComputeInstance *result = shader->createInstance();
+    if(result) {
+        result->setBuffer(gKernelParticles, particles);
+        result->setBuffer(gKernelEmitter, emitter);
+        result->setBuffer(gKernelState, state);
+        result->setBuffer(gKernelConstants, kernelConstants());
+        result->setBuffer(gKernelInstances, instances);
+
+        int32_t params[4] = {stage, 0, 0, 0};
+        result->setInteger("params", params);
+    }
+
+    return result;
+}
+/*!
+    \internal
+    Returns the buffer with constant and random values used by the kernel().
+    The buffer is filled when the kernel() is built.
+*/
+ComputeBuffer *VisualEffect::kernelConstants() {
+    if(m_kernelConstants == nullptr) {
+        m_kernelConstants = Engine::objectCreate<ComputeBuffer>();
+    }
+
+    return m_kernelConstants;
 }
 /*!
     Returns renderables count.
@@ -145,6 +547,13 @@ int VisualEffect::emitterStride() const {
 int VisualEffect::particleStride() const {
     return m_particleStride;
 }
+/*!
+    Returns random values used by the effect as streams of capacity() values per component.
+    Each effect instance should copy them to the Buffers::random, so the values can follow the particles.
+*/
+const VisualEffect::FloatData &VisualEffect::randomStreams() const {
+    return m_random;
+}
 /*!
     Sets a maximum \a capacity of particles to emit.
 */
@@ -166,15 +575,14 @@ void VisualEffect::setLocal(bool local) {
 /*!
     Returns true if GPU particle simulation is enabled, false otherwise.
 
-    \note Gpu simulation is not supported yet.
+    GPU effects are simulated by the kernel() and drawn with indirect draw arguments produced by it.
+    On backends without runtime compute kernels (see CommandBuffer::isComputeSupported()) the effect falls back to the CPU simulation.
 */
 bool VisualEffect::gpu() const {
     return m_gpu;
 }
 /*!
     Setter for the \a gpu flag indicating GPU particle simulation.
-
-    \note Gpu simulation is not supported yet.
 */
 void VisualEffect::setGpu(bool gpu) {
     m_gpu = gpu;
@@ -198,174 +606,352 @@ AABBox VisualEffect::bound() const {
     return m_aabb;
 }
 
-inline void movOp(float *ret, int retSize, const float *arg, int argSize) {
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize) {
-            ret[i] = arg[i];
-        }
-    }
-}
+namespace {
 
-inline void addOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    float value = arg[1][0];
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize[1]) {
-            value = arg[1][i];
-        }
-        if(i < argSize[0]) {
-            ret[i] = arg[0][i] + value;
-        }
+struct Stream {
+    float *data;
+
+    // Distance between components of a value
+    int32_t component;
+
+    // Distance between values of adjacent particles, zero for the values shared by all particles
+    int32_t particle;
+};
+
+#if defined(NEXT_SSE)
+typedef __m128 Float4;
+
+inline Float4 load4(const float *data) { return _mm_loadu_ps(data); }
+inline void store4(float *data, Float4 value) { _mm_storeu_ps(data, value); }
+inline Float4 splat4(float value) { return _mm_set1_ps(value); }
+#elif defined(NEXT_NEON)
+typedef float32x4_t Float4;
+
+inline Float4 load4(const float *data) { return vld1q_f32(data); }
+inline void store4(float *data, Float4 value) { vst1q_f32(data, value); }
+inline Float4 splat4(float value) { return vdupq_n_f32(value); }
+#endif
+
+#if defined(NEXT_SSE) || defined(NEXT_NEON)
+#define EFFECT_SIMD
+
+// Applies the scalar function to each lane, used for operations without a native instruction
+template<typename F>
+inline Float4 lanes(Float4 a, F func) {
+    float v[4];
+    store4(v, a);
+    for(int i = 0; i < 4; i++) {
+        v[i] = func(v[i]);
     }
+    return load4(v);
 }
+#endif
 
-inline void subOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    float value = arg[1][0];
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize[1]) {
-            value = arg[1][i];
-        }
-        if(i < argSize[0]) {
-            ret[i] = arg[0][i] - value;
+// Operations have a scalar form and a four lane form for contiguous particle streams
+struct MovOp {
+    float operator()(float a) const { return a; }
+#ifdef EFFECT_SIMD
+    Float4 operator()(Float4 a) const { return a; }
+#endif
+};
+
+struct AddOp {
+    float operator()(float a, float b) const { return a + b; }
+#if defined(NEXT_SSE)
+    Float4 operator()(Float4 a, Float4 b) const { return _mm_add_ps(a, b); }
+#elif defined(NEXT_NEON)
+    Float4 operator()(Float4 a, Float4 b) const { return vaddq_f32(a, b); }
+#endif
+};
+
+struct SubOp {
+    float operator()(float a, float b) const { return a - b; }
+#if defined(NEXT_SSE)
+    Float4 operator()(Float4 a, Float4 b) const { return _mm_sub_ps(a, b); }
+#elif defined(NEXT_NEON)
+    Float4 operator()(Float4 a, Float4 b) const { return vsubq_f32(a, b); }
+#endif
+};
+
+struct MulOp {
+    float operator()(float a, float b) const { return a * b; }
+#if defined(NEXT_SSE)
+    Float4 operator()(Float4 a, Float4 b) const { return _mm_mul_ps(a, b); }
+#elif defined(NEXT_NEON)
+    Float4 operator()(Float4 a, Float4 b) const { return vmulq_f32(a, b); }
+#endif
+};
+
+struct DivOp {
+    float operator()(float a, float b) const { return a / b; }
+#if defined(NEXT_SSE)
+    Float4 operator()(Float4 a, Float4 b) const { return _mm_div_ps(a, b); }
+#elif defined(NEXT_NEON) && defined(__aarch64__)
+    Float4 operator()(Float4 a, Float4 b) const { return vdivq_f32(a, b); }
+#elif defined(NEXT_NEON)
+    Float4 operator()(Float4 a, Float4 b) const {
+        float x[4], y[4];
+        store4(x, a);
+        store4(y, b);
+        for(int i = 0; i < 4; i++) {
+            x[i] /= y[i];
         }
+        return load4(x);
     }
-}
+#endif
+};
+
+struct ModOp {
+    float operator()(float a, float) const { return a - truncf(a); }
+#ifdef EFFECT_SIMD
+    Float4 operator()(Float4 a, Float4) const { return lanes(a, [](float v) { return v - truncf(v); }); }
+#endif
+};
+
+struct MinOp {
+    float operator()(float a, float b) const { return MIN(a, b); }
+#if defined(NEXT_SSE)
+    Float4 operator()(Float4 a, Float4 b) const { return _mm_min_ps(a, b); }
+#elif defined(NEXT_NEON)
+    Float4 operator()(Float4 a, Float4 b) const { return vminq_f32(a, b); }
+#endif
+};
+
+struct MaxOp {
+    float operator()(float a, float b) const { return MAX(a, b); }
+#if defined(NEXT_SSE)
+    Float4 operator()(Float4 a, Float4 b) const { return _mm_max_ps(a, b); }
+#elif defined(NEXT_NEON)
+    Float4 operator()(Float4 a, Float4 b) const { return vmaxq_f32(a, b); }
+#endif
+};
+
+struct FloorOp {
+    float operator()(float a) const { return floorf(a); }
+#ifdef EFFECT_SIMD
+    Float4 operator()(Float4 a) const { return lanes(a, [](float v) { return floorf(v); }); }
+#endif
+};
 
-inline void mulOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    if(argSize[0] == 16) {
-        const Matrix4 *m = reinterpret_cast<const Matrix4 *>(arg[0]);
-        const Vector3 *v = reinterpret_cast<const Vector3 *>(arg[1]);
+struct CeilOp {
+    float operator()(float a) const { return ceilf(a); }
+#ifdef EFFECT_SIMD
+    Float4 operator()(Float4 a) const { return lanes(a, [](float v) { return ceilf(v); }); }
+#endif
+};
 
-        Vector3 *r = reinterpret_cast<Vector3 *>(ret);
+template<typename F>
+inline void unaryOp(const Stream &ret, int count, const Stream &arg, int size, F func) {
+    for(int i = 0; i < count; i++) {
+        float *r = ret.data + i * ret.component;
+        const float *a = arg.data + i * arg.component;
 
-        *r = *m * *v;
-    } else {
-        float value = arg[1][0];
-        for(int i = 0; i < retSize; i++) {
-            if(i < argSize[1]) {
-                value = arg[1][i];
+        if(ret.particle == 1 && arg.particle == 1) {
+            int p = 0;
+#ifdef EFFECT_SIMD
+            for(; p + 4 <= size; p += 4) {
+                store4(r + p, func(load4(a + p)));
             }
-            if(i < argSize[0]) {
-                ret[i] = arg[0][i] * value;
+#endif
+            for(; p < size; p++) {
+                r[p] = func(a[p]);
+            }
+        } else {
+            for(int p = 0; p < size; p++) {
+                r[p * ret.particle] = func(a[p * arg.particle]);
             }
         }
     }
 }
 
-inline void divOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    float value = arg[1][0];
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize[1]) {
-            value = arg[1][i];
-        }
-        if(i < argSize[0]) {
-            ret[i] = arg[0][i] / value;
-        }
-    }
-}
+template<typename F>
+inline void binaryOp(const Stream &ret, int count, const Stream &arg0, const Stream &arg1, int size1, int size, F func) {
+    for(int i = 0; i < count; i++) {
+        float *r = ret.data + i * ret.component;
+        const float *a = arg0.data + i * arg0.component;
+        // The last component of the second argument is repeated for the rest of the result
+        const float *b = arg1.data + MIN(i, size1 - 1) * arg1.component;
 
-inline void modOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize[0] && i < argSize[1]) {
-            float y = arg[1][i];
-            ret[i] = modf(arg[0][i], &y);
+        if(ret.particle == 1 && arg0.particle == 1 && arg1.particle == 1) {
+            int p = 0;
+#ifdef EFFECT_SIMD
+            for(; p + 4 <= size; p += 4) {
+                store4(r + p, func(load4(a + p), load4(b + p)));
+            }
+#endif
+            for(; p < size; p++) {
+                r[p] = func(a[p], b[p]);
+            }
+        } else if(ret.particle == 1 && arg0.particle == 1 && arg1.particle == 0) {
+            const float value = *b;
+            int p = 0;
+#ifdef EFFECT_SIMD
+            const Float4 value4 = splat4(value);
+            for(; p + 4 <= size; p += 4) {
+                store4(r + p, func(load4(a + p), value4));
+            }
+#endif
+            for(; p < size; p++) {
+                r[p] = func(a[p], value);
+            }
+        } else {
+            for(int p = 0; p < size; p++) {
+                r[p * ret.particle] = func(a[p * arg0.particle], b[p * arg1.particle]);
+            }
         }
     }
 }
 
-inline void minOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize[0] && i < argSize[1]) {
-            ret[i] = MIN(arg[0][i], arg[1][i]);
-        }
+inline void load(const Stream &stream, int particle, float *result, int count) {
+    for(int i = 0; i < count; i++) {
+        result[i] = stream.data[particle * stream.particle + i * stream.component];
     }
 }
 
-inline void maxOp(float *ret, int retSize, std::array<const float *, 3> &arg, std::array<int, 3> &argSize) {
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize[0] && i < argSize[1]) {
-            ret[i] = MAX(arg[0][i], arg[1][i]);
-        }
+inline void store(const Stream &stream, int particle, const float *value, int count) {
+    for(int i = 0; i < count; i++) {
+        stream.data[particle * stream.particle + i * stream.component] = value[i];
     }
 }
 
-inline void floorOp(float *ret, int retSize, const float *arg, int argSize) {
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize) {
-            ret[i] = floor(arg[i]);
-        }
-    }
-}
+inline void transformOp(const Stream &ret, const Stream &arg0, const Stream &arg1, int size) {
+    for(int p = 0; p < size; p++) {
+        Matrix4 m;
+        Vector3 v;
+        load(arg0, p, m.mat, 16);
+        load(arg1, p, v.v, 3);
 
-inline void ceilOp(float *ret, int retSize, const float *arg, int argSize) {
-    for(int i = 0; i < retSize; i++) {
-        if(i < argSize) {
-            ret[i] = ceil(arg[i]);
-        }
+        Vector3 r = m * v;
+        store(ret, p, r.v, 3);
     }
 }
 
-inline void makeOp(float *ret, int retSize, std::array<const float *, 3> &arg) {
-    if(retSize == 16) {
-        const Vector3 *t = reinterpret_cast<const Vector3 *>(arg[0]);
-        const Vector3 *r = reinterpret_cast<const Vector3 *>(arg[1]);
-        const Vector3 *s = reinterpret_cast<const Vector3 *>(arg[2]);
+inline void makeOp(const Stream &ret, const Stream &arg0, const Stream &arg1, const Stream &arg2, int size) {
+    for(int p = 0; p < size; p++) {
+        Vector3 t, r, s;
+        load(arg0, p, t.v, 3);
+        load(arg1, p, r.v, 3);
+        load(arg2, p, s.v, 3);
 
-        *reinterpret_cast<Matrix4 *>(ret) = Matrix4(*t, Quaternion(*r), *s);
+        Matrix4 m(t, Quaternion(r), s);
+        store(ret, p, m.mat, 16);
     }
 }
 
+}
+
 /*!
     \internal
+    Executes the \a program for \a count particles starting from \a begin.
+    Instance data of the render stage is written to the \a render buffer with the \a stride per particle.
 */
-void VisualEffect::apply(std::vector<Operator> &operations, Buffers &buffers, int particle, int render, int stride) const {
-    Vector4 local;
-
-    float *p = &buffers.particles[particle * m_particleStride];
-
-     for(auto &it : operations) {
-        float *ret = nullptr;
-        switch(it.resultSpace) {
-            case Space::System: ret = &buffers.system[it.resultOffset]; break;
-            case Space::Emitter: ret = &buffers.emitter[it.resultOffset]; break;
-            case Space::Particle: ret = &p[it.resultOffset]; break;
-            case Space::Renderable: ret = &buffers.render[render][buffers.instances * stride + it.resultOffset]; break;
-            case Space::Local: ret = local.v; break;
+void VisualEffect::execute(const Program &program, Buffers &buffers, int begin, int count, float *render, int stride) const {
+    float local[gLocalSize * gBlockSize];
+
+    auto resolve = [&](const Argument &argument, int start) {
+        Stream stream = {nullptr, 1, 0};
+        switch(argument.space) {
+            case Space::System: stream.data = &buffers.system[argument.offset]; break;
+            case Space::Emitter: stream.data = &buffers.emitter[argument.offset]; break;
+            case Space::Particle: if(!buffers.particles.empty()) stream = {&buffers.particles[argument.offset * m_capacity + start], m_capacity, 1}; break;
+            case Space::Renderable: if(render) stream = {&render[(start - begin) * stride + argument.offset], 1, stride}; break;
+            case Space::Local: stream = {local, gBlockSize, 1}; break;
+            case Space::Constant: stream.data = const_cast<float *>(&m_constants[argument.offset]); break;
+            case Space::Random: {
+                const FloatData &random = buffers.random.empty() ? m_random : buffers.random;
+                stream = {const_cast<float *>(&random[argument.offset * m_capacity + start]), m_capacity, 1};
+            } break;
             default: break;
         }
+        return stream;
+    };
 
-        std::array<const float *, 3> arg = {ret, ret, ret};
-        std::array<int, 3> size = {1, 1, 1};
+    for(int start = begin; start < begin + count; start += gBlockSize) {
+        int size = MIN(gBlockSize, begin + count - start);
 
-        for(size_t a = 0; a < it.arguments.size(); a++) {
-            const Argument &argument = it.arguments[a];
-            size[a] = argument.size;
+        memset(local, 0, sizeof(local));
 
-            switch(argument.space) {
-                case Space::System: arg[a] = &buffers.system[argument.offset]; break;
-                case Space::Emitter: arg[a] = &buffers.emitter[argument.offset]; break;
-                case Space::Particle: arg[a] = &p[argument.offset]; break;
-                case Space::Local: arg[a] = local.v; break;
-                case Space::Constant: arg[a] = &it.constData[argument.offset]; break;
-                case Space::Random: arg[a] = &it.constData[particle * it.resultSize + argument.offset]; break;
+        for(auto &it : program) {
+            Stream ret = resolve(it.result, start);
+            Stream arg0 = resolve(it.arguments[0], start);
+            Stream arg1 = resolve(it.arguments[1], start);
+            Stream arg2 = resolve(it.arguments[2], start);
+            if(ret.data == nullptr || arg0.data == nullptr || arg1.data == nullptr || arg2.data == nullptr) {
+                continue;
+            }
+
+            int retSize = it.result.size;
+            int size0 = it.arguments[0].size;
+            int size1 = it.arguments[1].size;
+
+            switch(it.op) {
+                case Mov: unaryOp(ret, MIN(retSize, size0), arg0, size, MovOp()); break;
+                case Add: binaryOp(ret, MIN(retSize, size0), arg0, arg1, size1, size, AddOp()); break;
+                case Sub: binaryOp(ret, MIN(retSize, size0), arg0, arg1, size1, size, SubOp()); break;
+                case Mul: {
+                    if(size0 == 16) {
+                        transformOp(ret, arg0, arg1, size);
+                    } else {
+                        binaryOp(ret, MIN(retSize, size0), arg0, arg1, size1, size, MulOp());
+                    }
+                } break;
+                case Div: binaryOp(ret, MIN(retSize, size0), arg0, arg1, size1, size, DivOp()); break;
+                case Mod: binaryOp(ret, MIN(retSize, MIN(size0, size1)), arg0, arg1, size1, size, ModOp()); break;
+                case Min: binaryOp(ret, MIN(retSize, MIN(size0, size1)), arg0, arg1, size1, size, MinOp()); break;
+                case Max: binaryOp(ret, MIN(retSize, MIN(size0, size1)), arg0, arg1, size1, size, MaxOp()); break;
+                case Floor: unaryOp(ret, MIN(retSize, size0), arg0, size, FloorOp()); break;
+                case Ceil: unaryOp(ret, MIN(retSize, size0), arg0, size, CeilOp()); break;
+                case Make: {
+                    if(retSize == 16) {
+                        makeOp(ret, arg0, arg1, arg2, size);
+                    }
+                } break;
                 default: break;
             }
         }
+    }
+}
+/*!
+    \internal
+    Removes dead particles by moving the last live particles into their slots, so live particles stay contiguous.
+    Random streams are moved together with the particles, so every particle keeps its random values for the whole life.
+*/
+void VisualEffect::compact(Buffers &buffers) const {
+    float *data = buffers.particles.data();
+    float *random = buffers.random.empty() ? nullptr : buffers.random.data();
+    int randomStride = static_cast<int>(buffers.random.size()) / m_capacity;
 
-        switch(it.op) {
-            case Mov: movOp(ret, it.resultSize, arg[0], size[0]); break;
-            case Add: addOp(ret, it.resultSize, arg, size); break;
-            case Sub: subOp(ret, it.resultSize, arg, size); break;
-            case Mul: mulOp(ret, it.resultSize, arg, size); break;
-            case Div: divOp(ret, it.resultSize, arg, size); break;
-            case Mod: modOp(ret, it.resultSize, arg, size); break;
-            case Min: minOp(ret, it.resultSize, arg, size); break;
-            case Max: maxOp(ret, it.resultSize, arg, size); break;
-            case Floor: floorOp(ret, it.resultSize, arg[0], size[0]); break;
-            case Ceil: ceilOp(ret, it.resultSize, arg[0], size[0]); break;
-            case Make: makeOp(ret, it.resultSize, arg); break;
-            default: break;
+    int alive = buffers.alive;
+    int p = 0;
+    while(p < alive) {
+        if(data[p] > 0.0f) {
+            ++p;
+            continue;
+        }
+
+        --alive;
+        for(int c = 0; c < m_particleStride; c++) {
+            float *stream = data + c * m_capacity;
+            std::swap(stream[p], stream[alive]);
+        }
+        for(int c = 0; c < randomStride; c++) {
+            float *stream = random + c * m_capacity;
+            std::swap(stream[p], stream[alive]);
         }
     }
+
+    buffers.alive = alive;
+}
+/*!
+    \internal
+    Returns the number of floats in the instance data of the first renderable which is drawn by the kernel.
+*/
+int VisualEffect::kernelStride() const {
+    if(!m_renderables.empty()) {
+        return m_renderables.front().material->uniformSize() / sizeof(float);
+    }
+
+    return 0;
 }
 /*!
     \internal
@@ -400,57 +986,70 @@ void VisualEffect::loadUserData(const VariantMap &data) {
             loadRenderables((*it).value<VariantList>());
             it++;
 
-            loadOperations((*it).value<VariantList>(), m_emitterSpawnOperations);
+            m_constants.clear();
+            m_random.clear();
+            m_kernelDirty = true;
+
+            loadOperations((*it).value<VariantList>(), m_emitterSpawnProgram);
             it++;
-            loadOperations((*it).value<VariantList>(), m_emitterUpdateOperations);
+            loadOperations((*it).value<VariantList>(), m_emitterUpdateProgram);
             it++;
-            loadOperations((*it).value<VariantList>(), m_particleSpawnOperations);
+            loadOperations((*it).value<VariantList>(), m_particleSpawnProgram);
             it++;
-            loadOperations((*it).value<VariantList>(), m_particleUpdateOperations);
+            loadOperations((*it).value<VariantList>(), m_particleUpdateProgram);
             it++;
-            loadOperations((*it).value<VariantList>(), m_renderOperations);
+            loadOperations((*it).value<VariantList>(), m_renderProgram);
         }
     }
 }
 /*!
     \internal
 */
-void VisualEffect::loadOperations(const VariantList &list, std::vector<Operator> &operations) {
-    operations.clear();
+void VisualEffect::loadOperations(const VariantList &list, Program &program) {
+    program.clear();
 
     for(auto &it : list) {
         VariantList fields = it.value<VariantList>();
 
-        Operator op;
+        Instruction instruction;
         auto field = fields.begin();
-        op.op = static_cast<Operation>((*field).toInt());
+        instruction.op = static_cast<Operation>((*field).toInt());
         field++;
-        op.resultSpace = (*field).toInt();
+        instruction.result.space = (*field).toInt();
         field++;
-        op.resultSize = (*field).toInt();
+        instruction.result.size = (*field).toInt();
         field++;
-        op.resultOffset = (*field).toInt();
+        instruction.result.offset = (*field).toInt();
         field++;
 
+        // Missing arguments refer to the first component of the result
+        for(auto &argument : instruction.arguments) {
+            argument = {instruction.result.space, 1, instruction.result.offset};
+        }
+
+        int index = 0;
         for(Variant &arg : (*field).value<VariantList>()) {
+            if(index >= 3) {
+                break;
+            }
+
             VariantList argFields = arg.value<VariantList>();
 
             auto argField = argFields.begin();
 
-            Argument argument;
+            Argument &argument = instruction.arguments[index];
 
             argument.space = (*argField).toInt();
             argField++;
             argument.size = (*argField).toInt();
             argField++;
-            argument.offset = -1;
             switch(argument.space) {
                 case Constant: {
-                    argument.offset = op.constData.size();
-                    op.constData.resize(argument.offset + argument.size);
+                    argument.offset = m_constants.size();
+                    m_constants.resize(argument.offset + argument.size);
 
                     for(int i = 0; i < argument.size; i++) {
-                        op.constData[argument.offset + i] = (*argField).toFloat();
+                        m_constants[argument.offset + i] = (*argField).toFloat();
                         argField++;
                     }
                 } break;
@@ -467,23 +1066,29 @@ void VisualEffect::loadOperations(const VariantList &list, std::vector<Operator>
                         argField++;
                     }
 
-                    argument.offset = op.constData.size();
-                    op.constData.resize(argument.offset + m_capacity * argument.size);
-                    for(int p = 0; p < m_capacity; p++) {
-                        for(int i = 0; i < argument.size; i++) {
-                            op.constData[p * argument.size + argument.offset + i] = RANGE(min[i], max[i]);
+                    // Random values are stored as a stream of capacity() values per component like particle attributes
+                    argument.offset = static_cast<int32_t>(m_random.size()) / m_capacity;
+                    m_random.resize(m_random.size() + m_capacity * argument.size);
+                    for(int i = 0; i < argument.size; i++) {
+                        for(int p = 0; p < m_capacity; p++) {
+                            m_random[(argument.offset + i) * m_capacity + p] = RANGE(min[i], max[i]);
                         }
                     }
                 } break;
+                case Space::Renderable: {
+                    // Instance data can't be read back, the result is used instead
+                    argument.space = instruction.result.space;
+                    argument.offset = instruction.result.offset;
+                } break;
                 default: {
                     argument.offset = (*argField).toInt();
                 } break;
             }
 
-            op.arguments.push_back(argument);
+            index++;
         }
 
-        operations.push_back(op);
+        program.push_back(instruction);
     }
 }
 /*!
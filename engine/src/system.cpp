@@ -9,6 +9,8 @@
     \note All methods will be called internaly in the engine.
     \note Systems can process only components which registered in this system.
     \note Systems can be executed one by one or in parallel based on thread policy.
+    \note Systems should declare which component types and resources they read and write using declareRead() and declareWrite().
+    The engine executes systems with conflicting declarations one after another: writers of a type run before its readers, other conflicts keep the order of registration. All other systems may overlap.
 */
 
 /*!
@@ -75,3 +77,46 @@ void System::processEvents() {
 
     update(m_world);
 }
+/*!
+    Returns a set of component or resource types which this system reads during System::update.
+*/
+const std::set<TString> &System::reads() const {
+    return m_reads;
+}
+/*!
+    Returns a set of component or resource types which this system modifies during System::update.
+*/
+const std::set<TString> &System::writes() const {
+    return m_writes;
+}
+/*!
+    Returns true if this system and the \a other system can't be executed at the same time.
+    Systems conflict when one of them writes a type which the other reads or writes.
+*/
+bool System::isConflicting(const System *other) const {
+    for(auto &it : m_writes) {
+        if(other->m_writes.count(it) || other->m_reads.count(it)) {
+            return true;
+        }
+    }
+    for(auto &it : m_reads) {
+        if(other->m_writes.count(it)) {
+            return true;
+        }
+    }
+    return false;
+}
+/*!
+    Declares that this system reads data of the component or resource \a type.
+    Should be called in the constructor of the system.
+*/
+void System::declareRead(const TString &type) {
+    m_reads.insert(type);
+}
+/*!
+    Declares that this system modifies data of the component or resource \a type.
+    Should be called in the constructor of the system.
+*/
+void System::declareWrite(const TString &type) {
+    m_writes.insert(type);
+}
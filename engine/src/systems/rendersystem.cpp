@@ -79,6 +79,11 @@ RenderSystem::RenderSystem() :
     Tonemap::registerClassFactory(this);
     DepthOfField::registerClassFactory(this);
 
+    declareRead("Transform");
+    declareRead("Camera");
+    declareRead("Resource");
+    declareWrite("Renderable");
+
     setName("RenderSystem");
 }
 
@@ -138,6 +143,8 @@ void RenderSystem::update(World *world) {
     if(camera && m_pipelineContext) {
         PROFILER_RESET(POLYGONS);
         PROFILER_RESET(DRAWCALLS);
+        PROFILER_RESET(SPRITE_BATCHES);
+        PROFILER_RESET(BATCHED_SPRITES);
 
         m_pipelineContext->setWorld(world);
         m_pipelineContext->draw(camera);
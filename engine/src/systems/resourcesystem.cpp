@@ -3,11 +3,16 @@
 #include <bson.h>
 #include <json.h>
 #include <log.h>
+#include <jobsystem.h>
 
 #include <algorithm>
+#include <chrono>
 
 #include "file.h"
 
+#include "utils/assetcontainer.h"
+#include "utils/texturestreamer.h"
+
 #include "resources/resource.h"
 
 #include "resources/text.h"
@@ -37,13 +42,62 @@ namespace {
     static const char *gVersion("version");
     static const char *gContent("content");
     static const char *gSettings("settings");
+
+    const float gStreamingBudget(2.0f);
+
+    const uint64_t gCacheBudget(256 * 1024 * 1024);
+
+    bool readData(File &fp, AssetContainer &container, Variant &data) {
+        PROFILE_FUNCTION();
+
+        if(container.open(fp.fileName())) {
+            data = container.metadata();
+        } else {
+            ByteArray buffer(fp.readAll());
+            if(AssetContainer::isContainer(buffer.data(), buffer.size())) {
+                if(container.load(std::move(buffer), fp.fileName())) {
+                    data = container.metadata();
+                }
+            } else {
+                data = Bson::load(buffer);
+                if(!data.isValid()) {
+                    data = Json::load(TString(buffer));
+                }
+            }
+        }
+
+        return data.isValid();
+    }
 }
 
 #define INDEX_VERSION 2
 
+struct ResourceSystem::StreamResult {
+    Resource *resource = nullptr;
+
+    TString uuid;
+
+    AssetContainer container;
+
+    Variant data;
+
+    uint32_t ticket = 0;
+
+    bool opened = false;
+};
+
 ResourceSystem::ResourceSystem() :
+        m_jobSystem(nullptr),
+        m_streamCounter(new JobCounter),
+        m_textureStreamer(new TextureStreamer),
+        m_cacheBudget(gCacheBudget),
+        m_cachedMemory(0),
+        m_streamingBudget(gStreamingBudget),
+        m_inFlight(0),
+        m_nextTicket(0),
         m_clean(false) {
     setName("ResourceSystem");
+    declareWrite("Resource");
 
     // The order is critical for the import
     Resource::registerClassFactory(this);
@@ -79,6 +133,18 @@ ResourceSystem::ResourceSystem() :
 }
 
 ResourceSystem::~ResourceSystem() {
+    JobSystem *jobs = jobSystem();
+    if(jobs) {
+        jobs->wait(m_streamCounter);
+    }
+    delete m_streamCounter;
+
+    for(auto it : m_decoded) {
+        delete it;
+    }
+
+    delete m_textureStreamer;
+
     for(auto &it : m_referenceCache) {
         it.first->setState(Resource::ToBeDeleted);
     }
@@ -172,20 +238,14 @@ Resource *ResourceSystem::loadResource(const TString &path, uint32_t lod) {
         File fp(uuid);
         if(!m_clean || fp.exists()) {
             if(fp.open(File::Read)) {
-                ByteArray data(fp.readAll());
+                m_statistics.misses++;
 
-                Variant var = Bson::load(data);
-                if(!var.isValid()) {
-                    var = Json::load(TString(data));
+                resource = static_cast<Resource *>(readObject(fp, uuid));
+                if(resource) {
+                    resource->switchState(Resource::ToBeUpdated);
                 }
-                if(var.isValid()) {
-                    resource = static_cast<Resource *>(Engine::toObject(var, nullptr, uuid));
-                    if(resource) {
-                        resource->switchState(Resource::ToBeUpdated);
-                    }
 
-                    return resource;
-                }
+                return resource;
             }
         }
     }
@@ -217,6 +277,8 @@ Resource *ResourceSystem::loadResourceAsync(const TString &path, uint32_t lod) {
             if(resource == nullptr) {
                 if(!m_clean || File::isFile(info.uuid)) {
                     if(!info.type.isEmpty()) {
+                        m_statistics.misses++;
+
                         resource = static_cast<Resource *>(Engine::objectCreate(info.type, info.uuid, nullptr, info.id));
                         resource->setState(Resource::Loading);
                     }
@@ -232,9 +294,11 @@ Resource *ResourceSystem::loadResourceAsync(const TString &path, uint32_t lod) {
 void ResourceSystem::unloadResource(Resource *resource, bool force) {
     PROFILE_FUNCTION();
     if(resource) {
+        cancelResource(resource);
+
         resource->switchState(Resource::Unloading);
         if(force) {
-            processState(resource);
+            processState(resource, true);
         }
     }
 }
@@ -243,8 +307,10 @@ void ResourceSystem::reloadResource(Resource *resource, bool force) {
     PROFILE_FUNCTION();
     if(resource) {
         if(force) {
+            cancelResource(resource);
+
             resource->switchState(Resource::Loading);
-            processState(resource);
+            processState(resource, true);
         } else {
             resource->switchState(Resource::ToBeUpdated);
         }
@@ -302,6 +368,10 @@ ResourceSystem::Aliases &ResourceSystem::aliases() {
 
 void ResourceSystem::deleteFromCahe(Resource *resource) {
     PROFILE_FUNCTION();
+
+    cancelResource(resource);
+    uncacheResource(resource);
+
     auto ref = m_referenceCache.find(resource);
     if(ref != m_referenceCache.end()) {
         auto res = m_resourceCache.find(ref->second);
@@ -389,10 +459,16 @@ Object *ResourceSystem::instantiateObject(const MetaObject *meta, const TString
 void ResourceSystem::update(World *) {
     PROFILE_FUNCTION();
 
+    finalize();
+
     for(auto &it : m_referenceCache) {
         processState(it.first);
     }
 
+    dispatch();
+
+    m_textureStreamer->update();
+
     while(!m_deleteList.empty()) {
         Object *res = m_deleteList.back();
         m_deleteList.pop_back();
@@ -405,26 +481,32 @@ int ResourceSystem::threadPolicy() const {
     return Pool;
 }
 
-void ResourceSystem::processState(Resource *resource) {
+void ResourceSystem::processState(Resource *resource, bool force) {
     if(resource) {
-        switch(resource->state()) {
+        Resource::State state = resource->state();
+        if(state != Resource::Suspend && !m_cacheIndex.empty() && m_cacheIndex.find(resource) != m_cacheIndex.end()) {
+            // The resource was referenced again while it was in the cache
+            if(state != Resource::Unloading && state != Resource::ToBeDeleted) {
+                m_statistics.hits++;
+            }
+            uncacheResource(resource);
+        }
+
+        switch(state) {
         case Resource::Loading: {
             TString uuid = reference(resource);
-            if(!uuid.isEmpty()) {
+            if(uuid.isEmpty()) {
+                break;
+            }
+
+            if(!force && jobSystem()) {
+                request(resource, uuid);
+            } else {
                 File fp(uuid);
                 if(fp.open(File::Read)) {
-                    ByteArray data(fp.readAll());
+                    readObject(fp, uuid);
                     fp.close();
 
-                    Variant var = Bson::load(data);
-                    if(!var.isValid()) {
-                        var = Json::load(TString(data));
-                    }
-
-                    if(var.isValid()) {
-                        Engine::toObject(var, nullptr, uuid);
-                    }
-
                     resource->switchState(Resource::ToBeUpdated);
                 } else {
                     aError() << "Unable to load resource:" << uuid;
@@ -432,8 +514,8 @@ void ResourceSystem::processState(Resource *resource) {
                 }
             }
         } break;
-        case Resource::Suspend: { /// \todo Don't delete resource imidiately Cache pattern implementation required
-            //resource->switchState(Resource::Unloading);
+        case Resource::Suspend: {
+            cacheResource(resource);
         } break;
         case Resource::ToBeDeleted: {
             auto it = std::find(m_deleteList.begin(), m_deleteList.end(), resource);
@@ -446,6 +528,367 @@ void ResourceSystem::processState(Resource *resource) {
     }
 }
 
+/*!
+    \internal
+    Deserializes objects stored in the opened file \a fp and returns the root object created with \a uuid name.
+    Imported assets are stored in AssetContainer and mapped into memory when it's possible; legacy BSON and JSON files are read entirely.
+*/
+Object *ResourceSystem::readObject(File &fp, const TString &uuid) {
+    PROFILE_FUNCTION();
+
+    AssetContainer container;
+
+    // Objects are created straight from the BSON document
+    if(container.open(fp.fileName())) {
+        return deserialize(container.metadataReader(), container, uuid);
+    }
+
+    ByteArray buffer(fp.readAll());
+    if(AssetContainer::isContainer(buffer.data(), buffer.size())) {
+        if(container.load(std::move(buffer), fp.fileName())) {
+            return deserialize(container.metadataReader(), container, uuid);
+        }
+        return nullptr;
+    }
+
+    BsonReader reader(buffer);
+    if(reader.isValid()) {
+        return deserialize(reader, container, uuid);
+    }
+
+    Variant data = Json::load(TString(buffer));
+    if(data.isValid()) {
+        return deserialize(data, container, uuid);
+    }
+    return nullptr;
+}
+/*!
+    \internal
+    Creates objects from the serialized \a data using payloads of the \a container and returns the root object created with \a uuid name.
+*/
+Object *ResourceSystem::deserialize(const Variant &data, const AssetContainer &container, const TString &uuid) {
+    PROFILE_FUNCTION();
+
+    // Loading of the object may trigger loading of dependencies
+    const AssetContainer *previous = AssetContainer::current();
+    AssetContainer::setCurrent(&container);
+    Object *result = Engine::toObject(data, nullptr, uuid);
+    AssetContainer::setCurrent(previous);
+
+    return result;
+}
+/*!
+    \internal
+    Creates objects from the BSON document provided by \a reader using payloads of the \a container and returns the root object created with \a uuid name.
+*/
+Object *ResourceSystem::deserialize(const BsonReader &reader, const AssetContainer &container, const TString &uuid) {
+    PROFILE_FUNCTION();
+
+    const AssetContainer *previous = AssetContainer::current();
+    AssetContainer::setCurrent(&container);
+    Object *result = Engine::toObject(reader, nullptr, uuid);
+    AssetContainer::setCurrent(previous);
+
+    return result;
+}
+/*!
+    Sets the streaming \a priority for the \a resource which is waiting to be loaded.
+    Resources with lower values are loaded first, so the distance from the camera to the object which uses the resource is a good candidate.
+    Resources requested without the priority have priority 0.
+*/
+void ResourceSystem::setPriority(Resource *resource, float priority) {
+    std::unique_lock<std::mutex> locker(m_streamMutex);
+
+    for(auto &it : m_queue) {
+        if(it.resource == resource) {
+            it.priority = priority;
+            break;
+        }
+    }
+}
+/*!
+    Returns the resources which are waiting to be loaded in the order they will be dispatched to the worker threads.
+    Resources which are being read at the moment are not included.
+*/
+std::list<Resource *> ResourceSystem::streamingQueue() const {
+    std::unique_lock<std::mutex> locker(m_streamMutex);
+
+    std::vector<StreamRequest> queue(m_queue);
+    std::stable_sort(queue.begin(), queue.end(), lessImportant);
+
+    std::list<Resource *> result;
+    for(auto it = queue.rbegin(); it != queue.rend(); ++it) {
+        result.push_back(it->resource);
+    }
+    return result;
+}
+/*!
+    Cancels the pending streaming request for the \a resource.
+    If the resource is being read on a worker thread at the moment the result will be discarded.
+    The resource stays in its current state.
+*/
+void ResourceSystem::cancelResource(Resource *resource) {
+    std::unique_lock<std::mutex> locker(m_streamMutex);
+
+    auto it = m_tickets.find(resource);
+    if(it != m_tickets.end()) {
+        m_tickets.erase(it);
+
+        auto request = std::find_if(m_queue.begin(), m_queue.end(), [resource](const StreamRequest &request) {
+            return request.resource == resource;
+        });
+        if(request != m_queue.end()) {
+            m_queue.erase(request);
+        }
+    }
+}
+/*!
+    Returns the time budget in milliseconds for the finalization of streamed resources per update.
+*/
+float ResourceSystem::streamingBudget() const {
+    return m_streamingBudget;
+}
+/*!
+    Sets the time \a budget in milliseconds for the finalization of streamed resources per update.
+    Objects of streamed resources are created on the thread which updates the resource system, so the budget limits the time spent on it every frame.
+    At least one resource is finalized per update regardless of the budget.
+*/
+void ResourceSystem::setStreamingBudget(float budget) {
+    m_streamingBudget = budget;
+}
+/*!
+    Returns the number of resources which are queued, being read or waiting for the finalization.
+*/
+uint32_t ResourceSystem::streamingCount() const {
+    std::unique_lock<std::mutex> locker(m_streamMutex);
+
+    return m_tickets.size();
+}
+/*!
+    Returns the job system which reads and parses the streamed resources.
+    Returns Engine::jobSystem() unless another job system is set; resources are loaded synchronously if there is no job system.
+*/
+JobSystem *ResourceSystem::jobSystem() const {
+    return m_jobSystem ? m_jobSystem : Engine::jobSystem();
+}
+/*!
+    Sets the job  system which reads and parses the streamed resources.
+    The  system must outlive the resource system or be reset before the destruction.
+*/
+void ResourceSystem::setJobSystem(JobSystem *system) {
+    m_jobSystem = system;
+}
+/*!
+    Returns the streamer which manages mip levels of the streamed textures.
+*/
+TextureStreamer *ResourceSystem::textureStreamer() const {
+    return m_textureStreamer;
+}
+/*!
+    Returns the memory budget in bytes for the suspended resources.
+*/
+uint64_t ResourceSystem::cacheBudget() const {
+    return m_cacheBudget;
+}
+/*!
+    Sets the memory \a budget in bytes for the suspended resources.
+    Resources which are not referenced anymore stay in memory until the total size of such resources exceeds the budget.
+    After that the least recently suspended resources are unloaded.
+*/
+void ResourceSystem::setCacheBudget(uint64_t budget) {
+    m_cacheBudget = budget;
+
+    trimCache();
+}
+/*!
+    Returns statistics of the resource cache.
+    Hits are counted when a suspended resource is referenced again, misses are counted when a resource is read from the disk.
+    The memory occupied by all loaded resources is grouped by resource type.
+*/
+ResourceSystem::CacheStatistics ResourceSystem::cacheStatistics() const {
+    CacheStatistics result(m_statistics);
+    result.cachedCount = m_suspended.size();
+    result.cachedMemory = m_cachedMemory;
+
+    for(auto &it : m_referenceCache) {
+        TString type(it.first->typeName());
+        result.cpuMemory[type] += it.first->cpuMemory();
+        result.gpuMemory[type] += it.first->gpuMemory();
+    }
+
+    return result;
+}
+/*!
+    Resets counters of the cache hits, misses and evictions.
+*/
+void ResourceSystem::resetCacheStatistics() {
+    m_statistics = CacheStatistics();
+}
+/*!
+    \internal
+    Puts the suspended \a resource to the cache and unloads the least recently suspended resources if the cache exceeds the budget.
+*/
+void ResourceSystem::cacheResource(Resource *resource) {
+    if(m_cacheIndex.find(resource) != m_cacheIndex.end()) {
+        return;
+    }
+
+    uint64_t size = resource->cpuMemory() + resource->gpuMemory();
+
+    m_suspended.push_front(resource);
+    m_cacheIndex[resource] = {m_suspended.begin(), size};
+    m_cachedMemory += size;
+
+    trimCache();
+}
+/*!
+    \internal
+    Removes the \a resource from the cache.
+*/
+void ResourceSystem::uncacheResource(Resource *resource) {
+    auto it = m_cacheIndex.find(resource);
+    if(it != m_cacheIndex.end()) {
+        m_cachedMemory -= it->second.size;
+        m_suspended.erase(it->second.position);
+        m_cacheIndex.erase(it);
+    }
+}
+/*!
+    \internal
+    Unloads the least recently suspended resources until the cache fits the budget.
+*/
+void ResourceSystem::trimCache() {
+    while(m_cachedMemory > m_cacheBudget && !m_suspended.empty()) {
+        Resource *resource = m_suspended.back();
+        uncacheResource(resource);
+
+        m_statistics.evictions++;
+
+        unloadResource(resource);
+    }
+}
+/*!
+    \internal
+    Adds the \a resource with \a uuid to the streaming queue if it's not there yet.
+*/
+void ResourceSystem::request(Resource *resource, const TString &uuid) {
+    std::unique_lock<std::mutex> locker(m_streamMutex);
+
+    if(m_tickets.find(resource) == m_tickets.end()) {
+        uint32_t ticket = ++m_nextTicket;
+        m_tickets[resource] = ticket;
+        m_queue.push_back({resource, uuid, 0.0f, ticket});
+    }
+}
+/*!
+    \internal
+    Returns true if the \a left request must be loaded after the \a right one.
+    Requests with lower priority values go first, requests with the same priority are loaded in the order they were made.
+*/
+bool ResourceSystem::lessImportant(const StreamRequest &left, const StreamRequest &right) {
+    if(left.priority != right.priority) {
+        return left.priority > right.priority;
+    }
+    return left.ticket > right.ticket;
+}
+/*!
+    \internal
+    Starts reading and parsing of the most important queued resources on worker threads.
+*/
+void ResourceSystem::dispatch() {
+    PROFILE_FUNCTION();
+
+    JobSystem *jobs = jobSystem();
+    if(jobs == nullptr) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> locker(m_streamMutex);
+
+    // Leave a room for other jobs
+    uint32_t limit = std::max(jobs->threadCount() / 2, 1U);
+    if(m_queue.empty() || m_inFlight >= limit) {
+        return;
+    }
+
+    // Most important requests go to the end of the queue
+    std::stable_sort(m_queue.begin(), m_queue.end(), lessImportant);
+
+    while(!m_queue.empty() && m_inFlight < limit) {
+        StreamRequest request = m_queue.back();
+        m_queue.pop_back();
+
+        StreamResult *result = new StreamResult;
+        result->resource = request.resource;
+        result->uuid = request.uuid;
+        result->ticket = request.ticket;
+
+        ++m_inFlight;
+
+        jobs->dispatch([this, result]() {
+            File fp(result->uuid);
+            result->opened = fp.open(File::Read);
+            if(result->opened) {
+                readData(fp, result->container, result->data);
+                fp.close();
+            }
+
+            std::unique_lock<std::mutex> locker(m_streamMutex);
+            m_decoded.push_back(result);
+        }, m_streamCounter);
+    }
+}
+/*!
+    \internal
+    Creates objects for resources read by worker threads within the streaming budget.
+    Results of cancelled requests are discarded.
+*/
+void ResourceSystem::finalize() {
+    PROFILE_FUNCTION();
+
+    auto start = std::chrono::steady_clock::now();
+
+    while(true) {
+        StreamResult *result = nullptr;
+        {
+            std::unique_lock<std::mutex> locker(m_streamMutex);
+            if(m_decoded.empty()) {
+                break;
+            }
+            result = m_decoded.front();
+            m_decoded.pop_front();
+            --m_inFlight;
+
+            auto it = m_tickets.find(result->resource);
+            if(it != m_tickets.end() && it->second == result->ticket) {
+                m_tickets.erase(it);
+            } else {
+                result->resource = nullptr;
+            }
+        }
+
+        Resource *resource = result->resource;
+        if(resource && resource->state() == Resource::Loading) {
+            if(result->opened) {
+                if(result->data.isValid()) {
+                    deserialize(result->data, result->container, result->uuid);
+                }
+                resource->switchState(Resource::ToBeUpdated);
+            } else {
+                aError() << "Unable to load resource:" << result->uuid;
+                resource->setState(Resource::Invalid);
+            }
+        }
+
+        delete result;
+
+        std::chrono::duration<float, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if(elapsed.count() >= m_streamingBudget) {
+            break;
+        }
+    }
+}
+
 void ResourceSystem::removeObject(Object *object) {
     ObjectSystem::removeObject(object);
 
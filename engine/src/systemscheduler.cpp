@@ -0,0 +1,315 @@
+#include "systemscheduler.h"
+
+#include <jobsystem.h>
+
+#include <thread>
+#include <algorithm>
+
+#include "system.h"
+
+namespace {
+    static const char *gSeparator(", ");
+
+    // Returns true if the system writes data which the other system reads
+    bool isFeeding(const System *system, const System *other) {
+        for(auto &it : system->writes()) {
+            if(other->reads().count(it)) {
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+/*!
+    \class SystemScheduler
+    \brief The SystemScheduler class executes engine systems according to their data dependencies.
+    \inmodule Engine
+
+    The scheduler builds a dependency graph from data access declared by each System (see System::declareRead() and System::declareWrite()).
+    Systems which write a type are executed before the systems which read it regardless of the registration order.
+    Other conflicting systems, like two writers of the same type, are executed in order of registration; the registration order also breaks cyclic read and write dependencies.
+    Systems without conflicts are executed at the same time: systems with System::Pool policy are dispatched to the JobSystem, systems with System::Main policy are executed on the calling thread as soon as their inputs are ready.
+    Systems which don't declare any data access have no dependencies.
+
+    Execution time of each system is recorded every frame, see records() and dump().
+*/
+/*!
+    \class SystemScheduler::Record
+    \brief Execution record of a single system for the last frame.
+    \inmodule Engine
+*/
+
+SystemScheduler::SystemScheduler() :
+        m_criticalPath(0.0f),
+        m_dirty(true) {
+
+}
+
+SystemScheduler::~SystemScheduler() {
+    for(auto it : m_nodes) {
+        delete it;
+    }
+}
+/*!
+    Adds a \a system to the schedule.
+*/
+void SystemScheduler::addSystem(System *system) {
+    m_systems.push_back(system);
+    m_dirty = true;
+}
+/*!
+    Removes a \a system from the schedule.
+*/
+void SystemScheduler::removeSystem(System *system) {
+    m_systems.remove(system);
+    m_dirty = true;
+}
+/*!
+    Returns a list of scheduled systems in order of registration.
+    \note This is not the execution order, which is defined by data dependencies; see records() for the scheduled order.
+*/
+const std::list<System *> &SystemScheduler::systems() const {
+    return m_systems;
+}
+/*!
+    Returns a list of systems which must be finished before the \a system can start.
+*/
+std::list<System *> SystemScheduler::dependencies(System *system) {
+    if(m_dirty) {
+        build();
+    }
+
+    std::list<System *> result;
+    for(auto node : m_nodes) {
+        if(node->system == system) {
+            for(auto it : node->predecessors) {
+                result.push_back(it->system);
+            }
+            break;
+        }
+    }
+    return result;
+}
+/*!
+    Executes all systems for the \a world.
+    Systems with System::Pool policy are executed using \a jobs; if \a jobs is nullptr all systems are executed on the calling thread.
+    Returns when all systems are finished.
+*/
+void SystemScheduler::execute(World *world, JobSystem *jobs) {
+    PROFILE_FUNCTION();
+
+    if(m_dirty) {
+        build();
+    }
+
+    m_frameStart = std::chrono::steady_clock::now();
+
+    int32_t mainCount = 0;
+    for(auto node : m_nodes) {
+        node->remaining.store(node->predecessors.size());
+        node->ready.store(false);
+        node->main = (jobs == nullptr || node->system->threadPolicy() == System::Main);
+        if(node->main) {
+            ++mainCount;
+        }
+    }
+
+    JobCounter counter;
+
+    for(auto node : m_nodes) {
+        if(node->predecessors.empty()) {
+            launch(node, world, jobs, &counter);
+        }
+    }
+
+    while(mainCount > 0) {
+        bool progress = false;
+        for(auto node : m_nodes) {
+            if(node->main && node->ready.exchange(false)) {
+                run(node, world);
+                complete(node, world, jobs, &counter);
+                --mainCount;
+                progress = true;
+            }
+        }
+
+        if(!progress) {
+            if(jobs == nullptr || !jobs->tryExecute()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    if(jobs) {
+        jobs->wait(&counter);
+    }
+
+    record();
+}
+/*!
+    Returns execution records of the last frame in the scheduled order: writers of a type come before its readers.
+*/
+const SystemScheduler::Records &SystemScheduler::records() const {
+    return m_records;
+}
+/*!
+    Returns the duration of the critical path of the last frame in milliseconds.
+    The critical path is the longest chain of dependent systems.
+*/
+float SystemScheduler::criticalPath() const {
+    return m_criticalPath;
+}
+/*!
+    Returns a human readable schedule of the last frame.
+    Each line contains a system name, a thread index, start and end time in milliseconds relative to the frame start and list of dependencies.
+    Systems on the critical path are marked with an asterisk.
+*/
+TString SystemScheduler::dump() const {
+    float total = 0.0f;
+    for(auto &it : m_records) {
+        total = std::max(total, it.end);
+    }
+
+    TString result = TString("Frame: %1 ms, critical path: %2 ms\n").arg(TString::number(total), TString::number(m_criticalPath));
+
+    auto record = m_records.begin();
+    for(auto node : m_nodes) {
+        if(record == m_records.end()) {
+            break;
+        }
+
+        StringList names;
+        for(auto it : node->predecessors) {
+            names.push_back(it->system->name());
+        }
+
+        result += TString("%1 %2 thread: %3 [%4 - %5 ms] after: %6\n").arg(record->critical ? "*" : " ",
+                                                                             node->system->name(),
+                                                                             TString::number(record->thread),
+                                                                             TString::number(record->start),
+                                                                             TString::number(record->end),
+                                                                             names.empty() ? TString("-") : TString::join(names, gSeparator));
+        ++record;
+    }
+
+    return result;
+}
+
+void SystemScheduler::build() {
+    for(auto it : m_nodes) {
+        delete it;
+    }
+    m_nodes.clear();
+
+    // Writers go before readers, the earliest registered system is taken when there is a choice
+    std::list<System *> pending(m_systems);
+    while(!pending.empty()) {
+        auto next = pending.begin();
+        for(auto it = pending.begin(); it != pending.end(); ++it) {
+            bool blocked = false;
+            for(auto other : pending) {
+                if(other != *it && isFeeding(other, *it)) {
+                    blocked = true;
+                    break;
+                }
+            }
+            if(!blocked) {
+                next = it;
+                break;
+            }
+        }
+
+        System *system = *next;
+        pending.erase(next);
+
+        Node *node = new Node;
+        node->system = system;
+
+        for(auto previous : m_nodes) {
+            if(system->isConflicting(previous->system)) {
+                previous->successors.push_back(node);
+                node->predecessors.push_back(previous);
+            }
+        }
+
+        m_nodes.push_back(node);
+    }
+
+    m_records.clear();
+    m_criticalPath = 0.0f;
+
+    m_dirty = false;
+}
+
+void SystemScheduler::launch(Node *node, World *world, JobSystem *jobs, JobCounter *counter) {
+    if(node->main) {
+        node->ready.store(true);
+    } else {
+        jobs->dispatch([this, node, world, jobs, counter]() {
+            run(node, world);
+            complete(node, world, jobs, counter);
+        }, counter);
+    }
+}
+
+void SystemScheduler::run(Node *node, World *world) {
+    PROFILE_FUNCTION();
+
+    node->thread = std::max(JobSystem::currentThreadIndex(), 0);
+    node->start = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_frameStart).count();
+
+    node->system->setActiveWorld(world);
+    node->system->processEvents();
+
+    node->end = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_frameStart).count();
+}
+
+void SystemScheduler::complete(Node *node, World *world, JobSystem *jobs, JobCounter *counter) {
+    for(auto it : node->successors) {
+        if(it->remaining.fetch_sub(1) == 1) {
+            launch(it, world, jobs, counter);
+        }
+    }
+}
+
+void SystemScheduler::record() {
+    m_records.resize(m_nodes.size());
+
+    // Nodes are topologically sorted by construction
+    std::vector<float> path(m_nodes.size(), 0.0f);
+    std::vector<int32_t> previous(m_nodes.size(), -1);
+
+    int32_t last = -1;
+    m_criticalPath = 0.0f;
+    for(size_t i = 0; i < m_nodes.size(); i++) {
+        Node *node = m_nodes[i];
+
+        Record &record = m_records[i];
+        record.system = node->system;
+        record.thread = node->thread;
+        record.start = node->start;
+        record.end = node->end;
+        record.critical = false;
+
+        float longest = 0.0f;
+        for(auto it : node->predecessors) {
+            size_t index = std::find(m_nodes.begin(), m_nodes.end(), it) - m_nodes.begin();
+            if(path[index] > longest) {
+                longest = path[index];
+                previous[i] = index;
+            }
+        }
+        path[i] = longest + (node->end - node->start);
+
+        if(path[i] > m_criticalPath) {
+            m_criticalPath = path[i];
+            last = i;
+        }
+    }
+
+    while(last >= 0) {
+        m_records[last].critical = true;
+        last = previous[last];
+    }
+}
@@ -0,0 +1,337 @@
+#include "utils/assetcontainer.h"
+
+#include <file.h>
+
+#include <cstring>
+
+namespace {
+    const uint32_t gMagic(0x31434154); // "TAC1"
+    const uint32_t gVersion(1);
+    const uint64_t gAlignment(64);
+
+    const char *gSectionTypes[] = { "Texture", "Mesh" };
+
+    uint64_t align(uint64_t value) {
+        return (value + gAlignment - 1) & ~(gAlignment - 1);
+    }
+
+    Variant extract(const Variant &value, std::vector<const ByteArray *> &blobs) {
+        switch(value.type()) {
+            case MetaType::BYTEARRAY: {
+                blobs.push_back(reinterpret_cast<const ByteArray *>(value.data()));
+                // Section 0 is reserved for metadata
+                return static_cast<int32_t>(blobs.size());
+            }
+            case MetaType::VARIANTLIST: {
+                VariantList result;
+                for(auto &it : *reinterpret_cast<const VariantList *>(value.data())) {
+                    result.push_back(extract(it, blobs));
+                }
+                return result;
+            }
+            case MetaType::VARIANTMAP: {
+                VariantMap result;
+                for(auto &it : *reinterpret_cast<const VariantMap *>(value.data())) {
+                    result[it.first] = extract(it.second, blobs);
+                }
+                return result;
+            }
+            default: break;
+        }
+        return value;
+    }
+}
+
+static thread_local const AssetContainer *t_current = nullptr;
+
+/*!
+    \class AssetContainer
+    \brief The AssetContainer class reads and writes the binary container of imported resources.
+    \inmodule Engine
+
+    The container starts with an aligned header followed by a table of sections.
+    Section 0 contains BSON serialized objects, all other sections contain raw payloads (mip levels of textures, vertex and index buffers of meshes) aligned to 64 bytes.
+    In the serialized user data of Texture and Mesh objects each binary blob is replaced by the index of its section.
+
+    The resource system maps containers into memory with File::map() when the file handler supports it, so payloads are copied only once, straight into the resource storage.
+    Files which can't be mapped (for example packed into an archive) are read into memory entirely.
+
+    While objects are deserialized the container is installed with setCurrent() for the calling thread; resources use blob() to access payloads regardless of the storage format.
+*/
+
+AssetContainer::AssetContainer() :
+        m_data(nullptr),
+        m_size(0),
+        m_sections(nullptr),
+        m_count(0),
+        m_mapped(false) {
+
+}
+
+AssetContainer::~AssetContainer() {
+    close();
+}
+/*!
+    Maps the container file with \a path into memory.
+    Returns false if the file can't be mapped or it isn't a valid container; use load() to read such files.
+*/
+bool AssetContainer::open(const TString &path) {
+    close();
+
+    void *data = File::map(path, m_size);
+    if(data == nullptr) {
+        return false;
+    }
+
+    m_data = static_cast<const uint8_t *>(data);
+    m_mapped = true;
+    m_path = path;
+
+    if(!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+/*!
+    Takes ownership of the container content \a data.
+    The optional \a path of the file the data was read from lets resources read their sections again later.
+    Returns false if the data isn't a valid container.
+*/
+bool AssetContainer::load(ByteArray data, const TString &path) {
+    close();
+
+    m_path = path;
+    m_buffer.swap(data);
+    m_data = m_buffer.data();
+    m_size = m_buffer.size();
+
+    if(!parse()) {
+        close();
+        return false;
+    }
+    return true;
+}
+/*!
+    Unmaps or releases the container content.
+    Pointers returned by section() become invalid.
+*/
+void AssetContainer::close() {
+    if(m_mapped) {
+        File::unmap(const_cast<uint8_t *>(m_data), m_size);
+    }
+    m_buffer.clear();
+    m_buffer.shrink_to_fit();
+    m_path.clear();
+
+    m_data = nullptr;
+    m_size = 0;
+    m_sections = nullptr;
+    m_count = 0;
+    m_mapped = false;
+}
+/*!
+    Returns true if the container is opened and valid.
+*/
+bool AssetContainer::isValid() const {
+    return m_sections != nullptr;
+}
+/*!
+    Returns true if the container content is mapped from a file.
+*/
+bool AssetContainer::isMapped() const {
+    return m_mapped;
+}
+/*!
+    Returns the path to the container file or an empty string if it's unknown.
+*/
+TString AssetContainer::path() const {
+    return m_path;
+}
+/*!
+    Returns the number of sections including the metadata section.
+*/
+uint32_t AssetContainer::sectionCount() const {
+    return m_count;
+}
+/*!
+    Returns a pointer to the payload of the section with \a index or nullptr if the index is out of range.
+*/
+const uint8_t *AssetContainer::section(uint32_t index) const {
+    if(index < m_count) {
+        return m_data + m_sections[index].offset;
+    }
+    return nullptr;
+}
+/*!
+    Returns the offset in bytes of the section with \a index from the beginning of the container file.
+*/
+uint64_t AssetContainer::sectionOffset(uint32_t index) const {
+    if(index < m_count) {
+        return m_sections[index].offset;
+    }
+    return 0;
+}
+/*!
+    Returns the size in bytes of the section with \a index.
+*/
+uint64_t AssetContainer::sectionSize(uint32_t index) const {
+    if(index < m_count) {
+        return m_sections[index].size;
+    }
+    return 0;
+}
+/*!
+    Returns deserialized objects stored in the metadata section.
+*/
+Variant AssetContainer::metadata() const {
+    PROFILE_FUNCTION();
+
+    if(m_count > 0) {
+        return Bson::load(section(0), sectionSize(0));
+    }
+    return Variant();
+}
+/*!
+    Returns the reader for objects stored in the metadata section.
+    Objects can be created from it with Engine::toObject() without building the intermediate Variant structure.
+*/
+BsonReader AssetContainer::metadataReader() const {
+    if(m_count > 0) {
+        return BsonReader(section(0), sectionSize(0));
+    }
+    return BsonReader();
+}
+/*!
+    Returns true if the \a data with \a size starts with a container header.
+*/
+bool AssetContainer::isContainer(const uint8_t *data, size_t size) {
+    uint32_t magic = 0;
+    if(data && size >= sizeof(Header)) {
+        memcpy(&magic, data, sizeof(magic));
+    }
+    return magic == gMagic;
+}
+/*!
+    Packs serialized \a objects into the container format.
+    Binary blobs from the user data of Texture and Mesh objects are moved to separate sections.
+*/
+ByteArray AssetContainer::pack(const Variant &objects) {
+    PROFILE_FUNCTION();
+
+    std::vector<const ByteArray *> blobs;
+
+    VariantList list;
+    for(auto &it : objects.toList()) {
+        VariantList object = it.toList();
+        if(object.size() > 1) {
+            TString type = object.front().toString();
+            for(auto section : gSectionTypes) {
+                if(type == section) {
+                    object.back() = extract(object.back(), blobs);
+                    break;
+                }
+            }
+        }
+        list.push_back(object);
+    }
+
+    ByteArray meta(Bson::save(list));
+
+    uint32_t count = blobs.size() + 1;
+
+    std::vector<Section> sections(count);
+    uint64_t offset = align(sizeof(Header) + sizeof(Section) * count);
+    for(uint32_t i = 0; i < count; i++) {
+        sections[i].offset = offset;
+        sections[i].size = (i == 0) ? meta.size() : blobs[i - 1]->size();
+
+        offset = align(offset + sections[i].size);
+    }
+
+    Header header;
+    header.magic = gMagic;
+    header.version = gVersion;
+    header.sections = count;
+    header.reserved = 0;
+    header.table = sizeof(Header);
+    header.size = offset;
+
+    ByteArray result(offset, 0);
+    memcpy(result.data(), &header, sizeof(Header));
+    memcpy(result.data() + header.table, sections.data(), sizeof(Section) * count);
+    for(uint32_t i = 0; i < count; i++) {
+        const ByteArray &data = (i == 0) ? meta : *blobs[i - 1];
+        if(!data.empty()) {
+            memcpy(result.data() + sections[i].offset, data.data(), data.size());
+        }
+    }
+
+    return result;
+}
+/*!
+    Returns the container installed for the calling thread or nullptr.
+*/
+const AssetContainer *AssetContainer::current() {
+    return t_current;
+}
+/*!
+    Installs the \a container for the calling thread; loaders of the resources use it to resolve section references.
+*/
+void AssetContainer::setCurrent(const AssetContainer *container) {
+    t_current = container;
+}
+/*!
+    Resolves a binary blob stored in the serialized \a value.
+    The \a value can be a ByteArray or an index of the section in the current() container.
+    On success writes a pointer to the payload into \a data and its \a size; the memory is valid while the value or the container is alive.
+    Returns false if the value doesn't reference a binary blob.
+*/
+bool AssetContainer::blob(const Variant &value, const uint8_t *&data, size_t &size) {
+    switch(value.type()) {
+        case MetaType::BYTEARRAY: {
+            const ByteArray *array = reinterpret_cast<const ByteArray *>(value.data());
+            data = array->data();
+            size = array->size();
+            return true;
+        }
+        case MetaType::INTEGER: {
+            int32_t index = value.toInt();
+            if(t_current && index > 0 && uint32_t(index) < t_current->sectionCount()) {
+                data = t_current->section(index);
+                size = t_current->sectionSize(index);
+                return true;
+            }
+        } break;
+        default: break;
+    }
+
+    data = nullptr;
+    size = 0;
+    return false;
+}
+
+bool AssetContainer::parse() {
+    if(!isContainer(m_data, m_size)) {
+        return false;
+    }
+
+    Header header;
+    memcpy(&header, m_data, sizeof(Header));
+    if(header.version != gVersion || header.sections == 0 || header.size > m_size || (header.table % sizeof(uint64_t)) != 0 ||
+       header.table + uint64_t(header.sections) * sizeof(Section) > m_size) {
+        return false;
+    }
+
+    const Section *sections = reinterpret_cast<const Section *>(m_data + header.table);
+    for(uint32_t i = 0; i < header.sections; i++) {
+        if(sections[i].offset > m_size || sections[i].size > m_size - sections[i].offset) {
+            return false;
+        }
+    }
+
+    m_sections = sections;
+    m_count = header.sections;
+
+    return true;
+}
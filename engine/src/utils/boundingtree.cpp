@@ -0,0 +1,530 @@
+#include "utils/boundingtree.h"
+
+namespace {
+    const int32_t gNull(-1);
+
+    inline Vector3 minimum(const Vector3 &a, const Vector3 &b) {
+        return Vector3(std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z));
+    }
+
+    inline Vector3 maximum(const Vector3 &a, const Vector3 &b) {
+        return Vector3(std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z));
+    }
+
+    inline float area(const Vector3 &min, const Vector3 &max) {
+        Vector3 d(max - min);
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    inline bool overlaps(const Vector3 &aMin, const Vector3 &aMax, const Vector3 &bMin, const Vector3 &bMax) {
+        return aMin.x <= bMax.x && aMax.x >= bMin.x &&
+               aMin.y <= bMax.y && aMax.y >= bMin.y &&
+               aMin.z <= bMax.z && aMax.z >= bMin.z;
+    }
+}
+
+/*!
+    \class BoundingTree
+    \brief The BoundingTree class is a dynamic bounding volume hierarchy of axis aligned boxes.
+    \inmodule Engine
+
+    Each object is stored in a leaf with a box enlarged by a margin, so small movements don't require any changes in the tree structure.
+    The tree is kept balanced using rotations on each insertion and removal.
+    Queries visit only the branches which intersect the query volume.
+
+    \note The tree is not thread safe.
+*/
+
+/*!
+    Constructs an empty tree.
+    Boxes of the leaves are enlarged by a \a margin relative to their extent; zero margin should be used for objects which never move.
+*/
+BoundingTree::BoundingTree(float margin) :
+        m_root(gNull),
+        m_free(gNull),
+        m_count(0),
+        m_margin(margin) {
+
+}
+/*!
+    Inserts an \a object with bounding \a box to the tree.
+    Returns a proxy identifier which must be used to update or remove the object.
+*/
+int32_t BoundingTree::insert(const AABBox &box, Object *object) {
+    int32_t proxy = allocate();
+
+    Vector3 margin(box.extent * m_margin);
+
+    Node &node = m_nodes[proxy];
+    node.min = box.center - box.extent - margin;
+    node.max = box.center + box.extent + margin;
+    node.object = object;
+    node.height = 0;
+
+    insertLeaf(proxy);
+
+    ++m_count;
+
+    return proxy;
+}
+/*!
+    Removes an object with \a proxy identifier from the tree.
+*/
+void BoundingTree::remove(int32_t proxy) {
+    removeLeaf(proxy);
+    release(proxy);
+
+    --m_count;
+}
+/*!
+    Updates bounding \a box of an object with \a proxy identifier.
+    Returns true if the tree was restructured; returns false if the new box fits into the enlarged box of the leaf.
+*/
+bool BoundingTree::update(int32_t proxy, const AABBox &box) {
+    Node &node = m_nodes[proxy];
+
+    Vector3 min(box.center - box.extent);
+    Vector3 max(box.center + box.extent);
+
+    if(node.min.x <= min.x && node.min.y <= min.y && node.min.z <= min.z &&
+       node.max.x >= max.x && node.max.y >= max.y && node.max.z >= max.z) {
+        return false;
+    }
+
+    removeLeaf(proxy);
+
+    Vector3 margin(box.extent * m_margin);
+
+    Node &leaf = m_nodes[proxy];
+    leaf.min = min - margin;
+    leaf.max = max + margin;
+
+    insertLeaf(proxy);
+
+    return true;
+}
+/*!
+    Returns an object with \a proxy identifier.
+*/
+Object *BoundingTree::object(int32_t proxy) const {
+    return m_nodes[proxy].object;
+}
+/*!
+    Returns an enlarged box of the leaf with \a proxy identifier.
+*/
+AABBox BoundingTree::fatBox(int32_t proxy) const {
+    AABBox result;
+    result.setBox(m_nodes[proxy].min, m_nodes[proxy].max);
+    return result;
+}
+/*!
+    Removes all objects from the tree.
+*/
+void BoundingTree::clear() {
+    m_nodes.clear();
+    m_root = gNull;
+    m_free = gNull;
+    m_count = 0;
+}
+/*!
+    Returns the number of objects in the tree.
+*/
+int32_t BoundingTree::count() const {
+    return m_count;
+}
+/*!
+    Returns the height of the tree; an empty tree has height -1 and a tree with a single object has height 0.
+*/
+int32_t BoundingTree::height() const {
+    return (m_root == gNull) ? -1 : m_nodes[m_root].height;
+}
+/*!
+    Appends objects which boxes are inside or intersect the \a frustum to the \a result list.
+    Branches which are entirely inside the frustum are collected without further tests.
+*/
+void BoundingTree::query(const Frustum &frustum, Object::ObjectList &result) const {
+    PROFILE_FUNCTION();
+
+    if(m_root == gNull) {
+        return;
+    }
+
+    const Plane *planes[6] = { &frustum.m_top, &frustum.m_bottom, &frustum.m_left, &frustum.m_right, &frustum.m_near, &frustum.m_far };
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+
+    while(!stack.empty()) {
+        int32_t index = stack.back();
+        stack.pop_back();
+
+        const Node &node = m_nodes[index];
+
+        Vector3 center((node.min + node.max) * 0.5f);
+        Vector3 extent((node.max - node.min) * 0.5f);
+
+        bool outside = false;
+        bool inside = true;
+        for(int i = 0; i < 6; i++) {
+            const Vector3 &n = planes[i]->normal;
+
+            float d = n.dot(center) - planes[i]->d;
+            float r = fabsf(n.x) * extent.x + fabsf(n.y) * extent.y + fabsf(n.z) * extent.z;
+
+            if(d < -r) {
+                outside = true;
+                break;
+            }
+            if(d < r) {
+                inside = false;
+            }
+        }
+
+        if(outside) {
+            continue;
+        }
+
+        if(inside) {
+            collect(index, result);
+        } else if(node.isLeaf()) {
+            result.push_back(node.object);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+/*!
+    Appends objects which boxes intersect a sphere with \a center and \a radius to the \a result list.
+*/
+void BoundingTree::query(const Vector3 &center, float radius, Object::ObjectList &result) const {
+    PROFILE_FUNCTION();
+
+    if(m_root == gNull) {
+        return;
+    }
+
+    float sqrRadius = radius * radius;
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+
+    while(!stack.empty()) {
+        const Node &node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        Vector3 closest(maximum(node.min, minimum(center, node.max)));
+        if((closest - center).sqrLength() > sqrRadius) {
+            continue;
+        }
+
+        if(node.isLeaf()) {
+            result.push_back(node.object);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+/*!
+    Appends objects which boxes intersect the \a box to the \a result list.
+*/
+void BoundingTree::query(const AABBox &box, Object::ObjectList &result) const {
+    PROFILE_FUNCTION();
+
+    if(m_root == gNull) {
+        return;
+    }
+
+    Vector3 min(box.center - box.extent);
+    Vector3 max(box.center + box.extent);
+
+    std::vector<int32_t> stack;
+    stack.reserve(64);
+    stack.push_back(m_root);
+
+    while(!stack.empty()) {
+        const Node &node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        if(!overlaps(node.min, node.max, min, max)) {
+            continue;
+        }
+
+        if(node.isLeaf()) {
+            result.push_back(node.object);
+        } else {
+            stack.push_back(node.left);
+            stack.push_back(node.right);
+        }
+    }
+}
+
+int32_t BoundingTree::allocate() {
+    if(m_free == gNull) {
+        m_nodes.push_back(Node());
+        return m_nodes.size() - 1;
+    }
+
+    int32_t index = m_free;
+    m_free = m_nodes[index].parent;
+
+    m_nodes[index] = Node();
+    return index;
+}
+
+void BoundingTree::release(int32_t index) {
+    Node &node = m_nodes[index];
+    node.object = nullptr;
+    node.left = gNull;
+    node.right = gNull;
+    node.height = -1;
+    node.parent = m_free;
+
+    m_free = index;
+}
+
+void BoundingTree::insertLeaf(int32_t leaf) {
+    if(m_root == gNull) {
+        m_root = leaf;
+        m_nodes[leaf].parent = gNull;
+        return;
+    }
+
+    Vector3 leafMin(m_nodes[leaf].min);
+    Vector3 leafMax(m_nodes[leaf].max);
+
+    // Find the best sibling using the surface area heuristic
+    int32_t index = m_root;
+    while(!m_nodes[index].isLeaf()) {
+        const Node &node = m_nodes[index];
+
+        float nodeArea = area(node.min, node.max);
+        float combinedArea = area(minimum(node.min, leafMin), maximum(node.max, leafMax));
+
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - nodeArea);
+
+        float costs[2];
+        int32_t children[2] = { node.left, node.right };
+        for(int i = 0; i < 2; i++) {
+            const Node &child = m_nodes[children[i]];
+            float childArea = area(minimum(child.min, leafMin), maximum(child.max, leafMax));
+            if(!child.isLeaf()) {
+                childArea -= area(child.min, child.max);
+            }
+            costs[i] = childArea + inheritance;
+        }
+
+        if(cost < costs[0] && cost < costs[1]) {
+            break;
+        }
+
+        index = (costs[0] < costs[1]) ? children[0] : children[1];
+    }
+
+    int32_t sibling = index;
+
+    int32_t parent = allocate();
+
+    int32_t oldParent = m_nodes[sibling].parent;
+
+    Node &node = m_nodes[parent];
+    node.parent = oldParent;
+    node.min = minimum(leafMin, m_nodes[sibling].min);
+    node.max = maximum(leafMax, m_nodes[sibling].max);
+    node.height = m_nodes[sibling].height + 1;
+    node.left = sibling;
+    node.right = leaf;
+
+    if(oldParent != gNull) {
+        if(m_nodes[oldParent].left == sibling) {
+            m_nodes[oldParent].left = parent;
+        } else {
+            m_nodes[oldParent].right = parent;
+        }
+    } else {
+        m_root = parent;
+    }
+
+    m_nodes[sibling].parent = parent;
+    m_nodes[leaf].parent = parent;
+
+    refit(m_nodes[leaf].parent);
+}
+
+void BoundingTree::removeLeaf(int32_t leaf) {
+    if(leaf == m_root) {
+        m_root = gNull;
+        return;
+    }
+
+    int32_t parent = m_nodes[leaf].parent;
+    int32_t grandParent = m_nodes[parent].parent;
+    int32_t sibling = (m_nodes[parent].left == leaf) ? m_nodes[parent].right : m_nodes[parent].left;
+
+    if(grandParent != gNull) {
+        if(m_nodes[grandParent].left == parent) {
+            m_nodes[grandParent].left = sibling;
+        } else {
+            m_nodes[grandParent].right = sibling;
+        }
+        m_nodes[sibling].parent = grandParent;
+        release(parent);
+
+        refit(grandParent);
+    } else {
+        m_root = sibling;
+        m_nodes[sibling].parent = gNull;
+        release(parent);
+    }
+
+    m_nodes[leaf].parent = gNull;
+}
+
+int32_t BoundingTree::balance(int32_t a) {
+    Node &nodeA = m_nodes[a];
+    if(nodeA.isLeaf() || nodeA.height < 2) {
+        return a;
+    }
+
+    int32_t b = nodeA.left;
+    int32_t c = nodeA.right;
+
+    Node &nodeB = m_nodes[b];
+    Node &nodeC = m_nodes[c];
+
+    int32_t delta = nodeC.height - nodeB.height;
+
+    // Rotate C up
+    if(delta > 1) {
+        int32_t f = nodeC.left;
+        int32_t g = nodeC.right;
+
+        Node &nodeF = m_nodes[f];
+        Node &nodeG = m_nodes[g];
+
+        nodeC.left = a;
+        nodeC.parent = nodeA.parent;
+        nodeA.parent = c;
+
+        if(nodeC.parent != gNull) {
+            if(m_nodes[nodeC.parent].left == a) {
+                m_nodes[nodeC.parent].left = c;
+            } else {
+                m_nodes[nodeC.parent].right = c;
+            }
+        } else {
+            m_root = c;
+        }
+
+        if(nodeF.height > nodeG.height) {
+            nodeC.right = f;
+            nodeA.right = g;
+            nodeG.parent = a;
+
+            nodeA.min = minimum(nodeB.min, nodeG.min);
+            nodeA.max = maximum(nodeB.max, nodeG.max);
+            nodeC.min = minimum(nodeA.min, nodeF.min);
+            nodeC.max = maximum(nodeA.max, nodeF.max);
+
+            nodeA.height = 1 + std::max(nodeB.height, nodeG.height);
+            nodeC.height = 1 + std::max(nodeA.height, nodeF.height);
+        } else {
+            nodeC.right = g;
+            nodeA.right = f;
+            nodeF.parent = a;
+
+            nodeA.min = minimum(nodeB.min, nodeF.min);
+            nodeA.max = maximum(nodeB.max, nodeF.max);
+            nodeC.min = minimum(nodeA.min, nodeG.min);
+            nodeC.max = maximum(nodeA.max, nodeG.max);
+
+            nodeA.height = 1 + std::max(nodeB.height, nodeF.height);
+            nodeC.height = 1 + std::max(nodeA.height, nodeG.height);
+        }
+
+        return c;
+    }
+
+    // Rotate B up
+    if(delta < -1) {
+        int32_t d = nodeB.left;
+        int32_t e = nodeB.right;
+
+        Node &nodeD = m_nodes[d];
+        Node &nodeE = m_nodes[e];
+
+        nodeB.left = a;
+        nodeB.parent = nodeA.parent;
+        nodeA.parent = b;
+
+        if(nodeB.parent != gNull) {
+            if(m_nodes[nodeB.parent].left == a) {
+                m_nodes[nodeB.parent].left = b;
+            } else {
+                m_nodes[nodeB.parent].right = b;
+            }
+        } else {
+            m_root = b;
+        }
+
+        if(nodeD.height > nodeE.height) {
+            nodeB.right = d;
+            nodeA.left = e;
+            nodeE.parent = a;
+
+            nodeA.min = minimum(nodeC.min, nodeE.min);
+            nodeA.max = maximum(nodeC.max, nodeE.max);
+            nodeB.min = minimum(nodeA.min, nodeD.min);
+            nodeB.max = maximum(nodeA.max, nodeD.max);
+
+            nodeA.height = 1 + std::max(nodeC.height, nodeE.height);
+            nodeB.height = 1 + std::max(nodeA.height, nodeD.height);
+        } else {
+            nodeB.right = e;
+            nodeA.left = d;
+            nodeD.parent = a;
+
+            nodeA.min = minimum(nodeC.min, nodeD.min);
+            nodeA.max = maximum(nodeC.max, nodeD.max);
+            nodeB.min = minimum(nodeA.min, nodeE.min);
+            nodeB.max = maximum(nodeA.max, nodeE.max);
+
+            nodeA.height = 1 + std::max(nodeC.height, nodeD.height);
+            nodeB.height = 1 + std::max(nodeA.height, nodeE.height);
+        }
+
+        return b;
+    }
+
+    return a;
+}
+
+void BoundingTree::refit(int32_t index) {
+    while(index != gNull) {
+        index = balance(index);
+
+        Node &node = m_nodes[index];
+        const Node &left = m_nodes[node.left];
+        const Node &right = m_nodes[node.right];
+
+        node.height = 1 + std::max(left.height, right.height);
+        node.min = minimum(left.min, right.min);
+        node.max = maximum(left.max, right.max);
+
+        index = node.parent;
+    }
+}
+
+void BoundingTree::collect(int32_t index, Object::ObjectList &result) const {
+    const Node &node = m_nodes[index];
+    if(node.isLeaf()) {
+        result.push_back(node.object);
+    } else {
+        collect(node.left, result);
+        collect(node.right, result);
+    }
+}
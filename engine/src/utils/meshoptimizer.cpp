@@ -0,0 +1,863 @@
+#include "utils/meshoptimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+    // Parameters of the vertex cache model from "Linear-Speed Vertex Cache Optimisation" by Tom Forsyth
+    const uint32_t gCacheSize(32);
+    const float gCacheDecayPower(1.5f);
+    const float gLastTriangleScore(0.75f);
+    const float gValenceBoostScale(2.0f);
+    const float gValenceBoostPower(0.5f);
+
+    // Size of the FIFO cache used to find cluster boundaries for overdraw optimization
+    const uint32_t gFifoSize(16);
+
+    const uint32_t gUnused(0xffffffff);
+
+    // Weight of texture coordinate and normal differences relative to the squared mesh radius
+    const float gAttributeWeight(0.5f);
+
+    // Size of a pixel in normalized device coordinates at 1080p, used to derive LOD switch distances from the geometric error
+    const float gLodPixelError(0.002f);
+
+    struct Quadric {
+        double a00 = 0.0, a01 = 0.0, a02 = 0.0, a11 = 0.0, a12 = 0.0, a22 = 0.0;
+        double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+        double c = 0.0;
+
+        void addPlane(const Vector3 &n, float d, float weight) {
+            a00 += weight * n.x * n.x; a01 += weight * n.x * n.y; a02 += weight * n.x * n.z;
+            a11 += weight * n.y * n.y; a12 += weight * n.y * n.z; a22 += weight * n.z * n.z;
+            b0 += weight * n.x * d; b1 += weight * n.y * d; b2 += weight * n.z * d;
+            c += weight * d * d;
+        }
+
+        float error(const Vector3 &p) const {
+            double x = p.x, y = p.y, z = p.z;
+            double result = a00 * x * x + 2.0 * a01 * x * y + 2.0 * a02 * x * z +
+                            a11 * y * y + 2.0 * a12 * y * z + a22 * z * z +
+                            2.0 * (b0 * x + b1 * y + b2 * z) + c;
+            return static_cast<float>(MAX(result, 0.0));
+        }
+    };
+
+    struct Collapse {
+        uint32_t from;
+        uint32_t to;
+        float cost;
+    };
+
+    float vertexScore(int32_t position, uint32_t remaining) {
+        if(remaining == 0) {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+        if(position >= 0) {
+            if(position < 3) {
+                score = gLastTriangleScore;
+            } else {
+                float scale = 1.0f / static_cast<float>(gCacheSize - 3);
+                score = powf(1.0f - static_cast<float>(position - 3) * scale, gCacheDecayPower);
+            }
+        }
+
+        return score + gValenceBoostScale * powf(static_cast<float>(remaining), -gValenceBoostPower);
+    }
+
+    template<typename T>
+    void remapArray(std::vector<T> &array, const std::vector<uint32_t> &remap) {
+        if(array.size() != remap.size()) {
+            return;
+        }
+
+        std::vector<T> result(array.size());
+        for(size_t i = 0; i < array.size(); i++) {
+            result[remap[i]] = array[i];
+        }
+        array.swap(result);
+    }
+
+    Mesh::Cluster makeCluster(const Vector3Vector &vertices, const uint32_t *indices, uint32_t start, uint32_t count, const std::vector<uint32_t> &used) {
+        Mesh::Cluster result;
+        result.indexStart = start;
+        result.indexCount = count;
+
+        Vector3 min( FLT_MAX);
+        Vector3 max(-FLT_MAX);
+        for(auto it : used) {
+            const Vector3 &v = vertices[it];
+            min = Vector3(MIN(min.x, v.x), MIN(min.y, v.y), MIN(min.z, v.z));
+            max = Vector3(MAX(max.x, v.x), MAX(max.y, v.y), MAX(max.z, v.z));
+        }
+        result.center = (min + max) * 0.5f;
+
+        result.radius = 0.0f;
+        for(auto it : used) {
+            result.radius = MAX(result.radius, (vertices[it] - result.center).length());
+        }
+
+        // Normal cone
+        Vector3Vector normals;
+        normals.reserve(count / 3);
+
+        Vector3 axis(0.0f);
+        for(uint32_t i = start; i < start + count; i += 3) {
+            const Vector3 &a = vertices[indices[i]];
+            Vector3 n = (vertices[indices[i + 1]] - a).cross(vertices[indices[i + 2]] - a);
+            if(n.normalize() > 0.0f) {
+                normals.push_back(n);
+                axis += n;
+            }
+        }
+
+        result.coneCutoff = 1.0f;
+        if(axis.normalize() > 0.0f) {
+            float minDot = 1.0f;
+            for(auto &it : normals) {
+                minDot = MIN(minDot, axis.dot(it));
+            }
+
+            // Normals spread over more than a hemisphere can't be culled
+            if(minDot > 0.0f) {
+                result.coneCutoff = sqrtf(1.0f - minDot * minDot);
+            }
+        }
+        result.coneAxis = axis;
+
+        return result;
+    }
+}
+
+/*!
+    \class MeshOptimizer
+    \brief The MeshOptimizer class reorders mesh data to reduce the cost of vertex processing on the GPU.
+    \inmodule Engine
+
+    The optimizations are intended to run offline, when the models are imported:
+    \list
+        \li optimizeVertexCache() reorders triangles so the post-transform cache of the GPU is reused as much as possible.
+        \li optimizeOverdraw() reorders clusters of triangles so the outer surfaces are rendered first, keeping most of the cache efficiency.
+        \li optimizeVertexFetch() reorders vertices in the order of their first use, so the memory is accessed linearly.
+        \li buildClusters() splits the index buffer into small clusters with bounds and normal cones for coarse culling.
+        \li simplify() and generateLods() reduce the number of triangles for the levels of detail.
+    \endlist
+
+    analyzeVertexCache() reports the average cache miss ratio (ACMR, transformed vertices per triangle) and the average transformed vertex ratio (ATVR, transformed vertices per unique vertex) for the FIFO cache model.
+    The best possible ATVR is 1.0.
+*/
+
+/*!
+    Returns vertex cache statistics for \a indexCount \a indices referencing \a vertexCount vertices with the FIFO cache of \a cacheSize entries.
+*/
+MeshOptimizer::Statistics MeshOptimizer::analyzeVertexCache(const uint32_t *indices, size_t indexCount, size_t vertexCount, uint32_t cacheSize) {
+    Statistics result;
+
+    size_t triangleCount = indexCount / 3;
+    if(triangleCount == 0 || vertexCount == 0) {
+        return result;
+    }
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    std::vector<bool> used(vertexCount, false);
+
+    uint32_t time = cacheSize + 1;
+    uint32_t misses = 0;
+    uint32_t unique = 0;
+    for(size_t i = 0; i < triangleCount * 3; i++) {
+        uint32_t v = indices[i];
+        if(v >= vertexCount) {
+            continue;
+        }
+
+        if(time - timestamps[v] > cacheSize) {
+            timestamps[v] = time++;
+            misses++;
+        }
+
+        if(!used[v]) {
+            used[v] = true;
+            unique++;
+        }
+    }
+
+    result.acmr = static_cast<float>(misses) / static_cast<float>(triangleCount);
+    result.atvr = (unique > 0) ? static_cast<float>(misses) / static_cast<float>(unique) : 0.0f;
+
+    return result;
+}
+/*!
+    Returns vertex cache statistics for the whole \a mesh with the FIFO cache of \a cacheSize entries.
+*/
+MeshOptimizer::Statistics MeshOptimizer::analyzeVertexCache(Mesh &mesh, uint32_t cacheSize) {
+    return analyzeVertexCache(mesh.indices().data(), mesh.indices().size(), mesh.vertices().size(), cacheSize);
+}
+/*!
+    Reorders triangles of \a indexCount \a indices referencing \a vertexCount vertices to improve the post-transform vertex cache hit rate.
+    Uses the greedy algorithm by Tom Forsyth which doesn't depend on the actual cache size of the GPU.
+*/
+void MeshOptimizer::optimizeVertexCache(uint32_t *indices, size_t indexCount, size_t vertexCount) {
+    PROFILE_FUNCTION();
+
+    size_t triangleCount = indexCount / 3;
+    if(triangleCount < 2 || vertexCount == 0) {
+        return;
+    }
+
+    for(size_t i = 0; i < triangleCount * 3; i++) {
+        if(indices[i] >= vertexCount) {
+            return;
+        }
+    }
+
+    // Triangles adjacent to each vertex
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for(size_t i = 0; i < triangleCount * 3; i++) {
+        remaining[indices[i]]++;
+    }
+
+    std::vector<uint32_t> offsets(vertexCount, 0);
+    for(size_t v = 1; v < vertexCount; v++) {
+        offsets[v] = offsets[v - 1] + remaining[v - 1];
+    }
+
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    {
+        std::vector<uint32_t> fill(offsets);
+        for(size_t i = 0; i < triangleCount * 3; i++) {
+            adjacency[fill[indices[i]]++] = i / 3;
+        }
+    }
+
+    std::vector<int32_t> positions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for(size_t v = 0; v < vertexCount; v++) {
+        vertexScores[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<bool> emitted(triangleCount, false);
+
+    IndexVector result;
+    result.reserve(triangleCount * 3);
+
+    uint32_t cache[gCacheSize + 3];
+    uint32_t cacheCount = 0;
+
+    size_t cursor = 0;
+    int64_t best = -1;
+
+    for(size_t e = 0; e < triangleCount; e++) {
+        if(best < 0) {
+            // Nothing in the cache to continue with, start from the next triangle in the original order
+            while(emitted[cursor]) {
+                cursor++;
+            }
+            best = cursor;
+        }
+
+        uint32_t t = static_cast<uint32_t>(best);
+        const uint32_t *triangle = &indices[t * 3];
+
+        emitted[t] = true;
+        result.insert(result.end(), triangle, triangle + 3);
+
+        // Move vertices of the triangle to the front of the cache
+        uint32_t next[gCacheSize + 3];
+        uint32_t nextCount = 0;
+        for(uint32_t k = 0; k < 3; k++) {
+            uint32_t v = triangle[k];
+            if(std::find(next, next + nextCount, v) == next + nextCount) {
+                next[nextCount++] = v;
+            }
+
+            // Remove the triangle from the adjacency of the vertex
+            uint32_t *begin = &adjacency[offsets[v]];
+            uint32_t *end = begin + remaining[v];
+            uint32_t *it = std::find(begin, end, t);
+            if(it != end) {
+                *it = *(end - 1);
+                remaining[v]--;
+            }
+        }
+        for(uint32_t i = 0; i < cacheCount; i++) {
+            uint32_t v = cache[i];
+            if(v != triangle[0] && v != triangle[1] && v != triangle[2]) {
+                next[nextCount++] = v;
+            }
+        }
+
+        for(uint32_t i = 0; i < nextCount; i++) {
+            uint32_t v = next[i];
+            positions[v] = (i < gCacheSize) ? static_cast<int32_t>(i) : -1;
+            vertexScores[v] = vertexScore(positions[v], remaining[v]);
+        }
+
+        // Find the best triangle among the ones adjacent to the cached vertices
+        best = -1;
+        float bestScore = -1.0f;
+        for(uint32_t i = 0; i < nextCount; i++) {
+            uint32_t v = next[i];
+            for(uint32_t j = 0; j < remaining[v]; j++) {
+                uint32_t a = adjacency[offsets[v] + j];
+                const uint32_t *adjacent = &indices[a * 3];
+
+                float score = vertexScores[adjacent[0]] + vertexScores[adjacent[1]] + vertexScores[adjacent[2]];
+                if(score > bestScore) {
+                    bestScore = score;
+                    best = a;
+                }
+            }
+        }
+
+        cacheCount = MIN(nextCount, gCacheSize);
+        std::copy(next, next + cacheCount, cache);
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+/*!
+    Reorders triangles of \a indexCount \a indices to reduce overdraw, \a vertices with \a vertexCount elements are used to compute the surface orientation.
+    The \a indices should be optimized with optimizeVertexCache() first.
+
+    Triangles are split into clusters at points where the vertex cache is completely missed, so the sorting doesn't affect the cache efficiency.
+    Clusters facing outwards from the center of the mesh are moved to the beginning, so they occlude the rest of the mesh in most views.
+*/
+void MeshOptimizer::optimizeOverdraw(uint32_t *indices, size_t indexCount, const Vector3 *vertices, size_t vertexCount) {
+    PROFILE_FUNCTION();
+
+    size_t triangleCount = indexCount / 3;
+    if(triangleCount < 2 || vertexCount == 0) {
+        return;
+    }
+
+    for(size_t i = 0; i < triangleCount * 3; i++) {
+        if(indices[i] >= vertexCount) {
+            return;
+        }
+    }
+
+    std::vector<uint32_t> clusters;
+
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = gFifoSize + 1;
+    for(size_t t = 0; t < triangleCount; t++) {
+        uint32_t misses = 0;
+        for(uint32_t k = 0; k < 3; k++) {
+            uint32_t v = indices[t * 3 + k];
+            if(time - timestamps[v] > gFifoSize) {
+                timestamps[v] = time++;
+                misses++;
+            }
+        }
+
+        if(t == 0 || misses == 3) {
+            clusters.push_back(t);
+        }
+    }
+    clusters.push_back(triangleCount);
+
+    if(clusters.size() < 3) {
+        return;
+    }
+
+    // Area weighted centroid of the mesh surface
+    std::vector<float> areas(triangleCount);
+    std::vector<Vector3> centroids(triangleCount);
+    std::vector<Vector3> normals(triangleCount);
+
+    Vector3 center(0.0f);
+    float total = 0.0f;
+    for(size_t t = 0; t < triangleCount; t++) {
+        const Vector3 &a = vertices[indices[t * 3]];
+        const Vector3 &b = vertices[indices[t * 3 + 1]];
+        const Vector3 &c = vertices[indices[t * 3 + 2]];
+
+        normals[t] = (b - a).cross(c - a);
+        areas[t] = normals[t].length() * 0.5f;
+        centroids[t] = (a + b + c) * (1.0f / 3.0f);
+
+        center += centroids[t] * areas[t];
+        total += areas[t];
+    }
+    if(total > 0.0f) {
+        center = center * (1.0f / total);
+    }
+
+    struct Sort {
+        float key;
+
+        uint32_t cluster;
+    };
+
+    std::vector<Sort> sort(clusters.size() - 1);
+    for(uint32_t i = 0; i < sort.size(); i++) {
+        Vector3 centroid(0.0f);
+        Vector3 normal(0.0f);
+        float area = 0.0f;
+        for(uint32_t t = clusters[i]; t < clusters[i + 1]; t++) {
+            centroid += centroids[t] * areas[t];
+            normal += normals[t];
+            area += areas[t];
+        }
+        if(area > 0.0f) {
+            centroid = centroid * (1.0f / area);
+        }
+        normal.normalize();
+
+        sort[i].key = (centroid - center).dot(normal);
+        sort[i].cluster = i;
+    }
+
+    std::stable_sort(sort.begin(), sort.end(), [](const Sort &left, const Sort &right) {
+        return left.key > right.key;
+    });
+
+    IndexVector result;
+    result.reserve(triangleCount * 3);
+    for(auto &it : sort) {
+        result.insert(result.end(), &indices[clusters[it.cluster] * 3], &indices[clusters[it.cluster + 1] * 3]);
+    }
+
+    std::copy(result.begin(), result.end(), indices);
+}
+/*!
+    Reorders vertices of the \a mesh in the order of their first use in the index buffer, unused vertices are moved to the end.
+    All vertex attributes, indices and blend shapes are remapped accordingly.
+*/
+void MeshOptimizer::optimizeVertexFetch(Mesh &mesh) {
+    PROFILE_FUNCTION();
+
+    size_t vertexCount = mesh.vertices().size();
+    IndexVector &indices = mesh.indices();
+    if(vertexCount == 0 || indices.empty()) {
+        return;
+    }
+
+    std::vector<uint32_t> remap(vertexCount, gUnused);
+    uint32_t next = 0;
+    for(auto &it : indices) {
+        if(it < vertexCount) {
+            if(remap[it] == gUnused) {
+                remap[it] = next++;
+            }
+            it = remap[it];
+        }
+    }
+    for(auto &it : remap) {
+        if(it == gUnused) {
+            it = next++;
+        }
+    }
+
+    remapArray(mesh.vertices(), remap);
+    remapArray(mesh.normals(), remap);
+    remapArray(mesh.tangents(), remap);
+    remapArray(mesh.colors(), remap);
+    remapArray(mesh.uv0(), remap);
+    remapArray(mesh.uv1(), remap);
+    remapArray(mesh.weights(), remap);
+    remapArray(mesh.bones(), remap);
+
+    for(auto &shape : mesh.blendShapes()) {
+        for(auto &frame : shape.frames) {
+            for(auto &it : frame.indices) {
+                if(it < vertexCount) {
+                    it = remap[it];
+                }
+            }
+        }
+    }
+}
+/*!
+    Splits each sub mesh of the \a mesh into clusters of consecutive triangles with at most \a maxVertices unique vertices and \a maxTriangles triangles.
+    Returns the clusters with bounding spheres and normal cones, see Mesh::clusters().
+    The index buffer isn't changed, so it should be optimized before.
+*/
+Mesh::ClusterVector MeshOptimizer::buildClusters(Mesh &mesh, uint32_t maxVertices, uint32_t maxTriangles) {
+    PROFILE_FUNCTION();
+
+    Mesh::ClusterVector result;
+
+    const Vector3Vector &vertices = mesh.vertices();
+    const IndexVector &indices = mesh.indices();
+    if(vertices.empty() || indices.empty() || maxVertices < 3 || maxTriangles == 0) {
+        return result;
+    }
+
+    std::vector<uint32_t> stamps(vertices.size(), gUnused);
+    std::vector<uint32_t> used;
+    used.reserve(maxVertices);
+
+    // Meshes without sub meshes have a single range of indices, each level of detail has its own ranges
+    int subMeshes = MAX(mesh.subMeshCount(), 1) * mesh.lodCount();
+    for(int sub = 0; sub < subMeshes; sub++) {
+        uint32_t start = mesh.indexStart(sub);
+        uint32_t count = mesh.indexCount(sub);
+        if(start + count > indices.size()) {
+            continue;
+        }
+        uint32_t end = start + count - count % 3;
+
+        uint32_t begin = start;
+        uint32_t triangles = 0;
+        used.clear();
+
+        for(uint32_t i = start; i < end; i += 3) {
+            uint32_t id = result.size();
+
+            uint32_t added = 0;
+            for(uint32_t k = 0; k < 3; k++) {
+                uint32_t v = indices[i + k];
+                if(v >= vertices.size()) {
+                    return Mesh::ClusterVector();
+                }
+                if(stamps[v] != id && (k < 1 || v != indices[i]) && (k < 2 || v != indices[i + 1])) {
+                    added++;
+                }
+            }
+
+            if(triangles == maxTriangles || used.size() + added > maxVertices) {
+                result.push_back(makeCluster(vertices, indices.data(), begin, i - begin, used));
+
+                id = result.size();
+                begin = i;
+                triangles = 0;
+                used.clear();
+            }
+
+            for(uint32_t k = 0; k < 3; k++) {
+                uint32_t v = indices[i + k];
+                if(stamps[v] != id) {
+                    stamps[v] = id;
+                    used.push_back(v);
+                }
+            }
+            triangles++;
+        }
+
+        if(triangles > 0) {
+            result.push_back(makeCluster(vertices, indices.data(), begin, end - begin, used));
+        }
+    }
+
+    return result;
+}
+/*!
+    Returns the simplified copy of \a indexCount \a indices of the \a mesh with at most \a targetIndexCount indices.
+    Edges are collapsed in the order of the quadric error metric until the target is reached or the next collapse would exceed \a targetError relative to the mesh radius.
+    Vertices on open borders and on attribute seams (different vertices with the same position) are never moved, and collapses are penalized for the difference of texture coordinates and normals, so the mesh keeps its silhouette and texture layout.
+    Collapses always move a vertex onto an existing one, so the result references the same vertex buffer.
+    The relative error of the result is written to \a resultError if it's not nullptr.
+*/
+IndexVector MeshOptimizer::simplify(Mesh &mesh, const uint32_t *indices, size_t indexCount, size_t targetIndexCount, float targetError, float *resultError) {
+    PROFILE_FUNCTION();
+
+    IndexVector result(indices, indices + indexCount - indexCount % 3);
+    if(resultError) {
+        *resultError = 0.0f;
+    }
+
+    const Vector3Vector &vertices = mesh.vertices();
+    size_t vertexCount = vertices.size();
+    for(auto it : result) {
+        if(it >= vertexCount) {
+            return result;
+        }
+    }
+    if(result.size() <= targetIndexCount) {
+        return result;
+    }
+
+    const Vector2Vector &uv0 = mesh.uv0();
+    const Vector3Vector &normals = mesh.normals();
+    bool hasUv = uv0.size() == vertexCount;
+    bool hasNormals = normals.size() == vertexCount;
+
+    Vector3 min( FLT_MAX);
+    Vector3 max(-FLT_MAX);
+    for(auto &v : vertices) {
+        min = Vector3(MIN(min.x, v.x), MIN(min.y, v.y), MIN(min.z, v.z));
+        max = Vector3(MAX(max.x, v.x), MAX(max.y, v.y), MAX(max.z, v.z));
+    }
+    float radius = MAX((max - min).length() * 0.5f, FLT_EPSILON);
+    float scale = radius * radius;
+    float maxCost = targetError * targetError * scale;
+
+    // Vertices with the same position share one group, groups of several vertices are attribute seams
+    std::vector<uint32_t> group(vertexCount);
+    std::vector<uint32_t> groupSize(vertexCount, 0);
+    {
+        std::map<std::tuple<float, float, float>, uint32_t> positions;
+        for(uint32_t i = 0; i < vertexCount; i++) {
+            auto it = positions.emplace(std::make_tuple(vertices[i].x, vertices[i].y, vertices[i].z), i).first;
+            group[i] = it->second;
+            groupSize[it->second]++;
+        }
+    }
+
+    // Open and non-manifold edges lock their vertices
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::unordered_map<uint64_t, uint32_t> edges;
+        for(size_t i = 0; i < result.size(); i += 3) {
+            for(uint32_t k = 0; k < 3; k++) {
+                uint32_t a = group[result[i + k]];
+                uint32_t b = group[result[i + (k + 1) % 3]];
+                edges[(static_cast<uint64_t>(MIN(a, b)) << 32) | MAX(a, b)]++;
+            }
+        }
+        for(auto &it : edges) {
+            if(it.second != 2) {
+                locked[it.first >> 32] = true;
+                locked[it.first & 0xffffffff] = true;
+            }
+        }
+        for(uint32_t i = 0; i < vertexCount; i++) {
+            if(groupSize[group[i]] > 1) {
+                locked[i] = true;
+            }
+        }
+    }
+
+    float error = 0.0f;
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<bool> touched(vertexCount);
+    std::vector<std::vector<uint32_t>> adjacency(vertexCount);
+    std::vector<Collapse> collapses;
+
+    while(result.size() > targetIndexCount) {
+        size_t triangleCount = result.size() / 3;
+
+        for(auto &it : quadrics) {
+            it = Quadric();
+        }
+        for(auto &it : adjacency) {
+            it.clear();
+        }
+
+        // Area weighted plane quadrics of the triangles accumulated in their vertices
+        for(uint32_t t = 0; t < triangleCount; t++) {
+            const uint32_t *tri = &result[t * 3];
+            const Vector3 &p0 = vertices[tri[0]];
+
+            Vector3 n = (vertices[tri[1]] - p0).cross(vertices[tri[2]] - p0);
+            float area = n.normalize() * 0.5f;
+            for(uint32_t k = 0; k < 3; k++) {
+                quadrics[tri[k]].addPlane(n, -n.dot(p0), area);
+                adjacency[tri[k]].push_back(t);
+            }
+        }
+
+        collapses.clear();
+        for(uint32_t t = 0; t < triangleCount; t++) {
+            for(uint32_t k = 0; k < 3; k++) {
+                uint32_t a = result[t * 3 + k];
+                uint32_t b = result[t * 3 + (k + 1) % 3];
+                for(uint32_t d = 0; d < 2; d++) {
+                    uint32_t from = (d == 0) ? a : b;
+                    uint32_t to = (d == 0) ? b : a;
+                    if(locked[from]) {
+                        continue;
+                    }
+
+                    float attributes = 0.0f;
+                    if(hasUv) {
+                        attributes += (uv0[from] - uv0[to]).sqrLength();
+                    }
+                    if(hasNormals) {
+                        attributes += (normals[from] - normals[to]).sqrLength();
+                    }
+
+                    float cost = quadrics[from].error(vertices[to]) + gAttributeWeight * attributes * scale;
+                    collapses.push_back({from, to, cost});
+                }
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse &left, const Collapse &right) {
+            return left.cost < right.cost;
+        });
+
+        for(uint32_t i = 0; i < vertexCount; i++) {
+            remap[i] = i;
+            touched[i] = false;
+        }
+
+        // Independent collapses with the lowest cost; neighbours of the collapsed vertices wait for the next pass
+        size_t removed = 0;
+        size_t required = (result.size() - targetIndexCount + 2) / 3;
+        for(auto &it : collapses) {
+            if(it.cost > maxCost || removed >= required) {
+                break;
+            }
+            if(touched[it.from] || touched[it.to]) {
+                continue;
+            }
+
+            // Reject collapses which flip the remaining triangles
+            bool valid = true;
+            size_t shared = 0;
+            for(auto t : adjacency[it.from]) {
+                const uint32_t *tri = &result[t * 3];
+                if(tri[0] == it.to || tri[1] == it.to || tri[2] == it.to) {
+                    shared++;
+                    continue;
+                }
+
+                Vector3 p[3];
+                for(uint32_t k = 0; k < 3; k++) {
+                    p[k] = vertices[tri[k]];
+                }
+                Vector3 before = (p[1] - p[0]).cross(p[2] - p[0]);
+                for(uint32_t k = 0; k < 3; k++) {
+                    if(tri[k] == it.from) {
+                        p[k] = vertices[it.to];
+                    }
+                }
+                Vector3 after = (p[1] - p[0]).cross(p[2] - p[0]);
+                if(before.dot(after) <= 0.0f) {
+                    valid = false;
+                    break;
+                }
+            }
+            if(!valid) {
+                continue;
+            }
+
+            remap[it.from] = it.to;
+            for(auto t : adjacency[it.from]) {
+                for(uint32_t k = 0; k < 3; k++) {
+                    touched[result[t * 3 + k]] = true;
+                }
+            }
+            removed += shared;
+            error = MAX(error, it.cost);
+        }
+
+        if(removed == 0) {
+            break;
+        }
+
+        IndexVector next;
+        next.reserve(result.size());
+        for(size_t i = 0; i < result.size(); i += 3) {
+            uint32_t a = remap[result[i]];
+            uint32_t b = remap[result[i + 1]];
+            uint32_t c = remap[result[i + 2]];
+            if(a != b && b != c && c != a) {
+                next.insert(next.end(), { a, b, c });
+            }
+        }
+        result.swap(next);
+    }
+
+    if(resultError) {
+        *resultError = sqrtf(error / scale);
+    }
+
+    return result;
+}
+/*!
+    Generates up to \a count levels of detail for the \a mesh, each one has \a ratio of the triangles of the previous level.
+    The generation stops when the simplification exceeds \a maxError relative to the mesh radius or can't remove enough triangles.
+    Screen size thresholds are chosen so that the error of each level is about one pixel at 1080p, see Mesh::selectLod().
+    Existing generated levels are replaced.
+*/
+void MeshOptimizer::generateLods(Mesh &mesh, uint32_t count, float ratio, float maxError) {
+    PROFILE_FUNCTION();
+
+    mesh.clearLods();
+
+    int subMeshes = MAX(mesh.subMeshCount(), 1);
+
+    std::vector<IndexVector> previous(subMeshes);
+    for(int sub = 0; sub < subMeshes; sub++) {
+        uint32_t start = mesh.indexStart(sub);
+        uint32_t size = mesh.indexCount(sub);
+        if(start + size > mesh.indices().size()) {
+            return;
+        }
+        previous[sub].assign(mesh.indices().begin() + start, mesh.indices().begin() + start + size);
+    }
+
+    float lastSize = FLT_MAX;
+    for(uint32_t lod = 1; lod <= count; lod++) {
+        size_t before = 0;
+        size_t after = 0;
+        float error = 0.0f;
+
+        std::vector<IndexVector> current(subMeshes);
+        for(int sub = 0; sub < subMeshes; sub++) {
+            size_t target = static_cast<size_t>(previous[sub].size() / 3 * ratio) * 3;
+
+            float subError = 0.0f;
+            current[sub] = simplify(mesh, previous[sub].data(), previous[sub].size(), target, maxError, &subError);
+
+            before += previous[sub].size();
+            after += current[sub].size();
+            error = MAX(error, subError);
+        }
+
+        // Levels which don't save at least a quarter of the triangles aren't worth the memory
+        if(after == 0 || after > before * 3 / 4) {
+            break;
+        }
+
+        IndexVector indices;
+        IndexVector offsets;
+        for(auto &it : current) {
+            offsets.push_back(indices.size());
+            indices.insert(indices.end(), it.begin(), it.end());
+        }
+
+        float size = MIN(gLodPixelError / MAX(error, 1e-4f), lastSize * 0.9f);
+        mesh.addLod(indices, offsets, size);
+
+        lastSize = size;
+        previous.swap(current);
+    }
+}
+/*!
+    Applies the optimizations selected with \a options to the \a mesh.
+    Triangles are reordered only within their sub meshes and levels of detail.
+    If MeshOptimizer::Clusters option is set, the clusters are stored to the \a mesh.
+*/
+void MeshOptimizer::optimize(Mesh &mesh, int options) {
+    PROFILE_FUNCTION();
+
+    IndexVector &indices = mesh.indices();
+    size_t vertexCount = mesh.vertices().size();
+
+    // Meshes without sub meshes have a single range of indices, each level of detail has its own ranges
+    int subMeshes = MAX(mesh.subMeshCount(), 1) * mesh.lodCount();
+    for(int sub = 0; sub < subMeshes; sub++) {
+        uint32_t start = mesh.indexStart(sub);
+        uint32_t count = mesh.indexCount(sub);
+        if(count == 0 || start + count > indices.size()) {
+            continue;
+        }
+
+        if(options & VertexCache) {
+            optimizeVertexCache(&indices[start], count, vertexCount);
+        }
+        if(options & Overdraw) {
+            optimizeOverdraw(&indices[start], count, mesh.vertices().data(), vertexCount);
+        }
+    }
+
+    if(options & VertexFetch) {
+        optimizeVertexFetch(mesh);
+    }
+
+    if(options & Clusters) {
+        mesh.setClusters(buildClusters(mesh));
+    }
+}
@@ -0,0 +1,360 @@
+#include "utils/texturestreamer.h"
+
+#include "resources/texture.h"
+#include "resources/material.h"
+
+#include <jobsystem.h>
+#include <file.h>
+
+#include <algorithm>
+
+namespace {
+    const uint64_t gTextureBudget(256 * 1024 * 1024);
+
+    // Textures which are not sampled by the scene renderables during this period are loaded completely
+    const uint32_t gGraceFrames(8);
+
+    const uint32_t gMaxLoading(4);
+}
+
+struct TextureStreamer::Result {
+    Texture *texture = nullptr;
+
+    Texture::Sides sides;
+
+    int32_t level = 0;
+
+    uint32_t ticket = 0;
+
+    bool valid = false;
+};
+
+/*!
+    \class TextureStreamer
+    \brief The TextureStreamer class keeps in memory only mip levels of the textures which are needed for rendering.
+    \inmodule Engine
+
+    Streamed textures are loaded with a few smallest mip levels (see Texture::streamingSize()) and registered with add().
+    Every frame the pipeline requests mip levels according to the screen space size of the renderables which sample the textures.
+    The update() loads missing levels one by one on the worker threads, starting from the smallest one, so the texture gets sharper progressively.
+
+    The memory occupied by the streamed textures is limited by budget().
+    When a new level doesn't fit the budget, high mip levels of the least recently used textures are evicted.
+    Textures which are never sampled by the scene renderables (for example user interface images) are loaded completely after a few frames.
+
+    Methods of this class except add() are expected to be called from the thread which updates resources.
+*/
+
+TextureStreamer::TextureStreamer() :
+        m_counter(new JobCounter),
+        m_budget(gTextureBudget),
+        m_residentSize(0),
+        m_frame(0),
+        m_loading(0),
+        m_nextTicket(0) {
+
+}
+
+TextureStreamer::~TextureStreamer() {
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs) {
+        jobs->wait(m_counter);
+    }
+    delete m_counter;
+
+    for(auto it : m_results) {
+        delete it;
+    }
+
+    for(auto &it : m_textures) {
+        it.first->m_streamer = nullptr;
+    }
+    for(auto it : m_pending) {
+        it->m_streamer = nullptr;
+    }
+}
+/*!
+    Returns the memory budget in bytes for the streamed textures.
+*/
+uint64_t TextureStreamer::budget() const {
+    return m_budget;
+}
+/*!
+    Sets the memory \a budget in bytes for the streamed textures.
+    Textures that exceed the budget are evicted during the next update().
+*/
+void TextureStreamer::setBudget(uint64_t budget) {
+    m_budget = budget;
+}
+/*!
+    Returns the size in bytes of the resident mip levels including the levels which are loading now.
+*/
+uint64_t TextureStreamer::residentSize() const {
+    return m_residentSize;
+}
+/*!
+    Returns the number of the textures managed by the streamer.
+*/
+uint32_t TextureStreamer::textureCount() const {
+    return m_textures.size();
+}
+/*!
+    Adds a streamable \a texture to the streamer.
+    The texture will be managed since the next update().
+    This method is thread safe, so textures can be added while they are loading on the worker threads.
+*/
+void TextureStreamer::add(Texture *texture) {
+    if(texture == nullptr || !texture->isStreamable()) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> locker(m_mutex);
+    texture->m_streamer = this;
+    m_pending.push_back(texture);
+}
+/*!
+    Removes the \a texture from the streamer.
+    Loading of the texture mip levels is cancelled.
+*/
+void TextureStreamer::remove(Texture *texture) {
+    if(texture == nullptr) {
+        return;
+    }
+
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_pending.erase(std::remove(m_pending.begin(), m_pending.end(), texture), m_pending.end());
+    }
+
+    auto it = m_textures.find(texture);
+    if(it != m_textures.end()) {
+        if(it->second.loading) {
+            m_loading--;
+        }
+        m_residentSize -= texture->mipsSize(it->second.loading ? (texture->m_residentMip - 1) : texture->m_residentMip, texture->m_mips);
+        m_textures.erase(it);
+    }
+
+    texture->m_streamer = nullptr;
+}
+/*!
+    Requests mip levels of the \a texture which is visible on the screen with \a size in pixels.
+    Zero \a size only marks the texture as used by the scene renderables.
+*/
+void TextureStreamer::request(Texture *texture, float size) {
+    if(texture == nullptr || texture->m_streamer != this) {
+        return;
+    }
+
+    auto it = m_textures.find(texture);
+    if(it == m_textures.end()) {
+        return;
+    }
+
+    Entry &entry = it->second;
+    entry.scene = true;
+    if(size <= 0.0f) {
+        return;
+    }
+
+    int32_t dimension = MAX(texture->m_width, texture->m_height);
+    int32_t level = 0;
+    while(level < texture->m_mips - 1 && float(dimension >> (level + 1)) >= size) {
+        level++;
+    }
+
+    if(entry.used != m_frame) {
+        entry.used = m_frame;
+        entry.requested = level;
+    } else {
+        entry.requested = MIN(entry.requested, level);
+    }
+}
+/*!
+    Requests mip levels of all textures assigned to the material \a instance which is visible on the screen with \a size in pixels.
+*/
+void TextureStreamer::request(const MaterialInstance &instance, float size) {
+    for(auto &it : instance.m_textureOverride) {
+        request(it.second, size);
+    }
+}
+/*!
+    Applies loaded mip levels, evicts unused levels to fit the budget and schedules loading of the requested levels.
+    Must be called once per frame.
+*/
+void TextureStreamer::update() {
+    PROFILE_FUNCTION();
+
+    m_frame++;
+
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        for(auto it : m_pending) {
+            Entry &entry = m_textures[it];
+            entry.requested = it->m_residentMip;
+            entry.tail = it->m_residentMip;
+            entry.added = m_frame;
+
+            m_residentSize += it->mipsSize(it->m_residentMip, it->m_mips);
+        }
+        m_pending.clear();
+    }
+
+    finalize();
+
+    std::vector<std::pair<Texture *, Entry *>> candidates;
+    for(auto &it : m_textures) {
+        Entry &entry = it.second;
+        if(!entry.scene && m_frame - entry.added > gGraceFrames) {
+            entry.requested = 0;
+            entry.used = m_frame;
+        }
+
+        bool recent = (m_frame - entry.used) <= 1;
+        if(recent && !entry.loading && entry.requested < it.first->m_residentMip) {
+            candidates.push_back(std::make_pair(it.first, &entry));
+        }
+    }
+
+    // Textures which are far from the requested quality go first
+    std::sort(candidates.begin(), candidates.end(), [](const std::pair<Texture *, Entry *> &left, const std::pair<Texture *, Entry *> &right) {
+        return (left.first->m_residentMip - left.second->requested) > (right.first->m_residentMip - right.second->requested);
+    });
+
+    for(auto &it : candidates) {
+        if(m_loading >= gMaxLoading) {
+            break;
+        }
+
+        Texture *texture = it.first;
+        uint64_t size = texture->mipsSize(texture->m_residentMip - 1, texture->m_residentMip);
+        if(m_residentSize + size > m_budget && !evict(m_residentSize + size - m_budget)) {
+            continue;
+        }
+
+        load(texture, *it.second);
+    }
+
+    if(m_residentSize > m_budget) {
+        evict(m_residentSize - m_budget);
+    }
+}
+/*!
+    \internal
+    Applies loaded mip levels to the textures.
+*/
+void TextureStreamer::finalize() {
+    std::list<Result *> results;
+    {
+        std::unique_lock<std::mutex> locker(m_mutex);
+        results.swap(m_results);
+    }
+
+    for(auto result : results) {
+        auto it = m_textures.find(result->texture);
+        if(it != m_textures.end() && it->second.loading && it->second.ticket == result->ticket) {
+            Entry &entry = it->second;
+            entry.loading = false;
+            m_loading--;
+
+            Texture *texture = result->texture;
+            if(result->valid && result->level == texture->m_residentMip - 1) {
+                texture->applyMips(result->level, result->sides);
+            } else {
+                // Release the reserved memory, the level will be requested again
+                m_residentSize -= texture->mipsSize(result->level, result->level + 1);
+            }
+        }
+        delete result;
+    }
+}
+/*!
+    \internal
+    Schedules loading of the next mip level of the \a texture.
+    Memory for the level is reserved at this point.
+*/
+void TextureStreamer::load(Texture *texture, Entry &entry) {
+    m_nextTicket++;
+
+    entry.loading = true;
+    entry.ticket = m_nextTicket;
+    m_loading++;
+
+    Result *result = new Result;
+    result->texture = texture;
+    result->level = texture->m_residentMip - 1;
+    result->ticket = m_nextTicket;
+
+    // The texture can be deleted while the job is running, so copy everything the job needs
+    TString path(texture->m_mipSource);
+    std::vector<Texture::MipSection> sections;
+    for(int side = 0; side < texture->sides(); side++) {
+        sections.push_back(texture->m_mipSections[side * texture->m_mips + result->level]);
+    }
+
+    m_residentSize += texture->mipsSize(result->level, result->level + 1);
+
+    auto job = [this, result, path, sections]() {
+        PROFILE_BLOCK("TextureStreamer::load");
+
+        File fp(path);
+        result->valid = fp.open(File::Read);
+        if(result->valid) {
+            for(auto &it : sections) {
+                ByteArray data(it.size);
+                fp.seek(it.offset);
+                if(fp.pos() != it.offset || (it.size > 0 && fp.read(data.data(), it.size, 1) != 1)) {
+                    result->valid = false;
+                    break;
+                }
+                result->sides.push_back({std::move(data)});
+            }
+            fp.close();
+        }
+
+        std::unique_lock<std::mutex> locker(m_mutex);
+        m_results.push_back(result);
+    };
+
+    JobSystem *jobs = Engine::jobSystem();
+    if(jobs) {
+        jobs->dispatch(job, m_counter);
+    } else {
+        job();
+    }
+}
+/*!
+    \internal
+    Evicts high mip levels of the least recently used textures until at least \a size bytes are released.
+    Textures requested during the last frames are never evicted.
+    Returns true if enough memory was released; otherwise returns false.
+*/
+bool TextureStreamer::evict(uint64_t size) {
+    uint64_t released = 0;
+    while(released < size) {
+        Texture *victim = nullptr;
+        Entry *lru = nullptr;
+        for(auto &it : m_textures) {
+            Entry &entry = it.second;
+            if(!entry.loading && (m_frame - entry.used) > 1 && it.first->m_residentMip < entry.tail) {
+                if(lru == nullptr || entry.used < lru->used) {
+                    victim = it.first;
+                    lru = &entry;
+                }
+            }
+        }
+
+        if(victim == nullptr) {
+            break;
+        }
+
+        uint64_t freed = victim->mipsSize(victim->m_residentMip, lru->tail);
+        victim->evictMips(lru->tail);
+        lru->requested = lru->tail;
+
+        released += freed;
+        m_residentSize -= freed;
+    }
+
+    return released >= size;
+}
@@ -0,0 +1,313 @@
+#include "utils/transformstorage.h"
+
+#include "components/transform.h"
+
+#include <jobsystem.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace {
+    const uint32_t gParallelLevel(512);
+    const uint32_t gGrain(128);
+}
+
+/*!
+    \class TransformStorage
+    \brief The TransformStorage class keeps world transformations of a transform hierarchy in contiguous arrays.
+    \inmodule Engine
+
+    Local and world matrices of the registered transforms are stored in arrays sorted by the depth in the hierarchy, so parents always go before their children.
+    A single update() call recalculates all dirty transforms level by level; large levels are processed in parallel on the JobSystem.
+    Between the updates Transform::worldTransform() becomes a plain array read, only transforms changed after the last update() are recalculated on demand.
+
+    Registered transforms are reordered only inside update(), so the storage must be updated at a synchronization point of the frame when no one reads the transforms.
+
+    Subclasses of the Transform with their own layout logic (like RectTransform) are not accepted and keep the lazy update.
+
+    \note Methods of the storage are not thread safe.
+*/
+
+TransformStorage::TransformStorage() :
+        m_structure(false) {
+
+}
+
+TransformStorage::~TransformStorage() {
+    clear();
+}
+/*!
+    Registers the \a transform in the storage; the transform is moved to the arrays on the next update() call.
+*/
+void TransformStorage::add(Transform *transform) {
+    if(transform == nullptr || transform->metaObject() != Transform::metaClass() || transform->m_storage != nullptr) {
+        return;
+    }
+
+    if(transform->m_pendingSlot < 0) {
+        transform->m_pendingSlot = m_pending.size();
+        m_pending.push_back(transform);
+        m_structure = true;
+    }
+}
+/*!
+    Unregisters the \a transform from the storage.
+    The transform gets back the latest state of its matrices and continues to work without the storage.
+*/
+void TransformStorage::remove(Transform *transform) {
+    if(transform == nullptr) {
+        return;
+    }
+
+    if(transform->m_storage == this) {
+        detach(transform->m_slot);
+        m_transforms[transform->m_slot] = nullptr;
+
+        transform->m_storage = nullptr;
+        transform->m_slot = -1;
+
+        m_structure = true;
+    } else {
+        int32_t slot = transform->m_pendingSlot;
+        if(slot >= 0 && slot < static_cast<int32_t>(m_pending.size()) && m_pending[slot] == transform) {
+            // The last pending transform takes the slot
+            Transform *last = m_pending.back();
+            m_pending[slot] = last;
+            last->m_pendingSlot = slot;
+            m_pending.pop_back();
+
+            transform->m_pendingSlot = -1;
+        }
+    }
+}
+/*!
+    Unregisters all transforms from the storage.
+*/
+void TransformStorage::clear() {
+    for(uint32_t i = 0; i < m_transforms.size(); i++) {
+        Transform *transform = m_transforms[i];
+        if(transform) {
+            detach(i);
+            transform->m_storage = nullptr;
+            transform->m_slot = -1;
+        }
+    }
+
+    for(auto it : m_pending) {
+        it->m_pendingSlot = -1;
+    }
+
+    m_transforms.clear();
+    m_pending.clear();
+    m_parents.clear();
+    m_levels.clear();
+    m_dirty.clear();
+    m_local.clear();
+    m_world.clear();
+    m_worldQuaternion.clear();
+    m_worldRotation.clear();
+    m_worldScale.clear();
+    m_hash.clear();
+
+    m_structure = false;
+}
+/*!
+    Recalculates world transformations of all dirty transforms.
+    Levels of the hierarchy which contain a lot of transforms are processed in parallel using \a jobs.
+*/
+void TransformStorage::update(JobSystem *jobs) {
+    PROFILE_FUNCTION();
+
+    if(m_structure) {
+        rebuild();
+    }
+
+    for(uint32_t level = 0; level + 1 < m_levels.size(); level++) {
+        uint32_t begin = m_levels[level];
+        uint32_t end = m_levels[level + 1];
+
+        if(jobs && end - begin >= gParallelLevel) {
+            jobs->parallelFor(end - begin, gGrain, [this, begin](uint32_t first, uint32_t last) {
+                updateRange(begin + first, begin + last);
+            });
+        } else {
+            updateRange(begin, end);
+        }
+    }
+}
+/*!
+    Returns the number of transforms in the storage including the transforms waiting for the next update().
+*/
+uint32_t TransformStorage::count() const {
+    uint32_t result = m_pending.size();
+    for(auto it : m_transforms) {
+        if(it) {
+            result++;
+        }
+    }
+    return result;
+}
+/*!
+    Returns the number of hierarchy levels after the last update().
+*/
+uint32_t TransformStorage::levels() const {
+    return m_levels.empty() ? 0 : m_levels.size() - 1;
+}
+
+void TransformStorage::rebuild() {
+    PROFILE_FUNCTION();
+
+    struct Entry {
+        Transform *transform;
+
+        int32_t slot;
+
+        uint32_t depth;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(m_transforms.size() + m_pending.size());
+
+    for(uint32_t i = 0; i < m_transforms.size(); i++) {
+        if(m_transforms[i]) {
+            entries.push_back({m_transforms[i], static_cast<int32_t>(i), 0});
+        }
+    }
+    for(auto it : m_pending) {
+        entries.push_back({it, -1, 0});
+        it->m_pendingSlot = -1;
+    }
+    m_pending.clear();
+
+    for(auto &it : entries) {
+        for(Transform *parent = it.transform->m_parent; parent != nullptr; parent = parent->m_parent) {
+            it.depth++;
+        }
+    }
+
+    std::stable_sort(entries.begin(), entries.end(), [](const Entry &left, const Entry &right) {
+        return left.depth < right.depth;
+    });
+
+    uint32_t count = entries.size();
+
+    std::vector<Transform *> transforms(count);
+    std::vector<int32_t> parents(count);
+    std::vector<uint8_t> dirty(count);
+    std::vector<Matrix4> local(count);
+    std::vector<Matrix4> world(count);
+    std::vector<Quaternion> worldQuaternion(count);
+    std::vector<Vector3> worldRotation(count);
+    std::vector<Vector3> worldScale(count);
+    std::vector<uint32_t> hash(count);
+
+    std::unordered_map<Transform *, int32_t> indices;
+    indices.reserve(count);
+
+    m_levels.clear();
+
+    for(uint32_t i = 0; i < count; i++) {
+        Entry &entry = entries[i];
+        Transform *transform = entry.transform;
+
+        if(m_levels.empty() || entries[i - 1].depth != entry.depth) {
+            m_levels.push_back(i);
+        }
+
+        transforms[i] = transform;
+
+        auto parent = indices.find(transform->m_parent);
+        parents[i] = (parent != indices.end()) ? parent->second : -1;
+
+        if(entry.slot >= 0) {
+            dirty[i] = m_dirty[entry.slot];
+            local[i] = m_local[entry.slot];
+            world[i] = m_world[entry.slot];
+            worldQuaternion[i] = m_worldQuaternion[entry.slot];
+            worldRotation[i] = m_worldRotation[entry.slot];
+            worldScale[i] = m_worldScale[entry.slot];
+            hash[i] = m_hash[entry.slot];
+        } else {
+            dirty[i] = 1;
+            local[i] = transform->m_transform;
+            world[i] = transform->m_worldTransform;
+            worldQuaternion[i] = transform->m_worldQuaternion;
+            worldRotation[i] = transform->m_worldRotation;
+            worldScale[i] = transform->m_worldScale;
+            hash[i] = transform->m_hash;
+
+            transform->m_dirty = true;
+        }
+
+        transform->m_storage = this;
+        transform->m_slot = i;
+
+        indices[transform] = i;
+    }
+    m_levels.push_back(count);
+
+    m_transforms.swap(transforms);
+    m_parents.swap(parents);
+    m_dirty.swap(dirty);
+    m_local.swap(local);
+    m_world.swap(world);
+    m_worldQuaternion.swap(worldQuaternion);
+    m_worldRotation.swap(worldRotation);
+    m_worldScale.swap(worldScale);
+    m_hash.swap(hash);
+
+    m_structure = false;
+}
+
+void TransformStorage::updateRange(uint32_t begin, uint32_t end) {
+    for(uint32_t i = begin; i < end; i++) {
+        if(m_dirty[i] == 0) {
+            continue;
+        }
+
+        Transform *transform = m_transforms[i];
+
+        Matrix4 &local = m_local[i];
+        local = Matrix4(transform->m_position, transform->m_quaternion, transform->m_scale);
+
+        int32_t parent = m_parents[i];
+        if(parent >= 0) {
+            m_world[i] = m_world[parent] * local;
+            m_worldQuaternion[i] = m_worldQuaternion[parent] * transform->m_quaternion;
+            m_worldRotation[i] = m_worldRotation[parent] + transform->m_rotation;
+            m_worldScale[i] = m_worldScale[parent] * transform->m_scale;
+        } else if(transform->m_parent) {
+            // The parent is not in the storage
+            Transform *external = transform->m_parent;
+            m_world[i] = external->worldTransform() * local;
+            m_worldQuaternion[i] = external->worldQuaternion() * transform->m_quaternion;
+            m_worldRotation[i] = external->worldRotation() + transform->m_rotation;
+            m_worldScale[i] = external->worldScale() * transform->m_scale;
+        } else {
+            m_world[i] = local;
+            m_worldQuaternion[i] = transform->m_quaternion;
+            m_worldRotation[i] = transform->m_rotation;
+            m_worldScale[i] = transform->m_scale;
+        }
+
+        uint32_t hash = 16;
+        for(int j = 0; j < 16; j++) {
+            Mathf::hashCombine(hash, m_world[i][j]);
+        }
+        m_hash[i] = hash;
+
+        m_dirty[i] = 0;
+        transform->m_dirty = false;
+    }
+}
+
+void TransformStorage::detach(uint32_t index) {
+    Transform *transform = m_transforms[index];
+
+    transform->m_transform = m_local[index];
+    transform->m_worldTransform = m_world[index];
+    transform->m_worldQuaternion = m_worldQuaternion[index];
+    transform->m_worldRotation = m_worldRotation[index];
+    transform->m_worldScale = m_worldScale[index];
+    transform->m_hash = m_hash[index];
+}
@@ -101,4 +101,69 @@ namespace EngineSuite {
         ASSERT_EQ(2, dataFrames.size());
         ASSERT_EQ(TString("test2"), dataFrames.back().m_value);
     }
+
+    TEST(AnimationTrack, Compiled_curve) {
+        AnimationCurve curve;
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Cubic, 0.0f, {0.0f, 1.0f, 2.0f}, {0.0f, 1.0f, 2.0f}, {1.0f, 2.0f, 3.0f} });
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 0.25f, {1.0f, 2.0f, 3.0f}, {0.5f, 1.5f, 2.5f}, {1.0f, 2.0f, 3.0f} });
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Constant, 0.5f, {2.0f, 3.0f, 0.0f} });
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 0.75f, {3.0f, 0.0f, 1.0f} });
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 1.0f, {0.0f, 1.0f, 2.0f} });
+
+        AnimationCurve compiled(curve);
+        compiled.compile();
+        ASSERT_FALSE(curve.isCompiled());
+        ASSERT_TRUE(compiled.isCompiled());
+
+        for(int i = -10; i <= 110; i++) {
+            float pos = i * 0.01f;
+
+            Vector4 expected(curve.valueVector4(pos));
+            Vector4 value(compiled.valueVector4(pos));
+            for(int c = 0; c < 4; c++) {
+                ASSERT_NEAR(expected[c], value[c], 1e-5f) << "position " << pos;
+            }
+        }
+
+        AnimationCurve scalar;
+        scalar.m_keys.push_back({ AnimationCurve::KeyFrame::Cubic, 0.0f, {1.0f}, {0.0f}, {2.0f} });
+        scalar.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 0.5f, {3.0f}, {2.5f}, {3.0f} });
+        scalar.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 1.0f, {2.0f} });
+
+        AnimationCurve compiledScalar(scalar);
+        compiledScalar.compile();
+        ASSERT_TRUE(compiledScalar.isCompiled());
+
+        for(int i = -10; i <= 110; i++) {
+            float pos = i * 0.01f;
+            ASSERT_NEAR(scalar.valueFloat(pos), compiledScalar.valueFloat(pos), 1e-5f) << "position " << pos;
+        }
+
+        // Unsorted keys can't be compiled
+        std::swap(compiled.m_keys[0], compiled.m_keys[1]);
+        compiled.compile();
+        ASSERT_FALSE(compiled.isCompiled());
+    }
+
+    TEST(AnimationTrack, Compiled_track) {
+        AnimationTrack track;
+
+        Quaternion q0;
+        Quaternion q1(Vector3(90.0f, 0.0f, 0.0f));
+
+        AnimationCurve &curve = track.curve();
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 2.0f, {q1.x, q1.y, q1.z, q1.w} });
+        curve.m_keys.push_back({ AnimationCurve::KeyFrame::Linear, 0.0f, {q0.x, q0.y, q0.z, q0.w} });
+        ASSERT_FALSE(curve.isCompiled());
+
+        track.fixCurves();
+        ASSERT_TRUE(curve.isCompiled());
+
+        Quaternion result(Vector3(45.0f, 0.0f, 0.0f));
+        ASSERT_TRUE(result.equal(track.valueQuaternion(0.5f)));
+        ASSERT_TRUE(q1.equal(track.valueQuaternion(1.0f)));
+
+        // Mutable access drops compiled data
+        ASSERT_FALSE(track.curve().isCompiled());
+    }
 }
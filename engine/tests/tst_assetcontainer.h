@@ -0,0 +1,96 @@
+#include "gtest/gtest.h"
+
+#include "resources/mesh.h"
+#include "resources/texture.h"
+
+#include "utils/assetcontainer.h"
+
+namespace EngineSuite {
+
+    class AssetContainerTest : public ::testing::Test {
+
+    };
+
+    TEST_F(AssetContainerTest, Pack_and_load_mesh) {
+        ObjectSystem system;
+        Mesh::registerClassFactory(&system);
+
+        Mesh *mesh = ObjectSystem::objectCreate<Mesh>();
+        mesh->setVertices({ Vector3(0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f) });
+        mesh->setUv0({ Vector2(0.0f), Vector2(1.0f, 0.0f), Vector2(0.0f, 1.0f) });
+        mesh->setIndices({ 0, 1, 2 });
+
+        ByteArray data = AssetContainer::pack(Engine::toVariant(mesh));
+        ASSERT_TRUE(AssetContainer::isContainer(data.data(), data.size()));
+
+        IndexVector indices = mesh->indices();
+        delete mesh;
+
+        AssetContainer container;
+        ASSERT_TRUE(container.load(data));
+        ASSERT_FALSE(container.isMapped());
+
+        // Metadata, positions, indices and uv0
+        ASSERT_EQ(container.sectionCount(), uint32_t(4));
+        for(uint32_t i = 0; i < container.sectionCount(); i++) {
+            ASSERT_EQ(reinterpret_cast<uintptr_t>(container.section(i)) % 16, uintptr_t(0));
+        }
+        ASSERT_EQ(container.sectionSize(1), sizeof(Vector3) * 3);
+
+        AssetContainer::setCurrent(&container);
+        Mesh *result = dynamic_cast<Mesh *>(Engine::toObject(container.metadata()));
+        AssetContainer::setCurrent(nullptr);
+
+        ASSERT_TRUE(result != nullptr);
+        ASSERT_EQ(result->vertices().size(), size_t(3));
+        ASSERT_EQ(result->vertices()[1], Vector3(1.0f, 0.0f, 0.0f));
+        ASSERT_EQ(result->indices(), indices);
+        ASSERT_EQ(result->uv0()[2], Vector2(0.0f, 1.0f));
+
+        delete result;
+    }
+
+    TEST_F(AssetContainerTest, Pack_and_load_texture) {
+        ObjectSystem system;
+        Texture::registerClassFactory(&system);
+
+        Texture *texture = ObjectSystem::objectCreate<Texture>();
+        texture->addSurface({ ByteArray(64, 1), ByteArray(16, 2) });
+
+        AssetContainer container;
+        ASSERT_TRUE(container.load(AssetContainer::pack(Engine::toVariant(texture))));
+        ASSERT_EQ(container.sectionCount(), uint32_t(3));
+
+        delete texture;
+
+        AssetContainer::setCurrent(&container);
+        Texture *result = dynamic_cast<Texture *>(Engine::toObject(container.metadata()));
+        AssetContainer::setCurrent(nullptr);
+
+        ASSERT_TRUE(result != nullptr);
+        ASSERT_EQ(result->sides(), 1);
+        ASSERT_EQ(result->surface(0).size(), size_t(2));
+        ASSERT_EQ(result->surface(0)[0], ByteArray(64, 1));
+        ASSERT_EQ(result->surface(0)[1], ByteArray(16, 2));
+
+        delete result;
+    }
+
+    TEST_F(AssetContainerTest, Reject_invalid_data) {
+        ObjectSystem system;
+        Texture::registerClassFactory(&system);
+
+        Texture *texture = ObjectSystem::objectCreate<Texture>();
+        ByteArray data = AssetContainer::pack(Engine::toVariant(texture));
+        delete texture;
+
+        AssetContainer container;
+        ASSERT_TRUE(container.load(data));
+
+        data.resize(data.size() / 2);
+        ASSERT_FALSE(container.load(data));
+        ASSERT_FALSE(container.isValid());
+
+        ASSERT_FALSE(container.load(ByteArray(8, 0)));
+    }
+}
@@ -0,0 +1,160 @@
+#include "gtest/gtest.h"
+
+#include "utils/boundingtree.h"
+
+#include <set>
+
+namespace EngineSuite {
+
+    class BoundingTreeTest : public ::testing::Test {
+    public:
+        void SetUp() override {
+            m_seed = 1;
+
+            m_objects.resize(1000);
+            m_boxes.resize(m_objects.size());
+            for(auto &it : m_boxes) {
+                it = randomBox();
+            }
+        }
+
+        float random(float range) {
+            m_seed = m_seed * 1664525 + 1013904223;
+            return (float(m_seed >> 8) / float(1 << 24) * 2.0f - 1.0f) * range;
+        }
+
+        AABBox randomBox() {
+            Vector3 extent(fabsf(random(2.0f)) + 0.1f, fabsf(random(2.0f)) + 0.1f, fabsf(random(2.0f)) + 0.1f);
+            return AABBox(Vector3(random(100.0f), random(100.0f), random(100.0f)), extent);
+        }
+
+        bool intersects(const Frustum &frustum, const AABBox &bb) {
+            const Plane *planes[6] = { &frustum.m_top, &frustum.m_bottom, &frustum.m_left, &frustum.m_right, &frustum.m_near, &frustum.m_far };
+            for(auto plane : planes) {
+                float d = plane->normal.dot(bb.center) - plane->d;
+                float r = fabsf(plane->normal.x) * bb.extent.x + fabsf(plane->normal.y) * bb.extent.y + fabsf(plane->normal.z) * bb.extent.z;
+                if(d < -r) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        std::set<Object *> toSet(const Object::ObjectList &list) {
+            std::set<Object *> result(list.begin(), list.end());
+            EXPECT_EQ(result.size(), list.size());
+            return result;
+        }
+
+        uint32_t m_seed;
+
+        std::vector<Object> m_objects;
+
+        std::vector<AABBox> m_boxes;
+
+    };
+
+    TEST_F(BoundingTreeTest, Balance) {
+        BoundingTree tree;
+        for(size_t i = 0; i < m_objects.size(); i++) {
+            tree.insert(m_boxes[i], &m_objects[i]);
+        }
+
+        ASSERT_EQ(tree.count(), int32_t(m_objects.size()));
+        ASSERT_TRUE(tree.height() < 2 * 10);
+
+        tree.clear();
+        ASSERT_EQ(tree.count(), 0);
+        ASSERT_EQ(tree.height(), -1);
+    }
+
+    TEST_F(BoundingTreeTest, Queries) {
+        BoundingTree tree(0.0f);
+        for(size_t i = 0; i < m_objects.size(); i++) {
+            tree.insert(m_boxes[i], &m_objects[i]);
+        }
+
+        Frustum frustum;
+        frustum.m_top = Plane(Vector3(0.0f, 30.0f, 0.0f), Vector3(0.0f,-1.0f, 0.0f));
+        frustum.m_bottom = Plane(Vector3(0.0f,-30.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+        frustum.m_left = Plane(Vector3(-30.0f, 0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f));
+        frustum.m_right = Plane(Vector3(30.0f, 0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f));
+        frustum.m_near = Plane(Vector3(0.0f, 0.0f,-30.0f), Vector3(0.0f, 0.0f, 1.0f));
+        frustum.m_far = Plane(Vector3(0.0f, 0.0f, 30.0f), Vector3(0.0f, 0.0f,-1.0f));
+
+        AABBox box(Vector3(10.0f, 0.0f, -20.0f), Vector3(25.0f));
+
+        Vector3 center(-20.0f, 10.0f, 0.0f);
+        float radius = 30.0f;
+
+        Object::ObjectList frustumList;
+        tree.query(frustum, frustumList);
+
+        Object::ObjectList boxList;
+        tree.query(box, boxList);
+
+        Object::ObjectList sphereList;
+        tree.query(center, radius, sphereList);
+
+        std::set<Object *> frustumResult(toSet(frustumList));
+        std::set<Object *> boxResult(toSet(boxList));
+        std::set<Object *> sphereResult(toSet(sphereList));
+
+        ASSERT_FALSE(frustumResult.empty());
+        ASSERT_TRUE(frustumResult.size() < m_objects.size());
+
+        Vector3 boxMin(box.center - box.extent);
+        Vector3 boxMax(box.center + box.extent);
+        for(size_t i = 0; i < m_objects.size(); i++) {
+            const AABBox &bb = m_boxes[i];
+            Vector3 min(bb.center - bb.extent);
+            Vector3 max(bb.center + bb.extent);
+
+            bool inFrustum = intersects(frustum, bb);
+            ASSERT_EQ(frustumResult.count(&m_objects[i]) > 0, inFrustum);
+
+            bool inBox = min.x <= boxMax.x && max.x >= boxMin.x &&
+                         min.y <= boxMax.y && max.y >= boxMin.y &&
+                         min.z <= boxMax.z && max.z >= boxMin.z;
+            ASSERT_EQ(boxResult.count(&m_objects[i]) > 0, inBox);
+
+            Vector3 closest(CLAMP(center.x, min.x, max.x), CLAMP(center.y, min.y, max.y), CLAMP(center.z, min.z, max.z));
+            bool inSphere = (closest - center).sqrLength() <= radius * radius;
+            ASSERT_EQ(sphereResult.count(&m_objects[i]) > 0, inSphere);
+        }
+    }
+
+    TEST_F(BoundingTreeTest, Update_and_remove) {
+        BoundingTree tree;
+
+        std::vector<int32_t> proxies(m_objects.size());
+        for(size_t i = 0; i < m_objects.size(); i++) {
+            proxies[i] = tree.insert(m_boxes[i], &m_objects[i]);
+        }
+
+        // Small movements stay inside of the enlarged boxes
+        AABBox moved(m_boxes[0].center + m_boxes[0].extent * 0.05f, m_boxes[0].extent);
+        ASSERT_FALSE(tree.update(proxies[0], moved));
+
+        for(size_t i = 0; i < m_objects.size(); i++) {
+            m_boxes[i] = randomBox();
+            tree.update(proxies[i], m_boxes[i]);
+        }
+
+        for(size_t i = 0; i < m_objects.size(); i += 2) {
+            tree.remove(proxies[i]);
+        }
+        ASSERT_EQ(tree.count(), int32_t(m_objects.size() / 2));
+
+        for(size_t i = 1; i < m_objects.size(); i += 2) {
+            ASSERT_EQ(tree.object(proxies[i]), &m_objects[i]);
+
+            Object::ObjectList list;
+            tree.query(m_boxes[i], list);
+
+            std::set<Object *> result(toSet(list));
+            ASSERT_EQ(result.count(&m_objects[i]), size_t(1));
+            ASSERT_EQ(result.count(&m_objects[i - 1]), size_t(0));
+        }
+    }
+}
@@ -0,0 +1,126 @@
+#include "gtest/gtest.h"
+
+#include "commandlist.h"
+#include "commandbuffer.h"
+
+#include "resources/mesh.h"
+#include "resources/material.h"
+#include "resources/rendertarget.h"
+
+#include <jobsystem.h>
+
+namespace EngineSuite {
+
+    class ReplayBuffer : public CommandBuffer {
+    public:
+        void drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, MaterialInstance &instance) override {
+            log += TString("DrawInstanced %1 %2 %3 %4\n").arg(mesh->name(), TString::number(int32_t(sub)), TString::number(int32_t(layer)), instance.material()->name());
+        }
+
+        void setRenderTarget(RenderTarget *target, uint32_t level) override {
+            log += TString("SetTarget %1 %2\n").arg(target->name(), TString::number(int32_t(level)));
+        }
+
+        void setViewport(int32_t x, int32_t y, int32_t width, int32_t height) override {
+            log += TString("SetViewport %1 %2 %3 %4\n").arg(TString::number(x), TString::number(y), TString::number(width), TString::number(height));
+        }
+
+        void setViewProjection(const Matrix4 &viewProjection) override {
+            log += TString("SetViewProjection %1\n").arg(TString::number(viewProjection[12]));
+        }
+
+        void beginDebugMarker(const TString &name) override {
+            log += TString("BeginMarker %1\n").arg(name);
+        }
+
+        void endDebugMarker() override {
+            log += "EndMarker\n";
+        }
+
+        TString log;
+    };
+
+    class CommandListTest : public ::testing::Test {
+
+    };
+
+    TEST_F(CommandListTest, Record_and_dump) {
+        RenderTarget target;
+        target.setName("target");
+
+        Mesh mesh;
+        mesh.setName("mesh");
+
+        Material material;
+        material.setName("material");
+        MaterialInstance instance(&material);
+
+        CommandList list;
+        ASSERT_TRUE(list.isEmpty());
+
+        list.beginDebugMarker("Pass");
+        list.setRenderTarget(&target);
+        list.setViewport(0, 0, 640, 480);
+        list.bindMaterial(&instance);
+        list.drawInstanced(&mesh, 1, Material::Opaque);
+        list.endDebugMarker();
+
+        ASSERT_EQ(list.count(), uint32_t(6));
+        ASSERT_EQ(list.type(4), CommandList::DrawInstanced);
+        ASSERT_EQ(list.command<CommandList::DrawCommand>(4).mesh, &mesh);
+        ASSERT_EQ(list.command<CommandList::RectCommand>(2).width, 640);
+        ASSERT_EQ(list.string(list.command<CommandList::MarkerCommand>(0).name), TString("Pass"));
+
+        ASSERT_EQ(list.dump(), TString("BeginMarker Pass\n"
+                                       "SetTarget target 0\n"
+                                       "SetViewport 0 0 640 480\n"
+                                       "BindMaterial material 0\n"
+                                       "DrawInstanced mesh 1 1\n"
+                                       "EndMarker\n"));
+
+        list.clear();
+        ASSERT_TRUE(list.isEmpty());
+        ASSERT_TRUE(list.data().empty());
+    }
+
+    TEST_F(CommandListTest, Parallel_recording) {
+        RenderTarget target;
+        target.setName("target");
+
+        Mesh mesh;
+        mesh.setName("mesh");
+
+        Material material;
+        material.setName("material");
+        MaterialInstance instance(&material);
+
+        const uint32_t count = 64;
+        std::vector<CommandList> lists(count);
+
+        JobSystem jobs(4);
+        jobs.parallelFor(count, 1, [&](uint32_t begin, uint32_t end) {
+            for(uint32_t i = begin; i < end; i++) {
+                Matrix4 crop;
+                crop[12] = i;
+
+                lists[i].setRenderTarget(&target, i);
+                lists[i].setViewProjection(crop);
+                lists[i].bindMaterial(&instance);
+                lists[i].drawInstanced(&mesh, 0, Material::Shadowcast);
+            }
+        });
+
+        ReplayBuffer buffer;
+
+        TString expected;
+        for(uint32_t i = 0; i < count; i++) {
+            buffer.execute(lists[i]);
+
+            expected += TString("SetTarget target %1\n").arg(TString::number(int32_t(i)));
+            expected += TString("SetViewProjection %1\n").arg(TString::number(float(i)));
+            expected += "DrawInstanced mesh 0 8 material\n";
+        }
+
+        ASSERT_EQ(buffer.log, expected);
+    }
+}
@@ -1,3 +1,16 @@
 #include "tst_actor.h"
 #include "tst_animationtrack.h"
 #include "tst_animator.h"
+#include "tst_assetcontainer.h"
+#include "tst_boundingtree.h"
+#include "tst_commandlist.h"
+#include "tst_mesh.h"
+#include "tst_meshoptimizer.h"
+#include "tst_pipelinecontext.h"
+#include "tst_renderqueue.h"
+#include "tst_resourcesystem.h"
+#include "tst_systemscheduler.h"
+#include "tst_texturestreamer.h"
+#include "tst_tilemap.h"
+#include "tst_transformstorage.h"
+#include "tst_visualeffect.h"
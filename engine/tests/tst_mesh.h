@@ -0,0 +1,203 @@
+#include "gtest/gtest.h"
+
+#include "resources/mesh.h"
+
+#include <cstring>
+
+namespace EngineSuite {
+
+    class MeshTest : public ::testing::Test {
+    public:
+        void fillSkinned(Mesh &mesh) {
+            mesh.setVertices({ Vector3(0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f) });
+            mesh.setUv0({ Vector2(0.0f), Vector2(1.0f, 0.5f), Vector2(0.25f, 2.0f) });
+            mesh.setColors({ Vector4(1.0f), Vector4(0.0f, 0.5f, 1.0f, 1.0f), Vector4(0.0f) });
+            mesh.setNormals({ Vector3(0.0f, 0.0f, 1.0f), Vector3(0.0f, 0.0f, -1.0f), Vector3(1.0f, 0.0f, 0.0f) });
+            mesh.setTangents({ Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(0.0f, -1.0f, 0.0f) });
+            mesh.setBones({ Vector4(0.0f, 1.0f, 2.0f, 3.0f), Vector4(4.0f), Vector4(255.0f, 0.0f, 0.0f, 0.0f) });
+            mesh.setWeights({ Vector4(0.5f, 0.25f, 0.25f, 0.0f), Vector4(1.0f, 0.0f, 0.0f, 0.0f), Vector4(0.3f, 0.3f, 0.3f, 0.0f) });
+            mesh.setIndices({ 0, 1, 2 });
+        }
+    };
+
+    TEST_F(MeshTest, Unpacked_layout) {
+        Mesh mesh;
+        fillSkinned(mesh);
+
+        Mesh::VertexLayout layout = mesh.vertexLayout();
+        ASSERT_EQ(layout.size(), size_t(7));
+
+        // Attributes are stored in consecutive blocks
+        ASSERT_EQ(layout[0].location, uint32_t(Mesh::Position));
+        ASSERT_EQ(layout[0].stride, uint32_t(sizeof(Vector3)));
+        ASSERT_EQ(layout[1].offset, uint32_t(sizeof(Vector3) * 3));
+        ASSERT_EQ(layout[1].format, uint32_t(Mesh::Float2));
+
+        ASSERT_EQ(mesh.indexSize(), uint32_t(sizeof(uint32_t)));
+        ASSERT_EQ(mesh.vertexBufferSize(), size_t((12 + 8 + 16 + 12 + 12 + 16 + 16) * 3));
+
+        ByteArray buffer(mesh.vertexBufferSize());
+        mesh.fillVertexBuffer(buffer.data());
+
+        Vector2 uv;
+        memcpy(&uv, buffer.data() + layout[1].offset + layout[1].stride * 2, sizeof(Vector2));
+        ASSERT_EQ(uv, Vector2(0.25f, 2.0f));
+    }
+
+    TEST_F(MeshTest, Packed_layout) {
+        Mesh mesh;
+        fillSkinned(mesh);
+        mesh.setPacked(true);
+        ASSERT_TRUE(mesh.isPacked());
+
+        Mesh::VertexLayout layout = mesh.vertexLayout();
+        ASSERT_EQ(layout.size(), size_t(7));
+
+        // Position, uv0, color, normal, tangent, bones, weights
+        const uint32_t stride = 12 + 4 + 4 + 4 + 4 + 8 + 4;
+        for(auto &it : layout) {
+            ASSERT_EQ(it.stride, stride);
+        }
+        ASSERT_EQ(layout[5].format, uint32_t(Mesh::Half4));
+        ASSERT_EQ(layout[5].offset, uint32_t(28));
+
+        ASSERT_EQ(mesh.vertexBufferSize(), size_t(stride * 3));
+        ASSERT_EQ(mesh.indexSize(), uint32_t(sizeof(uint16_t)));
+        ASSERT_EQ(mesh.indexBufferSize(), size_t(6));
+        ASSERT_EQ(mesh.gpuMemory(), uint64_t(stride * 3 + 6));
+
+        ByteArray buffer(mesh.vertexBufferSize());
+        mesh.fillVertexBuffer(buffer.data());
+        const uint8_t *vertex = buffer.data() + stride;
+
+        Vector3 position;
+        memcpy(&position, vertex, sizeof(Vector3));
+        ASSERT_EQ(position, Vector3(1.0f, 0.0f, 0.0f));
+
+        uint16_t half[4];
+        memcpy(half, vertex + layout[1].offset, sizeof(uint16_t) * 2);
+        ASSERT_EQ(half[0], uint16_t(0x3c00)); // 1.0
+        ASSERT_EQ(half[1], uint16_t(0x3800)); // 0.5
+
+        uint8_t color[4];
+        memcpy(color, vertex + layout[2].offset, sizeof(color));
+        ASSERT_EQ(color[0], uint8_t(0));
+        ASSERT_EQ(color[1], uint8_t(128));
+        ASSERT_EQ(color[2], uint8_t(255));
+
+        uint32_t normal;
+        memcpy(&normal, vertex + layout[3].offset, sizeof(uint32_t));
+        ASSERT_EQ(normal & 0x3ff, uint32_t(0));
+        ASSERT_EQ((normal >> 20) & 0x3ff, uint32_t(0x201)); // -511 in 10 bits
+
+        memcpy(half, buffer.data() + stride * 2 + layout[5].offset, sizeof(half));
+        ASSERT_EQ(half[0], uint16_t(0x5bf8)); // 255.0
+
+        // Quantized weights always sum to one
+        for(uint32_t v = 0; v < 3; v++) {
+            uint8_t weights[4];
+            memcpy(weights, buffer.data() + stride * v + layout[6].offset, sizeof(weights));
+            ASSERT_EQ(weights[0] + weights[1] + weights[2] + weights[3], 255);
+        }
+
+        ByteArray indices(mesh.indexBufferSize());
+        mesh.fillIndexBuffer(indices.data());
+        uint16_t index;
+        memcpy(&index, indices.data() + sizeof(uint16_t) * 2, sizeof(uint16_t));
+        ASSERT_EQ(index, uint16_t(2));
+    }
+
+    TEST_F(MeshTest, Packed_fallback) {
+        Mesh mesh;
+        fillSkinned(mesh);
+        mesh.setPacked(true);
+        mesh.makeDynamic();
+
+        // Dynamic meshes are updated from the CPU every frame and stay in full precision
+        ASSERT_FALSE(mesh.isPacked());
+        ASSERT_EQ(mesh.vertexLayout()[1].format, uint32_t(Mesh::Float2));
+
+        Mesh large;
+        large.setPacked(true);
+        large.setVertices(Vector3Vector(70000, Vector3(0.0f)));
+        large.setIndices({ 0, 1, 69999 });
+
+        ASSERT_EQ(large.indexSize(), uint32_t(sizeof(uint32_t)));
+        ASSERT_EQ(large.vertexLayout()[0].stride, uint32_t(sizeof(Vector3)));
+    }
+
+    TEST_F(MeshTest, Attributes_clamped) {
+        const uint8_t guard = 0xcd;
+
+        for(int packed = 0; packed < 2; packed++) {
+            Mesh mesh;
+            fillSkinned(mesh);
+            mesh.setPacked(packed == 1);
+
+            // Attributes longer than the vertex array must not write past the buffer
+            mesh.setUv0(Vector2Vector(8, Vector2(1.0f)));
+            mesh.setColors(Vector4Vector(8, Vector4(1.0f)));
+            mesh.setNormals(Vector3Vector(8, Vector3(0.0f, 0.0f, 1.0f)));
+            mesh.setTangents(Vector3Vector(8, Vector3(1.0f, 0.0f, 0.0f)));
+            mesh.setBones(Vector4Vector(8, Vector4(1.0f)));
+            mesh.setWeights(Vector4Vector(8, Vector4(1.0f, 0.0f, 0.0f, 0.0f)));
+
+            size_t size = mesh.vertexBufferSize();
+            ByteArray buffer(size + 256, guard);
+            mesh.fillVertexBuffer(buffer.data());
+
+            for(size_t i = size; i < buffer.size(); i++) {
+                ASSERT_EQ(buffer[i], guard);
+            }
+        }
+    }
+
+    TEST_F(MeshTest, Lod_ranges) {
+        ObjectSystem system;
+        Mesh::registerClassFactory(&system);
+
+        Mesh *mesh = ObjectSystem::objectCreate<Mesh>();
+        mesh->setVertices({ Vector3(0.0f), Vector3(1.0f, 0.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f) });
+        mesh->setIndices({ 0, 1, 2, 1, 3, 2, 0, 3, 2 });
+        mesh->setSubMesh(0, 0);
+        mesh->setSubMesh(6, 1);
+
+        mesh->addLod({ 0, 1, 3, 0, 3, 2 }, { 0, 3 }, 0.5f);
+        mesh->addLod({ 0, 1, 3 }, { 0, 3 }, 0.2f);
+
+        ASSERT_EQ(mesh->lodCount(), 3);
+        ASSERT_EQ(mesh->subMeshCount(), 2);
+
+        // Ranges of all levels follow the original geometry in the same index buffer
+        ASSERT_EQ(mesh->indexCount(mesh->lodSubMesh(0, 0)), 6);
+        ASSERT_EQ(mesh->indexStart(mesh->lodSubMesh(1, 1)), 12);
+        ASSERT_EQ(mesh->indexCount(mesh->lodSubMesh(0, 2)), 3);
+        ASSERT_EQ(mesh->indexCount(mesh->lodSubMesh(1, 2)), 0);
+        ASSERT_EQ(mesh->lodSubMesh(1, 5), mesh->lodSubMesh(1, 2));
+
+        // Levels change only outside of the hysteresis band
+        ASSERT_EQ(mesh->selectLod(1.0f, 0, 0.1f), 0);
+        ASSERT_EQ(mesh->selectLod(0.4f, 0, 0.1f), 1);
+        ASSERT_EQ(mesh->selectLod(0.47f, 0, 0.1f), 0);
+        ASSERT_EQ(mesh->selectLod(0.53f, 1, 0.1f), 1);
+        ASSERT_EQ(mesh->selectLod(0.6f, 1, 0.1f), 0);
+        ASSERT_EQ(mesh->selectLod(0.01f, 0, 0.1f), 2);
+        ASSERT_EQ(mesh->selectLod(0.01f, 7, 0.1f), 2);
+
+        Variant data = Engine::toVariant(mesh);
+        delete mesh;
+
+        Mesh *result = dynamic_cast<Mesh *>(Engine::toObject(data));
+        ASSERT_TRUE(result != nullptr);
+        ASSERT_EQ(result->lodCount(), 3);
+        ASSERT_EQ(result->subMeshCount(), 2);
+        ASSERT_FLOAT_EQ(result->lodScreenSize(2), 0.2f);
+        ASSERT_EQ(result->indexStart(result->lodSubMesh(0, 2)), 15);
+
+        result->clearLods();
+        ASSERT_EQ(result->lodCount(), 1);
+        ASSERT_EQ(result->indices().size(), size_t(9));
+
+        delete result;
+    }
+}
@@ -0,0 +1,187 @@
+#include "gtest/gtest.h"
+
+#include "resources/mesh.h"
+
+#include "utils/meshoptimizer.h"
+
+#include <algorithm>
+
+namespace EngineSuite {
+
+    class MeshOptimizerTest : public ::testing::Test {
+    public:
+        // Flat grid with triangles in a scattered order
+        void fillGrid(Mesh &mesh, uint32_t size) {
+            Vector3Vector vertices;
+            Vector2Vector uv0;
+            for(uint32_t y = 0; y <= size; y++) {
+                for(uint32_t x = 0; x <= size; x++) {
+                    vertices.push_back(Vector3(x, y, 0.0f));
+                    uv0.push_back(Vector2(x, y));
+                }
+            }
+
+            IndexVector triangles;
+            for(uint32_t y = 0; y < size; y++) {
+                for(uint32_t x = 0; x < size; x++) {
+                    uint32_t i = y * (size + 1) + x;
+                    triangles.insert(triangles.end(), { i, i + 1, i + size + 2 });
+                    triangles.insert(triangles.end(), { i, i + size + 2, i + size + 1 });
+                }
+            }
+
+            uint32_t count = triangles.size() / 3;
+            IndexVector indices;
+            for(uint32_t t = 0; t < count; t++) {
+                uint32_t s = (t * 7919) % count;
+                indices.insert(indices.end(), &triangles[s * 3], &triangles[s * 3 + 3]);
+            }
+
+            mesh.setVertices(vertices);
+            mesh.setUv0(uv0);
+            mesh.setIndices(indices);
+        }
+    };
+
+    TEST_F(MeshOptimizerTest, Vertex_cache) {
+        Mesh mesh;
+        fillGrid(mesh, 32);
+
+        IndexVector original = mesh.indices();
+
+        MeshOptimizer::Statistics before = MeshOptimizer::analyzeVertexCache(mesh);
+        MeshOptimizer::optimizeVertexCache(mesh.indices().data(), mesh.indices().size(), mesh.vertices().size());
+        MeshOptimizer::Statistics after = MeshOptimizer::analyzeVertexCache(mesh);
+
+        ASSERT_GT(before.acmr, 2.0f);
+        ASSERT_LT(after.acmr, 1.0f);
+        ASSERT_LT(after.atvr, before.atvr);
+        ASSERT_GE(after.atvr, 1.0f);
+
+        // The same set of triangles
+        IndexVector result = mesh.indices();
+        std::sort(original.begin(), original.end());
+        std::sort(result.begin(), result.end());
+        ASSERT_EQ(original, result);
+    }
+
+    TEST_F(MeshOptimizerTest, Vertex_fetch) {
+        Mesh mesh;
+        fillGrid(mesh, 8);
+
+        IndexVector indices = mesh.indices();
+        Vector3Vector vertices = mesh.vertices();
+
+        MeshOptimizer::optimize(mesh, MeshOptimizer::VertexCache | MeshOptimizer::Overdraw | MeshOptimizer::VertexFetch);
+
+        // Vertices are referenced in the order of first use
+        uint32_t next = 0;
+        for(auto it : mesh.indices()) {
+            ASSERT_LE(it, next);
+            next = std::max(next, it + 1);
+        }
+
+        // Triangles still reference the same positions and attributes follow them
+        std::vector<Vector3> expected;
+        for(auto it : indices) {
+            expected.push_back(vertices[it]);
+        }
+        std::vector<Vector3> result;
+        for(uint32_t i = 0; i < mesh.indices().size(); i++) {
+            uint32_t v = mesh.indices()[i];
+            result.push_back(mesh.vertices()[v]);
+            ASSERT_EQ(mesh.uv0()[v], Vector2(mesh.vertices()[v].x, mesh.vertices()[v].y));
+        }
+
+        auto less = [](const Vector3 &left, const Vector3 &right) {
+            return left.x < right.x || (left.x == right.x && left.y < right.y);
+        };
+        std::sort(expected.begin(), expected.end(), less);
+        std::sort(result.begin(), result.end(), less);
+        ASSERT_EQ(expected, result);
+    }
+
+    TEST_F(MeshOptimizerTest, Clusters) {
+        Mesh mesh;
+        fillGrid(mesh, 16);
+
+        MeshOptimizer::optimize(mesh, MeshOptimizer::VertexCache | MeshOptimizer::Clusters);
+
+        const Mesh::ClusterVector &clusters = mesh.clusters();
+        ASSERT_GT(clusters.size(), size_t(1));
+
+        uint32_t start = 0;
+        for(auto &it : clusters) {
+            ASSERT_EQ(it.indexStart, start);
+            ASSERT_LE(it.indexCount, uint32_t(124 * 3));
+            start += it.indexCount;
+
+            std::vector<uint32_t> unique(&mesh.indices()[it.indexStart], &mesh.indices()[it.indexStart + it.indexCount]);
+            std::sort(unique.begin(), unique.end());
+            unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+            ASSERT_LE(unique.size(), size_t(64));
+
+            for(auto v : unique) {
+                ASSERT_LE((mesh.vertices()[v] - it.center).length(), it.radius + 0.0001f);
+            }
+
+            // All triangles of the flat grid face the same direction
+            ASSERT_NEAR(it.coneAxis.z, 1.0f, 0.0001f);
+            ASSERT_NEAR(it.coneCutoff, 0.0f, 0.001f);
+        }
+        ASSERT_EQ(start, uint32_t(mesh.indices().size()));
+    }
+
+    TEST_F(MeshOptimizerTest, Simplify) {
+        Mesh mesh;
+        fillGrid(mesh, 16);
+        mesh.setUv0(Vector2Vector());
+
+        const IndexVector &indices = mesh.indices();
+
+        float error = 1.0f;
+        IndexVector result = MeshOptimizer::simplify(mesh, indices.data(), indices.size(), indices.size() / 4, 0.01f, &error);
+
+        ASSERT_GT(result.size(), size_t(0));
+        ASSERT_LE(result.size(), indices.size() / 4);
+        ASSERT_EQ(result.size() % 3, size_t(0));
+
+        // Flat plane is simplified without a geometric error, the border stays in place
+        ASSERT_NEAR(error, 0.0f, 0.0001f);
+
+        float area = 0.0f;
+        for(size_t i = 0; i < result.size(); i += 3) {
+            const Vector3 &a = mesh.vertices()[result[i]];
+            Vector3 n = (mesh.vertices()[result[i + 1]] - a).cross(mesh.vertices()[result[i + 2]] - a);
+            ASSERT_GT(n.z, 0.0f);
+            area += n.z * 0.5f;
+        }
+        ASSERT_NEAR(area, 256.0f, 0.01f);
+
+        for(uint32_t i = 0; i <= 16; i++) {
+            ASSERT_NE(std::find(result.begin(), result.end(), i), result.end());
+        }
+    }
+
+    TEST_F(MeshOptimizerTest, Lods) {
+        Mesh mesh;
+        fillGrid(mesh, 16);
+        for(auto &it : mesh.uv0()) {
+            it = it * (1.0f / 16.0f);
+        }
+
+        MeshOptimizer::generateLods(mesh, 3);
+        ASSERT_GT(mesh.lodCount(), 1);
+
+        MeshOptimizer::optimize(mesh);
+
+        for(int lod = 1; lod < mesh.lodCount(); lod++) {
+            ASSERT_LT(mesh.indexCount(mesh.lodSubMesh(0, lod)), mesh.indexCount(mesh.lodSubMesh(0, lod - 1)));
+            ASSERT_LT(mesh.lodScreenSize(lod), mesh.lodScreenSize(lod - 1));
+        }
+
+        int last = mesh.lodSubMesh(0, mesh.lodCount() - 1);
+        ASSERT_EQ(size_t(mesh.indexStart(last) + mesh.indexCount(last)), mesh.indices().size());
+        ASSERT_EQ(mesh.indexCount(mesh.lodSubMesh(0, 0)), 16 * 16 * 6);
+    }
+}
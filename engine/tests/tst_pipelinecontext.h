@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+
+#include "pipelinecontext.h"
+#include "pipelinetask.h"
+
+#include "resources/pipeline.h"
+#include "resources/texture.h"
+
+#include "systems/rendersystem.h"
+
+class GraphSource : public PipelineTask {
+    A_OBJECT(GraphSource, PipelineTask, Pipeline)
+
+public:
+    GraphSource() {
+        m_outputs.push_back(std::make_pair("sourceMap", nullptr));
+
+        addTransient("sourceDown", Texture::RGBA16Float, Texture::Bilinear, 1);
+        addTransient("sourceBlur", Texture::RGBA16Float, Texture::Bilinear, 1);
+    }
+};
+
+class GraphFilter : public PipelineTask {
+    A_OBJECT(GraphFilter, PipelineTask, Pipeline)
+
+public:
+    GraphFilter() {
+        m_inputs.push_back("In");
+        m_outputs.push_back(std::make_pair("filterMap", nullptr));
+
+        addTransient("filterDown", Texture::RGBA16Float, Texture::Bilinear, 1);
+        addTransient("filterMask", Texture::R8, Texture::None, 0);
+    }
+};
+
+class GraphUnused : public PipelineTask {
+    A_OBJECT(GraphUnused, PipelineTask, Pipeline)
+
+public:
+    GraphUnused() {
+        m_outputs.push_back(std::make_pair("unusedMap", nullptr));
+
+        addTransient("unusedMask", Texture::R8, Texture::None, 0);
+    }
+};
+
+class GraphExtra : public PipelineTask {
+    A_OBJECT(GraphExtra, PipelineTask, Pipeline)
+
+public:
+    GraphExtra() {
+        addTransient("extraMask", Texture::R8, Texture::None, 0);
+    }
+};
+
+namespace EngineSuite {
+
+    class PipelineContextTest : public ::testing::Test {
+
+    };
+
+    TEST_F(PipelineContextTest, Frame_graph) {
+        Engine system;
+        RenderSystem render;
+        GraphSource::registerClassFactory(&render);
+        GraphFilter::registerClassFactory(&render);
+        GraphUnused::registerClassFactory(&render);
+
+        Pipeline pipeline;
+        pipeline.loadUserData({
+            {"Tasks", VariantList({"GraphSource", "GraphUnused", "GraphFilter"})},
+            {"Links", VariantList({VariantList({"GraphSource", "GraphFilter", 0, 0})})}
+        });
+
+        PipelineContext *context = Engine::objectCreate<PipelineContext>();
+        context->setPipeline(&pipeline);
+
+        PipelineTask *source = nullptr;
+        PipelineTask *filter = nullptr;
+        PipelineTask *unused = nullptr;
+        for(auto it : context->renderTasks()) {
+            if(it->name() == "GraphSource") {
+                source = it;
+            } else if(it->name() == "GraphFilter") {
+                filter = it;
+            } else if(it->name() == "GraphUnused") {
+                unused = it;
+            }
+        }
+        ASSERT_TRUE(source != nullptr && filter != nullptr && unused != nullptr);
+
+        uint64_t memory = context->renderTargetMemory();
+
+        // Output of the task is not consumed by the final task
+        ASSERT_TRUE(unused->transient(0) == nullptr);
+
+        // Transients are shared between the tasks but not within the same task
+        ASSERT_TRUE(source->transient(0) != nullptr);
+        ASSERT_TRUE(source->transient(0) != source->transient(1));
+        ASSERT_EQ(filter->transient(0), source->transient(0));
+        ASSERT_EQ(source->transient(0)->width(), 32);
+        ASSERT_EQ(filter->transient(1)->width(), 64);
+
+        ASSERT_EQ(memory, source->transient(0)->gpuMemory() + source->transient(1)->gpuMemory() + filter->transient(1)->gpuMemory());
+
+        context->resize(128, 64);
+        ASSERT_GT(context->renderTargetMemory(), memory);
+        ASSERT_EQ(source->transient(1)->width(), 64);
+        ASSERT_EQ(source->transient(1)->height(), 32);
+
+        delete context;
+    }
+
+    TEST_F(PipelineContextTest, Late_task) {
+        Engine system;
+        RenderSystem render;
+        GraphSource::registerClassFactory(&render);
+        GraphExtra::registerClassFactory(&render);
+
+        Pipeline pipeline;
+        pipeline.loadUserData({
+            {"Tasks", VariantList({"GraphSource"})}
+        });
+
+        PipelineContext *context = Engine::objectCreate<PipelineContext>();
+        context->setPipeline(&pipeline);
+
+        uint64_t memory = context->renderTargetMemory();
+
+        // Task inserted after the graph compilation must be scheduled on the next frame
+        PipelineTask *extra = Engine::objectCreate<GraphExtra>("GraphExtra", context);
+        context->insertRenderTask(extra);
+
+        ASSERT_GT(context->renderTargetMemory(), memory);
+        ASSERT_TRUE(extra->transient(0) != nullptr);
+
+        delete context;
+    }
+}
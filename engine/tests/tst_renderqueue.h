@@ -0,0 +1,521 @@
+#include "gtest/gtest.h"
+
+#include "renderqueue.h"
+
+#include "resources/material.h"
+#include "resources/mesh.h"
+
+#include "components/actor.h"
+#include "components/transform.h"
+
+#include <algorithm>
+#include <cstring>
+#include <random>
+
+class QueueRender : public Renderable {
+    A_OBJECT(QueueRender, Renderable, Components)
+
+public:
+    QueueRender() :
+            m_mesh(nullptr),
+            m_batchable(true),
+            m_visible(true) {
+
+    }
+
+    void setMesh(Mesh *mesh) {
+        m_mesh = mesh;
+    }
+
+    void setBatchable(bool batchable) {
+        m_batchable = batchable;
+    }
+
+    void setVisible(bool visible) {
+        m_visible = visible;
+    }
+
+protected:
+    Mesh *meshToDraw() override {
+        return m_mesh;
+    }
+
+    bool isBatchable() const override {
+        return m_batchable;
+    }
+
+    bool isChunkVisible(int) override {
+        return m_visible;
+    }
+
+    AABBox localBound() override {
+        return m_mesh ? m_mesh->bound() : Renderable::localBound();
+    }
+
+    Mesh *m_mesh;
+
+    bool m_batchable;
+
+    bool m_visible;
+
+};
+
+namespace EngineSuite {
+
+    class RenderQueueTest : public ::testing::Test {
+    public:
+        Material *createMaterial() {
+            Material *material = Engine::objectCreate<Material>();
+            material->loadUserData({
+                {"Uniforms", VariantList({VariantList({Vector4(1.0f), 16, "mainColor"})})}
+            });
+            return material;
+        }
+
+        Mesh *createMesh(uint32_t vertices) {
+            Mesh *mesh = Engine::objectCreate<Mesh>();
+
+            Vector3Vector positions(vertices);
+            IndexVector indices;
+            for(uint32_t i = 0; i < vertices; i++) {
+                positions[i] = Vector3(i % 2, i / 2, 0.0f);
+                indices.push_back(i);
+            }
+            mesh->setVertices(positions);
+            mesh->setIndices(indices);
+            mesh->setSubMesh(0, 0);
+            mesh->recalcBounds();
+
+            return mesh;
+        }
+
+        QueueRender *createRender(Mesh *mesh, Material *material, const Vector3 &position) {
+            Actor *actor = Engine::composeActor("QueueRender", "Render");
+            actor->transform()->setPosition(position);
+
+            QueueRender *render = actor->getComponent<QueueRender>();
+            render->setMesh(mesh);
+            render->setMaterial(material);
+
+            m_actors.push_back(actor);
+
+            return render;
+        }
+
+        void TearDown() override {
+            for(auto it : m_actors) {
+                delete it;
+            }
+            m_actors.clear();
+        }
+
+        std::list<Actor *> m_actors;
+
+    };
+
+    TEST_F(RenderQueueTest, Sort_key) {
+        // Layer goes first
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Opaque, 100, 0xffffffff, 100.0f) < RenderQueue::sortKey(Material::Translucent, -100, 0, 0.0f));
+
+        // Then priority including negative values
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Opaque, -1, 0xffffffff, 100.0f) < RenderQueue::sortKey(Material::Opaque, 0, 0, 0.0f));
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Opaque, 1, 0xffffffff, 100.0f) < RenderQueue::sortKey(Material::Opaque, 2, 0, 0.0f));
+
+        // Opaque items are grouped by hash and sorted from front to back
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Opaque, 0, 1, 100.0f) < RenderQueue::sortKey(Material::Opaque, 0, 2, 0.0f));
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Opaque, 0, 1, 1.0f) < RenderQueue::sortKey(Material::Opaque, 0, 1, 2.0f));
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Shadowcast, 0, 1, 0.5f) < RenderQueue::sortKey(Material::Shadowcast, 0, 1, 1000.0f));
+
+        // Translucent items are sorted from back to front before hash
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Translucent, 0, 2, 100.0f) < RenderQueue::sortKey(Material::Translucent, 0, 1, 10.0f));
+        ASSERT_TRUE(RenderQueue::sortKey(Material::Translucent, 0, 1, 10.0f) < RenderQueue::sortKey(Material::Translucent, 0, 2, 10.0f));
+
+        // Items behind the view origin have the same depth
+        ASSERT_EQ(RenderQueue::sortKey(Material::Opaque, 0, 1, -10.0f), RenderQueue::sortKey(Material::Opaque, 0, 1, 0.0f));
+    }
+
+    TEST_F(RenderQueueTest, Empty_queue) {
+        RenderQueue queue;
+        queue.add(Renderable::RenderList(), Material::Opaque);
+        queue.build();
+
+        ASSERT_TRUE(queue.isEmpty());
+        ASSERT_TRUE(queue.batches().empty());
+    }
+
+    TEST_F(RenderQueueTest, Merge_to_world_space) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        Material *material = createMaterial();
+        Mesh *mesh0 = createMesh(4);
+        Mesh *mesh1 = createMesh(3);
+
+        QueueRender *render0 = createRender(mesh0, material, Vector3(10.0f, 0.0f, 0.0f));
+        QueueRender *render1 = createRender(mesh1, material, Vector3(0.0f, 20.0f, 0.0f));
+
+        RenderQueue queue;
+        queue.setBatching(true);
+        queue.add({render0, render1}, Material::Opaque);
+        queue.build();
+
+        ASSERT_EQ(queue.batches().size(), size_t(1));
+
+        const RenderQueue::Batch &batch = queue.batches().front();
+        ASSERT_EQ(batch.count, uint32_t(1));
+        ASSERT_TRUE(batch.mesh != mesh0 && batch.mesh != mesh1);
+
+        // Vertices are transformed to world space and indices are rebased
+        const Vector3Vector &vertices = batch.mesh->vertices();
+        ASSERT_EQ(vertices.size(), size_t(7));
+        ASSERT_EQ(vertices[1], Vector3(11.0f, 0.0f, 0.0f));
+        ASSERT_EQ(vertices[4], Vector3(0.0f, 20.0f, 0.0f));
+        ASSERT_EQ(vertices[6], Vector3(0.0f, 21.0f, 0.0f));
+        ASSERT_EQ(batch.mesh->indices().size(), size_t(7));
+        ASSERT_EQ(batch.mesh->indices()[6], uint32_t(6));
+
+        // Merged geometry is drawn with identity transform but keeps the object id of the first item
+        const ByteArray &uniforms = render0->materialInstance(0)->rawUniformBuffer();
+        ASSERT_TRUE(batch.buffer != nullptr);
+        ASSERT_EQ(batch.buffer->size(), size_t(material->uniformSize()));
+
+        float merged[16];
+        float source[16];
+        memcpy(merged, batch.buffer->data(), sizeof(merged));
+        memcpy(source, uniforms.data(), sizeof(source));
+
+        Matrix4 identity;
+        for(int i = 0; i < 16; i++) {
+            if(i % 4 == 3) {
+                ASSERT_FLOAT_EQ(merged[i], source[i]);
+            } else {
+                ASSERT_FLOAT_EQ(merged[i], identity.mat[i]);
+            }
+        }
+        ASSERT_EQ(memcmp(batch.buffer->data() + sizeof(Matrix4), uniforms.data() + sizeof(Matrix4), sizeof(Vector4)), 0);
+
+        TearDown();
+        delete mesh0;
+        delete mesh1;
+        delete material;
+    }
+
+    TEST_F(RenderQueueTest, Merge_splits) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        Material *material = createMaterial();
+        Mesh *mesh0 = createMesh(4);
+        Mesh *mesh1 = createMesh(3);
+
+        Renderable::RenderList list;
+        list.push_back(createRender(mesh0, material, Vector3()));
+        list.push_back(createRender(mesh1, material, Vector3()));
+
+        // Different instance parameters break the run
+        QueueRender *red = createRender(mesh0, material, Vector3());
+        Vector4 color(1.0f, 0.0f, 0.0f, 1.0f);
+        red->materialInstance(0)->setVector4("mainColor", &color);
+        list.push_back(red);
+
+        RenderQueue queue;
+        queue.setBatching(true);
+        queue.add(list, Material::Opaque);
+        queue.build();
+
+        ASSERT_EQ(queue.batches().size(), size_t(2));
+        ASSERT_EQ(queue.batches()[0].mesh->vertices().size(), size_t(7));
+        ASSERT_EQ(queue.batches()[1].mesh, mesh0);
+        ASSERT_EQ(queue.batches()[1].instance, red->materialInstance(0));
+        ASSERT_TRUE(queue.batches()[1].buffer == nullptr);
+
+        // The vertex limit of the shared mesh splits long runs
+        Mesh *big0 = createMesh(4096);
+        Mesh *big1 = createMesh(4096);
+
+        list.clear();
+        for(int i = 0; i < 17; i++) {
+            list.push_back(createRender((i % 2) ? big1 : big0, material, Vector3()));
+        }
+
+        queue.clear();
+        queue.add(list, Material::Opaque);
+        queue.build();
+
+        ASSERT_EQ(queue.batches().size(), size_t(2));
+        ASSERT_EQ(queue.batches()[0].mesh->vertices().size(), size_t(65536));
+        ASSERT_EQ(queue.batches()[1].mesh, big0);
+        ASSERT_EQ(queue.batches()[1].count, uint32_t(1));
+
+        TearDown();
+        delete mesh0;
+        delete mesh1;
+        delete big0;
+        delete big1;
+        delete material;
+    }
+
+    TEST_F(RenderQueueTest, Merge_keeps_instancing_and_order) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        Material *material0 = createMaterial();
+        Material *material1 = createMaterial();
+        Mesh *mesh = createMesh(4);
+
+        // The same mesh is drawn with instancing instead of copying the geometry
+        QueueRender *render0 = createRender(mesh, material0, Vector3(1.0f, 0.0f, 0.0f));
+        QueueRender *render1 = createRender(mesh, material0, Vector3(2.0f, 0.0f, 0.0f));
+
+        RenderQueue queue;
+        queue.setBatching(true);
+        queue.add({render0, render1}, Material::Opaque);
+
+#ifdef PROFILING_ENABLED
+        Profiler::statReset("SPRITE_BATCHES");
+        Profiler::statReset("BATCHED_SPRITES");
+#endif
+
+        queue.build();
+
+        ASSERT_EQ(queue.batches().size(), size_t(1));
+        ASSERT_EQ(queue.batches()[0].mesh, mesh);
+        ASSERT_EQ(queue.batches()[0].count, uint32_t(2));
+        ASSERT_EQ(queue.batches()[0].buffer->size(), size_t(material0->uniformSize() * 2));
+
+#ifdef PROFILING_ENABLED
+        ASSERT_EQ(Profiler::stat("SPRITE_BATCHES"), uint32_t(0));
+        ASSERT_EQ(Profiler::stat("BATCHED_SPRITES"), uint32_t(0));
+#endif
+
+        // Items are merged only when adjacent, priority order is kept
+        Mesh *other = createMesh(3);
+        QueueRender *render2 = createRender(other, material1, Vector3());
+        render0->materialInstance(0)->setPriority(0);
+        render2->materialInstance(0)->setPriority(1);
+        QueueRender *render3 = createRender(other, material0, Vector3());
+        render3->materialInstance(0)->setPriority(2);
+        render1->materialInstance(0)->setPriority(2);
+
+        queue.clear();
+        queue.add({render3, render2, render1, render0}, Material::Opaque);
+
+#ifdef PROFILING_ENABLED
+        Profiler::statReset("SPRITE_BATCHES");
+        Profiler::statReset("BATCHED_SPRITES");
+#endif
+
+        queue.build();
+
+        ASSERT_EQ(queue.batches().size(), size_t(3));
+        ASSERT_EQ(queue.batches()[0].instance, render0->materialInstance(0));
+        ASSERT_EQ(queue.batches()[1].instance, render2->materialInstance(0));
+        ASSERT_EQ(queue.batches()[2].instance, render3->materialInstance(0));
+        ASSERT_EQ(queue.batches()[2].mesh->vertices().size(), size_t(7));
+
+#ifdef PROFILING_ENABLED
+        ASSERT_EQ(Profiler::stat("SPRITE_BATCHES"), uint32_t(1));
+        ASSERT_EQ(Profiler::stat("BATCHED_SPRITES"), uint32_t(2));
+#endif
+
+        TearDown();
+        delete mesh;
+        delete other;
+        delete material0;
+        delete material1;
+    }
+
+    TEST_F(RenderQueueTest, Chunk_culling) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        Material *material = createMaterial();
+        Mesh *mesh = createMesh(4);
+
+        QueueRender *render = createRender(mesh, material, Vector3());
+        render->setVisible(false);
+
+        // Parts culled by the camera are skipped by the camera queues only
+        RenderQueue camera;
+        ASSERT_TRUE(camera.isChunkCulling());
+        camera.add({render}, Material::Opaque);
+        ASSERT_TRUE(camera.isEmpty());
+
+        RenderQueue shadow;
+        shadow.setChunkCulling(false);
+        shadow.add({render}, Material::Opaque);
+        ASSERT_EQ(shadow.items().size(), size_t(1));
+
+        RenderQueue copy(shadow);
+        ASSERT_FALSE(copy.isChunkCulling());
+
+        TearDown();
+        delete mesh;
+        delete material;
+    }
+
+    TEST_F(RenderQueueTest, Radix_sort) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        std::vector<Material *> materials = { createMaterial(), createMaterial(), createMaterial() };
+        std::vector<Mesh *> meshes = { createMesh(3), createMesh(4), createMesh(5), createMesh(6) };
+
+        std::mt19937 random(7);
+        std::uniform_int_distribution<int32_t> priority(-50, 50);
+        std::uniform_real_distribution<float> depth(-10.0f, 1000.0f);
+
+        Renderable::RenderList list;
+        for(int i = 0; i < 500; i++) {
+            QueueRender *render = createRender(meshes[random() % meshes.size()], materials[random() % materials.size()], Vector3(0.0f, 0.0f, depth(random)));
+            render->materialInstance(0)->setPriority(priority(random));
+            list.push_back(render);
+        }
+
+        RenderQueue queue;
+        queue.add(list, Material::Opaque, Vector3(), Vector3(0.0f, 0.0f, 1.0f));
+
+        // Radix sort must give the same order as a stable comparison sort
+        RenderQueue::Items expected(queue.items());
+        std::stable_sort(expected.begin(), expected.end(), [](const RenderQueue::Item &left, const RenderQueue::Item &right) {
+            return left.key < right.key;
+        });
+
+        queue.build();
+
+        const RenderQueue::Items &items = queue.items();
+        ASSERT_EQ(items.size(), expected.size());
+        for(size_t i = 0; i < items.size(); i++) {
+            ASSERT_EQ(items[i].key, expected[i].key);
+            ASSERT_EQ(items[i].renderable, expected[i].renderable);
+        }
+
+        TearDown();
+        for(auto it : meshes) {
+            delete it;
+        }
+        for(auto it : materials) {
+            delete it;
+        }
+    }
+
+    TEST_F(RenderQueueTest, Instancing_groups) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        Material *material0 = createMaterial();
+        Material *material1 = createMaterial();
+        Mesh *mesh0 = createMesh(4);
+        Mesh *mesh1 = createMesh(3);
+
+        // Identical mesh and material runs are drawn with one instanced call each
+        Renderable::RenderList list;
+        list.push_back(createRender(mesh0, material0, Vector3(1.0f, 0.0f, 0.0f)));
+        list.push_back(createRender(mesh1, material0, Vector3(2.0f, 0.0f, 0.0f)));
+        list.push_back(createRender(mesh0, material1, Vector3(3.0f, 0.0f, 0.0f)));
+        list.push_back(createRender(mesh0, material0, Vector3(4.0f, 0.0f, 0.0f)));
+        list.push_back(createRender(mesh1, material0, Vector3(5.0f, 0.0f, 0.0f)));
+        list.push_back(createRender(mesh0, material0, Vector3(6.0f, 0.0f, 0.0f)));
+
+        RenderQueue queue;
+        ASSERT_FALSE(queue.isBatching());
+        queue.add(list, Material::Opaque);
+        queue.build();
+
+        ASSERT_EQ(queue.items().size(), size_t(6));
+        ASSERT_EQ(queue.batches().size(), size_t(3));
+
+        uint32_t total = 0;
+        for(auto &it : queue.batches()) {
+            total += it.count;
+
+            if(it.mesh == mesh0 && it.instance->material() == material0) {
+                ASSERT_EQ(it.count, uint32_t(3));
+            } else if(it.mesh == mesh1) {
+                ASSERT_EQ(it.count, uint32_t(2));
+                ASSERT_EQ(it.instance->material(), material0);
+            } else {
+                ASSERT_EQ(it.count, uint32_t(1));
+                ASSERT_EQ(it.instance->material(), material1);
+                ASSERT_TRUE(it.buffer == nullptr);
+                continue;
+            }
+
+            // Instance data of all items in the order of the sorted items
+            ASSERT_TRUE(it.buffer != nullptr);
+            ASSERT_EQ(it.buffer->size(), size_t(material0->uniformSize() * it.count));
+
+            std::vector<float> positions;
+            for(uint32_t i = 0; i < it.count; i++) {
+                Matrix4 transform;
+                memcpy(transform.mat, it.buffer->data() + i * material0->uniformSize(), sizeof(Matrix4));
+                positions.push_back(transform[12]);
+            }
+            ASSERT_TRUE(std::is_sorted(positions.begin(), positions.end()));
+        }
+        ASSERT_EQ(total, uint32_t(6));
+
+        TearDown();
+        delete mesh0;
+        delete mesh1;
+        delete material0;
+        delete material1;
+    }
+
+    TEST_F(RenderQueueTest, Storage_reuse) {
+        Engine system;
+        QueueRender::registerClassFactory(&system);
+
+        Material *material = createMaterial();
+        Mesh *mesh0 = createMesh(4);
+        Mesh *mesh1 = createMesh(3);
+
+        Renderable::RenderList list;
+        for(int i = 0; i < 4; i++) {
+            list.push_back(createRender(mesh0, material, Vector3(i, 0.0f, 0.0f)));
+            list.push_back(createRender(mesh1, material, Vector3(i, 1.0f, 0.0f)));
+        }
+
+        RenderQueue instanced;
+        RenderQueue batched;
+        batched.setBatching(true);
+
+        std::vector<const ByteArray *> buffers;
+        const RenderQueue::Batch *batches = nullptr;
+        Mesh *merged = nullptr;
+
+        for(int frame = 0; frame < 3; frame++) {
+            instanced.clear();
+            instanced.add(list, Material::Opaque);
+            instanced.build();
+
+            batched.clear();
+            batched.add(list, Material::Opaque);
+            batched.build();
+
+            ASSERT_EQ(instanced.batches().size(), size_t(2));
+            ASSERT_EQ(batched.batches().size(), size_t(1));
+
+            if(frame == 0) {
+                for(auto &it : instanced.batches()) {
+                    buffers.push_back(it.buffer);
+                }
+                batches = instanced.batches().data();
+                merged = batched.batches()[0].mesh;
+            } else {
+                // Batch arrays, instance buffers and merged meshes of the previous frame are reused
+                for(size_t i = 0; i < buffers.size(); i++) {
+                    ASSERT_EQ(instanced.batches()[i].buffer, buffers[i]);
+                }
+                ASSERT_EQ(instanced.batches().data(), batches);
+                ASSERT_EQ(batched.batches()[0].mesh, merged);
+                ASSERT_EQ(merged->vertices().size(), size_t(28));
+            }
+        }
+
+        TearDown();
+        delete mesh0;
+        delete mesh1;
+        delete material;
+    }
+}
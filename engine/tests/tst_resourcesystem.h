@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+
+#include "systems/resourcesystem.h"
+
+#include "resources/text.h"
+
+#include <jobsystem.h>
+
+namespace EngineSuite {
+
+    class ResourceSystemTest : public ::testing::Test {
+
+    };
+
+    TEST_F(ResourceSystemTest, Suspended_resources_cache) {
+        ResourceSystem resourceSystem;
+        resourceSystem.setCacheBudget(300);
+
+        System &system = resourceSystem;
+
+        Text *first = ObjectSystem::objectCreate<Text>("{00000000-0000-0000-0000-000000000001}");
+        first->setSize(200);
+        first->incRef();
+
+        Text *second = ObjectSystem::objectCreate<Text>("{00000000-0000-0000-0000-000000000002}");
+        second->setSize(200);
+        second->incRef();
+
+        system.update(nullptr);
+        ASSERT_EQ(first->state(), Resource::Ready);
+
+        // Released resources stay in memory
+        first->decRef();
+        system.update(nullptr);
+
+        ResourceSystem::CacheStatistics statistics = resourceSystem.cacheStatistics();
+        ASSERT_EQ(first->state(), Resource::Suspend);
+        ASSERT_EQ(statistics.cachedCount, uint32_t(1));
+        ASSERT_EQ(statistics.cachedMemory, uint64_t(200));
+        ASSERT_EQ(statistics.cpuMemory["Text"], uint64_t(400));
+
+        // The least recently suspended resource is unloaded when the cache exceeds the budget
+        second->decRef();
+        system.update(nullptr);
+
+        statistics = resourceSystem.cacheStatistics();
+        ASSERT_EQ(statistics.evictions, uint32_t(1));
+        ASSERT_EQ(statistics.cachedCount, uint32_t(1));
+        ASSERT_EQ(first->state(), Resource::ToBeDeleted);
+        ASSERT_EQ(second->state(), Resource::Suspend);
+
+        system.update(nullptr);
+        TString uuid("{00000000-0000-0000-0000-000000000001}");
+        ASSERT_EQ(resourceSystem.resource(uuid), nullptr);
+
+        // Referenced again
+        second->incRef();
+        system.update(nullptr);
+
+        statistics = resourceSystem.cacheStatistics();
+        ASSERT_EQ(statistics.hits, uint32_t(1));
+        ASSERT_EQ(statistics.cachedCount, uint32_t(0));
+        ASSERT_EQ(statistics.cachedMemory, uint64_t(0));
+        ASSERT_EQ(second->state(), Resource::Ready);
+
+        resourceSystem.resetCacheStatistics();
+        ASSERT_EQ(resourceSystem.cacheStatistics().hits, uint32_t(0));
+
+        delete second;
+    }
+
+    TEST_F(ResourceSystemTest, Streaming_priority) {
+        // Own job system, the engine doesn't create one on single core machines
+        JobSystem jobs(2);
+
+        Engine engine;
+
+        ResourceSystem *resourceSystem = Engine::resourceSystem();
+        resourceSystem->setJobSystem(&jobs);
+
+        System &system = *resourceSystem;
+
+        // Requests above the limit stay in the queue
+        uint32_t inFlight = std::max(jobs.threadCount() / 2, 1U);
+        for(uint32_t i = 0; i < inFlight + 3; i++) {
+            TString uuid = TString("{00000000-0000-0000-0000-0000000001%1}").arg(TString::number(int32_t(10 + i)));
+
+            ResourceSystem::ResourceInfo info;
+            info.type = "Text";
+            info.uuid = uuid;
+            resourceSystem->indices()[uuid] = info;
+
+            ASSERT_TRUE(resourceSystem->loadResourceAsync(uuid) != nullptr);
+        }
+        system.update(nullptr);
+
+        std::list<Resource *> queue = resourceSystem->streamingQueue();
+        ASSERT_EQ(queue.size(), size_t(3));
+
+        Resource *first = queue.front();
+        Resource *last = queue.back();
+
+        // Lower values are loaded first
+        resourceSystem->setPriority(last, -1.0f);
+        resourceSystem->setPriority(first, 10.0f);
+
+        queue = resourceSystem->streamingQueue();
+        ASSERT_EQ(queue.front(), last);
+        ASSERT_EQ(queue.back(), first);
+    }
+}
@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include "system.h"
+#include "systemscheduler.h"
+
+#include <jobsystem.h>
+
+#include <mutex>
+
+namespace EngineSuite {
+
+    class ScheduledSystem : public System {
+    public:
+        ScheduledSystem(const TString &name, int policy, std::list<TString> &log, std::mutex &mutex) :
+                m_log(log),
+                m_mutex(mutex),
+                m_policy(policy) {
+
+            setName(name);
+        }
+
+        void update(World *) override {
+            std::unique_lock<std::mutex> locker(m_mutex);
+            m_log.push_back(name());
+        }
+
+        int threadPolicy() const override {
+            return m_policy;
+        }
+
+        void read(const TString &type) {
+            declareRead(type);
+        }
+
+        void write(const TString &type) {
+            declareWrite(type);
+        }
+
+    private:
+        std::list<TString> &m_log;
+
+        std::mutex &m_mutex;
+
+        int m_policy;
+
+    };
+
+    class SystemSchedulerTest : public ::testing::Test {
+    public:
+        int32_t position(const std::list<TString> &log, const TString &name) {
+            int32_t result = 0;
+            for(auto &it : log) {
+                if(it == name) {
+                    return result;
+                }
+                ++result;
+            }
+            return -1;
+        }
+    };
+
+    TEST_F(SystemSchedulerTest, Dependencies) {
+        std::list<TString> log;
+        std::mutex mutex;
+
+        ScheduledSystem resources("Resources", System::Pool, log, mutex);
+        resources.write("Resource");
+
+        ScheduledSystem physics("Physics", System::Pool, log, mutex);
+        physics.write("Transform");
+
+        ScheduledSystem scripts("Scripts", System::Pool, log, mutex);
+        scripts.write("Transform");
+
+        ScheduledSystem render("Render", System::Main, log, mutex);
+        render.read("Transform");
+        render.read("Resource");
+
+        SystemScheduler scheduler;
+        scheduler.addSystem(&resources);
+        scheduler.addSystem(&physics);
+        scheduler.addSystem(&scripts);
+        scheduler.addSystem(&render);
+
+        ASSERT_TRUE(scheduler.dependencies(&resources).empty());
+        ASSERT_TRUE(scheduler.dependencies(&physics).empty());
+
+        std::list<System *> dependencies = scheduler.dependencies(&scripts);
+        ASSERT_EQ(dependencies.size(), size_t(1));
+        ASSERT_EQ(dependencies.front(), &physics);
+
+        ASSERT_EQ(scheduler.dependencies(&render).size(), size_t(3));
+    }
+
+    TEST_F(SystemSchedulerTest, Execution_order) {
+        std::list<TString> log;
+        std::mutex mutex;
+
+        ScheduledSystem resources("Resources", System::Pool, log, mutex);
+        resources.write("Resource");
+
+        ScheduledSystem physics("Physics", System::Pool, log, mutex);
+        physics.write("Transform");
+
+        ScheduledSystem scripts("Scripts", System::Pool, log, mutex);
+        scripts.write("Transform");
+
+        ScheduledSystem audio("Audio", System::Pool, log, mutex);
+
+        ScheduledSystem render("Render", System::Main, log, mutex);
+        render.read("Transform");
+        render.read("Resource");
+
+        SystemScheduler scheduler;
+        scheduler.addSystem(&render);
+        scheduler.addSystem(&resources);
+        scheduler.addSystem(&physics);
+        scheduler.addSystem(&scripts);
+        scheduler.addSystem(&audio);
+
+        JobSystem jobs(4);
+
+        for(int i = 0; i < 100; i++) {
+            log.clear();
+            scheduler.execute(nullptr, (i % 2) ? &jobs : nullptr);
+
+            ASSERT_EQ(log.size(), size_t(5));
+            ASSERT_TRUE(position(log, "Physics") < position(log, "Scripts"));
+            ASSERT_TRUE(position(log, "Scripts") < position(log, "Render"));
+            ASSERT_TRUE(position(log, "Resources") < position(log, "Render"));
+        }
+
+        ASSERT_EQ(scheduler.dependencies(&render).size(), size_t(3));
+
+        const SystemScheduler::Records &records = scheduler.records();
+        ASSERT_EQ(records.size(), size_t(5));
+
+        bool critical = false;
+        const SystemScheduler::Record *main = nullptr;
+        for(auto &it : records) {
+            critical |= it.critical;
+            if(it.system == &render) {
+                main = &it;
+            }
+        }
+        ASSERT_TRUE(critical);
+        ASSERT_TRUE(main != nullptr);
+        ASSERT_EQ(main->thread, 0);
+
+        ASSERT_FALSE(scheduler.dump().isEmpty());
+    }
+}
@@ -0,0 +1,162 @@
+#include "gtest/gtest.h"
+
+#include "resources/texture.h"
+
+#include "utils/assetcontainer.h"
+#include "utils/texturestreamer.h"
+
+#include "adapters/handlers/defaultfilehandler.h"
+
+namespace EngineSuite {
+
+    class TextureStreamerTest : public ::testing::Test {
+    protected:
+        void SetUp() override {
+            m_handler = File::handler();
+            File::setHandler(&m_files);
+
+            m_streamingSize = Texture::streamingSize();
+            Texture::setStreamingSize(8);
+
+            Texture::registerClassFactory(&m_system);
+        }
+
+        void TearDown() override {
+            Texture::setStreamingSize(m_streamingSize);
+
+            File::setHandler(m_handler);
+
+            for(auto &it : m_paths) {
+                std::filesystem::remove(it.data());
+            }
+        }
+
+        // Creates a 64x64 texture with 7 mip levels, each level is filled with its index
+        Texture *createTexture(const TString &name) {
+            Texture *texture = ObjectSystem::objectCreate<Texture>();
+            texture->setWidth(64);
+            texture->setHeight(64);
+            texture->clear();
+
+            Texture::Surface surface;
+            for(int32_t i = 0; i < 7; i++) {
+                surface.push_back(ByteArray((64 >> i) * (64 >> i), i));
+            }
+            texture->addSurface(surface);
+            texture->setMipCount(surface.size());
+
+            TString path = (std::filesystem::temp_directory_path() / name.data()).string();
+            m_paths.push_back(path);
+
+            File fp(path);
+            fp.open(File::Write);
+            fp.write(AssetContainer::pack(Engine::toVariant(texture)));
+            fp.close();
+
+            delete texture;
+
+            AssetContainer container;
+            if(!container.open(path)) {
+                return nullptr;
+            }
+
+            AssetContainer::setCurrent(&container);
+            Texture *result = dynamic_cast<Texture *>(Engine::toObject(container.metadata()));
+            AssetContainer::setCurrent(nullptr);
+
+            return result;
+        }
+
+        ObjectSystem m_system;
+
+        DefaultFileHandler m_files;
+
+        FileHandler *m_handler = nullptr;
+
+        uint32_t m_streamingSize = 0;
+
+        std::list<TString> m_paths;
+    };
+
+    TEST_F(TextureStreamerTest, Stream_mips) {
+        Texture *texture = createTexture("texture_stream.tac");
+        ASSERT_TRUE(texture != nullptr);
+
+        // Only the levels up to 8x8 are resident after loading
+        ASSERT_TRUE(texture->isStreamable());
+        ASSERT_EQ(texture->mipCount(), 7);
+        ASSERT_EQ(texture->residentMip(), 3);
+        ASSERT_EQ(texture->surface(0).size(), size_t(4));
+        ASSERT_TRUE(texture->getPixels(0).empty());
+        ASSERT_EQ(texture->getPixels(3), ByteArray(64, 3));
+
+        TextureStreamer streamer;
+        streamer.add(texture);
+        streamer.update();
+
+        ASSERT_EQ(streamer.textureCount(), uint32_t(1));
+        ASSERT_EQ(streamer.residentSize(), uint64_t(64 + 16 + 4 + 1));
+
+        // 16 pixels on the screen need the 16x16 level
+        for(int32_t i = 0; i < 8; i++) {
+            streamer.request(texture, 16.0f);
+            streamer.update();
+        }
+        ASSERT_EQ(texture->residentMip(), 2);
+
+        // Levels are loaded one by one up to the full resolution
+        int32_t previous = texture->residentMip();
+        for(int32_t i = 0; i < 8; i++) {
+            streamer.request(texture, 100.0f);
+            streamer.update();
+
+            ASSERT_LE(texture->residentMip(), previous);
+            previous = texture->residentMip();
+        }
+        ASSERT_EQ(texture->residentMip(), 0);
+        ASSERT_EQ(texture->surface(0).size(), size_t(7));
+        ASSERT_EQ(texture->getPixels(0), ByteArray(64 * 64, 0));
+        ASSERT_EQ(texture->getPixels(1), ByteArray(32 * 32, 1));
+
+        // Removed on destruction
+        delete texture;
+        ASSERT_EQ(streamer.textureCount(), uint32_t(0));
+        ASSERT_EQ(streamer.residentSize(), uint64_t(0));
+    }
+
+    TEST_F(TextureStreamerTest, Evict_least_recently_used) {
+        Texture *first = createTexture("texture_first.tac");
+        Texture *second = createTexture("texture_second.tac");
+        ASSERT_TRUE(first != nullptr && second != nullptr);
+
+        const uint64_t tail = 64 + 16 + 4 + 1;
+        const uint64_t full = 64 * 64 + 32 * 32 + 16 * 16 + tail;
+
+        TextureStreamer streamer;
+        streamer.setBudget(full + tail + 64);
+        streamer.add(first);
+        streamer.add(second);
+
+        for(int32_t i = 0; i < 8; i++) {
+            streamer.request(first, 64.0f);
+            streamer.request(second, 0.0f);
+            streamer.update();
+        }
+        ASSERT_EQ(first->residentMip(), 0);
+        ASSERT_EQ(second->residentMip(), 3);
+
+        // The first texture isn't visible anymore, so it gives the memory to the second one
+        for(int32_t i = 0; i < 8; i++) {
+            streamer.request(first, 0.0f);
+            streamer.request(second, 64.0f);
+            streamer.update();
+
+            ASSERT_LE(streamer.residentSize(), streamer.budget());
+        }
+        ASSERT_EQ(first->residentMip(), 3);
+        ASSERT_EQ(second->residentMip(), 0);
+
+        delete first;
+        delete second;
+    }
+}
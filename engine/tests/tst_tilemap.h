@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include "resources/tilemap.h"
+#include "resources/tileset.h"
+#include "resources/mesh.h"
+
+namespace EngineSuite {
+
+    class TileMapTest : public ::testing::Test {
+    public:
+        void fillMap(TileMap &map, TileSet &set, int width, int height) {
+            set.setTileWidth(16);
+            set.setTileHeight(16);
+            set.setColumns(4);
+
+            map.setTileSet(&set);
+            map.setOrientation(TileSet::Orthogonal);
+            map.setCellWidth(16);
+            map.setCellHeight(16);
+            map.setWidth(width);
+            map.setHeight(height);
+
+            for(int y = 0; y < height; y++) {
+                for(int x = 0; x < width; x++) {
+                    map.setTile(x, y, (x + y) % 2 ? -1 : 1);
+                }
+            }
+        }
+    };
+
+    TEST_F(TileMapTest, Chunks) {
+        ObjectSystem system;
+        Mesh::registerClassFactory(&system);
+
+        TileSet set;
+        TileMap map;
+        fillMap(map, set, 40, 70);
+
+        // 2 by 3 chunks
+        ASSERT_EQ(map.chunkCount(), 6);
+
+        map.refreshChunks();
+
+        size_t quads = 0;
+        for(int i = 0; i < map.chunkCount(); i++) {
+            Mesh *mesh = map.chunkMesh(i);
+            ASSERT_EQ(mesh->vertices().size() % 4, size_t(0));
+            quads += mesh->vertices().size() / 4;
+        }
+        ASSERT_EQ(quads, size_t(40 * 70 / 2));
+
+        AABBox bb(map.bound());
+        Vector3 min, max;
+        bb.box(min, max);
+        ASSERT_FLOAT_EQ(min.x, 0.0f);
+        ASSERT_FLOAT_EQ(max.x, 40.0f * 16.0f);
+        ASSERT_FLOAT_EQ(min.y, -70.0f * 16.0f);
+        ASSERT_FLOAT_EQ(max.y, 0.0f);
+
+        ASSERT_EQ(map.tilePosition(33, 2), Vector2(33.0f * 16.0f, -2.0f * 16.0f));
+    }
+
+    TEST_F(TileMapTest, Incremental_update) {
+        ObjectSystem system;
+        Mesh::registerClassFactory(&system);
+
+        TileSet set;
+        TileMap map;
+        fillMap(map, set, 64, 64);
+        map.refreshChunks();
+
+        // Chunks which weren't changed keep their meshes untouched
+        Vector3 sentinel(-1.0f, -1.0f, 5.0f);
+        map.chunkMesh(0)->vertices()[0] = sentinel;
+
+        size_t before = map.chunkMesh(3)->vertices().size();
+        map.setTile(33, 34, 1);
+
+        // Reading the chunks doesn't rebuild them
+        ASSERT_EQ(map.chunkMesh(3)->vertices().size(), before);
+        map.bound();
+        ASSERT_EQ(map.chunkMesh(3)->vertices().size(), before);
+
+        map.refreshChunks();
+
+        ASSERT_EQ(map.chunkMesh(0)->vertices()[0], sentinel);
+        ASSERT_EQ(map.chunkMesh(3)->vertices().size(), before + 4);
+
+        // The same tile doesn't trigger a rebuild
+        map.chunkMesh(3)->vertices()[0] = sentinel;
+        map.setTile(33, 34, 1);
+        map.refreshChunks();
+        ASSERT_EQ(map.chunkMesh(3)->vertices()[0], sentinel);
+
+        // Empty chunks have no geometry
+        for(int y = 0; y < 32; y++) {
+            for(int x = 32; x < 64; x++) {
+                map.setTile(x, y, -1);
+            }
+        }
+        map.refreshChunks();
+        ASSERT_TRUE(map.chunkMesh(1)->isEmpty());
+        ASSERT_LT(map.chunkBound(1).extent.x, 0.0f);
+    }
+}
@@ -0,0 +1,105 @@
+#include "gtest/gtest.h"
+
+#include "components/transform.h"
+
+#include "utils/transformstorage.h"
+
+#include <jobsystem.h>
+
+namespace EngineSuite {
+
+    class TransformStorageTest : public ::testing::Test {
+    public:
+        static void setup(std::vector<Transform> &transforms) {
+            // Chains of three levels
+            for(uint32_t i = 0; i < transforms.size(); i++) {
+                Transform &it = transforms[i];
+                it.setPosition(Vector3(i, 1.0f, 2.0f));
+                it.setRotation(Vector3(0.0f, i * 10.0f, 0.0f));
+                it.setScale(Vector3(1.0f + (i % 3) * 0.5f));
+                if(i % 3 != 0) {
+                    it.setParentTransform(&transforms[i - 1], true);
+                }
+            }
+        }
+
+        static void compare(const Transform &a, const Transform &b) {
+            for(int i = 0; i < 16; i++) {
+                ASSERT_NEAR(a.worldTransform()[i], b.worldTransform()[i], 0.0001f);
+            }
+            ASSERT_EQ(a.worldScale(), b.worldScale());
+            ASSERT_EQ(a.worldRotation(), b.worldRotation());
+            ASSERT_EQ(a.hash(), b.hash());
+        }
+    };
+
+    TEST_F(TransformStorageTest, Batched_update) {
+        const uint32_t count = 3000;
+
+        std::vector<Transform> stored(count);
+        std::vector<Transform> reference(count);
+        setup(stored);
+        setup(reference);
+
+        TransformStorage storage;
+        // Add children before parents to check sorting
+        for(int32_t i = count - 1; i >= 0; i--) {
+            storage.add(&stored[i]);
+        }
+        ASSERT_EQ(storage.count(), count);
+
+        JobSystem jobs(4);
+        storage.update(&jobs);
+        ASSERT_EQ(storage.levels(), uint32_t(3));
+
+        for(uint32_t i = 0; i < count; i++) {
+            compare(stored[i], reference[i]);
+        }
+
+        // Changes between the updates are calculated on demand
+        stored[0].setPosition(Vector3(5.0f, 0.0f, 0.0f));
+        reference[0].setPosition(Vector3(5.0f, 0.0f, 0.0f));
+        compare(stored[2], reference[2]);
+
+        stored[3].setScale(Vector3(2.0f));
+        reference[3].setScale(Vector3(2.0f));
+        storage.update(&jobs);
+        compare(stored[5], reference[5]);
+
+        // Reparenting reorders the storage
+        stored[2].setParentTransform(&stored[3], true);
+        reference[2].setParentTransform(&reference[3], true);
+        storage.update();
+        compare(stored[2], reference[2]);
+
+        // Removed transform keeps its state
+        storage.remove(&stored[5]);
+        ASSERT_EQ(storage.count(), count - 1);
+        compare(stored[5], reference[5]);
+
+        storage.clear();
+        ASSERT_EQ(storage.count(), uint32_t(0));
+        compare(stored[4], reference[4]);
+
+        // Pending transforms are added once and removed before the update
+        for(uint32_t i = 0; i < 6; i++) {
+            storage.add(&stored[i]);
+            storage.add(&stored[i]);
+        }
+        ASSERT_EQ(storage.count(), uint32_t(6));
+
+        storage.remove(&stored[1]);
+        storage.remove(&stored[1]);
+        ASSERT_EQ(storage.count(), uint32_t(5));
+
+        storage.add(&stored[1]);
+        storage.remove(&stored[0]);
+        ASSERT_EQ(storage.count(), uint32_t(5));
+
+        storage.update();
+        ASSERT_EQ(storage.count(), uint32_t(5));
+        for(uint32_t i = 0; i < 6; i++) {
+            compare(stored[i], reference[i]);
+        }
+    }
+}
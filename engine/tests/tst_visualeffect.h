@@ -0,0 +1,287 @@
+#include "gtest/gtest.h"
+
+#include "resources/visualeffect.h"
+
+#include "components/actor.h"
+#include "components/effectrender.h"
+
+#include "systems/rendersystem.h"
+
+#include <algorithm>
+
+namespace EngineSuite {
+
+    class VisualEffectTest : public ::testing::Test {
+    public:
+        // Spaces and operations as stored by the effect builder
+        enum { Mov = 0, Add, Sub };
+        enum { System = 0, Emitter, Particle, Renderable, Local, Constant, Random };
+
+        // Particles live for 0.25 seconds and move up by one unit per frame
+        // Optionally the first component of the position is replaced by a random value every frame
+        // Age of the particles is written to the instance data of the renderables if any
+        void load(VisualEffect &effect, int capacity, float spawnRate, bool random = false, const VariantList &renderables = VariantList()) {
+            VariantList emitterUpdate = {
+                VariantList({ Add, Emitter, 1, VisualEffect::SpawnCounter, VariantList({ VariantList({ Emitter, 1, VisualEffect::SpawnCounter }), VariantList({ Constant, 1, spawnRate }) }) })
+            };
+
+            VariantList particleSpawn = {
+                VariantList({ Mov, Particle, 1, 0, VariantList({ VariantList({ Constant, 1, 0.25f }) }) }),
+                VariantList({ Mov, Particle, 3, 1, VariantList({ VariantList({ Constant, 3, 1.0f, 2.0f, 3.0f }) }) })
+            };
+
+            VariantList particleUpdate = {
+                VariantList({ Sub, Particle, 1, 0, VariantList({ VariantList({ Particle, 1, 0 }), VariantList({ System, 1, VisualEffect::DeltaTime }) }) }),
+                VariantList({ Add, Particle, 3, 1, VariantList({ VariantList({ Particle, 3, 1 }), VariantList({ Constant, 3, 0.0f, 1.0f, 0.0f }) }) })
+            };
+            if(random) {
+                particleUpdate.push_back(VariantList({ Mov, Particle, 1, 1, VariantList({ VariantList({ Random, 1, 0.0f, 1.0f }) }) }));
+            }
+
+            VariantList render;
+            if(!renderables.empty()) {
+                render.push_back(VariantList({ Mov, Renderable, 1, 0, VariantList({ VariantList({ Particle, 1, 0 }) }) }));
+            }
+
+            VariantList emitter = { false, false, true, capacity, 1, 18, 4, renderables,
+                                    VariantList(), emitterUpdate, particleSpawn, particleUpdate, render };
+
+            VariantMap data;
+            data["Emitters"] = VariantList({ emitter });
+            effect.loadUserData(data);
+        }
+
+        void init(VisualEffect &effect, VisualEffect::Buffers &buffers) {
+            buffers.system.resize(effect.systemStride());
+            buffers.emitter.resize(effect.emitterStride());
+            buffers.particles.resize(effect.capacity() * effect.particleStride());
+            buffers.random = effect.randomStreams();
+            buffers.system[VisualEffect::DeltaTime] = 0.1f;
+        }
+
+        bool prepare(EffectRender &render, float dt) {
+            return render.prepareSimulation(dt);
+        }
+
+        void simulate(EffectRender &render) {
+            render.simulate();
+        }
+
+        void publish(EffectRender &render) {
+            render.publish();
+        }
+
+        // The same as the pipeline context does for the emitters which passed the culling
+        void markVisible(EffectRender &render) {
+            render.m_invisibleFrames = 0;
+        }
+
+        const VisualEffect::Buffers &data(EffectRender &render) {
+            return render.m_data;
+        }
+    };
+
+    TEST_F(VisualEffectTest, Spawn_and_compact) {
+        VisualEffect effect;
+        load(effect, 25, 10.0f);
+
+        VisualEffect::Buffers buffers;
+        init(effect, buffers);
+
+        effect.update(buffers);
+        ASSERT_EQ(buffers.alive, 10);
+
+        effect.update(buffers);
+        ASSERT_EQ(buffers.alive, 20);
+
+        // Only 5 slots are free, the first 10 particles die during this frame
+        effect.update(buffers);
+        ASSERT_EQ(buffers.alive, 15);
+        ASSERT_FLOAT_EQ(buffers.emitter[VisualEffect::SpawnCounter], 5.0f);
+
+        // Attributes are stored as streams of capacity values
+        const int capacity = effect.capacity();
+        int young = 0;
+        for(int p = 0; p < buffers.alive; p++) {
+            float age = buffers.particles[p];
+            ASSERT_GT(age, 0.0f);
+            if(age > 0.1f) {
+                young++;
+            }
+
+            ASSERT_FLOAT_EQ(buffers.particles[capacity + p], 1.0f);
+            ASSERT_NEAR(buffers.particles[capacity * 2 + p], 2.0f + (0.25f - age) / 0.1f, 0.001f);
+            ASSERT_FLOAT_EQ(buffers.particles[capacity * 3 + p], 3.0f);
+        }
+        ASSERT_EQ(young, 5);
+    }
+
+    TEST_F(VisualEffectTest, Blocks) {
+        VisualEffect effect;
+        load(effect, 1000, 600.0f);
+
+        VisualEffect::Buffers buffers;
+        init(effect, buffers);
+
+        effect.update(buffers);
+        ASSERT_EQ(buffers.alive, 600);
+
+        const int capacity = effect.capacity();
+        for(int p = 0; p < capacity; p++) {
+            if(p < buffers.alive) {
+                ASSERT_NEAR(buffers.particles[p], 0.15f, 0.0001f);
+                ASSERT_FLOAT_EQ(buffers.particles[capacity * 2 + p], 3.0f);
+            } else {
+                ASSERT_FLOAT_EQ(buffers.particles[p], 0.0f);
+                ASSERT_FLOAT_EQ(buffers.particles[capacity * 2 + p], 0.0f);
+            }
+        }
+    }
+
+    TEST_F(VisualEffectTest, Random_follows_particles) {
+        VisualEffect effect;
+        load(effect, 25, 10.0f, true);
+
+        VisualEffect::Buffers buffers;
+        init(effect, buffers);
+
+        const int capacity = effect.capacity();
+        ASSERT_EQ(buffers.random.size(), size_t(capacity));
+
+        // Particles are moved to other slots during the compaction, but must keep their random values
+        for(int frame = 0; frame < 6; frame++) {
+            effect.update(buffers);
+
+            for(int p = 0; p < buffers.alive; p++) {
+                ASSERT_FLOAT_EQ(buffers.particles[capacity + p], buffers.random[p]);
+            }
+        }
+    }
+
+    TEST_F(VisualEffectTest, Double_buffering) {
+        Engine engine;
+        RenderSystem system;
+
+        Mesh *mesh = Engine::objectCreate<Mesh>("{00000000-0000-0000-0000-000000000e01}");
+        Material *material = Engine::objectCreate<Material>("{00000000-0000-0000-0000-000000000e02}");
+        material->loadUserData({
+            {"Uniforms", VariantList({VariantList({Vector4(1.0f), 16, "mainColor"})})}
+        });
+
+        VisualEffect *effect = Engine::objectCreate<VisualEffect>();
+        load(*effect, 25, 10.0f, false, VariantList({ VariantList({ Material::Static, mesh->name(), material->name() }) }));
+
+        Actor *actor = Engine::composeActor<EffectRender>("Effect");
+        EffectRender *render = actor->getComponent<EffectRender>();
+        render->setEffect(effect);
+
+        MaterialInstance *instance = render->materialInstance(0);
+        ASSERT_TRUE(instance != nullptr);
+        ASSERT_EQ(instance->instanceCount(), uint32_t(25));
+
+        for(uint32_t frame = 1; frame <= 2; frame++) {
+            ASSERT_TRUE(prepare(*render, 0.1f));
+            simulate(*render);
+
+            // Rendering reads the previous results until the simulation step is published
+            ASSERT_EQ(data(*render).instances, int(frame * 10));
+            ASSERT_EQ(instance->instanceCount(), (frame == 1) ? uint32_t(25) : uint32_t(10));
+
+            publish(*render);
+            ASSERT_EQ(instance->instanceCount(), frame * 10);
+
+            const float *instances = reinterpret_cast<const float *>(instance->rawUniformBuffer().data());
+            ASSERT_GT(instances[0], 0.0f);
+            ASSERT_LE(instances[0], 0.25f);
+
+            // Nothing to publish twice
+            publish(*render);
+            ASSERT_EQ(instance->instanceCount(), frame * 10);
+        }
+
+        delete actor;
+        delete effect;
+    }
+
+    TEST_F(VisualEffectTest, Offscreen_interval) {
+        Engine engine;
+        RenderSystem system;
+
+        Mesh *mesh = Engine::objectCreate<Mesh>("{00000000-0000-0000-0000-000000000e03}");
+        Material *material = Engine::objectCreate<Material>("{00000000-0000-0000-0000-000000000e04}");
+        material->loadUserData({
+            {"Uniforms", VariantList({VariantList({Vector4(1.0f), 16, "mainColor"})})}
+        });
+
+        VisualEffect *effect = Engine::objectCreate<VisualEffect>();
+        load(*effect, 25, 10.0f, false, VariantList({ VariantList({ Material::Static, mesh->name(), material->name() }) }));
+
+        Actor *actor = Engine::composeActor<EffectRender>("Effect");
+        EffectRender *render = actor->getComponent<EffectRender>();
+        render->setEffect(effect);
+        render->setOffscreenInterval(3);
+
+        // Recently visible emitters are simulated every frame
+        for(int frame = 0; frame < 30; frame++) {
+            ASSERT_TRUE(prepare(*render, 0.1f));
+        }
+
+        // Off-screen emitters are simulated every third frame with the accumulated time
+        for(int step = 0; step < 2; step++) {
+            ASSERT_FALSE(prepare(*render, 0.1f));
+            ASSERT_FALSE(prepare(*render, 0.1f));
+            ASSERT_TRUE(prepare(*render, 0.1f));
+            ASSERT_NEAR(data(*render).system[VisualEffect::DeltaTime], 0.3f, 0.0001f);
+        }
+
+        // Back to every frame simulation as soon as the emitter is visible
+        ASSERT_FALSE(prepare(*render, 0.1f));
+        markVisible(*render);
+        ASSERT_TRUE(prepare(*render, 0.1f));
+        ASSERT_NEAR(data(*render).system[VisualEffect::DeltaTime], 0.2f, 0.0001f);
+        ASSERT_TRUE(prepare(*render, 0.1f));
+
+        delete actor;
+        delete effect;
+    }
+
+    TEST_F(VisualEffectTest, Kernel_reference) {
+        VisualEffect effect;
+        load(effect, 25, 10.0f);
+
+        VisualEffect::Buffers vm;
+        init(effect, vm);
+
+        VisualEffect::Buffers kernel;
+        init(effect, kernel);
+
+        const int capacity = effect.capacity();
+        auto live = [capacity](const VisualEffect::Buffers &buffers) {
+            std::vector<std::vector<float>> result;
+            for(int p = 0; p < capacity; p++) {
+                if(buffers.particles[p] > 0.0f) {
+                    result.push_back({ buffers.particles[p], buffers.particles[capacity + p],
+                                       buffers.particles[capacity * 2 + p], buffers.particles[capacity * 3 + p] });
+                }
+            }
+            std::sort(result.begin(), result.end());
+            return result;
+        };
+
+        // Particles stay in their slots on the GPU, so only the sets of live particles are the same
+        for(int frame = 0; frame < 5; frame++) {
+            effect.update(vm);
+            effect.kernelUpdate(kernel);
+
+            ASSERT_FLOAT_EQ(kernel.emitter[VisualEffect::SpawnCounter], vm.emitter[VisualEffect::SpawnCounter]);
+            ASSERT_EQ(live(kernel), live(vm));
+            ASSERT_EQ(live(vm).size(), size_t(vm.alive));
+        }
+
+        TString source = effect.kernelSource();
+        ASSERT_NE(source.toStdString().find("void main()"), std::string::npos);
+        ASSERT_NE(source.toStdString().find("particles[25u + p] = 1.0;"), std::string::npos);
+        ASSERT_NE(source.toStdString().find("particles[0u + p] = particles[0u + p] - system[0];"), std::string::npos);
+        ASSERT_NE(source.toStdString().find("atomicAdd(spawned, 1u)"), std::string::npos);
+    }
+}
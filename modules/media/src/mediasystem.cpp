@@ -23,6 +23,10 @@ MediaSystem::MediaSystem() :
 
     AudioClip::registerClassFactory(Engine::resourceSystem());
 
+    declareRead("Transform");
+    declareRead("Camera");
+    declareWrite("AudioSource");
+
     setName("Media");
 }
 
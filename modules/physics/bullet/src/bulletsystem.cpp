@@ -62,6 +62,10 @@ BulletSystem::BulletSystem(Engine *engine) :
 
     PhysicMaterial::registerClassFactory(engine->resourceSystem());
 
+    declareWrite("Transform");
+    declareWrite("Collider");
+    declareWrite("Joint");
+
     m_overlappingPairCache->getOverlappingPairCache()->setInternalGhostPairCallback(new btGhostPairCallback());
 }
 
@@ -3,6 +3,8 @@
 
 #include <commandbuffer.h>
 
+#define INSTANCE_FRAMES 3
+
 class TextureGL;
 
 class CommandBufferGL : public CommandBuffer {
@@ -12,10 +14,16 @@ public:
     CommandBufferGL();
     ~CommandBufferGL();
 
+    void begin();
+
     static void setObjectName(int32_t type, int32_t id, const TString &name);
 
     void bindTexture(uint32_t index, TextureGL *texture);
 
+    bool isComputeSupported() const override;
+
+    uint32_t writeInstances(const ByteArray &data, uint32_t &offset);
+
 protected:
     void dispatchCompute(ComputeInstance &shader, int32_t groupsX, int32_t groupsY, int32_t groupsZ) override;
 
@@ -36,11 +44,27 @@ protected:
 
     void updateGlobal();
 
+    void resizeInstances(uint32_t size);
+
 protected:
     uint32_t m_globalBuffer;
 
     uint32_t m_textures[32];
 
+    uint32_t m_instanceBuffer;
+
+    uint8_t *m_instanceData;
+
+    uint32_t m_instanceSize;
+
+    uint32_t m_instanceOffset;
+
+    uint32_t m_instanceFrame;
+
+    int32_t m_instanceAlignment;
+
+    void *m_instanceFences[INSTANCE_FRAMES];
+
 };
 
 #endif // COMMANDBUFFERGL_H
@@ -39,6 +39,8 @@ private:
     Material::StencilState m_glStencilState;
 
     uint32_t m_instanceBuffer;
+
+    uint32_t m_instanceSize;
 };
 
 class MaterialGL : public Material {
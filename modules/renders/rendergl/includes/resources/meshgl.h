@@ -37,6 +37,10 @@ public:
     uint32_t m_triangles;
     uint32_t m_vertices;
 
+    uint32_t m_indexSize;
+
+    VertexLayout m_layout;
+
     std::list<VaoStruct *> m_vao;
 
 };
@@ -7,16 +7,65 @@
 #include "resources/materialgl.h"
 #include "resources/rendertargetgl.h"
 #include "resources/computeshadergl.h"
+#include "resources/computebuffergl.h"
+
+#include <cstring>
+
+#include <log.h>
+
+namespace {
+    const uint32_t gMinInstanceSize = 65536;
+
+    // One second in nanoseconds
+    const uint64_t gFenceTimeout = 1000000000;
+}
 
 CommandBufferGL::CommandBufferGL():
-        m_globalBuffer(0)  {
+        m_globalBuffer(0),
+        m_instanceBuffer(0),
+        m_instanceData(nullptr),
+        m_instanceSize(0),
+        m_instanceOffset(0),
+        m_instanceFrame(0),
+        m_instanceAlignment(0) {
     PROFILE_FUNCTION();
+
+    memset(m_instanceFences, 0, sizeof(m_instanceFences));
 }
 
 CommandBufferGL::~CommandBufferGL() {
     if(m_globalBuffer) {
         glDeleteBuffers(1, &m_globalBuffer);
     }
+
+    resizeInstances(0);
+}
+
+void CommandBufferGL::begin() {
+    PROFILE_FUNCTION();
+
+    CommandBuffer::begin();
+
+#ifndef THUNDER_MOBILE
+    if(m_instanceBuffer) {
+        // The region of the previous frame can be reused when the GPU has finished with it
+        m_instanceFences[m_instanceFrame] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_instanceFrame = (m_instanceFrame + 1) % INSTANCE_FRAMES;
+
+        GLsync fence = static_cast<GLsync>(m_instanceFences[m_instanceFrame]);
+        if(fence) {
+            GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, gFenceTimeout);
+            if(result == GL_TIMEOUT_EXPIRED || result == GL_WAIT_FAILED) {
+                aWarning() << "[ RenderGL ] Instance buffer fence wasn't signaled, waiting for the GPU to finish.";
+                glFinish();
+            }
+            glDeleteSync(fence);
+            m_instanceFences[m_instanceFrame] = nullptr;
+        }
+    }
+    m_instanceOffset = 0;
+#endif
 }
 
 void CommandBufferGL::dispatchCompute(ComputeInstance &shader, int32_t groupsX, int32_t groupsY, int32_t groupsZ) {
@@ -27,7 +76,8 @@ void CommandBufferGL::dispatchCompute(ComputeInstance &shader, int32_t groupsX,
     if(instance.bind(this)) {
         glDispatchCompute(groupsX, groupsY, groupsZ);
 
-        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+        // Results can be read by the following dispatches, draws and as indirect draw arguments
+        glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT | GL_COMMAND_BARRIER_BIT);
     }
 #endif
 }
@@ -39,6 +89,28 @@ void CommandBufferGL::drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, Materia
         MeshGL *meshGL = static_cast<MeshGL *>(mesh);
 
         MaterialInstanceGL &instanceGL = static_cast<MaterialInstanceGL &>(instance);
+
+#ifndef THUNDER_MOBILE
+        ComputeBuffer *arguments = instance.indirectArguments();
+        if(arguments) {
+            if(!meshGL->indices().empty() && instanceGL.bind(this, layer, 0, m_globalBuffer)) {
+                meshGL->bindVao(this);
+
+                int32_t glMode = (instance.material()->wireframe()) ? GL_LINES : GL_TRIANGLES;
+                uint32_t indexType = (meshGL->m_indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, static_cast<ComputeBufferGL *>(arguments)->nativeHandle());
+                glDrawElementsIndirect(glMode, indexType, nullptr);
+                glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+                PROFILER_STAT(DRAWCALLS, 1);
+
+                glBindVertexArray(0);
+            }
+            return;
+        }
+#endif
+
         for(uint32_t index = 0; index < instanceGL.drawsCount(); index++) {
             if(instanceGL.bind(this, layer, index, m_globalBuffer)) {
                 meshGL->bindVao(this);
@@ -53,7 +125,9 @@ void CommandBufferGL::drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, Materia
                     int32_t indexCount = meshGL->indexCount(sub);
                     int32_t glMode = (instance.material()->wireframe()) ? GL_LINES : GL_TRIANGLES;
 
-                    glDrawElementsInstanced(glMode, indexCount, GL_UNSIGNED_INT, reinterpret_cast<void *>(meshGL->indexStart(sub) * sizeof(int32_t)), instance.instanceCount());
+                    uint32_t indexType = (meshGL->m_indexSize == sizeof(uint16_t)) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+                    glDrawElementsInstanced(glMode, indexCount, indexType, reinterpret_cast<void *>(meshGL->indexStart(sub) * meshGL->m_indexSize), instance.instanceCount());
                     PROFILER_STAT(POLYGONS, index / 3);
                 }
                 PROFILER_STAT(DRAWCALLS, 1);
@@ -169,6 +243,94 @@ void CommandBufferGL::bindTexture(uint32_t index, TextureGL *texture) {
     }
 }
 
+bool CommandBufferGL::isComputeSupported() const {
+#ifndef THUNDER_MOBILE
+    return GLAD_GL_ARB_compute_shader && GLAD_GL_ARB_shader_storage_buffer_object && GLAD_GL_ARB_draw_indirect;
+#else
+    return false;
+#endif
+}
+
+uint32_t CommandBufferGL::writeInstances(const ByteArray &data, uint32_t &offset) {
+#ifndef THUNDER_MOBILE
+    if(m_instanceAlignment == 0) {
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &m_instanceAlignment);
+        m_instanceAlignment = MAX(m_instanceAlignment, 1);
+    }
+
+    uint32_t size = data.size();
+    uint32_t start = (m_instanceOffset + m_instanceAlignment - 1) / m_instanceAlignment * m_instanceAlignment;
+    if(start + size > m_instanceSize) {
+        // Draws recorded earlier in this frame keep the old buffer alive until they are completed
+        resizeInstances(MAX(MAX(m_instanceSize * 2, start + size), gMinInstanceSize));
+        start = 0;
+    }
+
+    offset = m_instanceFrame * m_instanceSize + start;
+    if(m_instanceData) {
+        memcpy(m_instanceData + offset, data.data(), size);
+    } else {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, offset, size, data.data());
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    m_instanceOffset = start + size;
+
+    return m_instanceBuffer;
+#else
+    A_UNUSED(data);
+    offset = 0;
+    return 0;
+#endif
+}
+
+void CommandBufferGL::resizeInstances(uint32_t size) {
+#ifndef THUNDER_MOBILE
+    if(m_instanceBuffer) {
+        if(m_instanceData) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+            glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+            m_instanceData = nullptr;
+        }
+        glDeleteBuffers(1, &m_instanceBuffer);
+        m_instanceBuffer = 0;
+
+        for(auto &it : m_instanceFences) {
+            if(it) {
+                glDeleteSync(static_cast<GLsync>(it));
+                it = nullptr;
+            }
+        }
+    }
+
+    m_instanceSize = 0;
+    m_instanceOffset = 0;
+
+    if(size > 0) {
+        // Each frame in flight writes to its own region, regions are aligned for glBindBufferRange
+        m_instanceSize = (size + m_instanceAlignment - 1) / m_instanceAlignment * m_instanceAlignment;
+        uint32_t total = m_instanceSize * INSTANCE_FRAMES;
+
+        glGenBuffers(1, &m_instanceBuffer);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
+        if(GLAD_GL_ARB_buffer_storage) {
+            GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_SHADER_STORAGE_BUFFER, total, nullptr, flags);
+            m_instanceData = static_cast<uint8_t *>(glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, total, flags));
+        } else {
+            glBufferData(GL_SHADER_STORAGE_BUFFER, total, nullptr, GL_DYNAMIC_DRAW);
+        }
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+        setObjectName(GL_BUFFER, m_instanceBuffer, "instances");
+    }
+#else
+    A_UNUSED(size);
+#endif
+}
+
 void CommandBufferGL::setViewProjection(const Matrix4 &viewProjection) {
     CommandBuffer::setViewProjection(viewProjection);
 
@@ -6,6 +6,7 @@
 #include "commandbuffergl.h"
 
 #include "resources/texturegl.h"
+#include "resources/computebuffergl.h"
 
 #include <log.h>
 
@@ -296,7 +297,8 @@ inline int32_t convertBlendFactor(int32_t factor) {
 
 MaterialInstanceGL::MaterialInstanceGL(Material *material) :
         MaterialInstance(material),
-        m_instanceBuffer(0) {
+        m_instanceBuffer(0),
+        m_instanceSize(0) {
 
     MaterialGL *m = static_cast<MaterialGL *>(material);
 
@@ -342,7 +344,12 @@ MaterialInstanceGL::~MaterialInstanceGL() {
 uint32_t MaterialInstanceGL::drawsCount() const {
     const ByteArray &gpuBuffer = m_batchBuffer ? *m_batchBuffer : m_uniformBuffer;
 
+#ifdef THUNDER_MOBILE
     return (uint32_t)ceil((float)gpuBuffer.size() / (float)gMaxUBO);
+#else
+    // Storage buffers are not limited in size, so the whole batch is drawn at once
+    return gpuBuffer.empty() ? 0 : 1;
+#endif
 }
 
 bool MaterialInstanceGL::bind(CommandBufferGL *buffer, uint32_t layer, uint32_t index, uint32_t globalBuffer) {
@@ -377,21 +384,42 @@ bool MaterialInstanceGL::bind(CommandBufferGL *buffer, uint32_t layer, uint32_t
         }
     }
 
+    uint32_t current = m_instanceBuffer;
+#ifndef THUNDER_MOBILE
+    uint32_t offset = 0;
+    if(m_indirectInstances) {
+        // Instance data is generated on the GPU
+        current = static_cast<ComputeBufferGL *>(m_indirectInstances)->nativeHandle();
+    } else if(m_batchBuffer) {
+        // Instance data of batches is written to the frame ring of the command buffer, the own buffer stays untouched
+        current = buffer->writeInstances(*m_batchBuffer, offset);
+    } else
+#endif
     if(m_localDirty) {
         copyLocalData(index, program, instanceLocation);
         m_localDirty = false;
+
+        current = m_instanceBuffer;
     }
 
     static uint32_t instanceBuffer = 0;
-    if(instanceBuffer != m_instanceBuffer) {
+#ifndef THUNDER_MOBILE
+    if(m_batchBuffer && !m_indirectInstances) {
+        if(instanceLocation > -1) {
+            glBindBufferRange(GL_SHADER_STORAGE_BUFFER, instanceLocation, current, offset, m_batchBuffer->size());
+        }
+        instanceBuffer = 0;
+    } else
+#endif
+    if(instanceBuffer != current) {
         if(instanceLocation > -1) {
 #ifdef THUNDER_MOBILE
-            glBindBufferBase(GL_UNIFORM_BUFFER, instanceLocation, m_instanceBuffer);
+            glBindBufferBase(GL_UNIFORM_BUFFER, instanceLocation, current);
 #else
-            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, instanceLocation, m_instanceBuffer);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, instanceLocation, current);
 #endif
         }
-        instanceBuffer = m_instanceBuffer;
+        instanceBuffer = current;
     }
 
     uint8_t i = 0;
@@ -454,8 +482,14 @@ void MaterialInstanceGL::copyLocalData(uint32_t index, uint32_t program, int32_t
         glGenBuffers(1, &m_instanceBuffer);
     }
 
+    // Storage is reallocated only when the instance data grows
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_instanceBuffer);
-    glBufferData(GL_SHADER_STORAGE_BUFFER, gpuBuffer.size(), gpuBuffer.data(), GL_DYNAMIC_DRAW);
+    if(gpuBuffer.size() > m_instanceSize) {
+        m_instanceSize = gpuBuffer.size();
+        glBufferData(GL_SHADER_STORAGE_BUFFER, m_instanceSize, gpuBuffer.data(), GL_DYNAMIC_DRAW);
+    } else if(!gpuBuffer.empty()) {
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, gpuBuffer.size(), gpuBuffer.data());
+    }
     glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
 #endif
 }
@@ -4,18 +4,10 @@
 
 #include "commandbuffergl.h"
 
-#define VERTEX_ATRIB    0
-#define UV0_ATRIB       1
-#define COLOR_ATRIB     2
-#define NORMAL_ATRIB    3
-#define TANGENT_ATRIB   4
-
-#define BONES_ATRIB     5
-#define WEIGHTS_ATRIB   6
-
 MeshGL::MeshGL() :
         m_triangles(0),
-        m_vertices(0) {
+        m_vertices(0),
+        m_indexSize(sizeof(uint32_t)) {
 
 }
 
@@ -98,54 +90,46 @@ void MeshGL::updateVao() {
     // vertices
     glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
 
-    uint32_t vCount = vertices().size();
-    glEnableVertexAttribArray(VERTEX_ATRIB);
-    glVertexAttribPointer(VERTEX_ATRIB, 3, GL_FLOAT, GL_FALSE, 0, nullptr);
-    size_t offset = sizeof(Vector3) * vCount;
-
-    // The order is matter and must be the same with MeshGL::updateVbo attributes
-    if(!uv0().empty()) {
-        glEnableVertexAttribArray(UV0_ATRIB);
-        glVertexAttribPointer(UV0_ATRIB, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
-        offset += sizeof(Vector2) * vCount;
-    }
-    if(!colors().empty()) {
-        glEnableVertexAttribArray(COLOR_ATRIB);
-        glVertexAttribPointer(COLOR_ATRIB, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
-        offset += sizeof(Vector4) * vCount;
-    }
-    if(!normals().empty()) {
-        glEnableVertexAttribArray(NORMAL_ATRIB);
-        glVertexAttribPointer(NORMAL_ATRIB, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
-        offset += sizeof(Vector3) * vCount;
-    }
-    if(!tangents().empty()) {
-        glEnableVertexAttribArray(TANGENT_ATRIB);
-        glVertexAttribPointer(TANGENT_ATRIB, 3, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
-        offset += sizeof(Vector3) * vCount;
-    }
-    if(!bones().empty()) {
-        glEnableVertexAttribArray(BONES_ATRIB);
-        glVertexAttribPointer(BONES_ATRIB, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
-        offset += sizeof(Vector4) * vCount;
+    for(auto &it : m_layout) {
+        int32_t size = 0;
+        uint32_t type = GL_FLOAT;
+        uint8_t normalized = GL_FALSE;
+        switch(it.format) {
+            case Float2: size = 2; break;
+            case Float3: size = 3; break;
+            case Float4: size = 4; break;
+            case Half2: size = 2; type = GL_HALF_FLOAT; break;
+            case Half4: size = 4; type = GL_HALF_FLOAT; break;
+            case Unorm8x4: size = 4; type = GL_UNSIGNED_BYTE; normalized = GL_TRUE; break;
+            case Snorm10x3: size = 4; type = GL_INT_2_10_10_10_REV; normalized = GL_TRUE; break;
+            default: break;
+        }
 
-        glEnableVertexAttribArray(WEIGHTS_ATRIB);
-        glVertexAttribPointer(WEIGHTS_ATRIB, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<void *>(offset));
+        glEnableVertexAttribArray(it.location);
+        glVertexAttribPointer(it.location, size, type, normalized, it.stride, reinterpret_cast<void *>(it.offset));
     }
-
 }
 
 void MeshGL::updateVbo() {
     bool dynamic = isDynamic();
     uint32_t usage = (dynamic) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
-    uint32_t vCount = vertices().size();
+
+    m_layout = vertexLayout();
+    m_indexSize = indexSize();
 
     if(!indices().empty()) {
         if(m_triangles == 0) {
             glGenBuffers(1, &m_triangles);
         }
         glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_triangles);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indices().size(), indices().data(), usage);
+
+        if(m_indexSize == sizeof(uint32_t)) {
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t) * indices().size(), indices().data(), usage);
+        } else {
+            ByteArray buffer(indexBufferSize());
+            fillIndexBuffer(buffer.data());
+            glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer.size(), buffer.data(), usage);
+        }
     }
 
     if(!vertices().empty()) {
@@ -154,55 +138,14 @@ void MeshGL::updateVbo() {
         }
         glBindBuffer(GL_ARRAY_BUFFER, m_vertices);
 
-        uint32_t size = sizeof(Vector3) * vCount;
-        if(!uv0().empty()) size += sizeof(Vector2) * vCount;
-        if(!colors().empty()) size += sizeof(Vector4) * vCount;
-        if(!normals().empty()) size += sizeof(Vector3) * vCount;
-        if(!tangents().empty()) size += sizeof(Vector3) * vCount;
-        if(!weights().empty()) size += sizeof(Vector4) * vCount;
-        if(!bones().empty()) size += sizeof(Vector4) * vCount;
-
-        glBufferData(GL_ARRAY_BUFFER, size, nullptr, usage);
-        size = sizeof(Vector3) * vCount;
-        size_t offset = 0;
-
-        glBufferSubData(GL_ARRAY_BUFFER, offset, size, vertices().data());
-        offset += size;
-
-        if(!uv0().empty()) {
-            size = sizeof(Vector2) * vCount;
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, uv0().data());
-            offset += size;
-        }
-        if(!colors().empty()) {
-            size = sizeof(Vector4) * vCount;
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, colors().data());
-            offset += size;
-        }
-        if(!normals().empty()) {
-            size = sizeof(Vector3) * vCount;
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, normals().data());
-            offset += size;
-        }
-        if(!tangents().empty()) {
-            size = sizeof(Vector3) * vCount;
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, tangents().data());
-            offset += size;
-        }
-        if(!bones().empty()) {
-            size = sizeof(Vector4) * vCount;
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, bones().data());
-            offset += size;
-        }
-        if(!weights().empty()) {
-            size = sizeof(Vector4) * vCount;
-            glBufferSubData(GL_ARRAY_BUFFER, offset, size, weights().data());
-        }
+        ByteArray buffer(vertexBufferSize());
+        fillVertexBuffer(buffer.data());
+
+        glBufferData(GL_ARRAY_BUFFER, buffer.size(), buffer.data(), usage);
     }
 
-    if(dynamic) {
-        for(auto &it : m_vao) {
-            it->dirty = true;
-        }
+    // Layout of the buffers might be changed
+    for(auto &it : m_vao) {
+        it->dirty = true;
     }
 }
@@ -39,6 +39,11 @@ void TextureGL::readPixels(int x, int y, int width, int height) {
 }
 
 void TextureGL::updateTexture() {
+    if(isStreamable()) {
+        // Number of resident levels has changed, so the storage must be reallocated
+        destroyTexture();
+    }
+
     bool newObject = false;
     if(m_id == 0) {
         glGenTextures(1, &m_id);
@@ -176,10 +181,12 @@ bool TextureGL::uploadTexture(uint32_t imageIndex, uint32_t target, uint32_t int
         glTexImage2D(target, 0, internal, m_width, m_height, 0, format, type, nullptr);
     } else {
         const Surface &image = surface(imageIndex);
+        // Streamed textures start from the highest resident level
+        uint32_t base = residentMip();
         if(m_compress != Uncompressed) {
             // load all mipmaps
             for(uint32_t i = 0; i < image.size(); i++) {
-                glCompressedTexImage2D(target, i, internal, (m_width >> i), (m_height >> i), 0, image[i].size(), image[i].data());
+                glCompressedTexImage2D(target, i, internal, (m_width >> (i + base)), (m_height >> (i + base)), 0, image[i].size(), image[i].data());
                 CheckGLError();
             }
         } else {
@@ -194,9 +201,9 @@ bool TextureGL::uploadTexture(uint32_t imageIndex, uint32_t target, uint32_t int
             // load all mipmaps
             for(uint32_t i = 0; i < image.size(); i++) {
                 if(m_depth > 1) {
-                    glTexImage3D(target, i, internal, (m_width >> i), (m_height >> i), (m_depth >> i), 0, format, type, image[i].data());
+                    glTexImage3D(target, i, internal, (m_width >> (i + base)), (m_height >> (i + base)), (m_depth >> (i + base)), 0, format, type, image[i].data());
                 } else {
-                    glTexImage2D(target, i, internal, (m_width >> i), (m_height >> i), 0, format, type, image[i].data());
+                    glTexImage2D(target, i, internal, (m_width >> (i + base)), (m_height >> (i + base)), 0, format, type, image[i].data());
                 }
                 CheckGLError();
             }
@@ -12,6 +12,7 @@
 
 class CommandBufferMt;
 class RenderTargetMt;
+class MeshMt;
 
 class MaterialInstanceMt : public MaterialInstance {
 public:
@@ -19,7 +20,7 @@ public:
 
     ~MaterialInstanceMt();
 
-    bool bind(CommandBufferMt &buffer, uint32_t layer, const MTL::Buffer *global, uint32_t currentFrame);
+    bool bind(CommandBufferMt &buffer, const MeshMt &mesh, uint32_t layer, const MTL::Buffer *global, uint32_t currentFrame);
 
 private:
     std::vector<MTL::Buffer *> m_local;
@@ -66,16 +67,16 @@ public:
 
     Textures &textures() { return m_textures; }
 
-    bool bind(MTL::RenderCommandEncoder *encoder, RenderTargetMt *target, uint32_t layer, uint16_t vertex);
+    bool bind(MTL::RenderCommandEncoder *encoder, RenderTargetMt *target, const MeshMt &mesh, uint32_t layer, uint16_t vertex);
 
     MTL::DepthStencilState *depthStencilState() const { return m_depthStencilState; }
 
 protected:
     MTL::Function *buildShader(const TString &src) const;
 
-    MTL::RenderPipelineState *getPipeline(uint16_t vertex, uint16_t fragment, RenderTargetMt *target);
+    MTL::RenderPipelineState *getPipeline(uint16_t vertex, uint16_t fragment, RenderTargetMt *target, const MeshMt &mesh);
 
-    MTL::RenderPipelineState *buildPipeline(uint32_t v, uint32_t f, RenderTargetMt *target);
+    MTL::RenderPipelineState *buildPipeline(uint32_t v, uint32_t f, RenderTargetMt *target, const MeshMt &mesh);
 
     MaterialInstance *createInstance(SurfaceType type = SurfaceType::Static) override;
 
@@ -21,6 +21,14 @@ public:
 
     MTL::Buffer *indexBuffer();
 
+    MTL::IndexType indexType() const;
+
+    uint32_t indexStride() const;
+
+    uint32_t layoutHash() const;
+
+    const VertexLayout &layout() const;
+
     void bind(MTL::RenderCommandEncoder *encoder, int uniformOffset);
 
 protected:
@@ -33,17 +41,11 @@ protected:
 
     uint32_t m_vertexSize;
 
-    uint32_t m_uvSize;
-
-    uint32_t m_colorSize;
-
-    uint32_t m_normalsSize;
-
-    uint32_t m_tangentsSize;
+    uint32_t m_indexSize;
 
-    uint32_t m_weightsSize;
+    uint32_t m_layoutHash;
 
-    uint32_t m_bonesSize;
+    VertexLayout m_layout;
 
 };
 
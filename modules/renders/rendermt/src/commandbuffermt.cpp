@@ -51,10 +51,12 @@ void CommandBufferMt::drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, Materia
     PROFILE_FUNCTION();
 
     if(mesh && m_encoder) {
+        // The mesh is bound first, the pipeline depends on its vertex layout
+        MeshMt *meshMt = static_cast<MeshMt *>(mesh);
+        meshMt->bind(m_encoder, 2);
+
         MaterialInstanceMt &instanceMt = static_cast<MaterialInstanceMt &>(instance);
-        if(instanceMt.bind(*this, layer, static_cast<RenderTargetMt *>(m_target)->globalBuffer(m_currentFrame), m_currentFrame)) {
-            MeshMt *meshMt = static_cast<MeshMt *>(mesh);
-            meshMt->bind(m_encoder, 2);
+        if(instanceMt.bind(*this, *meshMt, layer, static_cast<RenderTargetMt *>(m_target)->globalBuffer(m_currentFrame), m_currentFrame)) {
 
             bool wire = instance.material()->wireframe();
 
@@ -71,8 +73,8 @@ void CommandBufferMt::drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, Materia
                 int32_t index = meshMt->indexCount(sub);
 
                 MTL::PrimitiveType primitiveType = wire ? MTL::PrimitiveTypeLine : MTL::PrimitiveTypeTriangle;
-                m_encoder->drawIndexedPrimitives(primitiveType, index, MTL::IndexTypeUInt32, meshMt->indexBuffer(),
-                                                 meshMt->indexStart(sub), instance.instanceCount(), 0, 0);
+                m_encoder->drawIndexedPrimitives(primitiveType, index, meshMt->indexType(), meshMt->indexBuffer(),
+                                                 meshMt->indexStart(sub) * meshMt->indexStride(), instance.instanceCount(), 0, 0);
 
                 PROFILER_STAT(POLYGONS, (index / 3) * count);
             }
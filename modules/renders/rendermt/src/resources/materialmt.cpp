@@ -8,6 +8,7 @@
 
 #include "resources/texturemt.h"
 #include "resources/rendertargetmt.h"
+#include "resources/meshmt.h"
 
 #include <log.h>
 
@@ -188,7 +189,7 @@ void MaterialMt::loadUserData(const VariantMap &data) {
     }
 }
 
-MTL::RenderPipelineState *MaterialMt::getPipeline(uint16_t vertex, uint16_t fragment, RenderTargetMt *target) {
+MTL::RenderPipelineState *MaterialMt::getPipeline(uint16_t vertex, uint16_t fragment, RenderTargetMt *target, const MeshMt &mesh) {
     switch(state()) {
         case ToBeUpdated: {
             setState(Ready);
@@ -199,12 +200,13 @@ MTL::RenderPipelineState *MaterialMt::getPipeline(uint16_t vertex, uint16_t frag
     uint32_t index = target->uuid();
     Mathf::hashCombine(index, vertex);
     Mathf::hashCombine(index, fragment);
+    Mathf::hashCombine(index, mesh.layoutHash());
 
     auto it = m_pipelines.find(index);
     if(it != m_pipelines.end()) {
         return it->second;
     } else {
-        MTL::RenderPipelineState *pipeline = buildPipeline(vertex, fragment, target);
+        MTL::RenderPipelineState *pipeline = buildPipeline(vertex, fragment, target, mesh);
         if(pipeline) {
             m_pipelines[index] = pipeline;
             return pipeline;
@@ -213,13 +215,13 @@ MTL::RenderPipelineState *MaterialMt::getPipeline(uint16_t vertex, uint16_t frag
     return nullptr;
 }
 
-bool MaterialMt::bind(MTL::RenderCommandEncoder *encoder, RenderTargetMt *target, uint32_t layer, uint16_t vertex) {
+bool MaterialMt::bind(MTL::RenderCommandEncoder *encoder, RenderTargetMt *target, const MeshMt &mesh, uint32_t layer, uint16_t vertex) {
     uint16_t type = FragmentDefault;
     if((layer & Material::Visibility) || (layer & Material::Shadowcast)) {
         type = FragmentVisibility;
     }
 
-    MTL::RenderPipelineState *pipeline = getPipeline(vertex, type, target);
+    MTL::RenderPipelineState *pipeline = getPipeline(vertex, type, target, mesh);
     if(pipeline) {
         encoder->setRenderPipelineState(pipeline);
 
@@ -228,7 +230,7 @@ bool MaterialMt::bind(MTL::RenderCommandEncoder *encoder, RenderTargetMt *target
     return false;
 }
 
-MTL::RenderPipelineState *MaterialMt::buildPipeline(uint32_t v, uint32_t f, RenderTargetMt *target) {
+MTL::RenderPipelineState *MaterialMt::buildPipeline(uint32_t v, uint32_t f, RenderTargetMt *target, const MeshMt &mesh) {
     MaterialMt::Shader *vertex = shader(v);
     MaterialMt::Shader *fragment = shader(f);
 
@@ -250,6 +252,24 @@ MTL::RenderPipelineState *MaterialMt::buildPipeline(uint32_t v, uint32_t f, Rend
             default: break;
         }
 
+        // The mesh defines the actual format of the attribute, the GPU converts it to the shader input type
+        for(auto &it : mesh.layout()) {
+            if(it.location == static_cast<uint32_t>(vertex->attributes[i].location)) {
+                switch(it.format) {
+                    case Mesh::Float2: format = MTL::VertexFormatFloat2; break;
+                    case Mesh::Float3: format = MTL::VertexFormatFloat3; break;
+                    case Mesh::Float4: format = MTL::VertexFormatFloat4; break;
+                    case Mesh::Half2: format = MTL::VertexFormatHalf2; break;
+                    case Mesh::Half4: format = MTL::VertexFormatHalf4; break;
+                    case Mesh::Unorm8x4: format = MTL::VertexFormatUChar4Normalized; break;
+                    case Mesh::Snorm10x3: format = MTL::VertexFormatInt1010102Normalized; break;
+                    default: break;
+                }
+                size = it.stride;
+                break;
+            }
+        }
+
         attributeDesc->setFormat(format);
         vertexDescriptor->attributes()->setObject(attributeDesc, vertex->attributes[i].location);
 
@@ -362,12 +382,12 @@ MaterialInstanceMt::~MaterialInstanceMt() {
     m_local.clear();
 }
 
-bool MaterialInstanceMt::bind(CommandBufferMt &buffer, uint32_t layer, const MTL::Buffer *global, uint32_t currentFrame) {
+bool MaterialInstanceMt::bind(CommandBufferMt &buffer, const MeshMt &mesh, uint32_t layer, const MTL::Buffer *global, uint32_t currentFrame) {
     MTL::RenderCommandEncoder *encoder = buffer.encoder();
 
     MaterialMt *material = static_cast<MaterialMt *>(m_material);
 
-    if(material->bind(encoder, static_cast<RenderTargetMt *>(buffer.renderTarget()), layer, m_surfaceType + 1)) {
+    if(material->bind(encoder, static_cast<RenderTargetMt *>(buffer.renderTarget()), mesh, layer, m_surfaceType + 1)) {
         if(m_globalVertextLocation == -1 && m_localVertextLocation == -1) {
             MaterialMt::Shader *shader = material->shader(VertexStatic);
             for(auto uniform : shader->uniforms) {
@@ -6,11 +6,8 @@ MeshMt::MeshMt() :
         m_vertexBuffer(nullptr),
         m_indexBuffer(nullptr),
         m_vertexSize(0),
-        m_uvSize(0),
-        m_normalsSize(0),
-        m_tangentsSize(0),
-        m_bonesSize(0),
-        m_weightsSize(0) {
+        m_indexSize(sizeof(uint32_t)),
+        m_layoutHash(0) {
 
 }
 
@@ -18,6 +15,22 @@ MTL::Buffer *MeshMt::indexBuffer() {
     return m_indexBuffer;
 }
 
+MTL::IndexType MeshMt::indexType() const {
+    return (m_indexSize == sizeof(uint16_t)) ? MTL::IndexTypeUInt16 : MTL::IndexTypeUInt32;
+}
+
+uint32_t MeshMt::indexStride() const {
+    return m_indexSize;
+}
+
+uint32_t MeshMt::layoutHash() const {
+    return m_layoutHash;
+}
+
+const Mesh::VertexLayout &MeshMt::layout() const {
+    return m_layout;
+}
+
 void MeshMt::bind(MTL::RenderCommandEncoder *encoder, int uniformOffset) {
     switch(state()) {
         case ToBeUpdated: {
@@ -42,109 +55,43 @@ void MeshMt::bind(MTL::RenderCommandEncoder *encoder, int uniformOffset) {
         default: break;
     }
 
-    int index = uniformOffset;
-    size_t offset = 0;
-    encoder->setVertexBuffer(m_vertexBuffer, offset, index++);
-    offset += m_vertexSize;
-
-    if(m_uvSize > 0) {
-        encoder->setVertexBuffer(m_vertexBuffer, offset, index++);
-        offset += m_uvSize;
-    }
-
-    if(m_colorSize > 0) {
-        encoder->setVertexBuffer(m_vertexBuffer, offset, index++);
-        offset += m_colorSize;
-    }
-
-    if(m_normalsSize > 0) {
-        encoder->setVertexBuffer(m_vertexBuffer, offset, index++);
-        offset += m_normalsSize;
-    }
-
-    if(m_tangentsSize > 0) {
-        encoder->setVertexBuffer(m_vertexBuffer, offset, index++);
-        offset += m_tangentsSize;
-    }
-
-    if(m_bonesSize > 0) {
-        encoder->setVertexBuffer(m_vertexBuffer, offset, index++);
-        offset += m_bonesSize;
-    }
-
-    if(m_weightsSize > 0) {
-        encoder->setVertexBuffer(m_vertexBuffer, offset, index);
+    // Buffer indices follow the uniform buffers in the order of shader locations
+    for(auto &it : m_layout) {
+        encoder->setVertexBuffer(m_vertexBuffer, it.offset, it.location + uniformOffset);
     }
 }
 
 void MeshMt::update() {
+    m_layout = vertexLayout();
+    m_indexSize = indexSize();
+
+    m_layoutHash = 0;
+    for(auto &it : m_layout) {
+        Mathf::hashCombine(m_layoutHash, it.location);
+        Mathf::hashCombine(m_layoutHash, it.format);
+        Mathf::hashCombine(m_layoutHash, it.stride);
+    }
+
     if(!indices().empty()) {
         if(m_indexBuffer != nullptr) {
             m_indexBuffer->release();
         }
 
-        size_t size = sizeof(uint32_t) * indices().size();
-
-        m_indexBuffer = WrapperMt::device()->newBuffer(size, MTL::ResourceStorageModeShared);
-        memcpy(m_indexBuffer->contents(), indices().data(), size);
+        m_indexBuffer = WrapperMt::device()->newBuffer(indexBufferSize(), MTL::ResourceStorageModeShared);
+        fillIndexBuffer(reinterpret_cast<uint8_t *>(m_indexBuffer->contents()));
     }
 
     if(!vertices().empty()) {
-        uint32_t vCount = vertices().size();
-
-        uint32_t size = sizeof(Vector3) * vCount;
-        if(!uv0().empty()) size += sizeof(Vector2) * vCount;
-        if(!colors().empty()) size += sizeof(Vector4) * vCount;
-        if(!normals().empty()) size += sizeof(Vector3) * vCount;
-        if(!tangents().empty()) size += sizeof(Vector3) * vCount;
-        if(!weights().empty()) size += sizeof(Vector4) * vCount;
-        if(!bones().empty()) size += sizeof(Vector4) * vCount;
-
-        if(size > (m_vertexSize + m_uvSize + m_colorSize +
-                    m_normalsSize + m_tangentsSize + m_weightsSize + m_bonesSize)) {
-
+        uint32_t size = vertexBufferSize();
+        if(size > m_vertexSize) {
             if(m_vertexBuffer) {
                 m_vertexBuffer->release();
             }
 
             m_vertexBuffer = WrapperMt::device()->newBuffer(size, MTL::ResourceStorageModeShared);
+            m_vertexSize = size;
         }
 
-        uint8_t *ptr = reinterpret_cast<uint8_t *>(m_vertexBuffer->contents());
-
-        size_t offset = 0;
-        m_vertexSize = sizeof(Vector3) * vCount;
-        memcpy(ptr, vertices().data(), m_vertexSize);
-        offset += m_vertexSize;
-
-        if(!uv0().empty()) {
-            m_uvSize = sizeof(Vector2) * vCount;
-            memcpy(&ptr[offset], uv0().data(), m_uvSize);
-            offset += m_uvSize;
-        }
-        if(!colors().empty()) {
-            m_colorSize = sizeof(Vector4) * vCount;
-            memcpy(&ptr[offset], colors().data(), m_colorSize);
-            offset += m_colorSize;
-        }
-        if(!normals().empty()) {
-            m_normalsSize = sizeof(Vector3) * vCount;
-            memcpy(&ptr[offset], normals().data(), m_normalsSize);
-            offset += m_normalsSize;
-        }
-        if(!tangents().empty()) {
-            m_tangentsSize = sizeof(Vector3) * vCount;
-            memcpy(&ptr[offset], tangents().data(), m_tangentsSize);
-            offset += m_tangentsSize;
-        }
-        if(!bones().empty()) {
-            m_bonesSize = sizeof(Vector4) * vCount;
-            memcpy(&ptr[offset], bones().data(), m_bonesSize);
-            offset += m_bonesSize;
-        }
-        if(!weights().empty()) {
-            m_weightsSize = sizeof(Vector4) * vCount;
-            memcpy(&ptr[offset], weights().data(), m_weightsSize);
-        }
+        fillVertexBuffer(reinterpret_cast<uint8_t *>(m_vertexBuffer->contents()));
     }
 }
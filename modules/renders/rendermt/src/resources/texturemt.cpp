@@ -92,6 +92,12 @@ void TextureMt::updateTexture() {
         textureDesc->release();
     }
 
+    if(m_sampler && isStreamable()) {
+        // Sampler clamps levels which are not resident yet
+        m_sampler->release();
+        m_sampler = nullptr;
+    }
+
     if(m_sampler == nullptr) {
         MTL::SamplerDescriptor *samplerDesc = MTL::SamplerDescriptor::alloc()->init();
 
@@ -108,6 +114,7 @@ void TextureMt::updateTexture() {
 
         if(mipCount() > 1) {
             samplerDesc->setMipFilter(MTL::SamplerMipFilterLinear);
+            samplerDesc->setLodMinClamp(residentMip());
         }
 
         MTL::SamplerAddressMode wrap = MTL::SamplerAddressModeClampToEdge;
@@ -155,10 +162,13 @@ void TextureMt::uploadTexture(uint32_t slice) {
 
     bool cube = isCubemap();
 
+    // Streamed textures start from the highest resident level
+    uint32_t base = residentMip();
+
     for(uint32_t i = 0; i < image.size(); i++) {
-        uint32_t w = (m_width >> i);
-        uint32_t h = (m_height >> i);
-        uint32_t d = cube ? (m_depth >> i) : 1;
+        uint32_t w = (m_width >> (i + base));
+        uint32_t h = (m_height >> (i + base));
+        uint32_t d = cube ? (m_depth >> (i + base)) : 1;
 
         int rowSize = w * components() * bytesPerChannel();
         switch(m_compress) {
@@ -172,7 +182,7 @@ void TextureMt::uploadTexture(uint32_t slice) {
             default: break;
         }
 
-        m_native->replaceRegion(MTL::Region(0, 0, 0, w, h, d), i, slice, image[i].data(), rowSize, image[i].size());
+        m_native->replaceRegion(MTL::Region(0, 0, 0, w, h, d), i + base, slice, image[i].data(), rowSize, image[i].size());
     }
 }
 
@@ -0,0 +1,46 @@
+#ifndef COMMANDBUFFERNULL_H
+#define COMMANDBUFFERNULL_H
+
+#include <commandbuffer.h>
+
+class CommandBufferNull : public CommandBuffer {
+    A_OBJECT_OVERRIDE(CommandBufferNull, CommandBuffer, System)
+
+public:
+    CommandBufferNull();
+
+    void resetStatistics();
+
+    uint32_t drawCalls() const;
+
+    uint32_t polygons() const;
+
+    uint32_t dispatches() const;
+
+    uint32_t commands() const;
+
+    uint64_t uploadedBytes() const;
+
+protected:
+    void dispatchCompute(ComputeInstance &shader, int32_t groupsX, int32_t groupsY, int32_t groupsZ) override;
+
+    void drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, MaterialInstance &instance) override;
+
+    void setRenderTarget(RenderTarget *target, uint32_t level = 0) override;
+
+    void execute(const CommandList &list) override;
+
+protected:
+    uint64_t m_uploaded;
+
+    uint32_t m_drawCalls;
+
+    uint32_t m_polygons;
+
+    uint32_t m_dispatches;
+
+    uint32_t m_commands;
+
+};
+
+#endif // COMMANDBUFFERNULL_H
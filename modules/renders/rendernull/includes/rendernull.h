@@ -0,0 +1,22 @@
+#ifndef RENDERNULL_H
+#define RENDERNULL_H
+
+#include <module.h>
+
+class RenderNull : public Module {
+public:
+    RenderNull(Engine *engine);
+
+    ~RenderNull();
+
+    const char *metaInfo() const override;
+
+    void *getObject(const char *name) override;
+
+};
+#ifdef SHARED_DEFINE
+extern "C" {
+    MODULE_EXPORT Module *moduleCreate(Engine *engine);
+}
+#endif
+#endif // RENDERNULL_H
@@ -0,0 +1,19 @@
+#ifndef RENDERNULLSYSTEM_H
+#define RENDERNULLSYSTEM_H
+
+#include <cstdint>
+
+#include <systems/rendersystem.h>
+
+class RenderNullSystem : public RenderSystem {
+public:
+    RenderNullSystem();
+    ~RenderNullSystem();
+
+    bool init() override;
+
+    void update(World *world) override;
+
+};
+
+#endif // RENDERNULLSYSTEM_H
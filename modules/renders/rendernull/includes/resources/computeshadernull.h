@@ -0,0 +1,18 @@
+#ifndef COMPUTESHADERNULL_H
+#define COMPUTESHADERNULL_H
+
+#include <resources/computeshader.h>
+
+class ComputeShaderNull : public ComputeShader {
+    A_OBJECT_OVERRIDE(ComputeShaderNull, ComputeShader, Resources)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+    A_NOENUMS()
+
+protected:
+    void switchState(State state) override;
+
+};
+
+#endif // COMPUTESHADERNULL_H
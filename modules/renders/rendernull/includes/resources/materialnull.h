@@ -0,0 +1,36 @@
+#ifndef MATERIALNULL_H
+#define MATERIALNULL_H
+
+#include <resources/material.h>
+
+class CommandBufferNull;
+
+class MaterialInstanceNull : public MaterialInstance {
+public:
+    explicit MaterialInstanceNull(Material *material);
+
+    uint32_t bind(CommandBufferNull *buffer);
+
+private:
+    ByteArray m_deviceBuffer;
+
+};
+
+class MaterialNull : public Material {
+    A_OBJECT_OVERRIDE(MaterialNull, Material, Resources)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+    A_NOENUMS()
+
+public:
+    Textures &textures() { return m_textures; }
+
+protected:
+    MaterialInstance *createInstance(SurfaceType type = SurfaceType::Static) override;
+
+    void switchState(State state) override;
+
+};
+
+#endif // MATERIALNULL_H
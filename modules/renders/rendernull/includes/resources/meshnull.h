@@ -0,0 +1,20 @@
+#ifndef MESHNULL_H
+#define MESHNULL_H
+
+#include <resources/mesh.h>
+
+class MeshNull : public Mesh {
+    A_OBJECT_OVERRIDE(MeshNull, Mesh, Resources)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+
+public:
+    MeshNull();
+
+protected:
+    void switchState(State state) override;
+
+};
+
+#endif // MESHNULL_H
@@ -0,0 +1,21 @@
+#ifndef RENDERTARGETNULL_H
+#define RENDERTARGETNULL_H
+
+#include <resources/rendertarget.h>
+
+class RenderTargetNull : public RenderTarget {
+    A_OBJECT_OVERRIDE(RenderTargetNull, RenderTarget, Resources)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+    A_NOENUMS()
+
+public:
+    RenderTargetNull();
+
+protected:
+    void switchState(State state) override;
+
+};
+
+#endif // RENDERTARGETNULL_H
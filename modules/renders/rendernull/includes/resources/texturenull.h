@@ -0,0 +1,21 @@
+#ifndef TEXTURENULL_H
+#define TEXTURENULL_H
+
+#include <resources/texture.h>
+
+class TextureNull : public Texture {
+    A_OBJECT_OVERRIDE(TextureNull, Texture, Resources)
+
+    A_NOPROPERTIES()
+    A_NOMETHODS()
+    A_NOENUMS()
+
+public:
+    TextureNull();
+
+protected:
+    void switchState(State state) override;
+
+};
+
+#endif // TEXTURENULL_H
@@ -0,0 +1,83 @@
+#include "commandbuffernull.h"
+
+#include "resources/meshnull.h"
+#include "resources/materialnull.h"
+
+#include <commandlist.h>
+
+CommandBufferNull::CommandBufferNull() :
+        m_uploaded(0),
+        m_drawCalls(0),
+        m_polygons(0),
+        m_dispatches(0),
+        m_commands(0) {
+    PROFILE_FUNCTION();
+}
+
+void CommandBufferNull::resetStatistics() {
+    m_uploaded = 0;
+    m_drawCalls = 0;
+    m_polygons = 0;
+    m_dispatches = 0;
+    m_commands = 0;
+}
+
+uint32_t CommandBufferNull::drawCalls() const {
+    return m_drawCalls;
+}
+
+uint32_t CommandBufferNull::polygons() const {
+    return m_polygons;
+}
+
+uint32_t CommandBufferNull::dispatches() const {
+    return m_dispatches;
+}
+
+uint32_t CommandBufferNull::commands() const {
+    return m_commands;
+}
+
+uint64_t CommandBufferNull::uploadedBytes() const {
+    return m_uploaded;
+}
+
+void CommandBufferNull::dispatchCompute(ComputeInstance &shader, int32_t groupsX, int32_t groupsY, int32_t groupsZ) {
+    A_UNUSED(shader);
+    A_UNUSED(groupsX);
+    A_UNUSED(groupsY);
+    A_UNUSED(groupsZ);
+
+    m_dispatches++;
+}
+
+void CommandBufferNull::drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, MaterialInstance &instance) {
+    PROFILE_FUNCTION();
+    A_UNUSED(layer);
+
+    if(mesh) {
+        MaterialInstanceNull &instanceNull = static_cast<MaterialInstanceNull &>(instance);
+        m_uploaded += instanceNull.bind(this);
+
+        uint32_t count = mesh->indices().empty() ? mesh->vertices().size() : mesh->indexCount(sub);
+        uint32_t polygons = count / 3 * instance.instanceCount();
+
+        PROFILER_STAT(POLYGONS, polygons);
+        PROFILER_STAT(DRAWCALLS, 1);
+
+        m_polygons += polygons;
+        m_drawCalls++;
+    }
+}
+
+void CommandBufferNull::execute(const CommandList &list) {
+    m_commands += list.count();
+
+    CommandBuffer::execute(list);
+}
+
+void CommandBufferNull::setRenderTarget(RenderTarget *target, uint32_t level) {
+    PROFILE_FUNCTION();
+
+    CommandBuffer::setRenderTarget(target, level);
+}
@@ -0,0 +1,36 @@
+#include "rendernull.h"
+
+#include "rendernullsystem.h"
+
+#ifdef SHARED_DEFINE
+Module *moduleCreate(Engine *engine) {
+    return new RenderNull(engine);
+}
+#endif
+
+static const char *meta = \
+"{"
+"   \"module\": \"RenderNull\","
+"   \"version\": \"1.0\","
+"   \"description\": \"Headless Null Render Module\","
+"   \"author\": \"Evgeniy Prikazchikov\","
+"   \"objects\": {"
+"       \"RenderNull\": \"render\""
+"   }"
+"}";
+
+RenderNull::RenderNull(Engine *engine) :
+        Module(engine) {
+}
+
+RenderNull::~RenderNull() {
+
+}
+
+const char *RenderNull::metaInfo() const {
+    return meta;
+}
+
+void *RenderNull::getObject(const char *) {
+    return new RenderNullSystem();
+}
@@ -0,0 +1,81 @@
+#include "rendernullsystem.h"
+
+#include <components/world.h>
+
+#include "resources/meshnull.h"
+#include "resources/texturenull.h"
+#include "resources/materialnull.h"
+#include "resources/rendertargetnull.h"
+#include "resources/computeshadernull.h"
+
+#include "systems/resourcesystem.h"
+
+#include <pipelinecontext.h>
+#include "commandbuffernull.h"
+
+namespace {
+    const int32_t gMaxTextureSize(16384);
+    const int32_t gMaxCubemapSize(16384);
+}
+
+RenderNullSystem::RenderNullSystem() :
+        RenderSystem() {
+
+    PROFILE_FUNCTION();
+
+    ResourceSystem *system = Engine::resourceSystem();
+
+    TextureNull::registerClassFactory(system);
+    RenderTargetNull::registerClassFactory(system);
+    MaterialNull::registerClassFactory(system);
+    MeshNull::registerClassFactory(system);
+    ComputeShaderNull::registerClassFactory(system);
+
+    CommandBufferNull::registerClassFactory(system);
+
+    setName("RenderNull");
+}
+
+RenderNullSystem::~RenderNullSystem() {
+    PROFILE_FUNCTION();
+
+    ResourceSystem *system = Engine::resourceSystem();
+
+    TextureNull::unregisterClassFactory(system);
+    RenderTargetNull::unregisterClassFactory(system);
+    MaterialNull::unregisterClassFactory(system);
+    MeshNull::unregisterClassFactory(system);
+    ComputeShaderNull::unregisterClassFactory(system);
+
+    CommandBufferNull::unregisterClassFactory(system);
+}
+/*!
+    Initialization of render.
+    The null render doesn't need any device or window, so it always succeeds.
+*/
+bool RenderNullSystem::init() {
+    PROFILE_FUNCTION();
+
+    Texture::setMaxTextureSize(gMaxTextureSize);
+    Texture::setMaxCubemapSize(gMaxCubemapSize);
+
+    CommandBufferNull::setInited();
+
+    return RenderSystem::init();
+}
+/*!
+    Main drawing procedure.
+    Runs the whole pipeline on the CPU side; draw calls are only counted by the command buffer.
+*/
+void RenderNullSystem::update(World *world) {
+    PROFILE_FUNCTION();
+
+    PipelineContext *context = pipelineContext();
+    if(context && CommandBufferNull::isInited()) {
+        CommandBufferNull *cmd = static_cast<CommandBufferNull *>(context->buffer());
+        cmd->begin();
+        cmd->resetStatistics();
+
+        RenderSystem::update(world);
+    }
+}
@@ -0,0 +1,6 @@
+#include "resources/computeshadernull.h"
+
+void ComputeShaderNull::switchState(State state) {
+    // There is no device to compile the shader, so it's ready at once
+    Resource::switchState(state);
+}
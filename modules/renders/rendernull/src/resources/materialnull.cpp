@@ -0,0 +1,55 @@
+#include "resources/materialnull.h"
+
+#include "commandbuffernull.h"
+
+#include <cstring>
+
+MaterialInstance *MaterialNull::createInstance(SurfaceType type) {
+    MaterialInstanceNull *result = new MaterialInstanceNull(this);
+
+    if(state() == ToBeUpdated || state() == Ready) {
+        initInstance(result);
+    }
+
+    result->setSurfaceType(type);
+
+    return result;
+}
+
+void MaterialNull::switchState(State state) {
+    if(state == ToBeUpdated) {
+        for(auto it : Material::m_instances) {
+            initInstance(it);
+        }
+    }
+
+    Resource::switchState(state);
+}
+
+MaterialInstanceNull::MaterialInstanceNull(Material *material) :
+        MaterialInstance(material) {
+
+}
+
+uint32_t MaterialInstanceNull::bind(CommandBufferNull *buffer) {
+    uint32_t result = 0;
+
+    // Emulate the uniform upload with a copy to keep the CPU cost of the frame close to real backends
+    if(m_localDirty) {
+        const ByteArray &gpuBuffer = m_batchBuffer ? *m_batchBuffer : m_uniformBuffer;
+
+        m_deviceBuffer.resize(gpuBuffer.size());
+        if(!gpuBuffer.empty()) {
+            memcpy(m_deviceBuffer.data(), gpuBuffer.data(), gpuBuffer.size());
+        }
+
+        result = gpuBuffer.size();
+        m_localDirty = false;
+    }
+
+    for(auto &it : static_cast<MaterialNull *>(m_material)->textures()) {
+        texture(*buffer, it.binding);
+    }
+
+    return result;
+}
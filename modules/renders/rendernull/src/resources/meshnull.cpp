@@ -0,0 +1,10 @@
+#include "resources/meshnull.h"
+
+MeshNull::MeshNull() {
+
+}
+
+void MeshNull::switchState(State state) {
+    // Nothing to upload, vertex data stays on the CPU side
+    Resource::switchState(state);
+}
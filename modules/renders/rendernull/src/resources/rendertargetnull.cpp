@@ -0,0 +1,9 @@
+#include "resources/rendertargetnull.h"
+
+RenderTargetNull::RenderTargetNull() {
+
+}
+
+void RenderTargetNull::switchState(State state) {
+    Resource::switchState(state);
+}
@@ -0,0 +1,10 @@
+#include "resources/texturenull.h"
+
+TextureNull::TextureNull() {
+
+}
+
+void TextureNull::switchState(State state) {
+    // Nothing to upload, pixel data stays on the CPU side
+    Resource::switchState(state);
+}
@@ -0,0 +1,101 @@
+#include "gtest/gtest.h"
+
+#include "components/world.h"
+#include "components/scene.h"
+#include "components/actor.h"
+#include "components/transform.h"
+#include "components/camera.h"
+#include "components/meshrender.h"
+
+#include "resources/pipeline.h"
+
+#include "systems/rendersystem.h"
+
+#include "pipelinecontext.h"
+
+#include "rendernull.h"
+#include "commandbuffernull.h"
+
+namespace RenderNullSuite {
+
+    class RenderNullTest : public ::testing::Test {
+    public:
+        Material *createMaterial() {
+            Material *material = Engine::objectCreate<Material>();
+            material->loadUserData({
+                {"Uniforms", VariantList({VariantList({Vector4(1.0f), 16, "mainColor"})})}
+            });
+            return material;
+        }
+
+        Mesh *createMesh() {
+            Mesh *mesh = Engine::objectCreate<Mesh>();
+            mesh->setVertices({Vector3(-1.0f,-1.0f, 0.0f), Vector3(1.0f,-1.0f, 0.0f), Vector3(1.0f, 1.0f, 0.0f), Vector3(-1.0f, 1.0f, 0.0f)});
+            mesh->setIndices({0, 1, 2, 0, 2, 3});
+            mesh->setSubMesh(0, 0);
+            mesh->recalcBounds();
+            return mesh;
+        }
+    };
+
+    TEST_F(RenderNullTest, Draw_scene) {
+        Engine engine;
+        engine.addModule(new RenderNull(&engine));
+
+        RenderSystem *render = Engine::renderSystem();
+        ASSERT_TRUE(render != nullptr);
+        ASSERT_TRUE(render->init());
+
+        Pipeline pipeline;
+        pipeline.loadUserData({
+            {"Tasks", VariantList({"GBuffer"})}
+        });
+
+        PipelineContext *context = Engine::objectCreate<PipelineContext>();
+        context->setPipeline(&pipeline);
+        render->setPipelineContext(context);
+
+        CommandBufferNull *buffer = dynamic_cast<CommandBufferNull *>(context->buffer());
+        ASSERT_TRUE(buffer != nullptr);
+
+        World *world = Engine::objectCreate<World>("World");
+        Scene *scene = world->createScene("Scene");
+
+        Actor *view = Engine::composeActor<Camera>("Camera", scene);
+        view->transform()->setPosition(Vector3(0.0f, 0.0f, 20.0f));
+        Camera::setCurrent(view->getComponent<Camera>());
+
+        Mesh *mesh = createMesh();
+        Material *first = createMaterial();
+        Material *second = createMaterial();
+
+        // Six quads with the first material and two with the second one, one quad is behind the camera
+        for(int i = 0; i < 9; i++) {
+            Actor *actor = Engine::composeActor<MeshRender>("Quad", scene);
+            actor->transform()->setPosition(Vector3(i - 4.0f, 0.0f, (i == 8) ? 40.0f : 0.0f));
+
+            MeshRender *quad = actor->getComponent<MeshRender>();
+            quad->setMesh(mesh);
+            quad->setMaterial((i < 6) ? first : second);
+        }
+
+        for(int frame = 0; frame < 2; frame++) {
+            render->update(world);
+
+            // Each material run is drawn with one instanced call: the target, two bindings and two draws are replayed
+            ASSERT_EQ(buffer->drawCalls(), uint32_t(2));
+            ASSERT_EQ(buffer->polygons(), uint32_t(16));
+            ASSERT_EQ(buffer->commands(), uint32_t(5));
+            ASSERT_EQ(buffer->dispatches(), uint32_t(0));
+        }
+
+        Camera::setCurrent(nullptr);
+        render->setPipelineContext(nullptr);
+
+        delete world;
+        delete context;
+        delete mesh;
+        delete first;
+        delete second;
+    }
+}
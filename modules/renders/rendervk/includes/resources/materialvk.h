@@ -13,13 +13,14 @@ class CommandBufferVk;
 
 class RenderTargetVk;
 class TextureVk;
+class MeshVk;
 
 class MaterialInstanceVk : public MaterialInstance {
 public:
     MaterialInstanceVk(Material *material);
     ~MaterialInstanceVk() override;
 
-    bool bind(CommandBufferVk &buffer, uint32_t layer, VkDescriptorSet globalDescriptorSet, uint32_t currentFrame);
+    bool bind(CommandBufferVk &buffer, const MeshVk &mesh, uint32_t layer, VkDescriptorSet globalDescriptorSet, uint32_t currentFrame);
 
     void destroyDescriptors();
 
@@ -80,7 +81,7 @@ public:
 
     void switchState(State state) override;
 
-    bool bind(VkCommandBuffer buffer, RenderTargetVk *target, uint32_t layer, uint16_t vertex);
+    bool bind(VkCommandBuffer buffer, RenderTargetVk *target, const MeshVk &mesh, uint32_t layer, uint16_t vertex);
 
     VkPipelineLayout pipelineLayout();
 
@@ -91,14 +92,14 @@ public:
     void removeInstance(MaterialInstanceVk *instance);
 
 protected:
-    VkPipeline getPipeline(uint16_t vertex, uint32_t layer, RenderTargetVk *target);
+    VkPipeline getPipeline(uint16_t vertex, uint32_t layer, RenderTargetVk *target, const MeshVk &mesh);
 
     void destroyPrograms();
 
     VkShaderModule buildShader(const ByteArray &src);
 
     void buildPipelineLayout();
-    VkPipeline buildPipeline(uint32_t vertex, uint32_t layer, RenderTargetVk *target);
+    VkPipeline buildPipeline(uint32_t vertex, uint32_t layer, RenderTargetVk *target, const MeshVk &mesh);
 
     MaterialInstance *createInstance(SurfaceType type = SurfaceType::Static) override;
 
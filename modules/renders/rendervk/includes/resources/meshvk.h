@@ -32,12 +32,12 @@ public:
 
     size_t m_indicesSize;
     size_t m_verticesSize;
-    size_t m_uvSize;
-    size_t m_colorsSize;
-    size_t m_normalsSize;
-    size_t m_tangentsSize;
-    size_t m_bonesSize;
-    size_t m_weightsSize;
+
+    uint32_t m_indexSize;
+
+    uint32_t m_layoutHash;
+
+    VertexLayout m_layout;
 
 };
 
@@ -94,9 +94,11 @@ void CommandBufferVk::drawMesh(Mesh *mesh, uint32_t sub, uint32_t layer, Materia
     if(mesh) {
         MeshVk *meshVk = static_cast<MeshVk *>(mesh);
 
+        // The mesh is bound first, the pipeline depends on its vertex layout
+        meshVk->bind(m_commandBuffer);
+
         MaterialInstanceVk &instanceVk = static_cast<MaterialInstanceVk &>(instance);
-        if(instanceVk.bind(*this, layer, static_cast<RenderTargetVk *>(m_target)->globalDescriptorSet(m_currentFrame), m_currentFrame)) {
-            meshVk->bind(m_commandBuffer);
+        if(instanceVk.bind(*this, *meshVk, layer, static_cast<RenderTargetVk *>(m_target)->globalDescriptorSet(m_currentFrame), m_currentFrame)) {
 
             if(meshVk->indices().empty()) {
                 uint32_t vert = meshVk->vertices().size();
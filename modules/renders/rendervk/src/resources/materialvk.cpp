@@ -4,6 +4,7 @@
 
 #include "resources/texturevk.h"
 #include "resources/rendertargetvk.h"
+#include "resources/meshvk.h"
 
 #include "commandbuffervk.h"
 #include "wrappervk.h"
@@ -71,7 +72,7 @@ void MaterialVk::switchState(State state) {
     }
 }
 
-VkPipeline MaterialVk::getPipeline(uint16_t vertex, uint32_t layer, RenderTargetVk *target) {
+VkPipeline MaterialVk::getPipeline(uint16_t vertex, uint32_t layer, RenderTargetVk *target, const MeshVk &mesh) {
     switch(state()) {
         case ToBeUpdated: {
             for(uint16_t v = VertexStatic; v < VertexLast; v++) {
@@ -96,12 +97,13 @@ VkPipeline MaterialVk::getPipeline(uint16_t vertex, uint32_t layer, RenderTarget
     uint32_t index = target->uuid();
     Mathf::hashCombine(index, vertex);
     Mathf::hashCombine(index, layer);
+    Mathf::hashCombine(index, mesh.m_layoutHash);
 
     auto it = m_pipelines.find(index);
     if(it != m_pipelines.end()) {
         return it->second;
     } else {
-        VkPipeline pipeline = buildPipeline(vertex, layer, target);
+        VkPipeline pipeline = buildPipeline(vertex, layer, target, mesh);
         if(pipeline) {
             m_pipelines[index] = pipeline;
             return pipeline;
@@ -148,8 +150,8 @@ VkDescriptorSetLayout MaterialVk::localDescriptorSetLayout() const {
     return m_localDescSetLayout;
 }
 
-bool MaterialVk::bind(VkCommandBuffer buffer, RenderTargetVk *target, uint32_t layer, uint16_t vertex) {
-    VkPipeline pipeline = getPipeline(vertex, layer, target);
+bool MaterialVk::bind(VkCommandBuffer buffer, RenderTargetVk *target, const MeshVk &mesh, uint32_t layer, uint16_t vertex) {
+    VkPipeline pipeline = getPipeline(vertex, layer, target, mesh);
     if(pipeline) {
         vkCmdBindPipeline(buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 
@@ -198,7 +200,7 @@ void MaterialVk::buildPipelineLayout() {
     }
 }
 
-VkPipeline MaterialVk::buildPipeline(uint32_t vertex, uint32_t layer, RenderTargetVk *target) {
+VkPipeline MaterialVk::buildPipeline(uint32_t vertex, uint32_t layer, RenderTargetVk *target, const MeshVk &mesh) {
     uint16_t fragment = FragmentDefault;
     if((layer & Material::Visibility) || (layer & Material::Shadowcast)) {
         fragment = FragmentVisibility;
@@ -220,6 +222,8 @@ VkPipeline MaterialVk::buildPipeline(uint32_t vertex, uint32_t layer, RenderTarg
     vertexAttributes.resize(attributes.size());
 
     for(uint32_t i = 0; i < attributes.size(); i++) {
+        uint32_t location = static_cast<uint32_t>(attributes[i].location);
+
         VkFormat format = VK_FORMAT_UNDEFINED;
         uint32_t size = 0;
         switch(attributes[i].format) {
@@ -229,8 +233,26 @@ VkPipeline MaterialVk::buildPipeline(uint32_t vertex, uint32_t layer, RenderTarg
             default: break;
         }
 
-        vertexInputBindings[i] = {i, size, VK_VERTEX_INPUT_RATE_VERTEX};
-        vertexAttributes[i] = {static_cast<uint32_t>(attributes[i].location), i, format, 0};
+        // The mesh defines the actual format of the attribute, the GPU converts it to the shader input type
+        for(auto &it : mesh.m_layout) {
+            if(it.location == location) {
+                switch(it.format) {
+                    case Mesh::Float2: format = VK_FORMAT_R32G32_SFLOAT; break;
+                    case Mesh::Float3: format = VK_FORMAT_R32G32B32_SFLOAT; break;
+                    case Mesh::Float4: format = VK_FORMAT_R32G32B32A32_SFLOAT; break;
+                    case Mesh::Half2: format = VK_FORMAT_R16G16_SFLOAT; break;
+                    case Mesh::Half4: format = VK_FORMAT_R16G16B16A16_SFLOAT; break;
+                    case Mesh::Unorm8x4: format = VK_FORMAT_R8G8B8A8_UNORM; break;
+                    case Mesh::Snorm10x3: format = VK_FORMAT_A2B10G10R10_SNORM_PACK32; break;
+                    default: break;
+                }
+                size = it.stride;
+                break;
+            }
+        }
+
+        vertexInputBindings[i] = {location, size, VK_VERTEX_INPUT_RATE_VERTEX};
+        vertexAttributes[i] = {location, location, format, 0};
     }
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo = {};
@@ -471,12 +493,12 @@ void MaterialInstanceVk::destroyDescriptors() {
     }
 }
 
-bool MaterialInstanceVk::bind(CommandBufferVk &buffer, uint32_t layer, VkDescriptorSet globalDescriptorSet, uint32_t currentFrame) {
+bool MaterialInstanceVk::bind(CommandBufferVk &buffer, const MeshVk &mesh, uint32_t layer, VkDescriptorSet globalDescriptorSet, uint32_t currentFrame) {
     MaterialVk *materialVk = static_cast<MaterialVk *>(m_material);
 
     VkCommandBuffer cmd = buffer.nativeBuffer();
 
-    if(materialVk->bind(cmd, static_cast<RenderTargetVk *>(buffer.renderTarget()), layer, surfaceType())) {
+    if(materialVk->bind(cmd, static_cast<RenderTargetVk *>(buffer.renderTarget()), mesh, layer, surfaceType())) {
         size_t swapChainCount = WrapperVk::framesInFlight();
         if(m_descriptorPool == VK_NULL_HANDLE) {
             std::vector<VkDescriptorPoolSize> poolSize;
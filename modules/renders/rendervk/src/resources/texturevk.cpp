@@ -186,18 +186,21 @@ void TextureVk::updateTexture() {
 
             VkCommandBuffer commandBuffer = WrapperVk::beginSingleTimeCommands();
 
+            // Streamed textures start from the highest resident level
+            uint32_t base = residentMip();
+
             VkDeviceSize offset = 0;
             for(uint32_t mip = 0; mip < src.size(); mip++) {
-                uint32_t w = mipLevel(m_width, mip);
-                uint32_t h = mipLevel(m_height, mip);
-                uint32_t d = mipLevel(m_depth, mip);
+                uint32_t w = mipLevel(m_width, mip + base);
+                uint32_t h = mipLevel(m_height, mip + base);
+                uint32_t d = mipLevel(m_depth, mip + base);
 
                 VkDeviceSize mipSize = src[mip].size();
 
                 VkBufferImageCopy region = {};
                 region.bufferOffset = offset;
                 region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-                region.imageSubresource.mipLevel = mip;
+                region.imageSubresource.mipLevel = mip + base;
                 region.imageSubresource.baseArrayLayer = side;
                 region.imageSubresource.layerCount = 1;
                 region.imageOffset = { 0, 0, 0 };
@@ -324,8 +327,9 @@ void TextureVk::createImageView(VkDevice device, VkFormat format) {
     }
     viewInfo.format = format;
     viewInfo.subresourceRange.aspectMask = (TextureVk::format() == Depth) ? VK_IMAGE_ASPECT_DEPTH_BIT : VK_IMAGE_ASPECT_COLOR_BIT;
-    viewInfo.subresourceRange.baseMipLevel = 0;
-    viewInfo.subresourceRange.levelCount = mipCount();
+    // Levels which are not resident yet are excluded from sampling
+    viewInfo.subresourceRange.baseMipLevel = residentMip();
+    viewInfo.subresourceRange.levelCount = mipCount() - residentMip();
     viewInfo.subresourceRange.baseArrayLayer = 0;
     viewInfo.subresourceRange.layerCount = MAX(m_sides.size(), 1);
 
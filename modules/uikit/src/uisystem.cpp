@@ -79,6 +79,9 @@ UiSystem::UiSystem() :
 
     UiLoader::registerClassFactory(this);
 
+    declareWrite("Transform");
+    declareWrite("Widget");
+
     setName("UiSystem");
 }
 
@@ -87,6 +87,9 @@ AngelSystem::AngelSystem(Engine *engine) :
 
     resourceSystem->subscribe(bundleUpdated, this);
 
+    declareWrite("Transform");
+    declareWrite("AngelBehaviour");
+
     setName("AngelScript");
 
     m_generic = strstr(asGetLibraryOptions(), "AS_MAX_PORTABILITY");
@@ -1,6 +1,7 @@
 #include "tst_next.h"
 #include "tst_engine.h"
 #include "tst_uikit.h"
+#include "tst_rendernull.h"
 
 int main(int argc, char *argv[]) {
     ::testing::InitGoogleTest(&argc, argv);
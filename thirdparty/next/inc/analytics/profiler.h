@@ -19,41 +19,73 @@
 #ifndef PROFILER
 #define PROFILER
 
-#ifdef PROFILING_ENABLED
+#include <stdint.h>
 
-#include <thread>
-#include <unordered_map>
+#include <vector>
 
-#include "engine.h"
-#include "timer.h"
+#include <global.h>
+
+class TString;
 
 class NEXT_LIBRARY_EXPORT Profiler {
 public:
-    struct CallPoint {
+    enum EventType {
+        Begin = 1,
+        End,
+        Frame
+    };
+
+    struct Event {
         const char *name;
 
-        TimePoint started;
+        uint64_t time;
+
+        uint32_t thread;
+
+        uint16_t type;
 
-        TimePoint stoped;
+        uint16_t depth;
     };
 
+    typedef std::vector<Event> EventList;
+
 public:
-    Profiler(const char *name);
+    explicit Profiler(const char *name);
 
     ~Profiler();
 
+    static void start();
+
+    static void stop();
+
+    static bool isCapturing();
+
+    static void frameMark();
+
+    static void flush();
+
+    static void clear();
+
+    static EventList events();
+
+    static uint32_t dropped();
+
+    static TString chromeTrace();
+
     static uint32_t stat(const char *name);
 
     static void statAdd(const char *name, uint32_t value);
 
     static void statReset(const char *name);
 
-protected:
-    Profiler::CallPoint  m_current;
+private:
+    Profiler(const Profiler &) = delete;
+    Profiler &operator=(const Profiler &) = delete;
 
-};
+    const char *m_name;
 
-#endif
+    bool m_recorded;
 
-#endif // PROFILER
+};
 
+#endif // PROFILER
@@ -54,6 +54,11 @@ public:
     Vector4 valueVector4(float pos) const;
     Quaternion valueQuaternion(float pos) const;
 
+    void compile();
+    void invalidate();
+
+    bool isCompiled() const;
+
     Keys m_keys;
 
 protected:
@@ -61,6 +66,17 @@ protected:
 
     void frames(int32_t &b, int32_t &e, float pos) const;
 
+    void framesCompiled(int32_t &b, int32_t &e, float pos) const;
+
+    void valueCompiled(int32_t a, int32_t b, float f, float *result) const;
+
+protected:
+    std::vector<float> m_times;
+
+    std::vector<float> m_data;
+
+    std::vector<uint8_t> m_types;
+
 };
 
 #endif // ANIMATIONCURVE_H
@@ -21,6 +21,7 @@
 
 #include <list>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
@@ -40,6 +41,7 @@ public:
     TString(const ByteArray &array);
     TString(const std::string &str);
     TString(const char *str);
+    explicit TString(std::string_view str);
     TString(int n, const char ch);
 
     bool operator== (const TString &other) const;
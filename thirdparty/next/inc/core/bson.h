@@ -19,13 +19,121 @@
 #ifndef BSON_H
 #define BSON_H
 
+#include <string_view>
+
 #include <variant.h>
 
 class NEXT_LIBRARY_EXPORT Bson {
+public:
+    enum DataType {
+        END        = 0,
+        FLOAT,
+        STRING,
+        OBJECT,
+        ARRAY,
+        BINARY,
+        BOOL       = 8,
+        INT32      = 16,
+        VECTOR2    = 128,
+        VECTOR3,
+        VECTOR4,
+        MATRIX3,
+        MATRIX4,
+        QUATERNION
+    };
+
 public:
     static Variant load(const ByteArray &data, MetaType::Type type = MetaType::VARIANTLIST);
+    static Variant load(const uint8_t *data, size_t size, MetaType::Type type = MetaType::VARIANTLIST);
     static ByteArray save(const Variant &data);
 };
 
+class NEXT_LIBRARY_EXPORT BsonReader {
+public:
+    BsonReader();
+    BsonReader(const uint8_t *data, size_t size);
+    explicit BsonReader(const ByteArray &data);
+
+    bool isValid() const;
+
+    bool next();
+
+    uint8_t type() const;
+
+    std::string_view name() const;
+
+    bool toBool() const;
+    int32_t toInt() const;
+    float toFloat() const;
+
+    std::string_view toString() const;
+
+    const uint8_t *toBinary(size_t &size) const;
+
+    BsonReader toDocument() const;
+
+    Variant toVariant() const;
+
+    Variant document(MetaType::Type type) const;
+
+private:
+    const uint8_t *m_data;
+
+    uint32_t m_size;
+
+    uint32_t m_value;
+
+    uint32_t m_next;
+
+    uint32_t m_nameLength;
+
+    uint8_t m_type;
+
+    bool m_valid;
+
+};
+
+class NEXT_LIBRARY_EXPORT BsonWriter {
+public:
+    explicit BsonWriter(ByteArray &buffer);
+
+    void beginObject(std::string_view name = std::string_view());
+    void beginArray(std::string_view name = std::string_view());
+    void end();
+
+    void writeBool(std::string_view name, bool value);
+    void writeInt(std::string_view name, int32_t value);
+    void writeFloat(std::string_view name, float value);
+    void writeString(std::string_view name, std::string_view value);
+    void writeBinary(std::string_view name, const uint8_t *data, size_t size);
+
+    void write(std::string_view name, const Variant &value);
+
+    static size_t size(const Variant &value);
+
+private:
+    BsonWriter(const BsonWriter &) = delete;
+    BsonWriter &operator=(const BsonWriter &) = delete;
+
+    void begin(uint8_t type, std::string_view name);
+
+    void header(uint8_t type, std::string_view name);
+
+    void append(const void *data, size_t size);
+
+    struct Level {
+        size_t offset;
+
+        uint32_t index;
+
+        bool array;
+    };
+
+    ByteArray &m_buffer;
+
+    std::vector<Level> m_levels;
+
+};
+
 #endif // BSON_H
 
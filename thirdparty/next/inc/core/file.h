@@ -71,6 +71,10 @@ public:
 
     static bool isDir(const TString &path);
 
+    static void *map(const TString &file, size_t &size);
+
+    static void unmap(void *data, size_t size);
+
 protected:
     friend class FileHandler;
 
@@ -118,6 +122,15 @@ public:
 
     virtual size_t tell(int *handle) = 0;
 
+    virtual void *map(const char *path, size_t &size);
+
+    virtual void unmap(void *data, size_t size);
+
+protected:
+    static void *mapFile(const char *path, size_t &size);
+
+    static void unmapFile(void *data, size_t size);
+
 };
 
 #endif // FILE_H
@@ -0,0 +1,87 @@
+/*
+    This file is part of Thunder Next.
+
+    Copyright 2008-2026 Evgeniy Prikazchikov
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#ifndef JOBSYSTEM_H
+#define JOBSYSTEM_H
+
+#include <stdint.h>
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include <global.h>
+
+class JobSystemPrivate;
+struct JobData;
+
+class NEXT_LIBRARY_EXPORT JobCounter {
+public:
+    JobCounter();
+
+    ~JobCounter();
+
+    bool isDone() const;
+
+    uint32_t value() const;
+
+private:
+    JobCounter(const JobCounter &) = delete;
+    JobCounter &operator=(const JobCounter &) = delete;
+
+    friend class JobSystem;
+    friend class JobSystemPrivate;
+
+    std::atomic<uint32_t> m_value;
+
+    std::atomic_flag m_lock;
+
+    std::vector<JobData *> m_dependents;
+
+};
+
+class NEXT_LIBRARY_EXPORT JobSystem {
+public:
+    typedef std::function<void()> Job;
+    typedef std::function<void(uint32_t, uint32_t)> RangeJob;
+
+public:
+    explicit JobSystem(uint32_t threads = 0);
+
+    ~JobSystem();
+
+    uint32_t threadCount() const;
+
+    void dispatch(const Job &job, JobCounter *counter = nullptr, JobCounter *dependency = nullptr);
+
+    void parallelFor(uint32_t count, uint32_t grain, const RangeJob &job, JobCounter *counter = nullptr, JobCounter *dependency = nullptr);
+
+    void wait(JobCounter *counter);
+
+    void waitForDone();
+
+    bool tryExecute();
+
+    static int32_t currentThreadIndex();
+
+private:
+    JobSystemPrivate *p_ptr;
+
+};
+
+#endif // JOBSYSTEM_H
@@ -20,6 +20,7 @@
 #define JSON_H
 
 #include <cstdint>
+#include <string_view>
 
 #include <variant.h>
 
@@ -29,4 +30,55 @@ public:
     static TString save(const Variant &data, int32_t tab = -1);
 };
 
+class NEXT_LIBRARY_EXPORT JsonReader {
+public:
+    enum Token {
+        Invalid = 0,
+        End,
+        ObjectBegin,
+        ObjectEnd,
+        ArrayBegin,
+        ArrayEnd,
+        Name,
+        String,
+        Number,
+        Boolean,
+        Null
+    };
+
+public:
+    JsonReader(const char *data, size_t size);
+    explicit JsonReader(const TString &data);
+
+    Token next();
+
+    Token token() const;
+
+    std::string_view text() const;
+
+    bool isFloat() const;
+
+    bool toBool() const;
+    int32_t toInt() const;
+    float toFloat() const;
+
+private:
+    const char *m_data;
+
+    size_t m_size;
+
+    size_t m_position;
+
+    std::string_view m_text;
+
+    std::vector<bool> m_scopes;
+
+    Token m_token;
+
+    bool m_float;
+
+    bool m_expectName;
+
+};
+
 #endif // JSON_H
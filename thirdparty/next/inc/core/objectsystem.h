@@ -20,6 +20,7 @@
 #define OBJECTSYSTEM_H
 
 #include <unordered_map>
+#include <functional>
 #include <thread>
 
 #include <astring.h>
@@ -27,6 +28,7 @@
 
 class MetaObject;
 class Invalid;
+class BsonReader;
 
 class NEXT_LIBRARY_EXPORT ObjectSystem : public Object {
 public:
@@ -73,6 +75,7 @@ public:
 
     static Variant toVariant(const Object *object, bool force = false);
     static Object *toObject(const Variant &variant, Object *parent = nullptr, const TString &name = TString());
+    static Object *toObject(const BsonReader &reader, Object *parent = nullptr, const TString &name = TString());
 
     static uint32_t generateUUID();
 
@@ -104,6 +107,11 @@ protected:
 
     virtual void removeObject(Object *object);
 
+private:
+    static Object *findCachedObject(uint32_t uuid, const ObjectMap &cache);
+
+    static Object *restoreObject(const TString &type, uint32_t uuid, uint32_t parentUuid, const TString &name, Object *parent, ObjectMap &cache, const std::function<VariantList ()> &data);
+
 private:
     friend class ObjectSystemTest;
     friend class Object;
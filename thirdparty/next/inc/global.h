@@ -19,23 +19,29 @@
         #define PROFILE_FUNCTION(...) EASY_FUNCTION(__VA_ARGS__)
         #define PROFILE_START EASY_PROFILER_ENABLE
         #define PROFILE_STOP profiler::dumpBlocksToFile("profile.prof")
+        #define PROFILE_FRAME()
         #define PROFILER_STAT(x, y)
         #define PROFILER_RESET(label)
     #else
         #include <analytics/profiler.h>
 
-        #define PROFILE_BLOCK(name, ...)
-        #define PROFILE_FUNCTION(...) Profiler MARK(__FUNCTION__);
-        #define PROFILE_START
-        #define PROFILE_STOP
-        #define PROFILER_STAT(x, y)
-        #define PROFILER_RESET(label)
+        #define PROFILE_CONCAT_IMPL(a, b) a##b
+        #define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+        #define PROFILE_BLOCK(name, ...) Profiler PROFILE_CONCAT(_profilerBlock, __LINE__)(name)
+        #define PROFILE_FUNCTION(...) Profiler _profilerFunction(__FUNCTION__)
+        #define PROFILE_START Profiler::start()
+        #define PROFILE_STOP Profiler::stop()
+        #define PROFILE_FRAME() Profiler::frameMark()
+        #define PROFILER_STAT(label, y) Profiler::statAdd(#label, y)
+        #define PROFILER_RESET(label) Profiler::statReset(#label)
     #endif
 #else
     #define PROFILE_BLOCK(name, ...)
     #define PROFILE_FUNCTION(...)
     #define PROFILE_START
     #define PROFILE_STOP
+    #define PROFILE_FRAME()
     #define PROFILER_STAT(label, y)
     #define PROFILER_RESET(label)
 #endif
@@ -19,6 +19,8 @@
 #ifndef FRUSTUM_H
 #define FRUSTUM_H
 
+#include <stdint.h>
+
 #include "plane.h"
 
 class AABBox;
@@ -31,6 +33,8 @@ public:
     bool contains(const AABBox &bb) const;
     bool contains(const OBBox &bb) const;
 
+    void containsSpheres(const float *x, const float *y, const float *z, const float *radius, uint32_t count, uint8_t *result) const;
+
     bool isOnOrForwardPlane(const Plane &plane, const AABBox &bb) const;
     bool isOnOrForwardPlane(const Plane &plane, const OBBox &bb) const;
 
@@ -18,35 +18,364 @@
 
 #include "analytics/profiler.h"
 
-#ifdef PROFILING_ENABLED
+#include "astring.h"
 
-typedef list<Profiler::CallPoint>             CallsList;
-typedef unordered_map<thread::id, CallsList>  ThreadMap;
-typedef unordered_map<const char *, uint32_t> StatsMap;
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
 
-static ThreadMap m_threads;
-static StatsMap  m_stats;
+namespace {
+    const uint32_t gCapacity(1 << 14);
+    const uint32_t gStatsSize(128);
+}
+
+struct ThreadBuffer {
+    explicit ThreadBuffer(uint32_t id) :
+            events(gCapacity),
+            head(0),
+            tail(0),
+            owned(true),
+            id(id),
+            open(0),
+            depth(0),
+            next(nullptr) {
+
+    }
+
+    std::vector<Profiler::Event> events;
+
+    std::atomic<uint64_t> head;
+
+    std::atomic<uint64_t> tail;
+
+    std::atomic<bool> owned;
+
+    // Owner thread only
+    uint32_t id;
+
+    uint32_t open;
+
+    uint32_t depth;
+
+    ThreadBuffer *next;
+
+    // Consumer only
+    Profiler::EventList captured;
+};
+
+struct ThreadHolder {
+    ~ThreadHolder() {
+        if(buffer) {
+            buffer->owned.store(false, std::memory_order_release);
+        }
+    }
+
+    ThreadBuffer *buffer = nullptr;
+};
+
+struct StatItem {
+    std::atomic<const char *> name;
+
+    std::atomic<uint32_t> value;
+};
+
+static std::atomic<ThreadBuffer *> s_buffers(nullptr);
+static std::atomic<uint32_t> s_threads(0);
+static std::atomic<uint32_t> s_dropped(0);
+static std::atomic<int64_t> s_origin(0);
+static std::atomic<bool> s_capturing(false);
+static std::atomic_flag s_consumer = ATOMIC_FLAG_INIT;
+
+static StatItem s_stats[gStatsSize];
+
+static thread_local ThreadHolder t_holder;
+
+inline int64_t clockTime() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static ThreadBuffer *threadBuffer() {
+    ThreadBuffer *result = t_holder.buffer;
+    if(result == nullptr) {
+        // Reuse a drained buffer of the finished thread
+        for(ThreadBuffer *it = s_buffers.load(std::memory_order_acquire); it != nullptr; it = it->next) {
+            bool expected = false;
+            if(it->head.load(std::memory_order_acquire) == it->tail.load(std::memory_order_acquire) &&
+               it->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel)) {
+                result = it;
+                result->id = s_threads++;
+                result->open = 0;
+                result->depth = 0;
+                break;
+            }
+        }
+
+        if(result == nullptr) {
+            result = new ThreadBuffer(s_threads++);
+
+            ThreadBuffer *head = s_buffers.load(std::memory_order_relaxed);
+            do {
+                result->next = head;
+            } while(!s_buffers.compare_exchange_weak(head, result, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        t_holder.buffer = result;
+    }
+    return result;
+}
+
+static bool push(ThreadBuffer *buffer, const char *name, uint16_t type, uint32_t reserve) {
+    uint64_t head = buffer->head.load(std::memory_order_relaxed);
+    uint64_t tail = buffer->tail.load(std::memory_order_acquire);
+    if(head - tail + 1 + reserve > gCapacity) {
+        s_dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    Profiler::Event &event = buffer->events[head & (gCapacity - 1)];
+    event.name = name;
+    event.time = clockTime() - s_origin.load(std::memory_order_relaxed);
+    event.thread = buffer->id;
+    event.type = type;
+    event.depth = buffer->depth;
+
+    buffer->head.store(head + 1, std::memory_order_release);
+
+    return true;
+}
+
+static void lockConsumer() {
+    while(s_consumer.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+static void drain() {
+    for(ThreadBuffer *it = s_buffers.load(std::memory_order_acquire); it != nullptr; it = it->next) {
+        uint64_t tail = it->tail.load(std::memory_order_relaxed);
+        uint64_t head = it->head.load(std::memory_order_acquire);
+        for(; tail < head; tail++) {
+            it->captured.push_back(it->events[tail & (gCapacity - 1)]);
+        }
+        it->tail.store(tail, std::memory_order_release);
+    }
+}
+
+static StatItem *statItem(const char *name, bool create) {
+    uint32_t hash = 2166136261U;
+    for(const char *c = name; *c; c++) {
+        hash = (hash ^ static_cast<uint8_t>(*c)) * 16777619U;
+    }
+
+    for(uint32_t i = 0; i < gStatsSize; i++) {
+        StatItem &item = s_stats[(hash + i) & (gStatsSize - 1)];
+
+        const char *current = item.name.load(std::memory_order_acquire);
+        if(current == nullptr) {
+            if(!create) {
+                return nullptr;
+            }
+            if(item.name.compare_exchange_strong(current, name, std::memory_order_acq_rel)) {
+                return &item;
+            }
+        }
+
+        if(current == name || strcmp(current, name) == 0) {
+            return &item;
+        }
+    }
+
+    return nullptr;
+}
+
+/*!
+    \class Profiler
+    \brief The Profiler class collects a timeline of nested scopes for all threads.
+    \inmodule Core
+
+    Each Profiler object marks a scope: the constructor records a begin event and the destructor records an end event.
+    Usually it's created with PROFILE_FUNCTION() and PROFILE_BLOCK() macros.
+
+    Every thread writes events to its own fixed-size ring buffer without any locks, so the profiler can be used from worker threads without distorting timings.
+    The ring buffers are drained with flush(), which is called by frameMark() at the end of each frame.
+    In case of a ring buffer overflow new scopes are skipped and counted as dropped(); end events of already recorded scopes are never lost.
 
-Profiler::Profiler(const char *name) {
-    m_current.name = name;
-    m_current.started = std::chrono::high_resolution_clock::now();
+    Events are recorded only between start() and stop() calls. Collected events can be exported with chromeTrace() to the Chrome trace format supported by chrome://tracing, Perfetto and Tracy importer.
+
+    Besides of the timeline, the profiler keeps named counters which can be changed with statAdd() and statReset() from any thread.
+*/
+
+/*!
+    Begins a new scope with \a name.
+    The \a name must stay valid for the whole capture, usually it's a string literal.
+*/
+Profiler::Profiler(const char *name) :
+        m_name(name),
+        m_recorded(false) {
+
+    if(s_capturing.load(std::memory_order_relaxed)) {
+        ThreadBuffer *buffer = threadBuffer();
+        // Keep a room for end events of all open scopes
+        if(push(buffer, name, Begin, buffer->open + 1)) {
+            buffer->open++;
+            buffer->depth++;
+            m_recorded = true;
+        }
+    }
 }
 
 Profiler::~Profiler() {
-    m_current.stoped = std::chrono::high_resolution_clock::now();
-    m_threads[this_thread::get_id()].push_back(m_current);
+    if(m_recorded) {
+        ThreadBuffer *buffer = t_holder.buffer;
+        buffer->depth--;
+        push(buffer, m_name, End, 0);
+        buffer->open--;
+    }
 }
+/*!
+    Starts a new capture; all previously collected events are removed.
+*/
+void Profiler::start() {
+    clear();
 
-uint32_t Profiler::stat(const char *name) {
-    return m_stats[name];
+    s_origin.store(clockTime(), std::memory_order_relaxed);
+    s_capturing.store(true, std::memory_order_release);
+}
+/*!
+    Stops the capture; scopes opened during the capture are still closed properly.
+*/
+void Profiler::stop() {
+    s_capturing.store(false, std::memory_order_release);
+}
+/*!
+    Returns true if the capture is in progress.
+*/
+bool Profiler::isCapturing() {
+    return s_capturing.load(std::memory_order_relaxed);
 }
+/*!
+    Records a frame boundary and flushes events of all threads.
+    Must be called once per frame, usually at the beginning of the main loop.
+*/
+void Profiler::frameMark() {
+    if(s_capturing.load(std::memory_order_relaxed)) {
+        ThreadBuffer *buffer = threadBuffer();
+        push(buffer, "Frame", Frame, buffer->open);
+    }
 
-void Profiler::statAdd(const char *name, uint32_t value) {
-    m_stats[name] += value;
+    flush();
 }
+/*!
+    Moves events from the ring buffers of all threads to the capture.
+    Does nothing if another thread is flushing at the moment.
+*/
+void Profiler::flush() {
+    if(s_consumer.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
 
-void Profiler::statReset(const char *name) {
-    m_stats[name] = 0;
+    drain();
+
+    s_consumer.clear(std::memory_order_release);
+}
+/*!
+    Removes all collected events and resets the dropped events counter.
+*/
+void Profiler::clear() {
+    lockConsumer();
+
+    drain();
+    for(ThreadBuffer *it = s_buffers.load(std::memory_order_acquire); it != nullptr; it = it->next) {
+        it->captured.clear();
+    }
+    s_dropped.store(0, std::memory_order_relaxed);
+
+    s_consumer.clear(std::memory_order_release);
+}
+/*!
+    Returns all collected events of all threads ordered by time.
+    Time of events is measured in nanoseconds from the start() call.
+*/
+Profiler::EventList Profiler::events() {
+    EventList result;
+
+    lockConsumer();
+
+    drain();
+    for(ThreadBuffer *it = s_buffers.load(std::memory_order_acquire); it != nullptr; it = it->next) {
+        result.insert(result.end(), it->captured.begin(), it->captured.end());
+    }
+
+    s_consumer.clear(std::memory_order_release);
+
+    std::stable_sort(result.begin(), result.end(), [](const Event &left, const Event &right) {
+        return left.time < right.time;
+    });
+
+    return result;
 }
+/*!
+    Returns the number of scopes which were skipped because of ring buffer overflow.
+*/
+uint32_t Profiler::dropped() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+/*!
+    Returns collected events in the Chrome trace JSON format.
+*/
+TString Profiler::chromeTrace() {
+    std::string result("{\"traceEvents\":[");
+
+    char buffer[64];
+    bool first = true;
+    for(auto &it : events()) {
+        if(!first) {
+            result += ',';
+        }
+        first = false;
+
+        result += "\n{\"name\":\"";
+        for(const char *c = it.name; c && *c; c++) {
+            if(*c == '"' || *c == '\\') {
+                result += '\\';
+            }
+            result += *c;
+        }
+
+        const char *phase = (it.type == Begin) ? "B" : (it.type == End) ? "E" : "i\",\"s\":\"g";
+        snprintf(buffer, sizeof(buffer), "\",\"ph\":\"%s\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", phase, double(it.time) / 1000.0, it.thread);
+        result += buffer;
+    }
 
-#endif
+    result += "\n],\"displayTimeUnit\":\"ns\"}\n";
+
+    return result;
+}
+/*!
+    Returns the value of the counter with \a name.
+*/
+uint32_t Profiler::stat(const char *name) {
+    StatItem *item = statItem(name, false);
+    return item ? item->value.load(std::memory_order_relaxed) : 0;
+}
+/*!
+    Adds \a value to the counter with \a name.
+*/
+void Profiler::statAdd(const char *name, uint32_t value) {
+    StatItem *item = statItem(name, true);
+    if(item) {
+        item->value.fetch_add(value, std::memory_order_relaxed);
+    }
+}
+/*!
+    Resets the counter with \a name to zero.
+*/
+void Profiler::statReset(const char *name) {
+    StatItem *item = statItem(name, false);
+    if(item) {
+        item->value.store(0, std::memory_order_relaxed);
+    }
+}
@@ -21,15 +21,87 @@
 #include <metatype.h>
 #include <float.h>
 
+#include <algorithm>
+#include <cstring>
+
+#include "math/simd.h"
+
+namespace {
+    // Compiled key layout: value, left tangent and right tangent, each padded to four components
+    const uint32_t gComponents(4);
+    const uint32_t gValue(0);
+    const uint32_t gLeft(gComponents);
+    const uint32_t gRight(gComponents * 2);
+    const uint32_t gStride(gComponents * 3);
+
+    inline void mix(const float *a, const float *b, float f, float *result) {
+#if defined(NEXT_SSE)
+        __m128 r = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(1.0f - f)), _mm_mul_ps(_mm_loadu_ps(b), _mm_set1_ps(f)));
+        _mm_storeu_ps(result, r);
+#elif defined(NEXT_NEON)
+        float32x4_t r = vaddq_f32(vmulq_n_f32(vld1q_f32(a), 1.0f - f), vmulq_n_f32(vld1q_f32(b), f));
+        vst1q_f32(result, r);
+#else
+        for(uint32_t i = 0; i < gComponents; i++) {
+            result[i] = MIX(a[i], b[i], f);
+        }
+#endif
+    }
+
+    inline void cubic(const float *a, const float *b, const float *c, const float *d, float f, float *result) {
+        float i = 1.0f - f;
+        float w0 = i * i * i;
+        float w1 = 3.0f * f * i * i;
+        float w2 = 3.0f * f * f * i;
+        float w3 = f * f * f;
+#if defined(NEXT_SSE)
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a), _mm_set1_ps(w0)), _mm_mul_ps(_mm_loadu_ps(b), _mm_set1_ps(w1))),
+                              _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(c), _mm_set1_ps(w2)), _mm_mul_ps(_mm_loadu_ps(d), _mm_set1_ps(w3))));
+        _mm_storeu_ps(result, r);
+#elif defined(NEXT_NEON)
+        float32x4_t r = vaddq_f32(vaddq_f32(vmulq_n_f32(vld1q_f32(a), w0), vmulq_n_f32(vld1q_f32(b), w1)),
+                                  vaddq_f32(vmulq_n_f32(vld1q_f32(c), w2), vmulq_n_f32(vld1q_f32(d), w3)));
+        vst1q_f32(result, r);
+#else
+        for(uint32_t k = 0; k < gComponents; k++) {
+            result[k] = a[k] * w0 + b[k] * w1 + c[k] * w2 + d[k] * w3;
+        }
+#endif
+    }
+}
+
+/*!
+    \class AnimationCurve
+    \brief The AnimationCurve class interpolates values between key frames.
+    \inmodule Animation
+
+    Key frames are stored in m_keys and must be sorted by position.
+    Every time the keys are modified the curve can be prepared for fast sampling with compile().
+    A compiled curve keeps positions, values and tangents of all keys in contiguous arrays, finds the keys with a binary search and interpolates all four components at once on SSE2 and NEON capable platforms.
+    Sampling of a curve which isn't compiled (or was invalidated) falls back to a linear search over m_keys.
+*/
+
 bool AnimationCurve::KeyFrame::operator ==(const KeyFrame &left) const {
     return abs(m_position - left.m_position) <= FLT_EPSILON  && (m_value == left.m_value);
 }
 
 float AnimationCurve::valueFloat(float pos) const {
+    if(isCompiled()) {
+        int32_t a, b;
+        framesCompiled(a, b, pos);
+        if(a != -1) {
+            float f = (a == b) ? 0.0f : (pos - m_times[a]) / (m_times[b] - m_times[a]);
+            float v[gComponents];
+            valueCompiled(a, b, f, v);
+            return v[0];
+        }
+        return m_data[gValue];
+    }
+
     int32_t a, b;
     frames(a, b, pos);
 
-    if(a != -1) {
+    if(a != -1 && b != -1) {
         float factor = (pos - m_keys[a].m_position) / (m_keys[b].m_position - m_keys[a].m_position);
 
         return value(a, b, 0, factor);
@@ -38,10 +110,22 @@ float AnimationCurve::valueFloat(float pos) const {
 }
 
 Vector2 AnimationCurve::valueVector2(float pos) const {
+    Vector2 result;
+    if(isCompiled()) {
+        int32_t a, b;
+        framesCompiled(a, b, pos);
+        if(a != -1) {
+            float f = (a == b) ? 0.0f : (pos - m_times[a]) / (m_times[b] - m_times[a]);
+            float v[gComponents];
+            valueCompiled(a, b, f, v);
+            result = Vector2(v[0], v[1]);
+        }
+        return result;
+    }
+
     int32_t a, b;
     frames(a, b, pos);
 
-    Vector2 result;
     if(a != -1) {
         float factor = (pos - m_keys[a].m_position) / (m_keys[b].m_position - m_keys[a].m_position);
         for(int i = 0; i < 2; i++) {
@@ -52,10 +136,22 @@ Vector2 AnimationCurve::valueVector2(float pos) const {
 }
 
 Vector3 AnimationCurve::valueVector3(float pos) const {
+    Vector3 result;
+    if(isCompiled()) {
+        int32_t a, b;
+        framesCompiled(a, b, pos);
+        if(a != -1) {
+            float f = (a == b) ? 0.0f : (pos - m_times[a]) / (m_times[b] - m_times[a]);
+            float v[gComponents];
+            valueCompiled(a, b, f, v);
+            result = Vector3(v[0], v[1], v[2]);
+        }
+        return result;
+    }
+
     int32_t a, b;
     frames(a, b, pos);
 
-    Vector3 result;
     if(a != -1) {
         float factor = (pos - m_keys[a].m_position) / (m_keys[b].m_position - m_keys[a].m_position);
         for(int i = 0; i < 3; i++) {
@@ -66,10 +162,22 @@ Vector3 AnimationCurve::valueVector3(float pos) const {
 }
 
 Vector4 AnimationCurve::valueVector4(float pos) const {
+    Vector4 result;
+    if(isCompiled()) {
+        int32_t a, b;
+        framesCompiled(a, b, pos);
+        if(a != -1) {
+            float f = (a == b) ? 0.0f : (pos - m_times[a]) / (m_times[b] - m_times[a]);
+            float v[gComponents];
+            valueCompiled(a, b, f, v);
+            result = Vector4(v[0], v[1], v[2], v[3]);
+        }
+        return result;
+    }
+
     int32_t a, b;
     frames(a, b, pos);
 
-    Vector4 result;
     if(a != -1 && b != -1) {
         float factor = (pos - m_keys[a].m_position) / (m_keys[b].m_position - m_keys[a].m_position);
         for(int i = 0; i < 4; i++) {
@@ -80,10 +188,28 @@ Vector4 AnimationCurve::valueVector4(float pos) const {
 }
 
 Quaternion AnimationCurve::valueQuaternion(float pos) const {
+    Quaternion result;
+    if(isCompiled()) {
+        int32_t a, b;
+        framesCompiled(a, b, pos);
+        if(a != -1) {
+            const float *vA = &m_data[a * gStride + gValue];
+            Quaternion qA(vA[0], vA[1], vA[2], vA[3]);
+            if(a == b) {
+                return qA;
+            }
+
+            const float *vB = &m_data[b * gStride + gValue];
+            Quaternion qB(vB[0], vB[1], vB[2], vB[3]);
+
+            result.mix(qA, qB, (pos - m_times[a]) / (m_times[b] - m_times[a]));
+        }
+        return result;
+    }
+
     int32_t a, b;
     frames(a, b, pos);
 
-    Quaternion result;
     if(a != -1 && b != -1) {
         const KeyFrame &keyA = m_keys[a];
         Quaternion qA(keyA.m_value[0], keyA.m_value[1], keyA.m_value[2], keyA.m_value[3]);
@@ -139,3 +265,91 @@ void AnimationCurve::frames(int32_t &b, int32_t &e, float pos) const {
         }
     }
 }
+/*!
+    Prepares the curve for fast sampling: copies positions, types, values and tangents of all keys into contiguous arrays.
+    Must be called again after any modification of m_keys; otherwise sampling results won't reflect the changes.
+    The curve stays uncompiled if keys aren't sorted by position or have different or more than four components.
+*/
+void AnimationCurve::compile() {
+    invalidate();
+
+    if(m_keys.size() < 2) {
+        return;
+    }
+
+    size_t components = m_keys.front().m_value.size();
+    if(components == 0 || components > gComponents) {
+        return;
+    }
+
+    for(size_t i = 0; i < m_keys.size(); i++) {
+        const KeyFrame &key = m_keys[i];
+        if(key.m_value.size() != components || (i > 0 && key.m_position < m_keys[i - 1].m_position)) {
+            return;
+        }
+    }
+
+    m_times.resize(m_keys.size());
+    m_types.resize(m_keys.size());
+    m_data.assign(m_keys.size() * gStride, 0.0f);
+
+    for(size_t i = 0; i < m_keys.size(); i++) {
+        const KeyFrame &key = m_keys[i];
+
+        m_times[i] = key.m_position;
+        m_types[i] = key.m_type;
+
+        float *data = &m_data[i * gStride];
+        memcpy(data + gValue, key.m_value.data(), components * sizeof(float));
+        memcpy(data + gLeft, key.m_leftTangent.data(), std::min(components, key.m_leftTangent.size()) * sizeof(float));
+        memcpy(data + gRight, key.m_rightTangent.data(), std::min(components, key.m_rightTangent.size()) * sizeof(float));
+    }
+}
+/*!
+    Drops compiled data, so the curve will be sampled directly from m_keys until the next compile() call.
+*/
+void AnimationCurve::invalidate() {
+    m_times.clear();
+    m_types.clear();
+    m_data.clear();
+}
+/*!
+    Returns true if the curve has been compiled with compile() and the number of keys hasn't changed since.
+*/
+bool AnimationCurve::isCompiled() const {
+    return !m_times.empty() && m_times.size() == m_keys.size();
+}
+
+void AnimationCurve::framesCompiled(int32_t &b, int32_t &e, float pos) const {
+    b = e = -1;
+    if(pos < m_times.front() || pos > m_times.back()) {
+        return;
+    }
+
+    int32_t index = std::lower_bound(m_times.begin(), m_times.end(), pos) - m_times.begin();
+    if(m_times[index] == pos) {
+        b = e = index;
+    } else {
+        b = index - 1;
+        e = index;
+    }
+}
+
+void AnimationCurve::valueCompiled(int32_t a, int32_t b, float f, float *result) const {
+    const float *keyA = &m_data[a * gStride];
+    const float *keyB = &m_data[b * gStride];
+
+    if(a != b) {
+        switch(m_types[a]) {
+            case KeyFrame::Linear: mix(keyA + gValue, keyB + gValue, f, result); return;
+            case KeyFrame::Cubic: cubic(keyA + gValue, keyA + gRight, keyB + gLeft, keyB + gValue, f, result); return;
+            default: break;
+        }
+
+        if(f >= 0.99f) {
+            keyA = keyB;
+        }
+    }
+
+    memcpy(result, keyA + gValue, gComponents * sizeof(float));
+}
@@ -36,6 +36,13 @@ TString::TString(const std::string &str) :
 TString::TString(const char *str) :
         m_data(str) {
 
+}
+/*!
+    Constructs a string from a standard string view \a str.
+*/
+TString::TString(std::string_view str) :
+        m_data(str) {
+
 }
 /*!
     Constructs a string of the given \a n size with every character set to \a ch.
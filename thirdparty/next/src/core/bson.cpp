@@ -18,213 +18,54 @@
 
 #include "bson.h"
 
+#include <charconv>
 #include <cstring>
 
-void appendProperty(Variant &container, const Variant &data, const std::string &name) {
-    switch(container.type()) {
-        case MetaType::VARIANTLIST: {
-            if(container.data() == nullptr) {
-                container = VariantList();
-            }
-            VariantList &list = *(reinterpret_cast<VariantList *>(container.data()));
-            list.push_back(data);
-        } break;
-        case MetaType::VARIANTMAP: {
-            if(container.data() == nullptr) {
-                container = VariantMap();
-            }
-            VariantMap &map = *(reinterpret_cast<VariantMap *>(container.data()));
-            map[name] = data;
-        } break;
-        default: break;
-    }
-}
-
-enum DataTypes {
-    FLOAT      = 1,
-    STRING,
-    OBJECT,
-    ARRAY,
-    BINARY,
-    BOOL       = 8,
-    INT32      = 16,
-    VECTOR2    = 128,
-    VECTOR3,
-    VECTOR4,
-    MATRIX3,
-    MATRIX4,
-    QUATERNION
-};
-
-Variant parse(const ByteArray &data, uint32_t &offset, MetaType::Type type, bool first) {
-    PROFILE_FUNCTION();
-    Variant result(type);
-    if(data.empty()) {
+namespace {
+    uint32_t digits(uint32_t value) {
+        uint32_t result = 1;
+        while(value >= 10) {
+            value /= 10;
+            result++;
+        }
         return result;
     }
 
-    uint32_t global = offset;
-
-    uint32_t size;
-    memcpy(&size, &data[offset], sizeof(uint32_t));
-    if(offset + size > data.size()) {
-        return Variant();
-    }
-    offset  += sizeof(uint32_t);
-
-    while(offset < global + size) {
-        uint8_t t = data[offset];
-        offset++;
-
-        std::string name;
-        for(; offset < global + size; offset++) {
-            if(data[offset] == 0) {
-                offset++;
-                break;
-            }
-            name.push_back(data[offset]);
-        }
-
-        if(global == 225) {
-            global = 225;
+    uint8_t type(const Variant &data) {
+        uint8_t result;
+        switch(data.type()) {
+            case MetaType::BOOLEAN:     result  = Bson::BOOL; break;
+            case MetaType::FLOAT:       result  = Bson::FLOAT; break;
+            case MetaType::INTEGER:     result  = Bson::INT32; break;
+            case MetaType::STRING:      result  = Bson::STRING; break;
+            case MetaType::VARIANTMAP:  result  = Bson::OBJECT; break;
+            case MetaType::BYTEARRAY:   result  = Bson::BINARY; break;
+            case MetaType::VECTOR2:     result  = Bson::VECTOR2; break;
+            case MetaType::VECTOR3:     result  = Bson::VECTOR3; break;
+            case MetaType::VECTOR4:     result  = Bson::VECTOR4; break;
+            case MetaType::MATRIX3:     result  = Bson::MATRIX3; break;
+            case MetaType::MATRIX4:     result  = Bson::MATRIX4; break;
+            case MetaType::QUATERNION:  result  = Bson::QUATERNION; break;
+            default:                    result  = Bson::ARRAY; break;
         }
-
-        switch(t) {
-            case BOOL: {
-                uint8_t value = data[offset];
-                offset++;
-
-                appendProperty(result, (value) ? true : false, name);
-            } break;
-            case STRING: {
-                uint32_t length;
-                memcpy(&length, &data[offset], sizeof(uint32_t));
-                offset += sizeof(uint32_t);
-
-                char *value = new char[length];
-                memcpy(value, &data[offset], length);
-                offset += length;
-
-                appendProperty(result, value, name);
-                delete []value;
-            } break;
-            case OBJECT: {
-                int32_t length;
-                memcpy(&length, &data[offset], sizeof(uint32_t));
-
-                Variant container  = parse(data, offset, MetaType::VARIANTMAP, false);
-                appendProperty(result, container, name);
-            } break;
-            case ARRAY: {
-                int32_t length;
-                memcpy(&length, &data[offset], sizeof(uint32_t));
-
-                Variant container  = parse(data, offset, MetaType::VARIANTLIST, false);
-                appendProperty(result, container, name);
-            } break;
-            case BINARY: {
-                uint32_t length;
-                memcpy(&length, &data[offset],  sizeof(uint32_t));
-                offset += sizeof(uint32_t);
-                uint8_t sub;
-                memcpy(&sub, &data[offset],     sizeof(uint8_t));
-                offset++;
-                ByteArray value(data.begin() + offset, data.begin() + offset + length);
-
-                appendProperty(result, value, name);
-                offset += length;
-            } break;
-            case FLOAT: {
-                float value;
-                memcpy(&value, &data[offset], sizeof(float));
-                offset += sizeof(float);
-
-                appendProperty(result, value, name);
-            } break;
-            case INT32: {
-                int32_t value;
-                memcpy(&value, &data[offset], sizeof(uint32_t));
-                offset += sizeof(uint32_t);
-
-                appendProperty(result, value, name);
-            } break;
-            case VECTOR2: {
-                Vector2 value;
-                memcpy((void*)&value, &data[offset], sizeof(Vector2));
-                offset += sizeof(Vector2);
-
-                appendProperty(result, value, name);
-            } break;
-            case VECTOR3: {
-                Vector3 value;
-                memcpy((void*)&value, &data[offset], sizeof(Vector3));
-                offset += sizeof(Vector3);
-
-                appendProperty(result, value, name);
-            } break;
-            case VECTOR4: {
-                Vector4 value;
-                memcpy((void*)&value, &data[offset], sizeof(Vector4));
-                offset += sizeof(Vector4);
-
-                appendProperty(result, value, name);
-            } break;
-            case MATRIX3: {
-                Matrix3 value;
-                memcpy((void*)&value, &data[offset], sizeof(Matrix3));
-                offset += sizeof(Matrix3);
-
-                appendProperty(result, value, name);
-            } break;
-            case MATRIX4: {
-                Matrix4 value;
-                memcpy((void*)&value, &data[offset], sizeof(Matrix4));
-                offset += sizeof(Matrix4);
-
-                appendProperty(result, value, name);
-            } break;
-            case QUATERNION: {
-                Quaternion value;
-                memcpy((void*)&value, &data[offset], sizeof(Quaternion));
-                offset += sizeof(Quaternion);
-
-                appendProperty(result, value, name);
-            } break;
-            default: break;
-        }
-
-    }
-
-    if(first && result.type() == MetaType::VARIANTLIST) {
-        return result.value<VariantList>();
-    }
-
-    if(result.data() == nullptr) {
         return result;
     }
 
-    return result;
-}
-
-uint8_t type(const Variant &data) {
-    PROFILE_FUNCTION();
-    uint8_t result;
-    switch (data.type()) {
-        case MetaType::BOOLEAN:     result  = BOOL; break;
-        case MetaType::FLOAT:       result  = FLOAT; break;
-        case MetaType::INTEGER:     result  = INT32; break;
-        case MetaType::STRING:      result  = STRING; break;
-        case MetaType::VARIANTMAP:  result  = OBJECT; break;
-        case MetaType::BYTEARRAY:   result  = BINARY; break;
-        case MetaType::VECTOR2:     result  = VECTOR2; break;
-        case MetaType::VECTOR3:     result  = VECTOR3; break;
-        case MetaType::VECTOR4:     result  = VECTOR4; break;
-        case MetaType::MATRIX3:     result  = MATRIX3; break;
-        case MetaType::MATRIX4:     result  = MATRIX4; break;
-        case MetaType::QUATERNION:  result  = QUATERNION; break;
-        default:                    result  = ARRAY; break;
+    uint32_t fixedSize(uint8_t type) {
+        switch(type) {
+            case Bson::BOOL:        return sizeof(uint8_t);
+            case Bson::FLOAT:       return sizeof(float);
+            case Bson::INT32:       return sizeof(int32_t);
+            case Bson::VECTOR2:     return sizeof(Vector2);
+            case Bson::VECTOR3:     return sizeof(Vector3);
+            case Bson::VECTOR4:     return sizeof(Vector4);
+            case Bson::MATRIX3:     return sizeof(Matrix3);
+            case Bson::MATRIX4:     return sizeof(Matrix4);
+            case Bson::QUATERNION:  return sizeof(Quaternion);
+            default: break;
+        }
+        return 0;
     }
-    return result;
 }
 /*!
     \class Bson
@@ -247,14 +88,27 @@ uint8_t type(const Variant &data) {
         ....
         VariantMap result = Bson::load(data).toMap(); // Resotoring it back
     \endcode
+
+    Use BsonReader and BsonWriter to process documents without building the Variant DOM structure.
 */
 
 /*!
     Returns deserialized binary \a data as Variant based DOM structure with expected \a type of container (can be MetaType::VARIANTLIST or MetaType::VARIANTMAP).
 */
 Variant Bson::load(const ByteArray &data, MetaType::Type type) {
-    uint32_t offset = 0;
-    return parse(data, offset, type, true);
+    return load(data.data(), data.size(), type);
+}
+/*!
+    Returns deserialized binary \a data with \a size as Variant based DOM structure with expected \a type of container (can be MetaType::VARIANTLIST or MetaType::VARIANTMAP).
+    Returns invalid Variant if the data is malformed.
+*/
+Variant Bson::load(const uint8_t *data, size_t size, MetaType::Type type) {
+    PROFILE_FUNCTION();
+    if(data == nullptr || size == 0) {
+        return Variant(type);
+    }
+
+    return BsonReader(data, size).document(type);
 }
 /*!
     Returns serialized \a data as binary buffer.
@@ -262,109 +116,542 @@ Variant Bson::load(const ByteArray &data, MetaType::Type type) {
 ByteArray Bson::save(const Variant &data) {
     PROFILE_FUNCTION();
     ByteArray result;
+    result.reserve(BsonWriter::size(data));
 
-    switch(data.type()) {
-        case MetaType::BOOLEAN: {
-            result.push_back( (data.toBool()) ? 0x01 : 0x00 );
-        } break;
-        case MetaType::STRING: {
-            TString value = data.toString();
-            uint32_t size = value.size() + 1;
-            result.resize(size + sizeof(uint32_t));
+    BsonWriter writer(result);
+    writer.write(std::string_view(), data);
+
+    return result;
+}
+/*!
+    \class BsonReader
+    \brief Pull parser for Binary JSON documents.
+    \since Next 1.0
+    \inmodule Core
+
+    BsonReader walks the elements of a document in place.
+    Names, strings and binary payloads are returned as pointers into the source buffer, so nothing is allocated until toVariant() or document() are called.
+    The buffer must stay alive while the reader and the values returned by it are used.
+
+    Example:
+    \code
+        BsonReader reader(data);
+        while(reader.next()) {
+            if(reader.name() == "mesh" && reader.type() == Bson::BINARY) {
+                size_t size;
+                const uint8_t *blob = reader.toBinary(size);
+                ....
+            }
+        }
+    \endcode
+
+    Nested objects and arrays are visited with the reader returned by toDocument().
+*/
+/*!
+    Constructs an invalid reader.
+*/
+BsonReader::BsonReader() :
+        m_data(nullptr),
+        m_size(0),
+        m_value(0),
+        m_next(0),
+        m_nameLength(0),
+        m_type(Bson::END),
+        m_valid(false) {
+
+}
+/*!
+    Constructs a reader for the document stored in \a data with \a size.
+*/
+BsonReader::BsonReader(const uint8_t *data, size_t size) :
+        BsonReader() {
+    uint32_t length = 0;
+    if(data && size > sizeof(uint32_t)) {
+        memcpy(&length, data, sizeof(uint32_t));
+    }
+    if(length > sizeof(uint32_t) && length <= size) {
+        m_data = data;
+        m_size = length;
+        m_next = sizeof(uint32_t);
+        m_valid = true;
+    }
+}
+/*!
+    Constructs a reader for the document stored in \a data.
+*/
+BsonReader::BsonReader(const ByteArray &data) :
+        BsonReader(data.data(), data.size()) {
+
+}
+/*!
+    Returns false if the document is malformed.
+*/
+bool BsonReader::isValid() const {
+    return m_valid;
+}
+/*!
+    Moves the reader to the next element of the document.
+    Returns false at the end of the document or if the document is malformed.
+*/
+bool BsonReader::next() {
+    if(!m_valid || m_next >= m_size) {
+        return false;
+    }
+
+    uint8_t t = m_data[m_next];
+    if(t == Bson::END) {
+        m_next = m_size;
+        m_type = Bson::END;
+        return false;
+    }
 
-            memcpy(&result[0], &size, sizeof(uint32_t));
-            memcpy(&result[sizeof(uint32_t)], value.data(), size);
+    uint32_t name = m_next + 1;
+    const void *terminator = memchr(m_data + name, 0, m_size - name);
+    if(terminator == nullptr) {
+        m_valid = false;
+        return false;
+    }
+    m_nameLength = static_cast<const uint8_t *>(terminator) - (m_data + name);
+
+    uint32_t value = name + m_nameLength + 1;
+    uint32_t size = fixedSize(t);
+    if(size == 0) {
+        if(value + sizeof(uint32_t) > m_size) {
+            m_valid = false;
+            return false;
+        }
+        uint32_t length;
+        memcpy(&length, m_data + value, sizeof(uint32_t));
+        switch(t) {
+            case Bson::STRING: size = sizeof(uint32_t) + length; break;
+            case Bson::BINARY: size = sizeof(uint32_t) + 1 + length; break;
+            case Bson::OBJECT:
+            case Bson::ARRAY: size = length; break;
+            default: {
+                m_valid = false;
+                return false;
+            }
+        }
+        if(size < length) {
+            m_valid = false;
+            return false;
+        }
+    }
+    if(size > m_size - value) {
+        m_valid = false;
+        return false;
+    }
+
+    m_type = t;
+    m_value = value;
+    m_next = value + size;
+
+    return true;
+}
+/*!
+    Returns the type of the current element (one of Bson::DataType).
+*/
+uint8_t BsonReader::type() const {
+    return m_type;
+}
+/*!
+    Returns the name of the current element.
+    The returned view is null-terminated.
+*/
+std::string_view BsonReader::name() const {
+    if(m_type == Bson::END) {
+        return std::string_view();
+    }
+    return std::string_view(reinterpret_cast<const char *>(m_data + m_value - m_nameLength - 1), m_nameLength);
+}
+/*!
+    Returns the value of the current element as a boolean.
+*/
+bool BsonReader::toBool() const {
+    switch(m_type) {
+        case Bson::BOOL: return m_data[m_value] != 0;
+        case Bson::INT32: return toInt() != 0;
+        default: break;
+    }
+    return false;
+}
+/*!
+    Returns the value of the current element as an integer.
+*/
+int32_t BsonReader::toInt() const {
+    switch(m_type) {
+        case Bson::INT32: {
+            int32_t result;
+            memcpy(&result, m_data + m_value, sizeof(int32_t));
+            return result;
+        }
+        case Bson::FLOAT: return static_cast<int32_t>(toFloat());
+        case Bson::BOOL: return m_data[m_value];
+        default: break;
+    }
+    return 0;
+}
+/*!
+    Returns the value of the current element as a float.
+*/
+float BsonReader::toFloat() const {
+    switch(m_type) {
+        case Bson::FLOAT: {
+            float result;
+            memcpy(&result, m_data + m_value, sizeof(float));
+            return result;
+        }
+        case Bson::INT32: return static_cast<float>(toInt());
+        default: break;
+    }
+    return 0.0f;
+}
+/*!
+    Returns the value of the current string element as a view into the source buffer.
+*/
+std::string_view BsonReader::toString() const {
+    if(m_type == Bson::STRING) {
+        uint32_t length;
+        memcpy(&length, m_data + m_value, sizeof(uint32_t));
+        const char *data = reinterpret_cast<const char *>(m_data + m_value + sizeof(uint32_t));
+        // Stored length includes the terminator
+        return std::string_view(data, strnlen(data, length));
+    }
+    return std::string_view();
+}
+/*!
+    Returns a pointer to the payload of the current binary element in the source buffer and writes its \a size.
+    Returns nullptr if the current element isn't binary.
+*/
+const uint8_t *BsonReader::toBinary(size_t &size) const {
+    if(m_type == Bson::BINARY) {
+        uint32_t length;
+        memcpy(&length, m_data + m_value, sizeof(uint32_t));
+        size = length;
+        return m_data + m_value + sizeof(uint32_t) + 1;
+    }
+    size = 0;
+    return nullptr;
+}
+/*!
+    Returns a reader for the current object or array element.
+    Returns an invalid reader for the elements of other types.
+*/
+BsonReader BsonReader::toDocument() const {
+    if(m_type == Bson::OBJECT || m_type == Bson::ARRAY) {
+        return BsonReader(m_data + m_value, m_next - m_value);
+    }
+    return BsonReader();
+}
+/*!
+    Returns the value of the current element converted to Variant.
+    Objects and arrays are converted to VariantMap and VariantList respectively.
+*/
+Variant BsonReader::toVariant() const {
+    switch(m_type) {
+        case Bson::BOOL:    return toBool();
+        case Bson::INT32:   return toInt();
+        case Bson::FLOAT:   return toFloat();
+        case Bson::STRING:  return TString(toString());
+        case Bson::OBJECT:  return toDocument().document(MetaType::VARIANTMAP);
+        case Bson::ARRAY:   return toDocument().document(MetaType::VARIANTLIST);
+        case Bson::BINARY: {
+            size_t size;
+            const uint8_t *data = toBinary(size);
+            return ByteArray(data, data + size);
+        }
+        case Bson::VECTOR2: {
+            Vector2 value;
+            memcpy(static_cast<void *>(&value), m_data + m_value, sizeof(Vector2));
+            return value;
+        }
+        case Bson::VECTOR3: {
+            Vector3 value;
+            memcpy(static_cast<void *>(&value), m_data + m_value, sizeof(Vector3));
+            return value;
+        }
+        case Bson::VECTOR4: {
+            Vector4 value;
+            memcpy(static_cast<void *>(&value), m_data + m_value, sizeof(Vector4));
+            return value;
+        }
+        case Bson::MATRIX3: {
+            Matrix3 value;
+            memcpy(static_cast<void *>(&value), m_data + m_value, sizeof(Matrix3));
+            return value;
+        }
+        case Bson::MATRIX4: {
+            Matrix4 value;
+            memcpy(static_cast<void *>(&value), m_data + m_value, sizeof(Matrix4));
+            return value;
+        }
+        case Bson::QUATERNION: {
+            Quaternion value;
+            memcpy(static_cast<void *>(&value), m_data + m_value, sizeof(Quaternion));
+            return value;
+        }
+        default: break;
+    }
+    return Variant();
+}
+/*!
+    Returns the whole document converted to the container of \a type (can be MetaType::VARIANTLIST or MetaType::VARIANTMAP) regardless of the current position.
+    Element names are ignored for lists.
+    Returns invalid Variant if the document is malformed.
+*/
+Variant BsonReader::document(MetaType::Type type) const {
+    PROFILE_FUNCTION();
+    if(!m_valid) {
+        return Variant();
+    }
+
+    BsonReader reader(m_data, m_size);
+
+    if(type == MetaType::VARIANTMAP) {
+        Variant result = VariantMap();
+        VariantMap &map = *(reinterpret_cast<VariantMap *>(result.data()));
+        while(reader.next()) {
+            Variant value = reader.toVariant();
+            if(!value.isValid()) {
+                return Variant();
+            }
+            // Keys are stored in order, so the hint makes insertion constant
+            auto it = map.emplace_hint(map.end(), TString(reader.name()), Variant());
+            it->second = value;
+        }
+        return reader.isValid() ? result : Variant();
+    }
+
+    Variant result = VariantList();
+    VariantList &list = *(reinterpret_cast<VariantList *>(result.data()));
+    while(reader.next()) {
+        Variant value = reader.toVariant();
+        if(!value.isValid()) {
+            return Variant();
+        }
+        list.push_back(value);
+    }
+    return reader.isValid() ? result : Variant();
+}
+/*!
+    \class BsonWriter
+    \brief Serializer of Binary JSON documents.
+    \since Next 1.0
+    \inmodule Core
+
+    BsonWriter appends elements straight into the provided buffer without intermediate Variant structures.
+    The buffer can be preallocated with the result of size() to avoid reallocations.
+
+    Example:
+    \code
+        ByteArray data;
+        BsonWriter writer(data);
+        writer.beginObject();
+            writer.writeString("name", "Cube");
+            writer.beginArray("indices");
+                writer.writeInt(std::string_view(), 0);
+                writer.writeInt(std::string_view(), 1);
+            writer.end();
+        writer.end();
+    \endcode
+
+    Names of array elements are ignored; elements are indexed automatically.
+    A value written outside of any object or array is stored without the element header, the same way as Bson::save() does.
+*/
+/*!
+    Constructs a writer which appends data to the \a buffer.
+*/
+BsonWriter::BsonWriter(ByteArray &buffer) :
+        m_buffer(buffer) {
+
+}
+/*!
+    Starts a nested object with \a name.
+*/
+void BsonWriter::beginObject(std::string_view name) {
+    begin(Bson::OBJECT, name);
+}
+/*!
+    Starts a nested array with \a name.
+*/
+void BsonWriter::beginArray(std::string_view name) {
+    begin(Bson::ARRAY, name);
+}
+/*!
+    Finishes the last started object or array.
+*/
+void BsonWriter::end() {
+    if(m_levels.empty()) {
+        return;
+    }
+
+    size_t offset = m_levels.back().offset;
+    m_levels.pop_back();
+
+    m_buffer.push_back(Bson::END);
+    uint32_t size = m_buffer.size() - offset;
+    memcpy(&m_buffer[offset], &size, sizeof(uint32_t));
+}
+/*!
+    Writes the boolean \a value with \a name.
+*/
+void BsonWriter::writeBool(std::string_view name, bool value) {
+    header(Bson::BOOL, name);
+    m_buffer.push_back(value ? 0x01 : 0x00);
+}
+/*!
+    Writes the integer \a value with \a name.
+*/
+void BsonWriter::writeInt(std::string_view name, int32_t value) {
+    header(Bson::INT32, name);
+    append(&value, sizeof(int32_t));
+}
+/*!
+    Writes the float \a value with \a name.
+*/
+void BsonWriter::writeFloat(std::string_view name, float value) {
+    header(Bson::FLOAT, name);
+    append(&value, sizeof(float));
+}
+/*!
+    Writes the string \a value with \a name.
+*/
+void BsonWriter::writeString(std::string_view name, std::string_view value) {
+    header(Bson::STRING, name);
+    uint32_t size = value.size() + 1;
+    append(&size, sizeof(uint32_t));
+    append(value.data(), value.size());
+    m_buffer.push_back(0x00);
+}
+/*!
+    Writes the binary \a data with \a size and \a name.
+*/
+void BsonWriter::writeBinary(std::string_view name, const uint8_t *data, size_t size) {
+    header(Bson::BINARY, name);
+    uint32_t length = size;
+    append(&length, sizeof(uint32_t));
+    m_buffer.push_back(0x00);
+    append(data, size);
+}
+/*!
+    Writes the \a value with \a name.
+    Containers are written recursively.
+*/
+void BsonWriter::write(std::string_view name, const Variant &value) {
+    switch(value.type()) {
+        case MetaType::BOOLEAN: writeBool(name, value.toBool()); break;
+        case MetaType::INTEGER: writeInt(name, value.toInt()); break;
+        case MetaType::FLOAT: writeFloat(name, value.toFloat()); break;
+        case MetaType::STRING: {
+            const TString &string = *(reinterpret_cast<const TString *>(value.data()));
+            writeString(name, std::string_view(string.data(), string.size()));
         } break;
         case MetaType::BYTEARRAY: {
-            ByteArray value = data.toByteArray();
-            uint32_t size   = value.size();
-            result.resize(sizeof(uint32_t) + 1 + size);
-
-            memcpy(&result[0], &size, sizeof(uint32_t));
-            result[sizeof(uint32_t)] = '\x00';
-            if(size) {
-                memcpy(&result[sizeof(uint32_t) + 1], &value[0], size);
-            }
+            const ByteArray &array = *(reinterpret_cast<const ByteArray *>(value.data()));
+            writeBinary(name, array.data(), array.size());
         } break;
         case MetaType::VARIANTMAP: {
-            uint32_t size   = sizeof(uint32_t);
-            result.resize(size);
-            uint32_t offset = size;
-            uint32_t index  = 0;
-            VariantMap map  = data.toMap();
-            for(auto &it: map) {
-                ByteArray element   = save(it.second);
-                uint8_t t = type(it.second);
-                size += element.size() + 1 + (it.first.size() + 1);
-                result.resize(size);
-
-                memcpy(&result[offset++], &t, 1);
-                memcpy(&result[offset], it.first.data(), it.first.size() + 1);
-                offset += it.first.size() + 1;
-                memcpy(&result[offset], &element[0], element.size());
-                offset += element.size();
-
-                index++;
+            beginObject(name);
+            for(auto &it : *(reinterpret_cast<const VariantMap *>(value.data()))) {
+                write(std::string_view(it.first.data(), it.first.size()), it.second);
             }
-            result.push_back(0x00);
-            memcpy(&result[0], &(++size), sizeof(uint32_t));
+            end();
         } break;
-        case MetaType::FLOAT: {
-            float value = data.value<float>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
-        } break;
-        case MetaType::INTEGER: {
-            int32_t value = data.value<int32_t>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+        case MetaType::VARIANTLIST: {
+            beginArray(name);
+            for(auto &it : *(reinterpret_cast<const VariantList *>(value.data()))) {
+                write(std::string_view(), it);
+            }
+            end();
         } break;
-        case MetaType::VECTOR2: {
-            Vector2 value = data.value<Vector2>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+        case MetaType::VECTOR2:
+        case MetaType::VECTOR3:
+        case MetaType::VECTOR4:
+        case MetaType::MATRIX3:
+        case MetaType::MATRIX4:
+        case MetaType::QUATERNION: {
+            uint8_t t = type(value);
+            header(t, name);
+            append(value.data(), fixedSize(t));
         } break;
-        case MetaType::VECTOR3: {
-            Vector3 value = data.value<Vector3>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+        default: {
+            beginArray(name);
+            for(auto &it : value.toList()) {
+                write(std::string_view(), it);
+            }
+            end();
         } break;
-        case MetaType::VECTOR4: {
-            Vector4 value = data.value<Vector4>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+    }
+}
+/*!
+    Returns the size in bytes of the \a value serialized with write() outside of any container.
+    Useful to preallocate the buffer.
+*/
+size_t BsonWriter::size(const Variant &value) {
+    size_t result = 0;
+    switch(value.type()) {
+        case MetaType::STRING: {
+            result = sizeof(uint32_t) + reinterpret_cast<const TString *>(value.data())->size() + 1;
         } break;
-        case MetaType::MATRIX3: {
-            Matrix3 value = data.value<Matrix3>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+        case MetaType::BYTEARRAY: {
+            result = sizeof(uint32_t) + 1 + reinterpret_cast<const ByteArray *>(value.data())->size();
         } break;
-        case MetaType::MATRIX4: {
-            Matrix4 value = data.value<Matrix4>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+        case MetaType::VARIANTMAP: {
+            result = sizeof(uint32_t) + 1;
+            for(auto &it : *(reinterpret_cast<const VariantMap *>(value.data()))) {
+                result += 1 + it.first.size() + 1 + size(it.second);
+            }
         } break;
-        case MetaType::QUATERNION: {
-            Quaternion value = data.value<Quaternion>();
-            result.assign( reinterpret_cast<char *>( &value ), reinterpret_cast<char *>( &value ) + sizeof( value ) );
+        case MetaType::VARIANTLIST: {
+            result = sizeof(uint32_t) + 1;
+            uint32_t index = 0;
+            for(auto &it : *(reinterpret_cast<const VariantList *>(value.data()))) {
+                result += 1 + digits(index) + 1 + size(it);
+                index++;
+            }
         } break;
         default: {
-            uint32_t size   = sizeof(uint32_t);
-            result.resize(size);
-            uint32_t offset = size;
-            uint32_t index  = 0;
-            VariantList list   = data.toList();
-            for(auto &it: list) {
-                ByteArray element = save(it);
-                std::string i = std::to_string(index);
-                uint8_t t = type(it);
-                size += element.size() + 1 + (i.size() + 1);
-                result.resize(size);
-
-                memcpy(&result[offset++], &t, 1);
-                memcpy(&result[offset], i.c_str(), i.size() + 1);
-                offset += i.size() + 1;
-                memcpy(&result[offset], &element[0], element.size());
-                offset += element.size();
-
-                index++;
+            result = fixedSize(type(value));
+            if(result == 0) {
+                result = size(value.toList());
             }
-            result.push_back(0x00);
-            memcpy(&result[0], &(++size), sizeof(uint32_t));
         } break;
     }
     return result;
 }
+
+void BsonWriter::begin(uint8_t type, std::string_view name) {
+    header(type, name);
+
+    m_levels.push_back({m_buffer.size(), 0, type == Bson::ARRAY});
+
+    uint32_t size = 0;
+    append(&size, sizeof(uint32_t));
+}
+
+void BsonWriter::header(uint8_t type, std::string_view name) {
+    if(m_levels.empty()) {
+        return;
+    }
+
+    Level &level = m_levels.back();
+
+    m_buffer.push_back(type);
+    if(level.array) {
+        char index[16];
+        auto result = std::to_chars(index, index + sizeof(index), level.index);
+        append(index, result.ptr - index);
+    } else {
+        append(name.data(), name.size());
+    }
+    m_buffer.push_back(0x00);
+
+    level.index++;
+}
+
+void BsonWriter::append(const void *data, size_t size) {
+    if(size > 0) {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        m_buffer.insert(m_buffer.end(), bytes, bytes + size);
+    }
+}
@@ -1,5 +1,14 @@
 #include "file.h"
 
+#if defined(_WIN32)
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+#endif
+
 static FileHandler *s_handler = nullptr;
 /*
 
@@ -126,3 +135,92 @@ bool File::isFile(const TString &path) {
 bool File::isDir(const TString &path) {
     return s_handler->isDir(path.data());
 }
+/*!
+    Maps the \a file into memory for reading and returns a pointer to its content; \a size receives the size of the file.
+    Returns nullptr if the file doesn't exist or the current file handler can't map it (for example the file is packed in an archive).
+    The mapped memory must be released with unmap().
+*/
+void *File::map(const TString &file, size_t &size) {
+    size = 0;
+    return s_handler ? s_handler->map(file.data(), size) : nullptr;
+}
+/*!
+    Releases the memory \a data with \a size previously mapped with map().
+*/
+void File::unmap(void *data, size_t size) {
+    if(s_handler && data) {
+        s_handler->unmap(data, size);
+    }
+}
+/*!
+    \class FileHandler
+    \brief The FileHandler class is an interface for file system backends used by File.
+    \inmodule Core
+*/
+/*!
+    Maps a file with \a path into memory and writes its \a size.
+    The default implementation doesn't support memory mapping and returns nullptr.
+    Handlers which can resolve the path to a file in the native file system should use mapFile().
+*/
+void *FileHandler::map(const char *path, size_t &size) {
+    A_UNUSED(path);
+    size = 0;
+    return nullptr;
+}
+/*!
+    Releases the memory \a data with \a size mapped by map().
+*/
+void FileHandler::unmap(void *data, size_t size) {
+    unmapFile(data, size);
+}
+/*!
+    Maps a native file system file with \a path into memory for reading and writes its \a size.
+    Returns nullptr on failure or for empty files.
+*/
+void *FileHandler::mapFile(const char *path, size_t &size) {
+    size = 0;
+    void *result = nullptr;
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file != INVALID_HANDLE_VALUE) {
+        LARGE_INTEGER length;
+        if(GetFileSizeEx(file, &length) && length.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if(mapping) {
+                result = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if(result) {
+                    size = static_cast<size_t>(length.QuadPart);
+                }
+                CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    int file = ::open(path, O_RDONLY);
+    if(file != -1) {
+        struct stat info;
+        if(fstat(file, &info) == 0 && info.st_size > 0) {
+            result = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+            if(result == MAP_FAILED) {
+                result = nullptr;
+            } else {
+                size = static_cast<size_t>(info.st_size);
+            }
+        }
+        ::close(file);
+    }
+#endif
+    return result;
+}
+/*!
+    Releases the memory \a data with \a size mapped by mapFile().
+*/
+void FileHandler::unmapFile(void *data, size_t size) {
+#if defined(_WIN32)
+    A_UNUSED(size);
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
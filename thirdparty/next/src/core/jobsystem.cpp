@@ -0,0 +1,563 @@
+/*
+    This file is part of Thunder Next.
+
+    Copyright 2008-2026 Evgeniy Prikazchikov
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "jobsystem.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <algorithm>
+
+namespace {
+    const uint32_t gQueueSize = 8192;
+    const uint32_t gQueueMask = gQueueSize - 1;
+
+    const uint32_t gAllocateProbes = 16;
+    const uint32_t gSpinCount = 64;
+}
+
+struct JobData {
+    JobSystem::Job function;
+
+    JobCounter *counter = nullptr;
+
+    std::atomic<bool> busy = { false };
+
+    bool heap = false;
+};
+
+struct JobThreadState {
+    JobSystemPrivate *system = nullptr;
+
+    int32_t index = -1;
+};
+
+static thread_local JobThreadState s_state;
+
+/*
+    Chase-Lev work-stealing deque. Only the owner thread pushes and pops from the bottom,
+    any other thread steals from the top.
+*/
+class JobQueue {
+public:
+    JobQueue() :
+            m_top(0),
+            m_bottom(0),
+            m_cursor(0) {
+
+        for(uint32_t i = 0; i < gQueueSize; i++) {
+            m_items[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    bool push(JobData *job) {
+        int64_t b = m_bottom.load(std::memory_order_relaxed);
+        int64_t t = m_top.load(std::memory_order_acquire);
+        if(b - t >= int64_t(gQueueSize)) {
+            return false;
+        }
+        m_items[b & gQueueMask].store(job, std::memory_order_relaxed);
+        m_bottom.store(b + 1, std::memory_order_release);
+        return true;
+    }
+
+    JobData *pop() {
+        int64_t b = m_bottom.load(std::memory_order_relaxed) - 1;
+        m_bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = m_top.load(std::memory_order_relaxed);
+
+        if(t <= b) {
+            JobData *job = m_items[b & gQueueMask].load(std::memory_order_relaxed);
+            if(t == b) {
+                // Last item, race against thieves
+                if(!m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                    job = nullptr;
+                }
+                m_bottom.store(b + 1, std::memory_order_relaxed);
+            }
+            return job;
+        }
+
+        m_bottom.store(b + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    JobData *steal() {
+        int64_t t = m_top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = m_bottom.load(std::memory_order_acquire);
+
+        if(t < b) {
+            JobData *job = m_items[t & gQueueMask].load(std::memory_order_relaxed);
+            if(m_top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    JobData *allocate() {
+        for(uint32_t i = 0; i < gAllocateProbes; i++) {
+            JobData &job = m_jobs[m_cursor & gQueueMask];
+            ++m_cursor;
+            if(!job.busy.load(std::memory_order_acquire)) {
+                job.busy.store(true, std::memory_order_relaxed);
+                return &job;
+            }
+        }
+        return nullptr;
+    }
+
+protected:
+    std::atomic<int64_t> m_top;
+
+    std::atomic<int64_t> m_bottom;
+
+    std::atomic<JobData *> m_items[gQueueSize];
+
+    JobData m_jobs[gQueueSize];
+
+    uint32_t m_cursor;
+
+};
+
+class JobSystemPrivate {
+public:
+    JobSystemPrivate() :
+            m_sleeping(0),
+            m_pending(0),
+            m_active(0),
+            m_injected(0),
+            m_enabled(true) {
+
+    }
+
+    bool isOwner() const {
+        return s_state.system == this && s_state.index >= 0;
+    }
+
+    JobData *allocate() {
+        JobData *job = nullptr;
+        if(isOwner()) {
+            job = m_queues[s_state.index]->allocate();
+        }
+        if(job == nullptr) {
+            job = new JobData;
+            job->busy.store(true, std::memory_order_relaxed);
+            job->heap = true;
+        }
+        return job;
+    }
+
+    void release(JobData *job) {
+        job->function = nullptr;
+        job->counter = nullptr;
+        if(job->heap) {
+            delete job;
+        } else {
+            job->busy.store(false, std::memory_order_release);
+        }
+    }
+
+    void submit(JobData *job) {
+        m_pending.fetch_add(1);
+
+        if(isOwner()) {
+            if(!m_queues[s_state.index]->push(job)) {
+                // Queue is full, the producer has to help
+                m_pending.fetch_sub(1);
+                execute(job);
+                return;
+            }
+        } else {
+            std::unique_lock<std::mutex> locker(m_injectMutex);
+            m_inject.push_back(job);
+            m_injected.fetch_add(1);
+        }
+
+        if(m_sleeping.load() > 0) {
+            std::unique_lock<std::mutex> locker(m_sleepMutex);
+            m_sleepVariable.notify_one();
+        }
+    }
+
+    void enqueue(JobData *job, JobCounter *dependency) {
+        if(dependency) {
+            while(dependency->m_lock.test_and_set(std::memory_order_acquire)) {
+                std::this_thread::yield();
+            }
+            if(dependency->m_value.load() > 0) {
+                dependency->m_dependents.push_back(job);
+                dependency->m_lock.clear(std::memory_order_release);
+                return;
+            }
+            dependency->m_lock.clear(std::memory_order_release);
+        }
+        submit(job);
+    }
+
+    JobData *take() {
+        int32_t index = -1;
+        if(isOwner()) {
+            index = s_state.index;
+            JobData *job = m_queues[index]->pop();
+            if(job) {
+                m_pending.fetch_sub(1);
+                return job;
+            }
+        }
+
+        if(m_injected.load(std::memory_order_relaxed) > 0) {
+            std::unique_lock<std::mutex> locker(m_injectMutex);
+            if(!m_inject.empty()) {
+                JobData *job = m_inject.front();
+                m_inject.pop_front();
+                m_injected.fetch_sub(1);
+                m_pending.fetch_sub(1);
+                return job;
+            }
+        }
+
+        uint32_t count = m_queues.size();
+        for(uint32_t i = 1; i <= count; i++) {
+            uint32_t victim = (index + i) % count;
+            if(int32_t(victim) == index) {
+                continue;
+            }
+            JobData *job = m_queues[victim]->steal();
+            if(job) {
+                m_pending.fetch_sub(1);
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void execute(JobData *job) {
+        job->function();
+
+        JobCounter *counter = job->counter;
+        release(job);
+
+        if(counter) {
+            finish(counter);
+        }
+        m_active.fetch_sub(1);
+    }
+
+    void finish(JobCounter *counter) {
+        uint32_t value = counter->m_value.load();
+        while(value > 1) {
+            if(counter->m_value.compare_exchange_weak(value, value - 1)) {
+                return;
+            }
+        }
+
+        // The last job of the counter must release dependents before anyone can observe completion
+        while(counter->m_lock.test_and_set(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        std::vector<JobData *> dependents;
+        if(counter->m_value.fetch_sub(1) == 1) {
+            dependents.swap(counter->m_dependents);
+        }
+        counter->m_lock.clear(std::memory_order_release);
+
+        for(auto it : dependents) {
+            submit(it);
+        }
+    }
+
+    void worker(int32_t index) {
+        s_state.system = this;
+        s_state.index = index;
+
+        uint32_t spin = 0;
+        while(m_enabled.load(std::memory_order_relaxed)) {
+            JobData *job = take();
+            if(job) {
+                execute(job);
+                spin = 0;
+                continue;
+            }
+
+            if(spin < gSpinCount) {
+                ++spin;
+                std::this_thread::yield();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> locker(m_sleepMutex);
+            m_sleeping.fetch_add(1);
+            m_sleepVariable.wait(locker, [this]() { return m_pending.load() > 0 || !m_enabled.load(); });
+            m_sleeping.fetch_sub(1);
+            spin = 0;
+        }
+
+        s_state = JobThreadState();
+    }
+
+    bool help() {
+        JobData *job = take();
+        if(job) {
+            execute(job);
+            return true;
+        }
+        std::this_thread::yield();
+        return false;
+    }
+
+public:
+    std::vector<std::unique_ptr<JobQueue>> m_queues;
+
+    std::vector<std::thread> m_threads;
+
+    std::deque<JobData *> m_inject;
+
+    std::mutex m_injectMutex;
+
+    std::mutex m_sleepMutex;
+
+    std::condition_variable m_sleepVariable;
+
+    std::atomic<int32_t> m_sleeping;
+
+    std::atomic<int32_t> m_pending;
+
+    std::atomic<int32_t> m_active;
+
+    std::atomic<int32_t> m_injected;
+
+    std::atomic<bool> m_enabled;
+
+    JobThreadState m_ownerState;
+
+};
+
+/*!
+    \class JobCounter
+    \brief The JobCounter class tracks the completion of a group of jobs.
+    \since Next 1.0
+    \inmodule Core
+
+    Every job dispatched with a counter increments it and decrements it when finished.
+    A counter can be used to wait for a group of jobs or as a dependency for other jobs.
+    The counter must outlive all jobs associated with it.
+*/
+JobCounter::JobCounter() :
+        m_value(0) {
+
+    m_lock.clear();
+}
+
+JobCounter::~JobCounter() {
+    // Wait for the last finished job to leave the critical section
+    while(m_lock.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+/*!
+    Returns true if all jobs associated with this counter are finished.
+*/
+bool JobCounter::isDone() const {
+    return m_value.load() == 0;
+}
+/*!
+    Returns the number of unfinished jobs associated with this counter.
+*/
+uint32_t JobCounter::value() const {
+    return m_value.load();
+}
+
+/*!
+    \class JobSystem
+    \brief The JobSystem class executes small jobs on a set of worker threads using work stealing.
+    \since Next 1.0
+    \inmodule Core
+
+    Each thread owns a lock-free deque of jobs. Jobs dispatched from a worker or from the thread that created the JobSystem are pushed to the local deque.
+    Idle threads steal jobs from the other deques, so fine-grained jobs don't contend on a single lock.
+    Jobs dispatched from any other thread go through a shared injection queue.
+
+    The thread which created the JobSystem participates in execution while it waits for jobs.
+
+    \sa ThreadPool
+*/
+/*!
+    \typedef JobSystem::Job
+
+    A callable executed by the job system.
+*/
+/*!
+    \typedef JobSystem::RangeJob
+
+    A callable which processes elements in the range [begin, end).
+*/
+/*!
+    Constructs a JobSystem which utilizes \a threads threads including the calling thread.
+    If \a threads is 0, the number of threads is based on the number of CPU cores.
+*/
+JobSystem::JobSystem(uint32_t threads) :
+        p_ptr(new JobSystemPrivate) {
+    PROFILE_FUNCTION();
+
+    if(threads == 0) {
+        threads = std::thread::hardware_concurrency();
+    }
+    threads = std::max(threads, 1U);
+
+    for(uint32_t i = 0; i < threads; i++) {
+        p_ptr->m_queues.push_back(std::unique_ptr<JobQueue>(new JobQueue));
+    }
+
+    p_ptr->m_ownerState = s_state;
+    s_state.system = p_ptr;
+    s_state.index = 0;
+
+    for(uint32_t i = 1; i < threads; i++) {
+        p_ptr->m_threads.push_back(std::thread(&JobSystemPrivate::worker, p_ptr, i));
+    }
+}
+
+JobSystem::~JobSystem() {
+    PROFILE_FUNCTION();
+
+    waitForDone();
+
+    {
+        std::unique_lock<std::mutex> locker(p_ptr->m_sleepMutex);
+        p_ptr->m_enabled.store(false);
+        p_ptr->m_sleepVariable.notify_all();
+    }
+
+    for(auto &it : p_ptr->m_threads) {
+        it.join();
+    }
+
+    if(s_state.system == p_ptr) {
+        s_state = p_ptr->m_ownerState;
+    }
+
+    delete p_ptr;
+}
+/*!
+    Returns the number of threads which execute jobs including the owner thread.
+*/
+uint32_t JobSystem::threadCount() const {
+    return p_ptr->m_queues.size();
+}
+/*!
+    Schedules a \a job for execution.
+    In case of \a counter provided it will be incremented now and decremented when the \a job is finished.
+    In case of \a dependency provided the \a job will not start before all jobs of \a dependency are finished.
+*/
+void JobSystem::dispatch(const Job &job, JobCounter *counter, JobCounter *dependency) {
+    JobData *data = p_ptr->allocate();
+    data->function = job;
+    data->counter = counter;
+
+    if(counter) {
+        counter->m_value.fetch_add(1);
+    }
+    p_ptr->m_active.fetch_add(1);
+
+    p_ptr->enqueue(data, dependency);
+}
+/*!
+    Splits the range [0, \a count) into chunks of \a grain elements and executes a \a job for each chunk in parallel.
+    If \a grain is 0 the chunk size is chosen based on the number of threads.
+    If \a counter is nullptr this function returns when all chunks are processed; otherwise it returns immediately and the \a counter must be used to wait for the result.
+    In case of \a dependency provided chunks will not start before all jobs of \a dependency are finished.
+*/
+void JobSystem::parallelFor(uint32_t count, uint32_t grain, const RangeJob &job, JobCounter *counter, JobCounter *dependency) {
+    PROFILE_FUNCTION();
+
+    if(count == 0) {
+        return;
+    }
+
+    if(grain == 0) {
+        grain = std::max(count / (threadCount() * 4), 1U);
+    }
+
+    if(counter == nullptr) {
+        JobCounter local;
+        const RangeJob *function = &job;
+        for(uint32_t begin = 0; begin < count; begin += grain) {
+            uint32_t end = std::min(begin + grain, count);
+            dispatch([function, begin, end]() { (*function)(begin, end); }, &local, dependency);
+        }
+        wait(&local);
+    } else {
+        std::shared_ptr<RangeJob> function = std::make_shared<RangeJob>(job);
+        for(uint32_t begin = 0; begin < count; begin += grain) {
+            uint32_t end = std::min(begin + grain, count);
+            dispatch([function, begin, end]() { (*function)(begin, end); }, counter, dependency);
+        }
+    }
+}
+/*!
+    Blocks the calling thread until all jobs associated with the \a counter are finished.
+    The calling thread executes pending jobs while waiting.
+*/
+void JobSystem::wait(JobCounter *counter) {
+    PROFILE_FUNCTION();
+
+    if(counter == nullptr) {
+        return;
+    }
+
+    while(!counter->isDone()) {
+        p_ptr->help();
+    }
+}
+/*!
+    Blocks the calling thread until all dispatched jobs are finished.
+    The calling thread executes pending jobs while waiting.
+*/
+void JobSystem::waitForDone() {
+    PROFILE_FUNCTION();
+
+    while(p_ptr->m_active.load() > 0) {
+        p_ptr->help();
+    }
+}
+/*!
+    Executes one pending job on the calling thread if there is any.
+    Returns true if a job was executed; otherwise returns false.
+    Useful for threads which wait for a condition not expressed with a JobCounter.
+*/
+bool JobSystem::tryExecute() {
+    JobData *job = p_ptr->take();
+    if(job) {
+        p_ptr->execute(job);
+        return true;
+    }
+    return false;
+}
+/*!
+    Returns the index of the current thread in the job system which owns it.
+    The thread which created a JobSystem has index 0 and worker threads have indices from 1 to threadCount() - 1.
+    Returns -1 for any other thread.
+*/
+int32_t JobSystem::currentThreadIndex() {
+    return s_state.index;
+}
@@ -18,8 +18,9 @@
 
 #include "json.h"
 
-#include <map>
-#include <stack>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 
 #define J_TRUE  "true"
 #define J_FALSE "false"
@@ -27,81 +28,57 @@
 
 #define FORMAT (tab > -1) ? "\n" : ""
 
-typedef std::stack<Variant> VariantStack;
-typedef std::stack<TString> NameStack;
+namespace {
+    struct Scope {
+        Variant container;
 
-void appendProperty(VariantStack &s, const Variant &data, const TString &name) {
-    Variant v;
-    if(!s.empty()) {
-        v = s.top();
-        s.pop();
-    }
-    switch(v.type()) {
-        case MetaType::VARIANTLIST: {
-            VariantList &list = *(reinterpret_cast<VariantList *>(v.data()));
-            list.push_back(data);
-            s.push(list);
+        TString name;
+    };
+
+    void appendProperty(std::vector<Scope> &stack, const Variant &data, const TString &name) {
+        if(stack.empty()) {
             return;
         }
-        case MetaType::VARIANTMAP: {
-            uint32_t type = MetaType::type(name.data());
-            if((type >= MetaType::VECTOR2 && type < MetaType::USERTYPE)) {
-                Variant object(type, MetaType::create(type));
-                VariantList &list = *(reinterpret_cast<VariantList *>(data.data()));
-                MetaType::convert(&list, MetaType::VARIANTLIST, object.data(), type);
-                s.push(object);
-            } else {
-                VariantMap &map = *(reinterpret_cast<VariantMap *>(v.data()));
-                map[name] = data;
-                s.push(map);
-            }
-            return;
+
+        Variant &v = stack.back().container;
+        switch(v.type()) {
+            case MetaType::VARIANTLIST: {
+                VariantList &list = *(reinterpret_cast<VariantList *>(v.data()));
+                list.push_back(data);
+            } break;
+            case MetaType::VARIANTMAP: {
+                uint32_t type = MetaType::type(name.data());
+                if(type >= MetaType::VECTOR2 && type < MetaType::USERTYPE && data.type() == MetaType::VARIANTLIST) {
+                    // Math types are stored as {"Vector3": [x, y, z]}
+                    Variant object(type, MetaType::create(type));
+                    MetaType::convert(data.data(), MetaType::VARIANTLIST, object.data(), type);
+                    v = object;
+                } else {
+                    VariantMap &map = *(reinterpret_cast<VariantMap *>(v.data()));
+                    map[name] = data;
+                }
+            } break;
+            default: break;
         }
-        default: break;
     }
-    s.push(v);
-}
 
+    inline bool isSpace(uint8_t c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
 
-inline TString readString(const TString &data, uint32_t &it) {
-    PROFILE_FUNCTION();
-    uint32_t s  = ++it;
-    char c = data.at(s);
-    while(it < data.length() && c != '"') {
-        c = data.at(++it);
-        if(c == '\\') {
-            c = data.at(++it);
-        }
+    inline bool isDigit(uint8_t c) {
+        return c >= '0' && c <= '9';
     }
-    return data.mid(s, it - s);
-}
 
-inline bool isSpace(uint8_t c) {
-    PROFILE_FUNCTION();
-    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
-}
+    const size_t gNumberLength = 64;
 
-inline void skipSpaces(const char *data, uint32_t &it) {
-    PROFILE_FUNCTION();
-    while(isSpace(data[it])) {
-        it++;
+    // Number tokens aren't null-terminated in the source text
+    void terminate(std::string_view text, char *buffer) {
+        size_t size = std::min(text.size(), gNumberLength - 1);
+        memcpy(buffer, text.data(), size);
+        buffer[size] = 0;
     }
 }
-
-inline bool isDigit(uint8_t c) {
-    PROFILE_FUNCTION();
-    return c >= '0' && c <= '9';
-}
-
-enum States {
-    objectBegin = 1,
-    objectEnd,
-    arrayBegin,
-    arrayEnd,
-    propertyNext,
-    propertyName,
-    propertyValue
-};
 /*!
     \class Json
     \brief JSON format parser.
@@ -123,6 +100,8 @@ enum States {
         ....
         VariantMap result = Json::load(data).toMap(); // Resotoring it back
     \endcode
+
+    Use JsonReader to process documents without building the Variant DOM structure.
 */
 /*!
     Returns deserialized string \a data as Variant based DOM structure.
@@ -131,135 +110,54 @@ Variant Json::load(const TString &data) {
     PROFILE_FUNCTION();
     Variant result;
 
-    VariantStack s;
-    NameStack n;
+    std::vector<Scope> stack;
     TString name;
-    States state = propertyValue;
-    uint32_t it = 0;
-    while(it < data.length()) {
-        skipSpaces(data.data(), it);
-        switch(data.at(it)) {
-            case '{': {
-                VariantMap map;
-                s.push(map);
-                n.push(name);
-                name = "";
-                state = propertyName;
-            } break;
-            case '}': {
-                result = s.top();
-                s.pop();
-                if(!s.empty()) {
-                    appendProperty(s, result, n.top());
-                }
-                n.pop();
-                state = propertyName;
+
+    JsonReader reader(data);
+    while(true) {
+        switch(reader.next()) {
+            case JsonReader::ObjectBegin: {
+                stack.push_back({VariantMap(), name});
+                name.clear();
             } break;
-            case '[': {
-                if(state == propertyValue) {
-                    VariantList list;
-                    s.push(list);
-                    n.push(name);
-                    name = "";
-                }
+            case JsonReader::ArrayBegin: {
+                stack.push_back({VariantList(), name});
+                name.clear();
             } break;
-            case ']': {
-                result = s.top();
-                s.pop();
-                if(!s.empty()) {
-                    appendProperty(s, result, n.top());
-                }
-                n.pop();
-                state = propertyName;
-            } break;
-            case ':': {
-                state = propertyValue;
-            } break;
-            case ',': {
-                if(s.top().type() == MetaType::VARIANTLIST) {
-                    state = propertyValue;
-                } else {
-                    state = propertyName;
-                    name = "";
+            case JsonReader::ObjectEnd:
+            case JsonReader::ArrayEnd: {
+                if(stack.empty()) {
+                    return result;
                 }
+                result = stack.back().container;
+                TString n = stack.back().name;
+                stack.pop_back();
+
+                appendProperty(stack, result, n);
             } break;
-            case '"': {
-                TString str = readString(data, it);
-                if(state == propertyName) {
-                    name = str;
-                } else {
-                    appendProperty(s, str, name);
-                }
+            case JsonReader::Name: {
+                name = TString(reader.text());
             } break;
-            case '0':
-            case '1':
-            case '2':
-            case '3':
-            case '4':
-            case '5':
-            case '6':
-            case '7':
-            case '8':
-            case '9':
-            case '-': {
-                uint32_t st = it;
-                bool number = false;
-                bool enotation = false;
-                while(it < data.length()) {
-                    char c = data.at(++it);
-                    if(!isDigit(c) && c != '.') {
-                        if(c != 'e' && c != 'E') {
-                            if(enotation) {
-                                if(c != '+' && c != '-') {
-                                    break;
-                                }
-                            } else {
-                                break;
-                            }
-                        } else {
-                            enotation = true;
-                        }
-                    }
-                    if(c == '.') {
-                        number = true;
-                    }
-                }
-                if(state == propertyValue) {
-                    Variant v(data.mid(st, it - st));
-                    appendProperty(s, (number) ? Variant(v.toFloat()) : Variant(v.toInt()), name);
-                }
-                it--;
+            case JsonReader::String: {
+                appendProperty(stack, TString(reader.text()), name);
             } break;
-            case 't': {
-                if(data.mid(it, 4) == J_TRUE) {
-                    if(state == propertyValue) {
-                        appendProperty(s, true, name);
-                    }
-                    it += 3;
-                }
+            case JsonReader::Number: {
+                appendProperty(stack, reader.isFloat() ? Variant(reader.toFloat()) : Variant(reader.toInt()), name);
             } break;
-            case 'f': {
-                if(data.mid(it, 5) == J_FALSE) {
-                    if(state == propertyValue) {
-                        appendProperty(s, false, name);
-                    }
-                    it += 4;
-                }
+            case JsonReader::Boolean: {
+                appendProperty(stack, reader.toBool(), name);
             } break;
-            case 'n': {
-                if(data.mid(it, 4) == J_NULL) {
-                    if(state == propertyValue) {
-                        appendProperty(s, static_cast<void *>(nullptr), name);
-                    }
-                    it += 3;
-                }
+            case JsonReader::Null: {
+                // Null values have always been restored as false
+                appendProperty(stack, false, name);
             } break;
-            default: {
+            case JsonReader::End: {
                 return result;
             }
+            default: {
+                return stack.empty() ? result : Variant();
+            }
         }
-        it++;
-        skipSpaces(data.data(), it);
     }
     return result;
 }
@@ -326,3 +224,202 @@ TString Json::save(const Variant &data, int32_t tab) {
     }
     return result;
 }
+
+/*!
+    \class JsonReader
+    \brief Pull parser for JSON documents.
+    \since Next 1.0
+    \inmodule Core
+
+    JsonReader splits a document into tokens in place.
+    Names, strings and numbers are returned as views into the source text, so nothing is allocated while the document is parsed.
+    The text must stay alive while the reader and the views returned by it are used.
+    Escape sequences in strings are kept as is.
+
+    Example:
+    \code
+        JsonReader reader(data);
+        JsonReader::Token token = reader.next();
+        while(token != JsonReader::End && token != JsonReader::Invalid) {
+            if(token == JsonReader::Name && reader.text() == "version") {
+                reader.next();
+                int32_t version = reader.toInt();
+                ....
+            }
+            token = reader.next();
+        }
+    \endcode
+*/
+/*!
+    Constructs a reader for the text \a data with \a size.
+*/
+JsonReader::JsonReader(const char *data, size_t size) :
+        m_data(data),
+        m_size(data ? size : 0),
+        m_position(0),
+        m_token(Invalid),
+        m_float(false),
+        m_expectName(false) {
+
+}
+/*!
+    Constructs a reader for the text \a data.
+*/
+JsonReader::JsonReader(const TString &data) :
+        JsonReader(data.data(), data.size()) {
+
+}
+/*!
+    Reads the next token and returns its type.
+    Returns JsonReader::End at the end of the text and JsonReader::Invalid if an unexpected character is found.
+*/
+JsonReader::Token JsonReader::next() {
+    m_text = std::string_view();
+    m_float = false;
+
+    while(true) {
+        while(m_position < m_size && isSpace(m_data[m_position])) {
+            m_position++;
+        }
+        if(m_position >= m_size) {
+            m_token = End;
+            return m_token;
+        }
+
+        const char c = m_data[m_position];
+        switch(c) {
+            case '{':
+            case '[': {
+                m_position++;
+                m_scopes.push_back(c == '{');
+                m_expectName = (c == '{');
+                m_token = (c == '{') ? ObjectBegin : ArrayBegin;
+                return m_token;
+            }
+            case '}':
+            case ']': {
+                m_position++;
+                if(!m_scopes.empty()) {
+                    m_scopes.pop_back();
+                }
+                m_expectName = false;
+                m_token = (c == '}') ? ObjectEnd : ArrayEnd;
+                return m_token;
+            }
+            case ':': {
+                m_position++;
+                m_expectName = false;
+            } break;
+            case ',': {
+                m_position++;
+                m_expectName = !m_scopes.empty() && m_scopes.back();
+            } break;
+            case '"': {
+                size_t begin = ++m_position;
+                while(m_position < m_size && m_data[m_position] != '"') {
+                    if(m_data[m_position] == '\\') {
+                        m_position++;
+                    }
+                    m_position++;
+                }
+                if(m_position >= m_size) {
+                    m_token = Invalid;
+                    return m_token;
+                }
+                m_text = std::string_view(m_data + begin, m_position - begin);
+                m_position++;
+
+                m_token = m_expectName ? Name : String;
+                m_expectName = false;
+                return m_token;
+            }
+            case 't':
+            case 'f':
+            case 'n': {
+                std::string_view rest(m_data + m_position, m_size - m_position);
+                const char *literal = (c == 't') ? J_TRUE : ((c == 'f') ? J_FALSE : J_NULL);
+                size_t length = strlen(literal);
+                if(rest.compare(0, length, literal) != 0) {
+                    m_token = Invalid;
+                    return m_token;
+                }
+                m_text = rest.substr(0, length);
+                m_position += length;
+
+                m_token = (c == 'n') ? Null : Boolean;
+                return m_token;
+            }
+            default: {
+                if(!isDigit(c) && c != '-') {
+                    m_token = Invalid;
+                    return m_token;
+                }
+
+                size_t begin = m_position++;
+                bool exponent = false;
+                while(m_position < m_size) {
+                    char n = m_data[m_position];
+                    if(n == '.') {
+                        m_float = true;
+                    } else if(n == 'e' || n == 'E') {
+                        m_float = exponent = true;
+                    } else if(!isDigit(n) && !(exponent && (n == '+' || n == '-'))) {
+                        break;
+                    }
+                    m_position++;
+                }
+                m_text = std::string_view(m_data + begin, m_position - begin);
+
+                m_token = Number;
+                return m_token;
+            }
+        }
+    }
+}
+/*!
+    Returns the type of the current token.
+*/
+JsonReader::Token JsonReader::token() const {
+    return m_token;
+}
+/*!
+    Returns the text of the current name, string, number or literal token as a view into the source text.
+    Quotes around names and strings are excluded.
+*/
+std::string_view JsonReader::text() const {
+    return m_text;
+}
+/*!
+    Returns true if the current number token has a fractional part or an exponent.
+*/
+bool JsonReader::isFloat() const {
+    return m_float;
+}
+/*!
+    Returns the value of the current boolean token.
+*/
+bool JsonReader::toBool() const {
+    return m_token == Boolean && m_text == J_TRUE;
+}
+/*!
+    Returns the value of the current number token as an integer.
+*/
+int32_t JsonReader::toInt() const {
+    if(m_token == Number) {
+        char buffer[gNumberLength];
+        terminate(m_text, buffer);
+        return static_cast<int32_t>(strtol(buffer, nullptr, 10));
+    }
+    return 0;
+}
+/*!
+    Returns the value of the current number token as a float.
+*/
+float JsonReader::toFloat() const {
+    if(m_token == Number) {
+        char buffer[gNumberLength];
+        terminate(m_text, buffer);
+        return strtof(buffer, nullptr);
+    }
+    return 0.0f;
+}
@@ -20,6 +20,7 @@
 
 #include "core/object.h"
 #include "core/invalid.h"
+#include "core/bson.h"
 
 #include "math/amath.h"
 
@@ -273,7 +274,7 @@ Object *ObjectSystem::toObject(const Variant &variant, Object *parent, const TSt
 
     bool first = true;
 
-    std::unordered_map<uint32_t, Object *> localCache;
+    ObjectMap localCache;
 
     // Create all declared objects
     VariantList objects = variant.value<VariantList>();
@@ -295,52 +296,7 @@ Object *ObjectSystem::toObject(const Variant &variant, Object *parent, const TSt
             }
             i++;
 
-            Object *parentObject = parent;
-            Object *tempObject = nullptr;
-            auto localIt = localCache.find(parentUuid);
-            if(localIt != localCache.end()) {
-                tempObject = localIt->second;
-            } else {
-                tempObject = findObject(parentUuid);
-            }
-            if(tempObject != nullptr) {
-                parentObject = tempObject;
-            }
-
-            Object *object = nullptr;
-            localIt = localCache.find(uuid);
-            if(localIt != localCache.end()) {
-                object = localIt->second;
-            } else if(!s_blockCache) {
-                object = findObject(uuid);
-            }
-
-            if(object == nullptr) {
-                object = objectCreate(type, n, parentObject);
-
-                if(object && uuid != 0) {
-                    replaceUUID(object, uuid);
-                    localCache[uuid] = object;
-                }
-            }
-
-            if(object == nullptr) {
-                // Create a dummy object to keep all fields
-                Invalid *invalid = new Invalid();
-                invalid->loadData(o);
-                s_Invalids.push_back(invalid);
-
-                object = invalid;
-                if(parentObject) {
-                    object->setSystem(parentObject->system());
-                }
-                if(uuid != 0) {
-                    replaceUUID(object, uuid);
-                    localCache[uuid] = object;
-                }
-                object->setName(n);
-                object->setParent(parentObject);
-            }
+            Object *object = restoreObject(type, uuid, parentUuid, n, parent, localCache, [&o]() { return o; });
 
             i++;
             i++;
@@ -364,13 +320,7 @@ Object *ObjectSystem::toObject(const Variant &variant, Object *parent, const TSt
             i++;
             i++;
 
-            Object *object = nullptr;
-            auto localIt = localCache.find(uuid);
-            if(localIt != localCache.end()) {
-                object = localIt->second;
-            } else {
-                object = findObject(uuid);
-            }
+            Object *object = findCachedObject(uuid, localCache);
             if(object == nullptr) {
                 return nullptr;
             }
@@ -394,25 +344,13 @@ Object *ObjectSystem::toObject(const Variant &variant, Object *parent, const TSt
                 if(list.size() == 4) {
                     auto l = list.begin();
 
-                    uint32_t senderUuid = static_cast<uint32_t>((*l).toInt());
-                    auto localIt = localCache.find(senderUuid);
-                    if(localIt != localCache.end()) {
-                        sender = localIt->second;
-                    } else {
-                        sender = findObject(senderUuid);
-                    }
+                    sender = findCachedObject(static_cast<uint32_t>((*l).toInt()), localCache);
                     l++;
 
                     TString signal = (*l).toString();
                     l++;
 
-                    uint32_t receiverUuid = static_cast<uint32_t>((*l).toInt());
-                    localIt = localCache.find(receiverUuid);
-                    if(localIt != localCache.end()) {
-                        receiver = localIt->second;
-                    } else {
-                        receiver = findObject(receiverUuid);
-                    }
+                    receiver = findCachedObject(static_cast<uint32_t>((*l).toInt()), localCache);
                     l++;
 
                     TString method = (*l).toString();
@@ -441,6 +379,138 @@ Object *ObjectSystem::toObject(const Variant &variant, Object *parent, const TSt
 
     return result;
 }
+/*!
+    Returns objects deserialized straight from the BSON document provided by \a reader.
+    The result is the same as for toObject(const Variant &, Object *, const TString &) with the document loaded by Bson::load(), but property values and connections are read in place without building the intermediate Variant tree.
+    Deserialization will try to restore objects hierarchy with \a parent, its properties and connections.
+    The root object will be created with a \a name in case of this parameter provided.
+*/
+Object *ObjectSystem::toObject(const BsonReader &reader, Object *parent, const TString &name) {
+    PROFILE_FUNCTION();
+    Object *result = nullptr;
+
+    bool first = true;
+
+    ObjectMap localCache;
+
+    struct Record {
+        Object *object;
+
+        BsonReader properties;
+
+        BsonReader links;
+
+        BsonReader dynamic;
+
+        Variant user;
+    };
+    std::vector<Record> records;
+
+    static const VariantMap empty;
+
+    // Create all declared objects
+    BsonReader objects(reader);
+    while(objects.next()) {
+        BsonReader o = objects.toDocument();
+
+        Record record = { nullptr, BsonReader(), BsonReader(), BsonReader(), Variant() };
+
+        TString type;
+        uint32_t uuid = 0;
+        uint32_t parentUuid = 0;
+        TString n;
+
+        uint32_t index = 0;
+        while(o.next()) {
+            switch(index) {
+                case 0: type = TString(o.toString()); break;
+                case 1: uuid = static_cast<uint32_t>(o.toInt()); break;
+                case 2: parentUuid = static_cast<uint32_t>(o.toInt()); break;
+                case 3: n = TString(o.toString()); break;
+                case 4: record.properties = o.toDocument(); break;
+                case 5: record.links = o.toDocument(); break;
+                case 6: record.user = o.toVariant(); break;
+                case 7: record.dynamic = o.toDocument(); break;
+                default: break;
+            }
+            index++;
+        }
+
+        if(index >= 5) {
+            if(first && !name.isEmpty()) {
+                n = name;
+                first = false;
+            }
+
+            BsonReader data = objects.toDocument();
+            record.object = restoreObject(type, uuid, parentUuid, n, parent, localCache, [&data]() {
+                return data.document(MetaType::VARIANTLIST).value<VariantList>();
+            });
+
+            // Load object data
+            const VariantMap &user = (record.user.type() == MetaType::VARIANTMAP) ? *(reinterpret_cast<VariantMap *>(record.user.data())) : empty;
+            record.object->loadObjectData(user);
+
+            if(result == nullptr) {
+                result = record.object;
+            }
+
+            records.push_back(record);
+        }
+    }
+
+    for(auto &it : records) {
+        Object *object = it.object;
+
+        // Load base properties
+        while(it.properties.next()) {
+            uint8_t type = it.properties.type();
+            if(type != Bson::OBJECT && type != Bson::ARRAY) {
+                object->setProperty(it.properties.name().data(), it.properties.toVariant());
+            }
+        }
+        // Restore connections
+        while(it.links.next()) {
+            BsonReader link = it.links.toDocument();
+
+            Object *sender = nullptr;
+            Object *receiver = nullptr;
+            std::string_view signal;
+            std::string_view method;
+
+            uint32_t index = 0;
+            while(link.next()) {
+                switch(index) {
+                    case 0: sender = findCachedObject(static_cast<uint32_t>(link.toInt()), localCache); break;
+                    case 1: signal = link.toString(); break;
+                    case 2: receiver = findCachedObject(static_cast<uint32_t>(link.toInt()), localCache); break;
+                    case 3: method = link.toString(); break;
+                    default: break;
+                }
+                index++;
+            }
+
+            if(index == 4) {
+                connect(sender, TString(signal).data(), receiver, TString(method).data());
+            }
+        }
+        // Load user data
+        const VariantMap &user = (it.user.type() == MetaType::VARIANTMAP) ? *(reinterpret_cast<VariantMap *>(it.user.data())) : empty;
+        object->loadUserData(user);
+        // Load dynamic properties
+        while(it.dynamic.next()) {
+            BsonReader pair = it.dynamic.toDocument();
+            if(pair.next() && pair.type() == Bson::STRING) {
+                TString property(pair.toString());
+                if(pair.next()) {
+                    object->setProperty(property.data(), pair.toVariant());
+                }
+            }
+        }
+    }
+
+    return result;
+}
 /*!
     Returns the new unique ID based on random number generator.
 */
@@ -576,3 +646,56 @@ Object::ObjectList ObjectSystem::getAllObjectsByType(const TString &type) const
     }
     return result;
 }
+
+Object *ObjectSystem::findCachedObject(uint32_t uuid, const ObjectMap &cache) {
+    auto it = cache.find(uuid);
+    if(it != cache.end()) {
+        return it->second;
+    }
+    return findObject(uuid);
+}
+
+Object *ObjectSystem::restoreObject(const TString &type, uint32_t uuid, uint32_t parentUuid, const TString &name, Object *parent, ObjectMap &cache, const std::function<VariantList ()> &data) {
+    Object *parentObject = parent;
+    Object *tempObject = findCachedObject(parentUuid, cache);
+    if(tempObject != nullptr) {
+        parentObject = tempObject;
+    }
+
+    Object *object = nullptr;
+    auto localIt = cache.find(uuid);
+    if(localIt != cache.end()) {
+        object = localIt->second;
+    } else if(!s_blockCache) {
+        object = findObject(uuid);
+    }
+
+    if(object == nullptr) {
+        object = objectCreate(type, name, parentObject);
+
+        if(object && uuid != 0) {
+            replaceUUID(object, uuid);
+            cache[uuid] = object;
+        }
+    }
+
+    if(object == nullptr) {
+        // Create a dummy object to keep all fields
+        Invalid *invalid = new Invalid();
+        invalid->loadData(data());
+        s_Invalids.push_back(invalid);
+
+        object = invalid;
+        if(parentObject) {
+            object->setSystem(parentObject->system());
+        }
+        if(uuid != 0) {
+            replaceUUID(object, uuid);
+            cache[uuid] = object;
+        }
+        object->setName(name);
+        object->setParent(parentObject);
+    }
+
+    return object;
+}
@@ -3,6 +3,8 @@
 #include "math/aabb.h"
 #include "math/obb.h"
 
+#include "math/simd.h"
+
 Frustum::Frustum() {
 
 }
@@ -25,6 +27,88 @@ bool Frustum::contains(const OBBox &bb) const {
            isOnOrForwardPlane(m_far, bb);
 }
 
+/*!
+    Tests \a count bounding spheres stored as separate arrays of center coordinates \a x, \a y, \a z and \a radius against the frustum.
+    Writes 1 into \a result for each sphere which is inside or intersects the frustum; otherwise writes 0.
+    A sphere is rejected if the signed distance from its center to any of the six frustum planes is less than minus its radius.
+    The test is conservative, so spheres near the edges of the frustum can be reported as visible.
+    Four spheres are processed at once on SSE2 and NEON capable platforms.
+*/
+void Frustum::containsSpheres(const float *x, const float *y, const float *z, const float *radius, uint32_t count, uint8_t *result) const {
+    const Plane *planes[6] = { &m_top, &m_bottom, &m_left, &m_right, &m_near, &m_far };
+
+    uint32_t i = 0;
+#if defined(NEXT_SSE)
+    __m128 nx[6], ny[6], nz[6], nd[6];
+    for(int p = 0; p < 6; p++) {
+        nx[p] = _mm_set1_ps(planes[p]->normal.x);
+        ny[p] = _mm_set1_ps(planes[p]->normal.y);
+        nz[p] = _mm_set1_ps(planes[p]->normal.z);
+        nd[p] = _mm_set1_ps(planes[p]->d);
+    }
+    const __m128 zero = _mm_setzero_ps();
+
+    for(; i + 4 <= count; i += 4) {
+        __m128 cx = _mm_loadu_ps(x + i);
+        __m128 cy = _mm_loadu_ps(y + i);
+        __m128 cz = _mm_loadu_ps(z + i);
+        __m128 r = _mm_loadu_ps(radius + i);
+
+        __m128 mask = _mm_cmpeq_ps(zero, zero);
+        for(int p = 0; p < 6; p++) {
+            __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx[p], cx), _mm_mul_ps(ny[p], cy)), _mm_mul_ps(nz[p], cz));
+            d = _mm_add_ps(_mm_sub_ps(d, nd[p]), r);
+            mask = _mm_and_ps(mask, _mm_cmpge_ps(d, zero));
+        }
+
+        int bits = _mm_movemask_ps(mask);
+        result[i] = bits & 1;
+        result[i + 1] = (bits >> 1) & 1;
+        result[i + 2] = (bits >> 2) & 1;
+        result[i + 3] = (bits >> 3) & 1;
+    }
+#elif defined(NEXT_NEON)
+    float32x4_t nx[6], ny[6], nz[6], nd[6];
+    for(int p = 0; p < 6; p++) {
+        nx[p] = vdupq_n_f32(planes[p]->normal.x);
+        ny[p] = vdupq_n_f32(planes[p]->normal.y);
+        nz[p] = vdupq_n_f32(planes[p]->normal.z);
+        nd[p] = vdupq_n_f32(planes[p]->d);
+    }
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+
+    for(; i + 4 <= count; i += 4) {
+        float32x4_t cx = vld1q_f32(x + i);
+        float32x4_t cy = vld1q_f32(y + i);
+        float32x4_t cz = vld1q_f32(z + i);
+        float32x4_t r = vld1q_f32(radius + i);
+
+        uint32x4_t mask = vdupq_n_u32(0xffffffff);
+        for(int p = 0; p < 6; p++) {
+            float32x4_t d = vaddq_f32(vaddq_f32(vmulq_f32(nx[p], cx), vmulq_f32(ny[p], cy)), vmulq_f32(nz[p], cz));
+            d = vaddq_f32(vsubq_f32(d, nd[p]), r);
+            mask = vandq_u32(mask, vcgeq_f32(d, zero));
+        }
+
+        uint32_t bits[4];
+        vst1q_u32(bits, mask);
+        result[i] = bits[0] & 1;
+        result[i + 1] = bits[1] & 1;
+        result[i + 2] = bits[2] & 1;
+        result[i + 3] = bits[3] & 1;
+    }
+#endif
+
+    for(; i < count; i++) {
+        bool inside = true;
+        for(int p = 0; p < 6 && inside; p++) {
+            float d = planes[p]->normal.x * x[i] + planes[p]->normal.y * y[i] + planes[p]->normal.z * z[i] - planes[p]->d;
+            inside = (d >= -radius[i]);
+        }
+        result[i] = inside ? 1 : 0;
+    }
+}
+
 bool Frustum::isOnOrForwardPlane(const Plane &plane, const AABBox &bb) const {
     float d = plane.normal.dot(bb.center) - plane.d;
 
@@ -0,0 +1,73 @@
+/*
+    This file is part of Thunder Next.
+
+    Copyright 2008-2026 Evgeniy Prikazchikov
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tst_common.h"
+
+#include "frustum.h"
+#include "aabb.h"
+
+namespace NextSuite {
+    class FrustumTest : public ::testing::Test {
+    public:
+        Frustum box(float size) {
+            Frustum result;
+            result.m_top = Plane(Vector3(0.0f, size, 0.0f), Vector3(0.0f,-1.0f, 0.0f));
+            result.m_bottom = Plane(Vector3(0.0f,-size, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+            result.m_left = Plane(Vector3(-size, 0.0f, 0.0f), Vector3(1.0f, 0.0f, 0.0f));
+            result.m_right = Plane(Vector3(size, 0.0f, 0.0f), Vector3(-1.0f, 0.0f, 0.0f));
+            result.m_near = Plane(Vector3(0.0f, 0.0f,-size), Vector3(0.0f, 0.0f, 1.0f));
+            result.m_far = Plane(Vector3(0.0f, 0.0f, size), Vector3(0.0f, 0.0f,-1.0f));
+            return result;
+        }
+    };
+
+    TEST_F(FrustumTest, Contains_spheres) {
+        Frustum frustum(box(10.0f));
+
+        const uint32_t count = 1023;
+        std::vector<float> x(count), y(count), z(count), r(count);
+        std::vector<uint8_t> result(count);
+
+        uint32_t seed = 1;
+        auto random = [&seed](float range) {
+            seed = seed * 1664525 + 1013904223;
+            return (float(seed >> 8) / float(1 << 24) * 2.0f - 1.0f) * range;
+        };
+
+        for(uint32_t i = 0; i < count; i++) {
+            x[i] = random(20.0f);
+            y[i] = random(20.0f);
+            z[i] = random(20.0f);
+            r[i] = fabs(random(5.0f));
+        }
+
+        frustum.containsSpheres(x.data(), y.data(), z.data(), r.data(), count, result.data());
+
+        uint32_t visible = 0;
+        for(uint32_t i = 0; i < count; i++) {
+            AABBox bb(Vector3(x[i], y[i], z[i]), Vector3(1.0f));
+            bb.radius = r[i];
+
+            ASSERT_EQ(result[i] != 0, frustum.contains(bb));
+            visible += result[i];
+        }
+
+        ASSERT_TRUE(visible > 0);
+        ASSERT_TRUE(visible < count);
+    }
+}
@@ -0,0 +1,161 @@
+/*
+    This file is part of Thunder Next.
+
+    Copyright 2008-2026 Evgeniy Prikazchikov
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tst_common.h"
+
+#include "jobsystem.h"
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+namespace NextSuite {
+    class JobSystemTest : public ::testing::Test {
+
+    };
+
+    TEST_F(JobSystemTest, Dispatch_jobs) {
+        JobSystem jobs(4);
+
+        std::atomic<uint32_t> result(0);
+
+        JobCounter counter;
+        for(int i = 0; i < 10000; i++) {
+            jobs.dispatch([&result]() { result++; }, &counter);
+        }
+        jobs.wait(&counter);
+
+        ASSERT_TRUE(counter.isDone());
+        ASSERT_EQ(result.load(), uint32_t(10000));
+    }
+
+    TEST_F(JobSystemTest, Job_dependencies) {
+        JobSystem jobs(4);
+
+        std::atomic<uint32_t> first(0);
+        std::atomic<uint32_t> violations(0);
+
+        JobCounter stage1;
+        JobCounter stage2;
+        for(int i = 0; i < 64; i++) {
+            jobs.dispatch([&first]() { first++; }, &stage1);
+        }
+        for(int i = 0; i < 64; i++) {
+            jobs.dispatch([&first, &violations]() {
+                if(first.load() != 64) {
+                    violations++;
+                }
+            }, &stage2, &stage1);
+        }
+        jobs.wait(&stage2);
+
+        ASSERT_EQ(first.load(), uint32_t(64));
+        ASSERT_EQ(violations.load(), uint32_t(0));
+    }
+
+    TEST_F(JobSystemTest, Nested_jobs) {
+        JobSystem jobs(4);
+
+        std::atomic<uint32_t> result(0);
+
+        JobCounter counter;
+        for(int i = 0; i < 16; i++) {
+            jobs.dispatch([&jobs, &result, &counter]() {
+                for(int j = 0; j < 16; j++) {
+                    jobs.dispatch([&result]() { result++; }, &counter);
+                }
+            }, &counter);
+        }
+        jobs.waitForDone();
+
+        ASSERT_EQ(result.load(), uint32_t(256));
+    }
+
+    TEST_F(JobSystemTest, Parallel_for) {
+        JobSystem jobs(4);
+
+        std::vector<uint32_t> data(100000, 1);
+        jobs.parallelFor(data.size(), 0, [&data](uint32_t begin, uint32_t end) {
+            for(uint32_t i = begin; i < end; i++) {
+                data[i] += i;
+            }
+        });
+
+        for(uint32_t i = 0; i < data.size(); i++) {
+            ASSERT_EQ(data[i], i + 1);
+        }
+
+        JobCounter counter;
+        std::atomic<uint32_t> sum(0);
+        jobs.parallelFor(1000, 10, [&sum](uint32_t begin, uint32_t end) {
+            sum += end - begin;
+        }, &counter);
+        jobs.wait(&counter);
+
+        ASSERT_EQ(sum.load(), uint32_t(1000));
+    }
+
+    TEST_F(JobSystemTest, Foreign_thread_dispatch) {
+        JobSystem jobs(2);
+
+        std::atomic<uint32_t> result(0);
+        int32_t index = 0;
+
+        std::thread thread([&jobs, &result, &index]() {
+            index = JobSystem::currentThreadIndex();
+
+            JobCounter counter;
+            for(int i = 0; i < 1000; i++) {
+                jobs.dispatch([&result]() { result++; }, &counter);
+            }
+            jobs.wait(&counter);
+        });
+        thread.join();
+
+        ASSERT_EQ(result.load(), uint32_t(1000));
+        ASSERT_EQ(index, -1);
+        ASSERT_EQ(JobSystem::currentThreadIndex(), 0);
+    }
+
+    TEST_F(JobSystemTest, Benchmark_jobs_per_second) {
+        const uint32_t count = 200000;
+
+        uint32_t threads = std::max(std::thread::hardware_concurrency(), 1U);
+        for(uint32_t t = 1; t <= threads; t++) {
+            JobSystem jobs(t);
+
+            std::atomic<uint32_t> result(0);
+
+            auto begin = std::chrono::high_resolution_clock::now();
+
+            JobCounter counter;
+            for(uint32_t i = 0; i < count; i++) {
+                jobs.dispatch([&result]() { result.fetch_add(1, std::memory_order_relaxed); }, &counter);
+            }
+            jobs.wait(&counter);
+
+            auto end = std::chrono::high_resolution_clock::now();
+            double seconds = std::chrono::duration<double>(end - begin).count();
+
+            // Reported in the test results (--gtest_output=xml) instead of the console
+            RecordProperty("jobs_per_second_" + std::to_string(t), std::to_string(uint64_t(count / seconds)));
+
+            ASSERT_EQ(result.load(), count);
+        }
+    }
+}
@@ -1,6 +1,9 @@
 #include "tst_variant.h"
 #include "tst_serialization.h"
 #include "tst_threadpool.h"
+#include "tst_jobsystem.h"
+#include "tst_profiler.h"
+#include "tst_frustum.h"
 #include "tst_url.h"
 #include "tst_object.h"
 #include "tst_objectsystem.h"
@@ -143,4 +143,45 @@ namespace NextSuite {
 
         delete clone;
     }
+
+    TEST_F(ObjectSystemTest, Desirialize_Object_From_Reader) {
+        ObjectSystem objectSystem;
+        TestObject::registerClassFactory(&objectSystem);
+
+        TestObject* obj1 = ObjectSystem::objectCreate<TestObject>();
+        TestObject* obj2 = ObjectSystem::objectCreate<TestObject>();
+
+        obj1->setName("MainObject");
+        obj1->setProperty("IntProperty", 5);
+        obj1->setProperty("vec", Vector2(1.0f, 2.0f));
+
+        obj2->setName("TestComponent2");
+        obj2->setParent(obj1);
+
+        ASSERT_TRUE(Object::connect(obj1, _SIGNAL(signal(int)), obj2, _SLOT(setSlot(int))));
+
+        ByteArray bytes = Bson::save(ObjectSystem::toVariant(obj1));
+        Object* clone = obj1->clone();
+
+        uint32_t id = obj1->uuid();
+
+        delete obj2;
+        delete obj1;
+
+        Object* result = ObjectSystem::toObject(BsonReader(bytes), nullptr, "Renamed");
+
+        ASSERT_TRUE(result != nullptr);
+        ASSERT_EQ(result->uuid(), id);
+        ASSERT_EQ(result->name(), TString("Renamed"));
+        ASSERT_EQ(result->getReceivers().size(), size_t(1));
+        ASSERT_EQ(result->property("IntProperty").toInt(), 5);
+        ASSERT_EQ(result->property("vec").value<Vector2>(), Vector2(1.0f, 2.0f));
+
+        clone->setName("Renamed");
+        ASSERT_TRUE(compare(*clone, *result));
+
+        delete result;
+
+        delete clone;
+    }
 }
@@ -0,0 +1,128 @@
+/*
+    This file is part of Thunder Next.
+
+    Copyright 2008-2026 Evgeniy Prikazchikov
+
+    Licensed under the Apache License, Version 2.0 (the "License");
+    you may not use this file except in compliance with the License.
+    You may obtain a copy of the License at
+
+        http://www.apache.org/licenses/LICENSE-2.0
+
+    Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+    See the License for the specific language governing permissions and
+    limitations under the License.
+*/
+
+#include "tst_common.h"
+
+#include "analytics/profiler.h"
+#include "json.h"
+
+#include <thread>
+
+namespace NextSuite {
+    class ProfilerTest : public ::testing::Test {
+
+    };
+
+    TEST_F(ProfilerTest, Nested_scopes) {
+        Profiler::start();
+        {
+            Profiler outer("outer");
+            {
+                Profiler inner("inner");
+            }
+        }
+        Profiler::frameMark();
+        Profiler::stop();
+
+        {
+            Profiler ignored("ignored");
+        }
+
+        Profiler::EventList events = Profiler::events();
+        ASSERT_EQ(events.size(), size_t(5));
+
+        ASSERT_EQ(TString(events[0].name), TString("outer"));
+        ASSERT_EQ(events[0].type, Profiler::Begin);
+        ASSERT_EQ(events[0].depth, 0);
+
+        ASSERT_EQ(TString(events[1].name), TString("inner"));
+        ASSERT_EQ(events[1].type, Profiler::Begin);
+        ASSERT_EQ(events[1].depth, 1);
+
+        ASSERT_EQ(events[2].type, Profiler::End);
+        ASSERT_EQ(events[2].depth, 1);
+
+        ASSERT_EQ(events[3].type, Profiler::End);
+        ASSERT_EQ(events[3].depth, 0);
+
+        ASSERT_EQ(events[4].type, Profiler::Frame);
+
+        ASSERT_TRUE(events[0].time <= events[4].time);
+    }
+
+    TEST_F(ProfilerTest, Threads_and_trace_export) {
+        const int threads = 4;
+        const int scopes = 100;
+
+        Profiler::start();
+
+        std::vector<std::thread> workers;
+        for(int t = 0; t < threads; t++) {
+            workers.push_back(std::thread([]() {
+                for(int i = 0; i < scopes; i++) {
+                    Profiler scope("work");
+                    Profiler::statAdd("ITEMS", 1);
+                }
+            }));
+        }
+        for(auto &it : workers) {
+            it.join();
+        }
+
+        Profiler::stop();
+
+        ASSERT_EQ(Profiler::stat("ITEMS"), uint32_t(threads * scopes));
+        Profiler::statReset("ITEMS");
+        ASSERT_EQ(Profiler::stat("ITEMS"), uint32_t(0));
+
+        Profiler::EventList events = Profiler::events();
+        ASSERT_EQ(events.size(), size_t(threads * scopes * 2));
+        ASSERT_EQ(Profiler::dropped(), uint32_t(0));
+
+        VariantMap trace = Json::load(Profiler::chromeTrace()).toMap();
+        VariantList list = trace["traceEvents"].toList();
+        ASSERT_EQ(list.size(), size_t(threads * scopes * 2));
+
+        VariantMap first = list.front().toMap();
+        ASSERT_EQ(first["name"].toString(), TString("work"));
+        ASSERT_EQ(first["ph"].toString(), TString("B"));
+    }
+
+    TEST_F(ProfilerTest, Ring_buffer_overflow) {
+        Profiler::start();
+
+        for(int i = 0; i < 100000; i++) {
+            Profiler scope("scope");
+        }
+
+        Profiler::stop();
+
+        // Buffer is not flushed so part of scopes must be dropped, but begin and end events stay paired
+        ASSERT_TRUE(Profiler::dropped() > 0);
+
+        Profiler::EventList events = Profiler::events();
+        ASSERT_EQ(events.size() % 2, size_t(0));
+        for(size_t i = 0; i < events.size(); i += 2) {
+            ASSERT_EQ(events[i].type, Profiler::Begin);
+            ASSERT_EQ(events[i + 1].type, Profiler::End);
+        }
+
+        Profiler::clear();
+        ASSERT_TRUE(Profiler::events().empty());
+    }
+}
@@ -72,4 +72,105 @@ namespace NextSuite {
 
         ASSERT_TRUE(Variant(var1) == Bson::load(Bson::save(var1), MetaType::VARIANTMAP));
     }
+
+    TEST_F(SerializationTest, Bson_Writer_Reader) {
+        ByteArray data;
+        data.reserve(BsonWriter::size(var1));
+
+        BsonWriter writer(data);
+        writer.write(std::string_view(), var1);
+
+        ASSERT_EQ(data.size(), BsonWriter::size(var1));
+        ASSERT_TRUE(data == Bson::save(var1));
+
+        ByteArray bin = { '\x00','\x01','\x02' };
+
+        data.clear();
+        writer.beginObject();
+            writer.writeString("name", "Cube");
+            writer.writeBinary("blob", bin.data(), bin.size());
+            writer.beginArray("list");
+                writer.writeInt(std::string_view(), 1);
+                writer.writeFloat(std::string_view(), 2.0f);
+            writer.end();
+        writer.end();
+
+        BsonReader reader(data);
+        ASSERT_TRUE(reader.next());
+        ASSERT_EQ(reader.name(), "name");
+        ASSERT_EQ(reader.toString(), "Cube");
+
+        ASSERT_TRUE(reader.next());
+        ASSERT_EQ(reader.type(), Bson::BINARY);
+        size_t size = 0;
+        const uint8_t *blob = reader.toBinary(size);
+        ASSERT_EQ(size, bin.size());
+        // Payload points into the source buffer
+        ASSERT_TRUE(blob > data.data() && blob + size < data.data() + data.size());
+
+        ASSERT_TRUE(reader.next());
+        BsonReader list = reader.toDocument();
+        ASSERT_TRUE(list.next());
+        ASSERT_EQ(list.name(), "0");
+        ASSERT_EQ(list.toInt(), 1);
+        ASSERT_TRUE(list.next());
+        ASSERT_EQ(list.name(), "1");
+        ASSERT_EQ(list.toFloat(), 2.0f);
+        ASSERT_FALSE(list.next());
+
+        ASSERT_FALSE(reader.next());
+        ASSERT_TRUE(reader.isValid());
+
+        VariantMap map = Bson::load(data, MetaType::VARIANTMAP).toMap();
+        ASSERT_EQ(map["name"].toString(), TString("Cube"));
+        ASSERT_TRUE(map["blob"].toByteArray() == bin);
+        ASSERT_EQ(map["list"].toList().size(), size_t(2));
+    }
+
+    TEST_F(SerializationTest, Bson_Malformed) {
+        ByteArray data = Bson::save(var1);
+        data.resize(data.size() - 8);
+        ASSERT_FALSE(Bson::load(data, MetaType::VARIANTMAP).isValid());
+
+        data = Bson::save(var1);
+        // Break the size of the first nested document
+        uint32_t size = 0xffff;
+        BsonReader reader(data);
+        while(reader.next() && reader.type() != Bson::ARRAY) {}
+        ASSERT_EQ(reader.type(), Bson::ARRAY);
+        size_t offset = reinterpret_cast<const uint8_t *>(reader.name().data()) - data.data() + reader.name().size() + 1;
+        memcpy(&data[offset], &size, sizeof(uint32_t));
+        ASSERT_FALSE(Bson::load(data, MetaType::VARIANTMAP).isValid());
+    }
+
+    TEST_F(SerializationTest, Json_Reader) {
+        TString data("{\"name\": \"Cube\", \"list\": [1, -2.5e1, true, null], \"pos\": {\"Vector2\": [1.0, 2.0]}}");
+
+        JsonReader reader(data);
+        ASSERT_EQ(reader.next(), JsonReader::ObjectBegin);
+        ASSERT_EQ(reader.next(), JsonReader::Name);
+        ASSERT_EQ(reader.text(), "name");
+        ASSERT_EQ(reader.next(), JsonReader::String);
+        ASSERT_EQ(reader.text(), "Cube");
+        ASSERT_EQ(reader.next(), JsonReader::Name);
+        ASSERT_EQ(reader.next(), JsonReader::ArrayBegin);
+        ASSERT_EQ(reader.next(), JsonReader::Number);
+        ASSERT_FALSE(reader.isFloat());
+        ASSERT_EQ(reader.toInt(), 1);
+        ASSERT_EQ(reader.next(), JsonReader::Number);
+        ASSERT_TRUE(reader.isFloat());
+        ASSERT_EQ(reader.toFloat(), -25.0f);
+        ASSERT_EQ(reader.next(), JsonReader::Boolean);
+        ASSERT_TRUE(reader.toBool());
+        ASSERT_EQ(reader.next(), JsonReader::Null);
+        ASSERT_EQ(reader.next(), JsonReader::ArrayEnd);
+
+        VariantMap map = Json::load(data).toMap();
+        ASSERT_EQ(map["name"].toString(), TString("Cube"));
+        ASSERT_EQ(map["list"].toList().size(), size_t(4));
+        ASSERT_EQ(map["pos"].type(), MetaType::VECTOR2);
+        ASSERT_EQ(map["pos"].value<Vector2>(), Vector2(1.0f, 2.0f));
+
+        ASSERT_FALSE(Json::load("{\"name\": \"Cube\", ").isValid());
+    }
 }